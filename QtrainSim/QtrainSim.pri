@@ -23,6 +23,9 @@ QT += core gui widgets printsupport
 !NOSOUND : QT += multimedia
 !NOSOUND : DEFINES += WITHSOUND
 
+#Lock profiling (--profil-verrous), disable with CONFIG += NOPROFILVERROUS
+!NOPROFILVERROUS : DEFINES += PROFIL_VERROUS
+
 #Target and template
 TARGET = QtrainSim
 TEMPLATE = app
@@ -96,7 +99,23 @@ SOURCES += \
     $$PWD/src/maquettemanager.cpp \
     $$PWD/src/voieaiguillageenroule.cpp \
     $$PWD/src/voieaiguillagetriple.cpp \
-    $$PWD/src/ctrain_handler.cpp
+    $$PWD/src/ctrain_handler.cpp \
+    $$PWD/src/instantanemonde.cpp \
+    $$PWD/src/declencheurvirtuel.cpp \
+    $$PWD/src/tabledistances.cpp \
+    $$PWD/src/chargeurmaquette.cpp \
+    $$PWD/src/backendtrain.cpp \
+    $$PWD/src/backendsimulateur.cpp \
+    $$PWD/src/backendnul.cpp \
+    $$PWD/src/backendtrace.cpp \
+    $$PWD/src/backendrejeu.cpp \
+    $$PWD/src/enregistreurtrace.cpp \
+    $$PWD/src/ordonnanceur.cpp \
+    $$PWD/src/bilansimulation.cpp \
+    $$PWD/src/histogramme.cpp \
+    $$PWD/src/profilverrous.cpp \
+    $$PWD/src/latencesreveil.cpp \
+    $$PWD/src/profilimages.cpp
 
 HEADERS += \
     $$PWD/src/mainwindow.h \
@@ -119,6 +138,24 @@ HEADERS += \
     $$PWD/src/maquettemanager.h \
     $$PWD/src/voieaiguillageenroule.h \
     $$PWD/src/voieaiguillagetriple.h \
-    $$PWD/src/ctrain_handler.h
+    $$PWD/src/ctrain_handler.h \
+    $$PWD/src/instantanemonde.h \
+    $$PWD/src/declencheurvirtuel.h \
+    $$PWD/src/tabledistances.h \
+    $$PWD/src/chargeurmaquette.h \
+    $$PWD/src/maquettecompilee.h \
+    $$PWD/src/backendtrain.h \
+    $$PWD/src/backendsimulateur.h \
+    $$PWD/src/backendnul.h \
+    $$PWD/src/backendtrace.h \
+    $$PWD/src/backendrejeu.h \
+    $$PWD/src/enregistreurtrace.h \
+    $$PWD/src/tracecommandes.h \
+    $$PWD/src/ordonnanceur.h \
+    $$PWD/src/bilansimulation.h \
+    $$PWD/src/histogramme.h \
+    $$PWD/src/profilverrous.h \
+    $$PWD/src/latencesreveil.h \
+    $$PWD/src/profilimages.h
 
 OTHER_FILES += $$PWD/data/infosVoies.txt
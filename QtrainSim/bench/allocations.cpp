@@ -0,0 +1,97 @@
+/*
+ * Compteur des allocations du banc.
+ *
+ * Les opérateurs new et delete globaux sont remplacés pour compter les allocations
+ * faites pendant une mesure (voir verifierAllocations). Le comptage n'est actif
+ * qu'entre debutComptageAllocations et finComptageAllocations, dans tous les threads.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "bancs.h"
+
+namespace {
+
+std::atomic<bool> comptageActif(false);
+std::atomic<unsigned long long> nbreAllocations(0);
+
+void* allouer(std::size_t taille)
+{
+    if(comptageActif.load(std::memory_order_relaxed))
+        nbreAllocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* p = std::malloc(taille == 0 ? 1 : taille);
+    if(p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+
+} // namespace
+
+void debutComptageAllocations()
+{
+    nbreAllocations = 0;
+    comptageActif = true;
+}
+
+unsigned long long finComptageAllocations()
+{
+    comptageActif = false;
+    return nbreAllocations.load();
+}
+
+void* operator new(std::size_t taille)
+{
+    return allouer(taille);
+}
+
+void* operator new[](std::size_t taille)
+{
+    return allouer(taille);
+}
+
+void* operator new(std::size_t taille, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return allouer(taille);
+    }
+    catch(const std::bad_alloc &)
+    {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t taille, const std::nothrow_t &) noexcept
+{
+    try
+    {
+        return allouer(taille);
+    }
+    catch(const std::bad_alloc &)
+    {
+        return nullptr;
+    }
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
@@ -0,0 +1,137 @@
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "banc.h"
+
+namespace {
+
+qint64 centile(const QVector<qint64> &triees, double p)
+{
+    int indice = int(p * triees.size());
+    return triees.at(qMin(indice, int(triees.size()) - 1));
+}
+
+QString cle(const QString &nom, const QString &cas)
+{
+    return nom + "|" + cas;
+}
+
+}
+
+Statistiques Statistiques::calculer(QVector<qint64> durees)
+{
+    Statistiques s;
+
+    if(durees.isEmpty())
+        return s;
+
+    std::sort(durees.begin(), durees.end());
+
+    qint64 somme = 0;
+    foreach(qint64 d, durees)
+        somme += d;
+
+    s.repetitions = durees.size();
+    s.minNs = durees.first();
+    s.medianeNs = durees.at(durees.size() / 2);
+    s.p90Ns = centile(durees, 0.90);
+    s.p99Ns = centile(durees, 0.99);
+    s.maxNs = durees.last();
+    s.moyenneNs = double(somme) / durees.size();
+    return s;
+}
+
+Banc::Banc(const QString &nom) :
+    nom(nom)
+{
+}
+
+void Banc::ajouter(const QString &nom, const QString &cas, const Statistiques &stats, const QJsonObject &parametres)
+{
+    resultats.append({nom, cas, stats, parametres});
+}
+
+void Banc::afficher() const
+{
+    std::printf("%-28s %-26s %6s %14s %14s %14s %9s\n", "mesure", "cas", "rep.", "min (us)",
+                "mediane (us)", "p90 (us)", reference.isEmpty() ? "" : "ref.");
+
+    foreach(const Resultat &r, resultats)
+    {
+        std::printf("%-28s %-26s %6d %14.3f %14.3f %14.3f", qPrintable(r.nom), qPrintable(r.cas),
+                    r.stats.repetitions, r.stats.minNs / 1000.0, r.stats.medianeNs / 1000.0,
+                    r.stats.p90Ns / 1000.0);
+
+        QJsonObject precedent = reference.value(cle(r.nom, r.cas)).toObject();
+        if(!precedent.isEmpty() && precedent.value("medianeNs").toDouble() > 0.0)
+            std::printf(" %8.2fx", r.stats.medianeNs / precedent.value("medianeNs").toDouble());
+
+        std::printf("\n");
+    }
+}
+
+bool Banc::ecrireJson(const QString &fichier) const
+{
+    QJsonArray liste;
+
+    foreach(const Resultat &r, resultats)
+    {
+        QJsonObject o;
+        o.insert("nom", r.nom);
+        o.insert("cas", r.cas);
+        o.insert("repetitions", r.stats.repetitions);
+        o.insert("minNs", double(r.stats.minNs));
+        o.insert("medianeNs", double(r.stats.medianeNs));
+        o.insert("p90Ns", double(r.stats.p90Ns));
+        o.insert("p99Ns", double(r.stats.p99Ns));
+        o.insert("maxNs", double(r.stats.maxNs));
+        o.insert("moyenneNs", r.stats.moyenneNs);
+        o.insert("parametres", r.parametres);
+        liste.append(o);
+    }
+
+    QJsonObject racine;
+    racine.insert("banc", nom);
+    racine.insert("date", QDateTime::currentDateTimeUtc().toString(Qt::ISODate));
+    racine.insert("qt", QString(qVersion()));
+    racine.insert("resultats", liste);
+
+    QByteArray contenu = QJsonDocument(racine).toJson(QJsonDocument::Indented);
+
+    if(fichier == "-")
+    {
+        std::fwrite(contenu.constData(), 1, contenu.size(), stdout);
+        return true;
+    }
+
+    QFile f(fichier);
+    if(!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    return f.write(contenu) == contenu.size();
+}
+
+bool Banc::chargerReference(const QString &fichier)
+{
+    QFile f(fichier);
+    if(!f.open(QIODevice::ReadOnly))
+        return false;
+
+    QJsonDocument document = QJsonDocument::fromJson(f.readAll());
+    if(!document.isObject())
+        return false;
+
+    reference = QJsonObject();
+    foreach(const QJsonValue &v, document.object().value("resultats").toArray())
+    {
+        QJsonObject o = v.toObject();
+        reference.insert(cle(o.value("nom").toString(), o.value("cas").toString()), o);
+    }
+
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef BANC_H
+#define BANC_H
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/** Statistiques d'une série de durées, en nanosecondes.
+  */
+struct Statistiques
+{
+    int repetitions{0};
+    qint64 minNs{0};
+    qint64 medianeNs{0};
+    qint64 p90Ns{0};
+    qint64 p99Ns{0};
+    qint64 maxNs{0};
+    double moyenneNs{0.0};
+
+    /** calcule les statistiques d'une série de durées.
+      * \param durees les durées mesurées, en nanosecondes.
+      * \return les statistiques, nulles si la série est vide.
+      */
+    static Statistiques calculer(QVector<qint64> durees);
+};
+
+/** Collecte les résultats d'un banc de mesure, les affiche sous forme de tableau
+  * et les écrit en JSON pour pouvoir comparer deux exécutions.
+  *
+  * Chaque résultat est identifié par son nom (l'opération mesurée) et son cas (la
+  * maquette, le nombre de locos, etc.). Le fichier JSON a la forme :
+  * { "banc": ..., "date": ..., "qt": ..., "resultats": [ { "nom": ..., "cas": ...,
+  *   "repetitions": ..., "minNs": ..., "medianeNs": ..., "p90Ns": ..., "p99Ns": ...,
+  *   "maxNs": ..., "moyenneNs": ..., "parametres": { ... } }, ... ] }
+  */
+class Banc
+{
+public:
+    /** Constructeur de classe.
+      * \param nom le nom du banc, repris dans le fichier JSON.
+      */
+    explicit Banc(const QString &nom);
+
+    /** ajoute un résultat.
+      * \param nom l'opération mesurée.
+      * \param cas le cas mesuré.
+      * \param stats les statistiques des durées mesurées.
+      * \param parametres les paramètres et grandeurs dérivées propres à la mesure.
+      */
+    void ajouter(const QString &nom, const QString &cas, const Statistiques &stats,
+                 const QJsonObject &parametres = QJsonObject());
+
+    /** affiche les résultats sur la sortie standard. Si une référence est chargée,
+      * le rapport des médianes à celles de la référence est ajouté.
+      */
+    void afficher() const;
+
+    /** écrit les résultats en JSON.
+      * \param fichier le fichier à écrire, "-" pour la sortie standard.
+      * \return vrai si l'écriture a réussi.
+      */
+    bool ecrireJson(const QString &fichier) const;
+
+    /** charge les résultats d'une exécution précédente, à laquelle comparer celle-ci.
+      * \param fichier le fichier JSON écrit par ecrireJson().
+      * \return vrai si le fichier a pu être lu.
+      */
+    bool chargerReference(const QString &fichier);
+
+private:
+    struct Resultat
+    {
+        QString nom;
+        QString cas;
+        Statistiques stats;
+        QJsonObject parametres;
+    };
+
+    QString nom;
+    QList<Resultat> resultats;
+    QJsonObject reference;
+};
+
+#endif // BANC_H
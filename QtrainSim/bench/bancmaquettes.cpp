@@ -0,0 +1,259 @@
+/*
+ * Mesures du chargement des maquettes et des segments.
+ *
+ * Pour chaque maquette :
+ * - chargerMaquette (lecture du fichier texte), construireMaquette (pose des voies)
+ *   et genererSegments, mesurés séparément à chaque répétition ;
+ * - le temps moyen de SimView::getSegmentByContacts, appelé à chaque franchissement
+ *   de contact par une loco, sur toutes les paires de contacts de la maquette ;
+ * - le temps de chargement complet depuis le fichier texte, depuis la maquette compilée
+ *   équivalente et depuis le cache de maquettes.
+ *
+ * verifierPoses ne mesure rien : il pose chaque maquette avec le parcours itératif
+ * (SimView::construireMaquette) et avec le parcours récursif de référence, et vérifie
+ * que la géométrie de chaque voie est identique au bit près.
+ */
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QVector>
+
+#include <cstdio>
+#include <cstring>
+
+#include "bancs.h"
+#include "maquettecompilee.h"
+#include "simview.h"
+
+namespace {
+
+bool mesurerConstruction(Banc &banc, ChargeurMaquette &chargeur, const QString &fichier, int repetitions)
+{
+    QString cas = QFileInfo(fichier).fileName();
+    QVector<qint64> chargements, constructions, generations;
+    int nbreVoies = 0, nbreSegments = 0;
+    double rechercheNs = 0.0;
+    int nbreContacts = 0;
+
+    for(int r = 0; r < repetitions; r++)
+    {
+        SimView vue(nullptr);
+
+        QElapsedTimer chrono;
+        chrono.start();
+        if(!chargeur.chargerMaquette(fichier, &vue))
+        {
+            vue.viderMaquette();
+            return false;
+        }
+        chargements.append(chrono.nsecsElapsed());
+
+        chrono.restart();
+        vue.construireMaquette();
+        constructions.append(chrono.nsecsElapsed());
+
+        chrono.restart();
+        vue.genererSegments();
+        generations.append(chrono.nsecsElapsed());
+
+        // La recherche n'est mesurée qu'une fois, sur la dernière maquette générée
+        if(r == repetitions - 1)
+        {
+            nbreVoies = vue.getVoies().size();
+            nbreSegments = vue.getNbreSegments();
+
+            // Sur les grandes maquettes synthétiques, seuls les premiers contacts sont sondés
+            nbreContacts = vue.getContacts().isEmpty() ? 1 : qMin(vue.getContacts().lastKey(), 256);
+            const int tours = 20;
+            int trouves = 0;
+
+            chrono.restart();
+            for(int t = 0; t < tours; t++)
+                for(int a = 1; a <= nbreContacts; a++)
+                    for(int b = 1; b <= nbreContacts; b++)
+                        if(vue.getSegmentByContacts(a, b) != nullptr)
+                            trouves++;
+            rechercheNs = double(chrono.nsecsElapsed()) / (tours * nbreContacts * nbreContacts);
+
+            if(trouves == 0)
+                qDebug() << "Aucun segment trouvé dans" << fichier;
+        }
+
+        vue.viderMaquette();
+    }
+
+    QJsonObject taille;
+    taille.insert("voies", nbreVoies);
+    taille.insert("segments", nbreSegments);
+
+    banc.ajouter("chargerMaquette", cas, Statistiques::calculer(chargements), taille);
+    banc.ajouter("construireMaquette", cas, Statistiques::calculer(constructions), taille);
+    banc.ajouter("genererSegments", cas, Statistiques::calculer(generations), taille);
+
+    // Une seule série de recherches : la moyenne par appel tient lieu de durée
+    Statistiques recherche = Statistiques::calculer(QVector<qint64>() << qint64(rechercheNs));
+    QJsonObject parametres;
+    parametres.insert("contactsSondes", nbreContacts);
+    parametres.insert("rechercheNs", rechercheNs);
+    banc.ajouter("getSegmentByContacts", cas, recherche, parametres);
+
+    return true;
+}
+
+bool mesurerChargement(Banc &banc, ChargeurMaquette &chargeur, const QString &fichier,
+                       const QString &fichierCompile, int repetitions)
+{
+    QString cas = QFileInfo(fichier).fileName();
+    QVector<qint64> textes, compiles;
+
+    for(int r = 0; r < repetitions; r++)
+    {
+        SimView vue(nullptr);
+
+        QElapsedTimer chrono;
+        chrono.start();
+        if(!chargeur.chargerMaquette(fichier, &vue))
+        {
+            vue.viderMaquette();
+            return false;
+        }
+        vue.construireMaquette();
+        vue.genererSegments();
+        textes.append(chrono.nsecsElapsed());
+
+        if(r == 0 && !chargeur.compilerMaquette(fichierCompile, fichier, &vue))
+        {
+            vue.viderMaquette();
+            return false;
+        }
+        vue.viderMaquette();
+    }
+
+    for(int r = 0; r < repetitions; r++)
+    {
+        SimView vue(nullptr);
+
+        QElapsedTimer chrono;
+        chrono.start();
+        bool ok = chargeur.chargerMaquetteCompilee(fichierCompile, &vue);
+        compiles.append(chrono.nsecsElapsed());
+
+        vue.viderMaquette();
+        if(!ok)
+            return false;
+    }
+
+    // Le premier chargement remplit le cache, les suivants le réutilisent
+    QVector<qint64> caches;
+
+    for(int r = 0; r <= repetitions; r++)
+    {
+        SimView vue(nullptr);
+        bool depuisCache = false;
+
+        QElapsedTimer chrono;
+        chrono.start();
+        bool ok = chargeur.chargerMaquetteConstruite(fichier, &vue, &depuisCache);
+        qint64 duree = chrono.nsecsElapsed();
+
+        vue.viderMaquette();
+        if(!ok || depuisCache != (r > 0))
+            return false;
+        if(r > 0)
+            caches.append(duree);
+    }
+
+    banc.ajouter("chargement texte", cas, Statistiques::calculer(textes));
+    banc.ajouter("chargement compile", cas, Statistiques::calculer(compiles));
+    banc.ajouter("chargement cache", cas, Statistiques::calculer(caches));
+    return true;
+}
+
+bool verifierPose(ChargeurMaquette &chargeur, const QString &fichier, int &nbreEcarts)
+{
+    SimView iterative(nullptr), recursive(nullptr);
+
+    bool ok = chargeur.chargerMaquette(fichier, &iterative) && chargeur.chargerMaquette(fichier, &recursive) &&
+              iterative.getPremiereVoie() != nullptr && recursive.getPremiereVoie() != nullptr;
+
+    if(ok)
+    {
+        iterative.construireMaquette();
+
+        recursive.getPremiereVoie()->calculerAnglesEtCoordonneesRecursif();
+        recursive.getPremiereVoie()->calculerPositionRecursive();
+
+        nbreEcarts = 0;
+        foreach(int id, iterative.getVoies().keys())
+        {
+            Voie* reference = recursive.getVoies().value(id);
+            GeometrieVoie a, b;
+            iterative.getVoies().value(id)->sauverGeometrie(a);
+            if(reference != nullptr)
+                reference->sauverGeometrie(b);
+
+            if(reference == nullptr || std::memcmp(&a, &b, sizeof(GeometrieVoie)) != 0)
+            {
+                qDebug() << "Voie" << id << ": géométrie différente";
+                nbreEcarts++;
+            }
+        }
+
+        foreach(int numero, iterative.getContacts().keys())
+        {
+            Contact* reference = recursive.getContacts().value(numero);
+            if(reference == nullptr || reference->scenePos() != iterative.getContacts().value(numero)->scenePos())
+            {
+                qDebug() << "Contact" << numero << ": position différente";
+                nbreEcarts++;
+            }
+        }
+    }
+
+    iterative.viderMaquette();
+    recursive.viderMaquette();
+    return ok;
+}
+
+} // namespace
+
+void mesurerMaquettes(Banc &banc, ChargeurMaquette &chargeur, const QStringList &fichiers, int repetitions)
+{
+    QTemporaryDir temporaire;
+    chargeur.setRepertoireCache(temporaire.filePath("cache"));
+
+    foreach(QString fichier, fichiers)
+    {
+        QString fichierCompile = temporaire.filePath(QFileInfo(fichier).completeBaseName() + MaquetteCompilee::EXTENSION);
+
+        if(!mesurerConstruction(banc, chargeur, fichier, repetitions) ||
+           !mesurerChargement(banc, chargeur, fichier, fichierCompile, repetitions))
+            std::fprintf(stderr, "%s ignoree\n", qPrintable(QFileInfo(fichier).fileName()));
+    }
+}
+
+int verifierPoses(ChargeurMaquette &chargeur, const QStringList &fichiers)
+{
+    int echecs = 0;
+
+    foreach(QString fichier, fichiers)
+    {
+        QString nom = QFileInfo(fichier).fileName();
+        int nbreEcarts = 0;
+
+        if(!verifierPose(chargeur, fichier, nbreEcarts))
+            std::printf("%-24s ignoree\n", qPrintable(nom));
+        else if(nbreEcarts == 0)
+            std::printf("%-24s identique\n", qPrintable(nom));
+        else
+        {
+            std::printf("%-24s %d ecart(s)\n", qPrintable(nom), nbreEcarts);
+            echecs++;
+        }
+    }
+
+    return echecs;
+}
@@ -0,0 +1,75 @@
+#ifndef BANCS_H
+#define BANCS_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "banc.h"
+#include "chargeurmaquette.h"
+
+/** mesure, pour chaque maquette, chargerMaquette, construireMaquette, genererSegments,
+  * getSegmentByContacts et le chargement complet depuis le fichier texte, la maquette
+  * compilée et le cache de maquettes.
+  * \param banc le banc recueillant les résultats.
+  * \param chargeur un chargeur dont les infos voies sont chargées.
+  * \param fichiers les fichiers des maquettes.
+  * \param repetitions le nombre de répétitions de chaque mesure.
+  */
+void mesurerMaquettes(Banc &banc, ChargeurMaquette &chargeur, const QStringList &fichiers, int repetitions);
+
+/** compare, pour chaque maquette, la pose itérative des voies à la pose récursive de
+  * référence, au bit près.
+  * \param chargeur un chargeur dont les infos voies sont chargées.
+  * \param fichiers les fichiers des maquettes.
+  * \return le nombre de maquettes dont la géométrie diffère.
+  */
+int verifierPoses(ChargeurMaquette &chargeur, const QStringList &fichiers);
+
+/** mesure SimView::animationStep avec nbreLocos locos réparties sur les segments de la maquette.
+  * \param banc le banc recueillant les résultats.
+  * \param chargeur un chargeur dont les infos voies sont chargées.
+  * \param fichier le fichier de la maquette.
+  * \param nbreLocos les nombres de locos à mesurer.
+  * \param pas le nombre de pas d'animation mesurés pour chaque nombre de locos.
+  */
+void mesurerAnimation(Banc &banc, ChargeurMaquette &chargeur, const QString &fichier,
+                      const QList<int> &nbreLocos, int pas);
+
+/** mesure Loco::avancer d'un pas d'animation, ventilé selon le type de la voie
+  * sur laquelle se trouve la loco.
+  * \param banc le banc recueillant les résultats.
+  * \param chargeur un chargeur dont les infos voies sont chargées.
+  * \param fichier le fichier de la maquette.
+  * \param pas le nombre de pas d'animation effectués par chaque loco.
+  */
+void mesurerAvancement(Banc &banc, ChargeurMaquette &chargeur, const QString &fichier, int pas);
+
+/** mesure la latence entre Contact::active et le réveil d'un thread bloqué dans
+  * Contact::attendContact.
+  * \param banc le banc recueillant les résultats.
+  * \param echantillons le nombre de réveils mesurés.
+  */
+void mesurerReveilContact(Banc &banc, int echantillons);
+
+/** vérifie que SimView::animationStep ne réserve pas de mémoire une fois la simulation
+  * lancée : les allocations de chaque pas sont comptées, avec quatre locos réparties
+  * sur la maquette. Les pas où une loco franchit un contact sont comptés à part,
+  * l'activation du contact notifiant l'interface et le programme client.
+  * \param chargeur un chargeur dont les infos voies sont chargées.
+  * \param fichier le fichier de la maquette.
+  * \param pas le nombre de pas d'animation vérifiés.
+  * \return le nombre de pas sans franchissement de contact qui ont réservé de la mémoire.
+  */
+int verifierAllocations(ChargeurMaquette &chargeur, const QString &fichier, int pas);
+
+/** commence à compter les allocations, dans tous les threads (voir allocations.cpp).
+  */
+void debutComptageAllocations();
+
+/** arrête de compter les allocations.
+  * \return le nombre d'allocations depuis debutComptageAllocations.
+  */
+unsigned long long finComptageAllocations();
+
+#endif // BANCS_H
@@ -0,0 +1,377 @@
+/*
+ * Mesures de la simulation.
+ *
+ * - SimView::animationStep avec N locos réparties sur des segments distincts de la
+ *   maquette, toutes à vitesse maximale, sans inertie ;
+ * - Loco::avancer d'un pas d'animation, ventilé selon le type de la voie sur laquelle
+ *   se trouve la loco au début du pas ;
+ * - la latence de réveil d'un thread bloqué dans Contact::attendContact, mesurée entre
+ *   l'appel à Contact::active et le retour d'attendContact.
+ *
+ * verifierAllocations ne mesure rien : il compte les allocations de chaque pas
+ * d'animation, une fois les tampons de la vue remplis.
+ *
+ * Les locos sont arrêtées avant d'atteindre un buttoir. Une loco arrêtée par une
+ * collision ou un buttoir continue d'être parcourue par animationStep ; le nombre de
+ * locos arrêtées est reporté dans les paramètres du résultat.
+ */
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QMap>
+#include <QThread>
+#include <QVector>
+
+#include <cstdio>
+
+#include "bancs.h"
+#include "contact.h"
+#include "general.h"
+#include "simview.h"
+#include "trainsimsettings.h"
+#include "voieaiguillage.h"
+#include "voieaiguillageenroule.h"
+#include "voieaiguillagetriple.h"
+#include "voiebuttoir.h"
+#include "voiecourbe.h"
+#include "voiecroisement.h"
+#include "voiedroite.h"
+#include "voietraverseejonction.h"
+
+namespace {
+
+const qreal DISTANCE_PAS = (VITESSE_MAXIMUM * 1000.0 / FRAME_RATE) * FACTEUR_VITESSE;
+
+QString typeVoie(Voie* v)
+{
+    if(qobject_cast<VoieDroite*>(v) != nullptr)
+        return "VoieDroite";
+    if(qobject_cast<VoieCourbe*>(v) != nullptr)
+        return "VoieCourbe";
+    if(qobject_cast<VoieButtoir*>(v) != nullptr)
+        return "VoieButtoir";
+    if(qobject_cast<VoieCroisement*>(v) != nullptr)
+        return "VoieCroisement";
+    if(qobject_cast<VoieAiguillage*>(v) != nullptr)
+        return "VoieAiguillage";
+    if(qobject_cast<VoieAiguillageEnroule*>(v) != nullptr)
+        return "VoieAiguillageEnroule";
+    if(qobject_cast<VoieTraverseeJonction*>(v) != nullptr)
+        return "VoieTraverseeJonction";
+    // VoieAiguillageTriple n'a pas de méta-objet propre
+    if(dynamic_cast<VoieAiguillageTriple*>(v) != nullptr)
+        return "VoieAiguillageTriple";
+    return "Voie";
+}
+
+bool chargerVue(ChargeurMaquette &chargeur, const QString &fichier, SimView &vue)
+{
+    if(!chargeur.chargerMaquette(fichier, &vue))
+        return false;
+
+    vue.construireMaquette();
+    vue.genererSegments();
+    return true;
+}
+
+/** segments reliant deux contacts, sur lesquels une loco peut être posée.
+  */
+QList<Segment*> segmentsPosables(SimView &vue)
+{
+    QList<Segment*> posables;
+
+    foreach(Segment* s, vue.getSegments())
+        if(s->getContact1() != nullptr && s->getContact2() != nullptr)
+            posables.append(s);
+
+    return posables;
+}
+
+Loco* poserLoco(SimView &vue, Segment* s, int numLoco)
+{
+    Loco* l = new Loco(numLoco);
+    vue.addLoco(l, numLoco);
+    vue.setLoco(s->getContact1()->getNumContact(), s->getContact2()->getNumContact(), numLoco, VITESSE_MAXIMUM);
+    return l;
+}
+
+/** arrête la loco si elle est sur le point d'atteindre un buttoir.
+  * \return vrai si la loco est arrêtée.
+  */
+bool arreterAvantButtoir(Loco* l)
+{
+    if(l->getVitesse() == 0)
+        return true;
+
+    if(qobject_cast<VoieButtoir*>(l->getVoie()) != nullptr ||
+       qobject_cast<VoieButtoir*>(l->getVoieSuivante()) != nullptr ||
+       l->getVoieSuivante() == nullptr)
+    {
+        l->setVitesse(0);
+        return true;
+    }
+
+    return false;
+}
+
+class AttenteContact : public QThread
+{
+public:
+    AttenteContact(Contact* c, const QElapsedTimer &chrono, int echantillons) :
+        c(c), chrono(chrono), echantillons(echantillons), reveils(echantillons + 1, 0)
+    {
+    }
+
+    QAtomicInt pret{0};
+    QAtomicInt reveille{0};
+
+    qint64 reveil(int tour) const
+    {
+        return reveils.at(tour);
+    }
+
+protected:
+    void run() override
+    {
+        for(int tour = 1; tour <= echantillons; tour++)
+        {
+            pret.storeRelease(tour);
+            c->attendContact();
+            reveils[tour] = chrono.nsecsElapsed();
+            reveille.storeRelease(tour);
+        }
+    }
+
+private:
+    Contact* c;
+    const QElapsedTimer &chrono;
+    int echantillons;
+    QVector<qint64> reveils;
+};
+
+} // namespace
+
+void mesurerAnimation(Banc &banc, ChargeurMaquette &chargeur, const QString &fichier,
+                      const QList<int> &nbreLocos, int pas)
+{
+    TrainSimSettings::getInstance()->setInertie(false);
+
+    foreach(int n, nbreLocos)
+    {
+        SimView vue(nullptr);
+
+        if(!chargerVue(chargeur, fichier, vue))
+        {
+            vue.viderMaquette();
+            std::fprintf(stderr, "%s ignoree\n", qPrintable(fichier));
+            return;
+        }
+
+        // Une loco par segment, les segments choisis étant régulièrement espacés
+        QList<Segment*> posables = segmentsPosables(vue);
+        QList<Loco*> locos;
+        int placees = qMin(n, int(posables.size()));
+
+        for(int i = 0; i < placees; i++)
+            locos.append(poserLoco(vue, posables.at(i * posables.size() / placees), i + 1));
+
+        QVector<qint64> durees;
+        durees.reserve(pas);
+
+        for(int p = 0; p < pas; p++)
+        {
+            foreach(Loco* l, locos)
+                arreterAvantButtoir(l);
+
+            QElapsedTimer chrono;
+            chrono.start();
+            vue.animationStep();
+            durees.append(chrono.nsecsElapsed());
+        }
+
+        int arretees = 0;
+        foreach(Loco* l, locos)
+            if(!l->getActive() || l->getVitesse() == 0)
+                arretees++;
+
+        QJsonObject parametres;
+        parametres.insert("locos", placees);
+        parametres.insert("locosArretees", arretees);
+        parametres.insert("pas", pas);
+
+        banc.ajouter("animationStep", QString("%1 locos, %2").arg(n).arg(QFileInfo(fichier).fileName()),
+                     Statistiques::calculer(durees), parametres);
+
+        vue.viderMaquette();
+    }
+}
+
+int verifierAllocations(ChargeurMaquette &chargeur, const QString &fichier, int pas)
+{
+    TrainSimSettings::getInstance()->setInertie(false);
+
+    SimView vue(nullptr);
+
+    if(!chargerVue(chargeur, fichier, vue))
+    {
+        vue.viderMaquette();
+        std::fprintf(stderr, "Impossible de charger %s\n", qPrintable(fichier));
+        return 1;
+    }
+
+    QList<Segment*> posables = segmentsPosables(vue);
+    QList<Loco*> locos;
+    int placees = qMin(4, int(posables.size()));
+
+    for(int i = 0; i < placees; i++)
+        locos.append(poserLoco(vue, posables.at(i * posables.size() / placees), i + 1));
+
+    // Les tampons de la vue et les images du profil sont remplis avant de compter
+    for(int p = 0; p < 700; p++)
+    {
+        foreach(Loco* l, locos)
+            arreterAvantButtoir(l);
+        vue.animationStep();
+    }
+
+    int pasAlloues = 0;
+    int pasContacts = 0;
+    unsigned long long allocations = 0;
+
+    for(int p = 0; p < pas; p++)
+    {
+        unsigned franchis = 0;
+        foreach(Loco* l, locos)
+        {
+            arreterAvantButtoir(l);
+            franchis += l->getNbreContactsFranchis();
+        }
+
+        debutComptageAllocations();
+        vue.animationStep();
+        unsigned long long n = finComptageAllocations();
+
+        foreach(Loco* l, locos)
+            franchis -= l->getNbreContactsFranchis();
+
+        if(franchis != 0)
+            pasContacts++;
+        else if(n > 0)
+        {
+            pasAlloues++;
+            allocations += n;
+        }
+    }
+
+    int actives = 0;
+    foreach(Loco* l, locos)
+        if(l->getActive() && l->getVitesse() != 0)
+            actives++;
+
+    std::printf("%s : %d pas, %d locos (%d en mouvement a la fin), %d pas avec contact\n",
+                qPrintable(QFileInfo(fichier).fileName()), pas, placees, actives, pasContacts);
+    if(pasAlloues == 0)
+        std::printf("aucune allocation\n");
+    else
+        std::printf("%d pas sans contact ont reserve de la memoire (%llu allocations)\n", pasAlloues, allocations);
+
+    vue.viderMaquette();
+    return pasAlloues;
+}
+
+void mesurerAvancement(Banc &banc, ChargeurMaquette &chargeur, const QString &fichier, int pas)
+{
+    TrainSimSettings::getInstance()->setInertie(false);
+
+    SimView vue(nullptr);
+
+    if(!chargerVue(chargeur, fichier, vue))
+    {
+        vue.viderMaquette();
+        std::fprintf(stderr, "%s ignoree\n", qPrintable(fichier));
+        return;
+    }
+
+    // Une loco à la fois, posée successivement sur quelques segments répartis sur la maquette
+    QList<Segment*> posables = segmentsPosables(vue);
+    const int departs = qMin(8, int(posables.size()));
+    QMap<QString, QVector<qint64> > parType;
+
+    for(int d = 0; d < departs; d++)
+    {
+        Loco* l = poserLoco(vue, posables.at(d * posables.size() / departs), d + 1);
+
+        for(int p = 0; p < pas && !arreterAvantButtoir(l); p++)
+        {
+            QString type = typeVoie(l->getVoie());
+
+            QElapsedTimer chrono;
+            chrono.start();
+            l->avancer(DISTANCE_PAS);
+            parType[type].append(chrono.nsecsElapsed());
+        }
+    }
+
+    for(QMap<QString, QVector<qint64> >::const_iterator it = parType.constBegin(); it != parType.constEnd(); ++it)
+    {
+        QJsonObject parametres;
+        parametres.insert("distanceMm", DISTANCE_PAS);
+
+        banc.ajouter("Loco::avancer", QString("%1, %2").arg(it.key()).arg(QFileInfo(fichier).fileName()),
+                     Statistiques::calculer(it.value()), parametres);
+    }
+
+    vue.viderMaquette();
+}
+
+void mesurerReveilContact(Banc &banc, int echantillons)
+{
+    Contact c(1, 1);
+    QElapsedTimer chrono;
+    chrono.start();
+
+    AttenteContact attente(&c, chrono, echantillons);
+    attente.start();
+
+    QVector<qint64> latences;
+    int perdus = 0;
+
+    for(int tour = 1; tour <= echantillons; tour++)
+    {
+        while(attente.pret.loadAcquire() != tour)
+            QThread::yieldCurrentThread();
+
+        // Laisse au thread le temps d'entrer dans l'attente : active() ne mémorise rien
+        QThread::usleep(200);
+
+        qint64 envoi = chrono.nsecsElapsed();
+        c.active();
+        bool perdu = false;
+
+        while(attente.reveille.loadAcquire() != tour)
+        {
+            // Le réveil est parti avant l'attente : on le renvoie, et l'échantillon est écarté
+            if(chrono.nsecsElapsed() - envoi > 50000000)
+            {
+                perdu = true;
+                envoi = chrono.nsecsElapsed();
+                c.active();
+            }
+            QThread::yieldCurrentThread();
+        }
+
+        if(perdu)
+            perdus++;
+        else
+            latences.append(attente.reveil(tour) - envoi);
+    }
+
+    attente.wait();
+
+    QJsonObject parametres;
+    parametres.insert("echantillons", echantillons);
+    parametres.insert("reveilsPerdus", perdus);
+
+    banc.ajouter("Contact::attendContact", "reveil", Statistiques::calculer(latences), parametres);
+}
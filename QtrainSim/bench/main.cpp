@@ -0,0 +1,127 @@
+/*
+ * Banc de mesure du simulateur.
+ *
+ * Enchaîne des mesures répétables, sans interface ni programme client :
+ * - chargement des maquettes de data/Maquettes (chargerMaquette, construireMaquette,
+ *   genererSegments, getSegmentByContacts, chargement texte, compilé et depuis le cache) ;
+ * - SimView::animationStep avec N locos ;
+ * - Loco::avancer par type de voie ;
+ * - latence de réveil d'un thread en attente sur un contact.
+ *
+ * Les résultats sont affichés sous forme de tableau et, avec --json, écrits en JSON pour
+ * pouvoir comparer deux exécutions (--reference affiche le rapport à une exécution
+ * précédente). Le débit de SharedSection et SharedStation est mesuré par le banc
+ * PCO_LAB04_bench, dans code/bench, qui écrit le même format.
+ *
+ * Avec --verifier, le banc ne mesure rien : il compare la pose itérative des voies à la
+ * pose récursive de référence, au bit près. Avec --verifier-allocations, il vérifie que
+ * les pas d'animation de la maquette de --maquette ne réservent pas de mémoire.
+ *
+ * Usage : qtrainsim_bench [--data <répertoire>] [--repetitions <n>] [--maquette <fichier>]
+ *                         [--locos <n,n,...>] [--pas <n>] [--reveils <n>]
+ *                         [--json <fichier>] [--reference <fichier>] [--verifier]
+ *                         [--verifier-allocations]
+ */
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+
+#include <algorithm>
+#include <cstdio>
+
+#include "banc.h"
+#include "bancs.h"
+#include "chargeurmaquette.h"
+
+// Le programme client n'est pas lancé par le banc
+int cmain()
+{
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Aucune fenêtre n'est affichée
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Banc de mesure de QtrainSim");
+    parser.addHelpOption();
+    QCommandLineOption optionData("data", "Répertoire data contenant infosVoies.txt et Maquettes/.", "répertoire", DATADIR);
+    QCommandLineOption optionRepetitions("repetitions", "Nombre de répétitions des mesures de chargement.", "n", "20");
+    QCommandLineOption optionMaquette("maquette", "Maquette des mesures de simulation, dans data/Maquettes.", "fichier", "Maquet_A0.txt");
+    QCommandLineOption optionLocos("locos", "Nombres de locos des mesures d'animation.", "n,n,...", "1,2,4,8");
+    QCommandLineOption optionPas("pas", "Nombre de pas d'animation par mesure.", "n", "2000");
+    QCommandLineOption optionReveils("reveils", "Nombre de réveils de contact mesurés.", "n", "1000");
+    QCommandLineOption optionJson("json", "Ecrit les résultats en JSON (- pour la sortie standard).", "fichier");
+    QCommandLineOption optionReference("reference", "Résultats JSON d'une exécution précédente, à comparer.", "fichier");
+    QCommandLineOption optionVerifier("verifier", "Compare la pose itérative des voies à la pose récursive de référence.");
+    QCommandLineOption optionVerifierAllocations("verifier-allocations", "Vérifie que les pas d'animation ne réservent pas de mémoire.");
+    parser.addOption(optionData);
+    parser.addOption(optionRepetitions);
+    parser.addOption(optionMaquette);
+    parser.addOption(optionLocos);
+    parser.addOption(optionPas);
+    parser.addOption(optionReveils);
+    parser.addOption(optionJson);
+    parser.addOption(optionReference);
+    parser.addOption(optionVerifier);
+    parser.addOption(optionVerifierAllocations);
+    parser.process(app);
+
+    QString data = parser.value(optionData);
+    int repetitions = std::max(1, parser.value(optionRepetitions).toInt());
+    int pas = std::max(1, parser.value(optionPas).toInt());
+    int reveils = std::max(1, parser.value(optionReveils).toInt());
+
+    QList<int> nbreLocos;
+    foreach(QString n, parser.value(optionLocos).split(',', Qt::SkipEmptyParts))
+        if(n.toInt() > 0)
+            nbreLocos.append(n.toInt());
+
+    ChargeurMaquette chargeur;
+    if(!chargeur.chargerInfosVoies(data + "/infosVoies.txt"))
+    {
+        std::fprintf(stderr, "Impossible de lire %s/infosVoies.txt\n", qPrintable(data));
+        return 1;
+    }
+
+    QDir repertoire(data + "/Maquettes");
+    QStringList fichiers;
+    foreach(QString nom, repertoire.entryList(QStringList() << "*.txt", QDir::Files, QDir::Name))
+        fichiers.append(repertoire.filePath(nom));
+
+    if(parser.isSet(optionVerifier))
+        return verifierPoses(chargeur, fichiers) == 0 ? 0 : 1;
+
+    if(parser.isSet(optionVerifierAllocations))
+        return verifierAllocations(chargeur, repertoire.filePath(parser.value(optionMaquette)), pas) == 0 ? 0 : 1;
+
+    Banc banc("qtrainsim_bench");
+
+    if(parser.isSet(optionReference) && !banc.chargerReference(parser.value(optionReference)))
+        std::fprintf(stderr, "Impossible de lire %s\n", qPrintable(parser.value(optionReference)));
+
+    QString maquette = repertoire.filePath(parser.value(optionMaquette));
+
+    mesurerMaquettes(banc, chargeur, fichiers, repetitions);
+    mesurerAnimation(banc, chargeur, maquette, nbreLocos, pas);
+    mesurerAvancement(banc, chargeur, maquette, pas);
+    mesurerReveilContact(banc, reveils);
+
+    // Le tableau ne se mêle pas au JSON écrit sur la sortie standard
+    if(parser.value(optionJson) != "-")
+        banc.afficher();
+
+    if(parser.isSet(optionJson) && !banc.ecrireJson(parser.value(optionJson)))
+    {
+        std::fprintf(stderr, "Impossible d'écrire %s\n", qPrintable(parser.value(optionJson)));
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Compilateur de maquettes.
+ *
+ * Transforme un ou plusieurs fichiers Maquet_*.txt, accompagnés de infosVoies.txt,
+ * en maquettes compilées (.qtm) : voies, liaisons, géométrie après la pose, contacts,
+ * aiguillages et segments. Le simulateur charge ces fichiers par projection en mémoire,
+ * sans analyse de texte ni calcul de géométrie.
+ *
+ * Usage : qtrainsim_compilateur [--data <répertoire>] [--sortie <répertoire>] <maquette.txt>...
+ * Sans --sortie, chaque fichier compilé est écrit à côté de sa source.
+ */
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFileInfo>
+
+#include <cstdio>
+
+#include "chargeurmaquette.h"
+#include "maquettecompilee.h"
+#include "simview.h"
+
+// Le programme client n'est pas lancé par le compilateur
+int cmain()
+{
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    // Aucune fenêtre n'est affichée
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Compilateur de maquettes QtrainSim");
+    parser.addHelpOption();
+    QCommandLineOption optionData("data", "Répertoire data contenant infosVoies.txt.", "répertoire", DATADIR);
+    QCommandLineOption optionSortie("sortie", "Répertoire où écrire les maquettes compilées.", "répertoire");
+    parser.addOption(optionData);
+    parser.addOption(optionSortie);
+    parser.addPositionalArgument("maquettes", "Fichiers maquette à compiler.", "<maquette.txt>...");
+    parser.process(app);
+
+    if(parser.positionalArguments().isEmpty())
+        parser.showHelp(1);
+
+    ChargeurMaquette chargeur;
+    if(!chargeur.chargerInfosVoies(parser.value(optionData) + "/infosVoies.txt"))
+    {
+        std::fprintf(stderr, "Impossible de lire %s/infosVoies.txt\n", qPrintable(parser.value(optionData)));
+        return 1;
+    }
+
+    int erreurs = 0;
+
+    foreach(QString source, parser.positionalArguments())
+    {
+        QFileInfo info(source);
+        QDir sortie(parser.isSet(optionSortie) ? parser.value(optionSortie) : info.absolutePath());
+        QString cible = sortie.filePath(info.completeBaseName() + MaquetteCompilee::EXTENSION);
+
+        SimView vue(nullptr);
+
+        if(!chargeur.chargerMaquette(source, &vue))
+        {
+            std::fprintf(stderr, "%s : lecture impossible\n", qPrintable(source));
+            vue.viderMaquette();
+            erreurs++;
+            continue;
+        }
+
+        vue.construireMaquette();
+        vue.genererSegments();
+
+        if(!chargeur.compilerMaquette(cible, source, &vue))
+        {
+            std::fprintf(stderr, "%s : écriture de %s impossible\n", qPrintable(source), qPrintable(cible));
+            erreurs++;
+        }
+        else
+            std::printf("%s -> %s\n", qPrintable(source), qPrintable(cible));
+
+        vue.viderMaquette();
+    }
+
+    return erreurs == 0 ? 0 : 1;
+}
@@ -0,0 +1,420 @@
+/*
+ * Générateur de maquettes synthétiques.
+ *
+ * Ecrit un fichier Maquet_*.txt valide, construit avec les voies de infosVoies.txt, pour
+ * mesurer le comportement du simulateur sur des maquettes bien plus grandes que celles
+ * fournies (1k, 10k, 100k voies...).
+ *
+ * La maquette est une pile d'ovales. Chaque ovale est formé de deux demi-cercles de six
+ * courbes 2221 et de deux lignes droites de même longueur, découpées en cellules :
+ * - droite 2206, qui peut porter un contact ;
+ * - aiguillage 2261 menant à un buttoir (évitement vers l'extérieur de l'ovale) ;
+ * - traversée-jonction 2260 dont la voie croisée mène à deux buttoirs ;
+ * - croisement 2258, complété par une droite 2201, dont la voie croisée mène à deux
+ *   buttoirs. Les croisements sont placés par paire, un sur chaque ligne, pour que
+ *   les deux lignes gardent la même longueur.
+ * Deux ovales successifs sont reliés par une communication : un aiguillage sur la ligne
+ * haute du premier, une rampe de droites 2200 et un aiguillage sur la ligne basse du
+ * second. Toutes les boucles se referment exactement, sans correction à la pose.
+ *
+ * Les contacts sont répartis régulièrement sur les cellules droites. Les maquettes dont
+ * les numéros de contact ou d'aiguillage dépassent MAX_CONTACTS ou MAX_AIGUILLAGES
+ * demandent un simulateur compilé avec des limites relevées (QTRAINSIM_MAX_*).
+ *
+ * Usage : qtrainsim_generateur [--voies <n>] [--boucles <n>] [--aiguillages <proportion>]
+ *                              [--traversees <proportion>] [--croisements <proportion>]
+ *                              [--contacts <n>] [--graine <n>] [--sortie <fichier>]
+ *                              [--verifier] [--data <répertoire>]
+ */
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "chargeurmaquette.h"
+#include "simview.h"
+
+// Le programme client n'est pas lancé par le générateur
+int cmain()
+{
+    return 0;
+}
+
+namespace {
+
+//! Types de voies utilisés, tels que numérotés dans infosVoies.txt
+const int DROITE_CELLULE = 2206;       // 168.9 mm, longueur de la partie droite des aiguillages
+const int DROITE_RAMPE = 2200;         // 180 mm
+const int DROITE_CROISEMENT = 2201;    // 90 mm, complète un croisement à 180 mm
+const int COURBE = 2221;               // 30 degrés, rayon 360 mm
+const int AIGUILLAGE = 2261;
+const int CROISEMENT = 2258;
+const int TRAVERSEE_JONCTION = 2260;
+const int BUTTOIR = 7391;
+
+//! Nombre de courbes d'un demi-cercle
+const int COURBES_DEMI_CERCLE = 6;
+
+//! Nombre de droites de la rampe entre deux ovales, qui les écarte d'environ 200 mm
+const int DROITES_RAMPE = 2;
+
+enum Cellule { Droite, Evitement, Traversee, Croisement, Depart, Arrivee };
+
+struct VoieGeneree
+{
+    int type;
+    int nbreLiaisons;
+    int liaisons[4];
+    const char* direction;      // "Gauche", "Droite", ou nullptr si la voie n'en a pas
+};
+
+struct Extremite
+{
+    int voie;
+    int ordre;
+};
+
+class Generateur
+{
+public:
+    /** construit la maquette.
+      * \param nbreCellules le nombre de cellules de chaque ligne droite d'un ovale.
+      */
+    void generer(int nbreBoucles, int nbreCellules, double pAiguillages, double pTraversees,
+                 double pCroisements, int nbreContacts, unsigned graine)
+    {
+        std::mt19937 aleatoire(graine);
+        std::uniform_real_distribution<double> tirage(0.0, 1.0);
+
+        // Choix du type d'une cellule autre qu'un croisement
+        auto tirerCellule = [&]() {
+            double reste = 1.0 - pCroisements;
+            double r = tirage(aleatoire) * reste;
+            if(r < pAiguillages)
+                return Evitement;
+            if(r < pAiguillages + pTraversees)
+                return Traversee;
+            return Droite;
+        };
+
+        Extremite rampe{0, 0};
+
+        for(int b = 0; b < nbreBoucles; b++)
+        {
+            QVector<Cellule> basse(nbreCellules), haute(nbreCellules);
+            int milieu = nbreCellules / 2;
+
+            for(int i = 0; i < nbreCellules; i++)
+            {
+                if(i != milieu && tirage(aleatoire) < pCroisements)
+                {
+                    basse[i] = Croisement;
+                    haute[i] = Croisement;
+                }
+                else
+                {
+                    basse[i] = tirerCellule();
+                    haute[i] = tirerCellule();
+                }
+            }
+            if(b > 0)
+                basse[milieu] = Arrivee;
+            if(b < nbreBoucles - 1)
+                haute[milieu] = Depart;
+
+            debut = {0, 0};
+            fin = {0, 0};
+
+            foreach(Cellule c, basse)
+                ajouterCellule(c, rampe);
+            ajouterDemiCercle();
+            foreach(Cellule c, haute)
+                ajouterCellule(c, rampe);
+            ajouterDemiCercle();
+
+            // Fermeture de l'ovale
+            lier(fin, debut);
+        }
+
+        nbreContacts = std::min(nbreContacts, int(candidatsContacts.size()));
+        for(int k = 0; k < nbreContacts; k++)
+            contacts.append(candidatsContacts.at(int(qint64(k) * candidatsContacts.size() / nbreContacts)));
+    }
+
+    int getNbreVoies() const { return voies.size(); }
+    int getNbreContacts() const { return contacts.size(); }
+    int getNbreAiguillages() const { return aiguillages.size(); }
+    int getNbreCandidatsContacts() const { return candidatsContacts.size(); }
+
+    /** écrit la maquette au format des fichiers Maquet_*.txt.
+      */
+    bool ecrire(const QString &nomFichier, const QString &titre) const
+    {
+        QSaveFile fichier(nomFichier);
+        if(!fichier.open(QIODevice::WriteOnly | QIODevice::Text))
+            return false;
+
+        QTextStream ecriture(&fichier);
+
+        ecriture << titre << "\n";
+        ecriture << voies.size() << "\n";
+        for(int i = 0; i < voies.size(); i++)
+        {
+            const VoieGeneree &v = voies.at(i);
+            ecriture << (i + 1) << " " << v.type;
+            for(int j = 0; j < v.nbreLiaisons; j++)
+                ecriture << " " << v.liaisons[j];
+            if(v.direction != nullptr)
+                ecriture << " " << v.direction;
+            ecriture << "\n";
+        }
+
+        ecriture << contacts.size() << "\n";
+        for(int i = 0; i < contacts.size(); i++)
+            ecriture << (i + 1) << " " << contacts.at(i) << "\n";
+
+        ecriture << aiguillages.size() << "\n";
+        for(int i = 0; i < aiguillages.size(); i++)
+            ecriture << (i + 1) << " " << aiguillages.at(i) << "\n";
+
+        // Première voie à poser
+        ecriture << 1 << "\n";
+
+        ecriture.flush();
+        return fichier.commit();
+    }
+
+private:
+    int ajouter(int type, int nbreLiaisons, const char* direction = nullptr)
+    {
+        voies.append({type, nbreLiaisons, {0, 0, 0, 0}, direction});
+        return voies.size();
+    }
+
+    void lier(Extremite a, Extremite b)
+    {
+        voies[a.voie - 1].liaisons[a.ordre] = b.voie;
+        voies[b.voie - 1].liaisons[b.ordre] = a.voie;
+    }
+
+    //! Ajoute une voie à la suite de la ligne en cours, entrée et sortie par les extrémités indiquées
+    void suivre(int voie, int entree, int sortie)
+    {
+        if(fin.voie == 0)
+            debut = {voie, entree};
+        else
+            lier(fin, {voie, entree});
+        fin = {voie, sortie};
+    }
+
+    void ajouterButtoir(Extremite e)
+    {
+        lier(e, {ajouter(BUTTOIR, 1), 0});
+    }
+
+    void ajouterCellule(Cellule c, Extremite &rampe)
+    {
+        int v;
+
+        switch(c)
+        {
+        case Droite:
+            v = ajouter(DROITE_CELLULE, 2);
+            suivre(v, 0, 1);
+            candidatsContacts.append(v);
+            break;
+        case Evitement:
+            // La branche déviée part vers l'extérieur de l'ovale, à droite dans le sens de parcours
+            v = ajouter(AIGUILLAGE, 3, "Droite");
+            suivre(v, 0, 1);
+            ajouterButtoir({v, 2});
+            aiguillages.append(v);
+            break;
+        case Traversee:
+            v = ajouter(TRAVERSEE_JONCTION, 4);
+            suivre(v, 0, 1);
+            ajouterButtoir({v, 2});
+            ajouterButtoir({v, 3});
+            aiguillages.append(v);
+            break;
+        case Croisement:
+            v = ajouter(CROISEMENT, 4);
+            suivre(v, 0, 1);
+            ajouterButtoir({v, 2});
+            ajouterButtoir({v, 3});
+            suivre(ajouter(DROITE_CROISEMENT, 2), 0, 1);
+            break;
+        case Depart:
+            // Ligne haute : la branche déviée monte vers l'ovale suivant
+            v = ajouter(AIGUILLAGE, 3, "Droite");
+            suivre(v, 0, 1);
+            aiguillages.append(v);
+            rampe = {v, 2};
+            for(int i = 0; i < DROITES_RAMPE; i++)
+            {
+                int d = ajouter(DROITE_RAMPE, 2);
+                lier(rampe, {d, 0});
+                rampe = {d, 1};
+            }
+            break;
+        case Arrivee:
+            // Ligne basse : la branche déviée descend vers la rampe de l'ovale précédent
+            v = ajouter(AIGUILLAGE, 3, "Droite");
+            suivre(v, 0, 1);
+            aiguillages.append(v);
+            lier(rampe, {v, 2});
+            break;
+        }
+    }
+
+    void ajouterDemiCercle()
+    {
+        for(int i = 0; i < COURBES_DEMI_CERCLE; i++)
+            suivre(ajouter(COURBE, 2, "Gauche"), 0, 1);
+    }
+
+    QVector<VoieGeneree> voies;
+    QVector<int> contacts;
+    QVector<int> aiguillages;
+    QVector<int> candidatsContacts;
+    Extremite debut{0, 0};
+    Extremite fin{0, 0};
+};
+
+/** charge la maquette générée comme le simulateur, et vérifie que toutes les voies
+  * sont posées et que leurs extrémités se rejoignent.
+  */
+bool verifier(const QString &data, const QString &nomFichier)
+{
+    ChargeurMaquette chargeur;
+    if(!chargeur.chargerInfosVoies(data + "/infosVoies.txt"))
+    {
+        std::fprintf(stderr, "Impossible de lire %s/infosVoies.txt\n", qPrintable(data));
+        return false;
+    }
+
+    SimView vue(nullptr);
+    QElapsedTimer chrono;
+    chrono.start();
+
+    if(!chargeur.chargerMaquette(nomFichier, &vue))
+    {
+        vue.viderMaquette();
+        std::fprintf(stderr, "Impossible de charger %s\n", qPrintable(nomFichier));
+        return false;
+    }
+    vue.construireMaquette();
+    vue.genererSegments();
+    qint64 duree = chrono.nsecsElapsed();
+
+    int nonPosees = 0;
+    double ecartMax = 0.0;
+    foreach(Voie* v, vue.getVoies())
+    {
+        if(!v->estPosee())
+        {
+            nonPosees++;
+            continue;
+        }
+        for(int i = 0; i < v->getNbreLiaisons(); i++)
+        {
+            Voie* voisine = v->getVoieVoisineDOrdre(i);
+            QPointF ecart = v->getPosAbsLiaison(voisine) - voisine->getPosAbsLiaison(v);
+            ecartMax = std::max(ecartMax, std::hypot(ecart.x(), ecart.y()));
+        }
+    }
+
+    std::printf("chargement : %.1f ms, %d segments, %d voies non posees, ecart max aux liaisons %.3g mm\n",
+                duree / 1e6, vue.getNbreSegments(), nonPosees, ecartMax);
+
+    vue.viderMaquette();
+    return nonPosees == 0 && ecartMax < 1e-3;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    // Aucune fenêtre n'est affichée
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Générateur de maquettes synthétiques QtrainSim");
+    parser.addHelpOption();
+    QCommandLineOption optionVoies("voies", "Nombre approximatif de voies.", "n", "1000");
+    QCommandLineOption optionBoucles("boucles", "Nombre d'ovales.", "n", "1");
+    QCommandLineOption optionAiguillages("aiguillages", "Proportion de cellules portant un évitement.", "proportion", "0.05");
+    QCommandLineOption optionTraversees("traversees", "Proportion de cellules portant une traversée-jonction.", "proportion", "0.01");
+    QCommandLineOption optionCroisements("croisements", "Proportion de paires de cellules portant un croisement.", "proportion", "0.01");
+    QCommandLineOption optionContacts("contacts", "Nombre de contacts.", "n", QString::number(MAX_CONTACTS));
+    QCommandLineOption optionGraine("graine", "Graine du générateur aléatoire.", "n", "1");
+    QCommandLineOption optionSortie("sortie", "Fichier maquette à écrire (par défaut Maquet_Synth_<voies>.txt).", "fichier");
+    QCommandLineOption optionVerifier("verifier", "Charge et pose la maquette générée, comme le simulateur.");
+    QCommandLineOption optionData("data", "Répertoire data contenant infosVoies.txt (pour --verifier).", "répertoire", DATADIR);
+    parser.addOptions({optionVoies, optionBoucles, optionAiguillages, optionTraversees, optionCroisements,
+                       optionContacts, optionGraine, optionSortie, optionVerifier, optionData});
+    parser.process(app);
+
+    int nbreVoies = parser.value(optionVoies).toInt();
+    int nbreBoucles = std::max(1, parser.value(optionBoucles).toInt());
+    double pAiguillages = parser.value(optionAiguillages).toDouble();
+    double pTraversees = parser.value(optionTraversees).toDouble();
+    double pCroisements = parser.value(optionCroisements).toDouble();
+    int nbreContacts = std::max(0, parser.value(optionContacts).toInt());
+
+    if(pAiguillages < 0.0 || pTraversees < 0.0 || pCroisements < 0.0 ||
+       pAiguillages + pTraversees + pCroisements > 1.0)
+    {
+        std::fprintf(stderr, "Les proportions doivent être positives et de somme au plus 1\n");
+        return 1;
+    }
+
+    // Voies par cellule en moyenne : droite 1, évitement 2, traversée 3, croisement 4
+    double voiesParCellule = 1.0 + pAiguillages + 2.0 * pTraversees + 3.0 * pCroisements;
+    double voiesParBoucle = double(nbreVoies) / nbreBoucles - 2 * COURBES_DEMI_CERCLE - (DROITES_RAMPE + 2);
+    int nbreCellules = std::max(2, int(std::lround(voiesParBoucle / (2.0 * voiesParCellule))));
+
+    Generateur generateur;
+    generateur.generer(nbreBoucles, nbreCellules, pAiguillages, pTraversees, pCroisements,
+                       nbreContacts, parser.value(optionGraine).toUInt());
+
+    QString nomFichier = parser.isSet(optionSortie) ? parser.value(optionSortie)
+                                                    : QString("Maquet_Synth_%1.txt").arg(nbreVoies);
+    QString titre = QString("Maquette synthetique : %1 ovales de %2 cellules, graine %3")
+                        .arg(nbreBoucles).arg(nbreCellules).arg(parser.value(optionGraine));
+
+    if(!generateur.ecrire(nomFichier, titre))
+    {
+        std::fprintf(stderr, "Impossible d'écrire %s\n", qPrintable(nomFichier));
+        return 1;
+    }
+
+    std::printf("%s : %d voies, %d contacts, %d aiguillages\n", qPrintable(nomFichier),
+                generateur.getNbreVoies(), generateur.getNbreContacts(), generateur.getNbreAiguillages());
+
+    if(generateur.getNbreContacts() < nbreContacts)
+        std::fprintf(stderr, "Attention : seules %d cellules droites peuvent porter un contact\n",
+                     generateur.getNbreCandidatsContacts());
+    if(generateur.getNbreContacts() > MAX_CONTACTS || generateur.getNbreAiguillages() > MAX_AIGUILLAGES)
+        std::fprintf(stderr, "Attention : la maquette dépasse MAX_CONTACTS (%d) ou MAX_AIGUILLAGES (%d), "
+                             "configurer avec -DQTRAINSIM_MAX_CONTACTS=%d -DQTRAINSIM_MAX_AIGUILLAGES=%d\n",
+                     MAX_CONTACTS, MAX_AIGUILLAGES,
+                     std::max(MAX_CONTACTS, generateur.getNbreContacts()),
+                     std::max(MAX_AIGUILLAGES, generateur.getNbreAiguillages()));
+
+    if(parser.isSet(optionVerifier) && !verifier(parser.value(optionData), nomFichier))
+        return 1;
+
+    return 0;
+}
@@ -0,0 +1,661 @@
+/*
+ * Exécution d'un lot de scénarios.
+ *
+ * Lance un programme client (simulateur compris, par exemple PCO_LAB04_prog2) sur chaque
+ * scénario d'un répertoire, sans fenêtre et en accéléré (options --sans-fenetre,
+ * --acceleration et --duree du simulateur), avec autant de simulations en parallèle que de
+ * coeurs. Chaque simulation est un processus distinct : le simulateur et le programme
+ * client ont leur état global, qu'il n'y a ainsi pas à partager. Les bilans des
+ * simulations (option --bilan du simulateur) sont réunis dans un tableau CSV : tours
+ * effectués, attentes de la section partagée, collisions et déraillements.
+ *
+ * Le répertoire contient les scénarios (*.txt) et les maquettes qu'ils utilisent
+ * (Maquet_*.txt ou *.qtm). Les simulations sont lancées depuis le répertoire : un
+ * scénario désigne sa maquette par son fichier (layout Maquet_A.txt), ou par le nom
+ * d'une maquette installée avec le programme.
+ *
+ * Avec --balayage, les simulations sont les variantes d'un scénario de base, dont on fait
+ * varier les réglages. Le fichier de balayage reprend les mots-clés des scénarios, avec
+ * les valeurs candidates séparées par des | :
+ *
+ *     scenario default.txt          scénario de base, relatif au fichier de balayage
+ *     reservation 100 2 | 50 3      marge de sécurité (mm) et rapport des distances de
+ *                                   requête et d'accès, qui placent les points de réservation
+ *     turns 1 10 | 1 3              nombres minimal et maximal de tours
+ *     priorities 0 10 | 0 0         priorités minimale et maximale
+ *     speed 0 10 | 15 | 20          vitesses de la loco 0
+ *     echantillon 50                50 configurations tirées au hasard (toute la grille sinon)
+ *     repetitions 3                 simulations par configuration, de graines différentes
+ *     graine 1                      graine du tirage et de la première répétition
+ *
+ * Les répétitions d'une configuration utilisent les mêmes graines d'une configuration à
+ * l'autre. Pour chaque configuration, le tableau donne le débit de la section partagée
+ * (accès par heure simulée), les tours par heure, l'attente moyenne et le 99e centile
+ * des attentes de la section, et les violations de sécurité (collisions et
+ * déraillements). Les configurations du front de Pareto (débit maximal, 99e centile et
+ * violations minimaux) sont marquées et affichées.
+ *
+ * Usage : qtrainsim_lot --programme <exécutable> [--taches <n>] [--acceleration <n>]
+ *                       [--duree <secondes>] [--delai <secondes>] [--bilans <répertoire>]
+ *                       [--sortie <fichier.csv>] (<répertoire> | --balayage <fichier>)
+ */
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QEventLoop>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <set>
+
+/**
+ * Une simulation du lot, et son résultat.
+ */
+struct Simulation
+{
+    QString scenario;               //!> Fichier du scénario
+    QString bilan;                  //!> Fichier du bilan écrit par le simulateur
+    QString etat;                   //!> "ok", "echec" (pas de bilan, ou erreur du client) ou "delai" (interrompue)
+    QJsonObject resultat;           //!> Le bilan lu
+};
+
+/**
+ * Un réglage balayé : le mot-clé du scénario qu'il remplace et ses valeurs candidates.
+ */
+struct Parametre
+{
+    QString cle;                    //!> "reservation", "turns", "priorities" ou "speed"
+    int loco = -1;                  //!> Loco dont on fait varier la vitesse, pour "speed"
+    QStringList valeurs;            //!> Valeurs candidates, telles qu'écrites dans le scénario
+};
+
+/**
+ * Une configuration du balayage : une valeur par réglage, et ses résultats.
+ */
+struct Configuration
+{
+    QStringList valeurs;            //!> Valeur choisie pour chaque réglage
+    int simulations = 0;
+    int echecs = 0;
+    double duree = 0.0;             //!> Durée simulée cumulée, en secondes
+    int acces = 0;                  //!> Accès à la section partagée
+    int tours = 0;
+    QVector<double> attentes;       //!> Attentes de la section partagée, en secondes
+    int violations = 0;             //!> Collisions et déraillements
+    bool pareto = false;
+
+    double debit() const { return duree > 0.0 ? acces * 3600.0 / duree : 0.0; }
+    double toursParHeure() const { return duree > 0.0 ? tours * 3600.0 / duree : 0.0; }
+};
+
+/**
+ * Lance les simulations, au plus taches à la fois, et lit leurs bilans.
+ * \param repertoire le répertoire courant des simulations.
+ * \param delai la durée réelle au bout de laquelle une simulation est interrompue, en ms.
+ * \param options les options du simulateur communes à toutes les simulations.
+ */
+static void executer(QVector<Simulation> &simulations, const QString &programme, const QString &repertoire,
+                     int taches, int delai, const QStringList &options)
+{
+    QEventLoop boucle;
+    int prochaine = 0;
+    int enCours = 0;
+
+    // Lance la simulation suivante, et la suivante encore quand elle se termine
+    std::function<void()> lancerSuivante = [&]() {
+        if (prochaine >= simulations.size())
+        {
+            if (enCours == 0)
+                boucle.quit();
+            return;
+        }
+
+        int indice = prochaine++;
+        enCours++;
+
+        QProcess *processus = new QProcess();
+        processus->setWorkingDirectory(repertoire);
+        processus->setStandardOutputFile(QProcess::nullDevice());
+        processus->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+
+        QTimer::singleShot(delai, processus, [&simulations, processus, indice]() {
+            simulations[indice].etat = "delai";
+            processus->kill();
+        });
+
+        // Une simulation qui ne démarre pas est terminée sans bilan
+        auto terminer = [&, processus, indice]() {
+            Simulation &simulation = simulations[indice];
+            if (simulation.etat.isEmpty())
+            {
+                QFile f(simulation.bilan);
+                QJsonDocument document;
+                if (f.open(QIODevice::ReadOnly))
+                    document = QJsonDocument::fromJson(f.readAll());
+                simulation.resultat = document.object();
+
+                // Le programme client rejette par exemple un scénario invalide
+                bool ok = document.isObject() && simulation.resultat["resultat_client"].toInt() <= 0;
+                simulation.etat = ok ? "ok" : "echec";
+            }
+            std::fprintf(stderr, "%s : %s\n", qPrintable(QFileInfo(simulation.scenario).fileName()),
+                         qPrintable(simulation.etat));
+
+            processus->deleteLater();
+            enCours--;
+            lancerSuivante();
+        };
+        QObject::connect(processus, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), &boucle,
+                         [terminer](int, QProcess::ExitStatus) { terminer(); });
+        QObject::connect(processus, &QProcess::errorOccurred, &boucle, [terminer](QProcess::ProcessError erreur) {
+            if (erreur == QProcess::FailedToStart)
+                terminer();
+        });
+
+        const Simulation &simulation = simulations.at(indice);
+        QFile::remove(simulation.bilan);
+        processus->start(programme, QStringList(options)
+                         << "--scenario" << simulation.scenario
+                         << "--bilan" << simulation.bilan);
+    };
+
+    QTimer::singleShot(0, &boucle, [&]() {
+        for (int i = 0; i < taches; i++)
+            lancerSuivante();
+    });
+    boucle.exec();
+}
+
+/**
+ * Ligne du tableau des résultats d'une simulation.
+ */
+static QStringList ligneResultat(const Simulation &simulation)
+{
+    QStringList ligne;
+    ligne << QFileInfo(simulation.scenario).fileName() << simulation.etat;
+
+    if (simulation.etat != "ok")
+    {
+        while (ligne.size() < 11)
+            ligne << "";
+        return ligne;
+    }
+
+    const QJsonObject &bilan = simulation.resultat;
+
+    int tours = 0;
+    QStringList toursParLoco;
+    QVector<double> attentes;
+    foreach (QJsonValue valeur, bilan["locos"].toArray())
+    {
+        QJsonObject loco = valeur.toObject();
+        tours += loco["tours"].toInt();
+        toursParLoco << QString("%1:%2").arg(loco["numero"].toInt()).arg(loco["tours"].toInt());
+        foreach (QJsonValue attente, loco["attentes"].toArray())
+            attentes.append(attente.toDouble());
+    }
+
+    double moyenne = 0.0;
+    foreach (double attente, attentes)
+        moyenne += attente;
+    if (!attentes.isEmpty())
+        moyenne /= attentes.size();
+    double maximum = attentes.isEmpty() ? 0.0 : *std::max_element(attentes.begin(), attentes.end());
+
+    ligne << bilan["fin"].toString()
+          << QString::number(bilan["duree_simulee"].toDouble(), 'f', 1)
+          << QString::number(tours)
+          << toursParLoco.join(' ')
+          << QString::number(attentes.size())
+          << QString::number(moyenne, 'f', 2)
+          << QString::number(maximum, 'f', 2)
+          << QString::number(bilan["collisions"].toInt())
+          << QString::number(bilan["deraillements"].toInt());
+    return ligne;
+}
+
+/**
+ * Ecrit un tableau au format CSV.
+ * \return vrai si le fichier a pu être écrit.
+ */
+static bool ecrireCsv(const QString &fichier, const QStringList &entete, const QVector<QStringList> &lignes)
+{
+    QFile sortie(fichier);
+    if (!sortie.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        std::fprintf(stderr, "Impossible d'écrire %s\n", qPrintable(fichier));
+        return false;
+    }
+    QTextStream csv(&sortie);
+    csv << entete.join(',') << "\n";
+    foreach (const QStringList &ligne, lignes)
+        csv << ligne.join(',') << "\n";
+    return true;
+}
+
+/**
+ * Affiche un tableau, colonnes alignées, sur la sortie standard.
+ */
+static void afficherTableau(const QStringList &entete, QVector<QStringList> lignes)
+{
+    QVector<int> largeurs(entete.size());
+    for (int i = 0; i < entete.size(); i++)
+    {
+        largeurs[i] = entete[i].size();
+        foreach (const QStringList &ligne, lignes)
+            largeurs[i] = std::max(largeurs[i], int(ligne[i].size()));
+    }
+    lignes.prepend(entete);
+    foreach (const QStringList &ligne, lignes)
+    {
+        QString texte;
+        for (int i = 0; i < ligne.size(); i++)
+            texte += ligne[i].leftJustified(largeurs[i] + 2);
+        std::printf("%s\n", qPrintable(texte.trimmed()));
+    }
+}
+
+/**
+ * Lance chaque scénario d'un répertoire.
+ */
+static int executerLot(const QDir &repertoire, const QDir &bilans, const QString &programme, int taches, int delai,
+                       const QStringList &options, const QString &fichierSortie)
+{
+    // Les fichiers texte qui ne sont pas des maquettes sont des scénarios
+    QVector<Simulation> simulations;
+    foreach (QFileInfo info, repertoire.entryInfoList(QStringList("*.txt"), QDir::Files, QDir::Name))
+    {
+        if (info.fileName().startsWith("Maquet_"))
+            continue;
+        Simulation simulation;
+        simulation.scenario = info.absoluteFilePath();
+        simulation.bilan = bilans.absoluteFilePath(info.completeBaseName() + ".json");
+        simulations.append(simulation);
+    }
+
+    if (simulations.isEmpty())
+    {
+        std::fprintf(stderr, "Aucun scénario dans %s\n", qPrintable(repertoire.path()));
+        return 1;
+    }
+
+    std::fprintf(stderr, "%d scénarios, %d en parallèle\n", int(simulations.size()), taches);
+    executer(simulations, programme, repertoire.absolutePath(), taches, delai, options);
+
+    QStringList entete;
+    entete << "scenario" << "etat" << "fin" << "duree_simulee" << "tours" << "tours_par_loco"
+           << "attentes" << "attente_moyenne" << "attente_max" << "collisions" << "deraillements";
+
+    QVector<QStringList> lignes;
+    int echecs = 0;
+    foreach (const Simulation &simulation, simulations)
+    {
+        lignes.append(ligneResultat(simulation));
+        if (simulation.etat != "ok")
+            echecs++;
+    }
+
+    if (!ecrireCsv(fichierSortie, entete, lignes))
+        return 1;
+    afficherTableau(entete, lignes);
+
+    return echecs == 0 ? 0 : 1;
+}
+
+/**
+ * Ecrit une variante du scénario de base : les lignes des réglages balayés sont
+ * remplacées par les valeurs de la configuration.
+ * \return vrai si le fichier a pu être écrit.
+ */
+static bool ecrireVariante(const QString &fichier, const QStringList &base, const QVector<Parametre> &parametres,
+                           const QStringList &valeurs, quint32 graine)
+{
+    QStringList lignes;
+    lignes << QString("seed %1").arg(graine);
+    for (int i = 0; i < parametres.size(); i++)
+    {
+        if (parametres[i].cle != "speed")
+            lignes << parametres[i].cle + " " + valeurs[i];
+    }
+
+    foreach (QString ligne, base)
+    {
+        QStringList mots = ligne.section('#', 0, 0).simplified().split(' ');
+        const QString &cle = mots.first();
+        bool remplacee = cle == "seed";
+
+        for (int i = 0; i < parametres.size() && !remplacee; i++)
+        {
+            const Parametre &p = parametres[i];
+            if (p.cle == "speed" && cle == "loco" && mots.size() == 3 && mots[1].toInt() == p.loco)
+            {
+                lignes << QString("loco %1 %2").arg(p.loco).arg(valeurs[i]);
+                remplacee = true;
+            }
+            else if (p.cle == cle)
+                remplacee = true;
+        }
+
+        if (!remplacee)
+            lignes << ligne;
+    }
+
+    QFile f(fichier);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+        return false;
+    QTextStream flux(&f);
+    flux << lignes.join('\n') << "\n";
+    return true;
+}
+
+/**
+ * Marque les configurations du front de Pareto : aucune autre n'a un débit au moins
+ * aussi élevé, un 99e centile des attentes et des violations au plus aussi élevés,
+ * et l'emporte sur l'un des trois. Les configurations dont une simulation a échoué
+ * n'en font pas partie.
+ */
+static void marquerPareto(QVector<Configuration> &configurations, const QVector<double> &p99)
+{
+    for (int i = 0; i < configurations.size(); i++)
+    {
+        const Configuration &c = configurations[i];
+        bool dominee = c.echecs > 0;
+        for (int j = 0; j < configurations.size() && !dominee; j++)
+        {
+            const Configuration &autre = configurations[j];
+            if (j == i || autre.echecs > 0)
+                continue;
+            bool auMoinsAussiBonne = autre.debit() >= c.debit() && p99[j] <= p99[i] && autre.violations <= c.violations;
+            bool meilleure = autre.debit() > c.debit() || p99[j] < p99[i] || autre.violations < c.violations;
+            dominee = auMoinsAussiBonne && meilleure;
+        }
+        configurations[i].pareto = !dominee;
+    }
+}
+
+/**
+ * Retourne le centile d'une liste de valeurs (rang le plus proche).
+ */
+static double centile(QVector<double> valeurs, double proportion)
+{
+    if (valeurs.isEmpty())
+        return 0.0;
+    std::sort(valeurs.begin(), valeurs.end());
+    int rang = int(std::ceil(proportion * valeurs.size())) - 1;
+    return valeurs[std::max(0, rang)];
+}
+
+/**
+ * Lance les variantes d'un scénario décrites par un fichier de balayage.
+ */
+static int executerBalayage(const QString &fichierBalayage, const QDir &bilans, const QString &programme, int taches,
+                            int delai, const QStringList &options, const QString &fichierSortie)
+{
+    QFile f(fichierBalayage);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        std::fprintf(stderr, "Impossible de lire %s\n", qPrintable(fichierBalayage));
+        return 1;
+    }
+
+    QString fichierBase;
+    QVector<Parametre> parametres;
+    int echantillon = 0;
+    int repetitions = 1;
+    quint32 graine = 1;
+
+    int numeroLigne = 0;
+    QTextStream flux(&f);
+    while (!flux.atEnd())
+    {
+        numeroLigne++;
+        QString ligne = flux.readLine().section('#', 0, 0).simplified();
+        if (ligne.isEmpty())
+            continue;
+
+        QString cle = ligne.section(' ', 0, 0);
+        QString valeurs = ligne.section(' ', 1);
+        bool valide = !valeurs.isEmpty();
+
+        if (cle == "scenario")
+            fichierBase = QFileInfo(fichierBalayage).dir().absoluteFilePath(valeurs);
+        else if (cle == "echantillon")
+            echantillon = valeurs.toInt(&valide);
+        else if (cle == "repetitions")
+            valide = (repetitions = valeurs.toInt()) > 0;
+        else if (cle == "graine")
+            graine = valeurs.toUInt(&valide);
+        else if (cle == "reservation" || cle == "turns" || cle == "priorities" || cle == "speed")
+        {
+            Parametre p;
+            p.cle = cle;
+            if (cle == "speed")
+            {
+                p.loco = valeurs.section(' ', 0, 0).toInt(&valide);
+                valeurs = valeurs.section(' ', 1);
+            }
+            foreach (QString valeur, valeurs.split('|'))
+                if (!valeur.simplified().isEmpty())
+                    p.valeurs << valeur.simplified();
+            valide = valide && !p.valeurs.isEmpty();
+            parametres.append(p);
+        }
+        else
+            valide = false;
+
+        if (!valide)
+        {
+            std::fprintf(stderr, "%s, ligne %d : ligne invalide\n", qPrintable(fichierBalayage), numeroLigne);
+            return 1;
+        }
+    }
+
+    QFile base(fichierBase);
+    if (fichierBase.isEmpty() || !base.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        std::fprintf(stderr, "Impossible de lire le scénario de base \"%s\"\n", qPrintable(fichierBase));
+        return 1;
+    }
+    QStringList lignesBase = QString::fromUtf8(base.readAll()).split('\n');
+
+    // Les configurations sont numérotées dans la grille, le premier réglage variant le plus vite
+    qint64 tailleGrille = 1;
+    foreach (const Parametre &p, parametres)
+        tailleGrille *= p.valeurs.size();
+
+    std::vector<qint64> indices;
+    if (echantillon <= 0 || echantillon >= tailleGrille)
+    {
+        for (qint64 i = 0; i < tailleGrille; i++)
+            indices.push_back(i);
+    }
+    else
+    {
+        std::mt19937_64 generateur(graine);
+        std::uniform_int_distribution<qint64> tirage(0, tailleGrille - 1);
+        std::set<qint64> tires;
+        while (int(tires.size()) < echantillon)
+            tires.insert(tirage(generateur));
+        indices.assign(tires.begin(), tires.end());
+    }
+
+    QVector<Configuration> configurations;
+    QVector<Simulation> simulations;
+    foreach (qint64 indice, indices)
+    {
+        Configuration configuration;
+        qint64 reste = indice;
+        foreach (const Parametre &p, parametres)
+        {
+            configuration.valeurs << p.valeurs[int(reste % p.valeurs.size())];
+            reste /= p.valeurs.size();
+        }
+
+        for (int r = 0; r < repetitions; r++)
+        {
+            QString nom = QString("config_%1_%2").arg(configurations.size(), 4, 10, QChar('0')).arg(r);
+            Simulation simulation;
+            simulation.scenario = bilans.absoluteFilePath(nom + ".txt");
+            simulation.bilan = bilans.absoluteFilePath(nom + ".json");
+            if (!ecrireVariante(simulation.scenario, lignesBase, parametres, configuration.valeurs, graine + r))
+            {
+                std::fprintf(stderr, "Impossible d'écrire %s\n", qPrintable(simulation.scenario));
+                return 1;
+            }
+            simulations.append(simulation);
+        }
+        configurations.append(configuration);
+    }
+
+    std::fprintf(stderr, "%d configurations sur %lld, %d simulations, %d en parallèle\n", int(configurations.size()),
+                 tailleGrille, int(simulations.size()), taches);
+
+    // Les maquettes sont cherchées à côté du scénario de base
+    executer(simulations, programme, QFileInfo(fichierBase).absolutePath(), taches, delai, options);
+
+    for (int i = 0; i < simulations.size(); i++)
+    {
+        Configuration &configuration = configurations[i / repetitions];
+        const Simulation &simulation = simulations[i];
+        configuration.simulations++;
+        if (simulation.etat != "ok")
+        {
+            configuration.echecs++;
+            continue;
+        }
+
+        const QJsonObject &bilan = simulation.resultat;
+        configuration.duree += bilan["duree_simulee"].toDouble();
+        configuration.violations += bilan["collisions"].toInt() + bilan["deraillements"].toInt();
+        foreach (QJsonValue valeur, bilan["locos"].toArray())
+        {
+            QJsonObject loco = valeur.toObject();
+            configuration.tours += loco["tours"].toInt();
+            foreach (QJsonValue attente, loco["attentes"].toArray())
+            {
+                configuration.attentes.append(attente.toDouble());
+                configuration.acces++;
+            }
+        }
+    }
+
+    QVector<double> p99;
+    foreach (const Configuration &configuration, configurations)
+        p99.append(centile(configuration.attentes, 0.99));
+    marquerPareto(configurations, p99);
+
+    QStringList entete;
+    foreach (const Parametre &p, parametres)
+        entete << (p.cle == "speed" ? QString("speed%1").arg(p.loco) : p.cle);
+    entete << "simulations" << "echecs" << "debit_heure" << "tours_heure" << "attente_moyenne"
+           << "attente_p99" << "violations" << "pareto";
+
+    QVector<QStringList> lignes;
+    QVector<QStringList> front;
+    for (int i = 0; i < configurations.size(); i++)
+    {
+        const Configuration &c = configurations[i];
+        double moyenne = 0.0;
+        foreach (double attente, c.attentes)
+            moyenne += attente;
+        if (!c.attentes.isEmpty())
+            moyenne /= c.attentes.size();
+
+        QStringList ligne = c.valeurs;
+        ligne << QString::number(c.simulations)
+              << QString::number(c.echecs)
+              << QString::number(c.debit(), 'f', 1)
+              << QString::number(c.toursParHeure(), 'f', 1)
+              << QString::number(moyenne, 'f', 2)
+              << QString::number(p99[i], 'f', 2)
+              << QString::number(c.violations)
+              << (c.pareto ? "1" : "0");
+        lignes.append(ligne);
+        if (c.pareto)
+            front.append(ligne);
+    }
+
+    if (!ecrireCsv(fichierSortie, entete, lignes))
+        return 1;
+
+    // Le front de Pareto, du débit le plus élevé au plus faible
+    int colonneDebit = entete.indexOf("debit_heure");
+    std::sort(front.begin(), front.end(), [colonneDebit](const QStringList &a, const QStringList &b) {
+        return a[colonneDebit].toDouble() > b[colonneDebit].toDouble();
+    });
+    std::printf("Front de Pareto (%d configurations sur %d) :\n", int(front.size()), int(configurations.size()));
+    afficherTableau(entete, front);
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Exécution parallèle d'un lot de scénarios QtrainSim");
+    parser.addHelpOption();
+    QCommandLineOption optionProgramme("programme", "Programme client à lancer sur chaque scénario.", "exécutable");
+    QCommandLineOption optionBalayage("balayage", "Fait varier les réglages d'un scénario de base, décrits dans ce fichier.", "fichier");
+    QCommandLineOption optionTaches("taches", "Simulations en parallèle (par défaut, le nombre de coeurs).", "n",
+                                    QString::number(QThread::idealThreadCount()));
+    QCommandLineOption optionAcceleration("acceleration", "Pas de simulation calculés par affichage.", "n", "20");
+    QCommandLineOption optionDuree("duree", "Durée simulée de chaque simulation, en secondes.", "secondes", "600");
+    QCommandLineOption optionDelai("delai", "Durée réelle au bout de laquelle une simulation est interrompue, en secondes.", "secondes", "600");
+    QCommandLineOption optionBilans("bilans", "Répertoire où conserver les bilans JSON (et les scénarios du balayage).", "répertoire");
+    QCommandLineOption optionSortie("sortie", "Tableau CSV des résultats à écrire.", "fichier", "resultats.csv");
+    parser.addOption(optionProgramme);
+    parser.addOption(optionBalayage);
+    parser.addOption(optionTaches);
+    parser.addOption(optionAcceleration);
+    parser.addOption(optionDuree);
+    parser.addOption(optionDelai);
+    parser.addOption(optionBilans);
+    parser.addOption(optionSortie);
+    parser.addPositionalArgument("répertoire", "Répertoire contenant les scénarios et leurs maquettes.");
+    parser.process(app);
+
+    int nbreArguments = parser.isSet(optionBalayage) ? 0 : 1;
+    if (parser.positionalArguments().size() != nbreArguments || !parser.isSet(optionProgramme))
+        parser.showHelp(1);
+
+    QString programme = QFileInfo(parser.value(optionProgramme)).absoluteFilePath();
+    int taches = std::max(1, parser.value(optionTaches).toInt());
+    int delai = parser.value(optionDelai).toInt() * 1000;
+
+    QStringList options;
+    options << "--sans-fenetre"
+            << "--acceleration" << parser.value(optionAcceleration)
+            << "--duree" << parser.value(optionDuree);
+
+    // Les bilans sont conservés si on le demande
+    QTemporaryDir temporaire;
+    QDir bilans(parser.isSet(optionBilans) ? parser.value(optionBilans) : temporaire.path());
+    if (!bilans.mkpath("."))
+    {
+        std::fprintf(stderr, "Impossible de créer le répertoire %s\n", qPrintable(bilans.path()));
+        return 1;
+    }
+
+    if (parser.isSet(optionBalayage))
+        return executerBalayage(parser.value(optionBalayage), bilans, programme, taches, delai, options,
+                                parser.value(optionSortie));
+
+    return executerLot(QDir(parser.positionalArguments().first()), bilans, programme, taches, delai, options,
+                       parser.value(optionSortie));
+}
@@ -0,0 +1,115 @@
+#include "backendnul.h"
+#include "general.h"
+
+
+BackendNul::BackendNul() :
+    nbreContacts(0), nbreCommandes(0), prochainDeclencheur(1)
+{
+}
+
+bool BackendNul::interactif() const
+{
+    return false;
+}
+
+void BackendNul::init_maquette()
+{
+}
+
+void BackendNul::selection_maquette(const QString &/*maquette*/)
+{
+}
+
+void BackendNul::ajouter_loco(int /*no_loco*/)
+{
+}
+
+void BackendNul::diriger_aiguillage(int /*no_aiguillage*/, int /*direction*/, int /*politique*/)
+{
+    nbreCommandes.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BackendNul::attendre_contact(int /*no_contact*/)
+{
+    nbreContacts.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BackendNul::mettre_vitesse_loco(int /*no_loco*/, int /*vitesse*/)
+{
+    nbreCommandes.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BackendNul::mettre_vitesse_progressive(int /*no_loco*/, int /*vitesse_future*/)
+{
+    nbreCommandes.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BackendNul::inverser_sens_loco(int /*no_loco*/)
+{
+    nbreCommandes.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BackendNul::demander_loco(int /*contact_a*/, int /*contact_b*/)
+{
+}
+
+void BackendNul::assigner_loco(int /*contact_a*/, int /*contact_b*/, int /*no_loco*/, int /*vitesse*/)
+{
+}
+
+int BackendNul::lire_position_loco(int /*no_loco*/, int */*contact_prec*/, int */*contact_suiv*/, double */*distance*/)
+{
+    return 0;
+}
+
+int BackendNul::lire_vitesse_reelle(int /*no_loco*/)
+{
+    return VITESSE_NULLE;
+}
+
+int BackendNul::creer_declencheur(int /*no_loco*/, int /*contact_prec*/, int /*contact_suiv*/, double /*distance*/, bool /*depuisPrecedent*/)
+{
+    return prochainDeclencheur.fetch_add(1);
+}
+
+void BackendNul::attendre_declencheur(int /*no_declencheur*/)
+{
+    nbreContacts.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BackendNul::supprimer_declencheur(int /*no_declencheur*/)
+{
+}
+
+double BackendNul::longueur_segment(int /*contact_a*/, int /*contact_b*/)
+{
+    return -1.0;
+}
+
+double BackendNul::distance_contacts(int /*contact_a*/, int /*contact_b*/)
+{
+    return -1.0;
+}
+
+double BackendNul::eta_contact(int /*no_loco*/, int /*contact*/)
+{
+    return -1.0;
+}
+
+void BackendNul::afficher_message(const QString &/*message*/)
+{
+}
+
+void BackendNul::afficher_message_loco(int /*no_loco*/, const QString &/*message*/)
+{
+}
+
+quint64 BackendNul::getNbreContacts() const
+{
+    return nbreContacts.load();
+}
+
+quint64 BackendNul::getNbreCommandes() const
+{
+    return nbreCommandes.load();
+}
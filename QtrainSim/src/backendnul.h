@@ -0,0 +1,57 @@
+#ifndef BACKENDNUL_H
+#define BACKENDNUL_H
+
+#include <atomic>
+
+#include "backendtrain.h"
+
+/**
+ * Backend sans simulateur ni maquette : chaque commande retourne immédiatement,
+ * et un contact est considéré comme activé dès qu'on l'attend. Permet de mesurer
+ * le coût de la logique du programme client seule.
+ * Les contacts attendus et les commandes reçues sont comptés.
+ */
+class BackendNul : public BackendTrain
+{
+public:
+    BackendNul();
+
+    bool interactif() const override;
+    void init_maquette() override;
+    void selection_maquette(const QString &maquette) override;
+    void ajouter_loco(int no_loco) override;
+    void diriger_aiguillage(int no_aiguillage, int direction, int politique) override;
+    void attendre_contact(int no_contact) override;
+    void mettre_vitesse_loco(int no_loco, int vitesse) override;
+    void mettre_vitesse_progressive(int no_loco, int vitesse_future) override;
+    void inverser_sens_loco(int no_loco) override;
+    void demander_loco(int contact_a, int contact_b) override;
+    void assigner_loco(int contact_a, int contact_b, int no_loco, int vitesse) override;
+    int lire_position_loco(int no_loco, int *contact_prec, int *contact_suiv, double *distance) override;
+    int lire_vitesse_reelle(int no_loco) override;
+    int creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance, bool depuisPrecedent) override;
+    void attendre_declencheur(int no_declencheur) override;
+    void supprimer_declencheur(int no_declencheur) override;
+    double longueur_segment(int contact_a, int contact_b) override;
+    double distance_contacts(int contact_a, int contact_b) override;
+    double eta_contact(int no_loco, int contact) override;
+    void afficher_message(const QString &message) override;
+    void afficher_message_loco(int no_loco, const QString &message) override;
+
+    /** retourne le nombre d'appels à attendre_contact.
+      * \return le nombre de contacts attendus.
+      */
+    quint64 getNbreContacts() const;
+
+    /** retourne le nombre de commandes de vitesse, de sens et d'aiguillage reçues.
+      * \return le nombre de commandes.
+      */
+    quint64 getNbreCommandes() const;
+
+private:
+    std::atomic<quint64> nbreContacts;
+    std::atomic<quint64> nbreCommandes;
+    std::atomic<int> prochainDeclencheur;
+};
+
+#endif // BACKENDNUL_H
@@ -0,0 +1,385 @@
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMetaObject>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+#include "backendrejeu.h"
+
+using namespace TraceCommandes;
+
+namespace {
+
+bool avant(const Evenement &x, const Evenement &y)
+{
+    if (x.type != y.type)
+        return x.type < y.type;
+    if (x.loco != y.loco)
+        return x.loco < y.loco;
+    if (x.a != y.a)
+        return x.a < y.a;
+    if (x.b != y.b)
+        return x.b < y.b;
+    if (x.c != y.c)
+        return x.c < y.c;
+    return x.d < y.d;
+}
+
+QString decrire(const Evenement &e)
+{
+    switch (e.type)
+    {
+    case CONTACT:
+        return QString("contact %1 activé par la loco %2").arg(e.a).arg(e.loco);
+    case VITESSE:
+        return QString("vitesse %1 pour la loco %2").arg(e.a).arg(e.loco);
+    case VITESSE_PROGRESSIVE:
+        return QString("vitesse progressive %1 pour la loco %2").arg(e.a).arg(e.loco);
+    case INVERSION:
+        return QString("inversion de la loco %1").arg(e.loco);
+    case AIGUILLAGE:
+        return QString("aiguillage %1 dans la direction %2").arg(e.a).arg(e.b);
+    case ATTENTE:
+        return QString("attente du contact %1").arg(e.a);
+    case SYNCHRO:
+        return QString("point de synchronisation %1 franchi par la loco %2").arg(e.a).arg(e.loco);
+    case GRAINE:
+        return QString("graine %1").arg(quint32(e.a));
+    case DECLENCHEUR:
+        return QString("déclencheur %1 à %2 mm avant le contact %3, après le contact %4, pour la loco %5")
+                .arg(e.a).arg(e.d / 1000.0).arg(e.c).arg(e.b).arg(e.loco);
+    case DECLENCHEUR_SEGMENT:
+        return QString("déclencheur %1 à %2 mm du contact %3 vers le contact %4, pour la loco %5")
+                .arg(e.a).arg(e.d / 1000.0).arg(e.b).arg(e.c).arg(e.loco);
+    case FRANCHISSEMENT:
+        return QString("déclencheur %1 franchi par la loco %2").arg(e.a).arg(e.loco);
+    case ATTENTE_DECLENCHEUR:
+        return QString("attente du déclencheur %1").arg(e.a);
+    case LONGUEUR:
+        return QString("lecture de la longueur du segment %1-%2").arg(e.a).arg(e.b);
+    case VITESSE_REELLE:
+        return QString("lecture de la vitesse réelle %1 de la loco %2").arg(e.a).arg(e.loco);
+    default:
+        return QString("événement de type %1").arg(e.type);
+    }
+}
+
+}
+
+BackendRejeu::BackendRejeu() :
+    avecGraine(false), graine(0), pilote(this), arret(false), nbreDivergences(0)
+{
+}
+
+BackendRejeu::~BackendRejeu()
+{
+    arret.store(true);
+    mutex.lock();
+    commandeEmise.wakeAll();
+    mutex.unlock();
+    pilote.wait();
+}
+
+bool BackendRejeu::charger(const QString &fichier)
+{
+    QFile f(fichier);
+    if (!f.open(QIODevice::ReadOnly))
+        return false;
+
+    EnTete entete;
+    if (f.read(reinterpret_cast<char*>(&entete), sizeof(entete)) != sizeof(entete) ||
+        std::memcmp(entete.signature, SIGNATURE, sizeof(entete.signature)) != 0 ||
+        entete.version != VERSION || entete.boutisme != BOUTISME)
+        return false;
+
+    qint64 taille = f.size() - qint64(sizeof(entete));
+    evenements.resize(int(taille / qint64(sizeof(Evenement))));
+    qint64 aLire = evenements.size() * qint64(sizeof(Evenement));
+    if (f.read(reinterpret_cast<char*>(evenements.data()), aLire) != aLire)
+        return false;
+
+    // L'ordonnancement est imposé par l'Ordonnanceur, il ne fait pas partie des commandes
+    QVector<Evenement> commandes;
+    commandes.reserve(evenements.size());
+    foreach (const Evenement &e, evenements)
+    {
+        if (e.type == SYNCHRO)
+            decisions.append(e);
+        else if (e.type == GRAINE)
+        {
+            avecGraine = true;
+            graine = quint32(e.a);
+        }
+        else
+            commandes.append(e);
+    }
+    evenements = commandes;
+
+    int contactMax = 0;
+    foreach (const Evenement &e, evenements)
+    {
+        if (e.type == CONTACT || e.type == ATTENTE)
+            contactMax = std::max(contactMax, int(e.a));
+        else if (e.type == DECLENCHEUR || e.type == DECLENCHEUR_SEGMENT)
+            creations.append(e);
+        else if (e.type == LONGUEUR)
+            longueurs.insert(qMakePair(int(e.a), int(e.b)), e.c);
+        else if (e.type == VITESSE_REELLE)
+            vitessesReelles[e.loco].append(e.a);
+    }
+    generations.fill(0, contactMax + 1);
+
+    return true;
+}
+
+int BackendRejeu::getNbreDivergences() const
+{
+    return nbreDivergences.load();
+}
+
+const QVector<Evenement> &BackendRejeu::getDecisions() const
+{
+    return decisions;
+}
+
+bool BackendRejeu::getGraine(quint32 &graine) const
+{
+    if (avecGraine)
+        graine = this->graine;
+    return avecGraine;
+}
+
+void BackendRejeu::init_maquette()
+{
+    pilote.start();
+}
+
+void BackendRejeu::diriger_aiguillage(int no_aiguillage, int direction, int politique)
+{
+    BackendNul::diriger_aiguillage(no_aiguillage, direction, politique);
+    observer(AIGUILLAGE, 0, no_aiguillage, direction);
+}
+
+void BackendRejeu::attendre_contact(int no_contact)
+{
+    BackendNul::attendre_contact(no_contact);
+
+    QMutexLocker locker(&mutex);
+
+    Evenement e = {0, quint8(ATTENTE), 0, 0, no_contact, 0, 0, 0};
+    emises.append(e);
+    commandeEmise.wakeAll();
+
+    // Un contact absent de la trace n'est jamais activé
+    quint64 generation = no_contact > 0 && no_contact < generations.size() ? generations.at(no_contact) : 0;
+    while (!arret.load() && (no_contact <= 0 || no_contact >= generations.size() || generations.at(no_contact) == generation))
+        activation.wait(&mutex);
+}
+
+void BackendRejeu::mettre_vitesse_loco(int no_loco, int vitesse)
+{
+    BackendNul::mettre_vitesse_loco(no_loco, vitesse);
+    observer(VITESSE, no_loco, vitesse);
+}
+
+void BackendRejeu::mettre_vitesse_progressive(int no_loco, int vitesse_future)
+{
+    BackendNul::mettre_vitesse_progressive(no_loco, vitesse_future);
+    observer(VITESSE_PROGRESSIVE, no_loco, vitesse_future);
+}
+
+void BackendRejeu::inverser_sens_loco(int no_loco)
+{
+    BackendNul::inverser_sens_loco(no_loco);
+    observer(INVERSION, no_loco, 0);
+}
+
+int BackendRejeu::lire_vitesse_reelle(int no_loco)
+{
+    int vitesse = BackendNul::lire_vitesse_reelle(no_loco);
+
+    mutex.lock();
+    const QVector<int> &lues = vitessesReelles[no_loco];
+    int &rang = lecturesVitesse[no_loco];
+    if (rang < lues.size())
+        vitesse = lues.at(rang++);
+    mutex.unlock();
+
+    observer(VITESSE_REELLE, no_loco, vitesse);
+    return vitesse;
+}
+
+int BackendRejeu::creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance, bool depuisPrecedent)
+{
+    BackendNul::creer_declencheur(no_loco, contact_prec, contact_suiv, distance, depuisPrecedent);
+
+    TypeEvenement type = depuisPrecedent ? DECLENCHEUR_SEGMENT : DECLENCHEUR;
+    int micrometres = qRound(distance * 1000.0);
+    int no_declencheur = -1;
+
+    // Le déclencheur reçoit le numéro de la première création identique de la trace
+    mutex.lock();
+    for (int i = 0; i < creations.size(); i++)
+    {
+        const Evenement &e = creations.at(i);
+        if (e.type == type && e.loco == no_loco && e.b == contact_prec && e.c == contact_suiv &&
+            e.d == micrometres)
+        {
+            no_declencheur = e.a;
+            creations.remove(i);
+            break;
+        }
+    }
+    mutex.unlock();
+
+    observer(type, no_loco, no_declencheur, contact_prec, contact_suiv, micrometres);
+    return no_declencheur;
+}
+
+void BackendRejeu::attendre_declencheur(int no_declencheur)
+{
+    BackendNul::attendre_declencheur(no_declencheur);
+
+    QMutexLocker locker(&mutex);
+
+    Evenement e = {0, quint8(ATTENTE_DECLENCHEUR), 0, 0, no_declencheur, 0, 0, 0};
+    emises.append(e);
+    commandeEmise.wakeAll();
+
+    // Comme dans le simulateur, un franchissement antérieur à l'attente n'est pas perdu,
+    // et chaque thread en attente est libéré par le même franchissement
+    QPair<int, Qt::HANDLE> attente(no_declencheur, QThread::currentThreadId());
+    quint64 vus = franchissementsVus.value(attente);
+    while (!arret.load() && !supprimes.contains(no_declencheur) &&
+           franchissements.value(no_declencheur) == vus)
+        activation.wait(&mutex);
+    franchissementsVus.insert(attente, franchissements.value(no_declencheur));
+}
+
+void BackendRejeu::supprimer_declencheur(int no_declencheur)
+{
+    BackendNul::supprimer_declencheur(no_declencheur);
+
+    mutex.lock();
+    supprimes.insert(no_declencheur);
+    mutex.unlock();
+    activation.wakeAll();
+}
+
+double BackendRejeu::longueur_segment(int contact_a, int contact_b)
+{
+    mutex.lock();
+    int micrometres = longueurs.value(qMakePair(contact_a, contact_b), -1);
+    mutex.unlock();
+
+    observer(LONGUEUR, 0, contact_a, contact_b, micrometres);
+    return micrometres < 0 ? -1.0 : micrometres / 1000.0;
+}
+
+void BackendRejeu::observer(TypeEvenement type, int loco, int a, int b, int c, int d)
+{
+    Evenement e = {0, quint8(type), 0, quint16(loco), a, b, c, d};
+
+    QMutexLocker locker(&mutex);
+    emises.append(e);
+    commandeEmise.wakeAll();
+}
+
+void BackendRejeu::attendreCommandes(int n)
+{
+    QElapsedTimer chrono;
+    chrono.start();
+
+    QMutexLocker locker(&mutex);
+    while (emises.size() < n && !arret.load())
+    {
+        qint64 reste = DELAI_MS - chrono.elapsed();
+        if (reste <= 0)
+            break;
+        commandeEmise.wait(&mutex, quint64(reste));
+    }
+}
+
+void BackendRejeu::comparer(QVector<Evenement> attendues, int position)
+{
+    mutex.lock();
+    QVector<Evenement> obtenues = emises;
+    emises.clear();
+    mutex.unlock();
+
+    // Seules les commandes comptent, pas leur ordre entre threads au sein de l'intervalle
+    std::sort(attendues.begin(), attendues.end(), avant);
+    std::sort(obtenues.begin(), obtenues.end(), avant);
+
+    int i = 0, j = 0;
+    while (i < attendues.size() || j < obtenues.size())
+    {
+        if (j >= obtenues.size() || (i < attendues.size() && avant(attendues.at(i), obtenues.at(j))))
+        {
+            std::cout << "Divergence avant l'événement " << position << " : manque "
+                      << qPrintable(decrire(attendues.at(i))) << std::endl;
+            nbreDivergences++;
+            i++;
+        }
+        else if (i >= attendues.size() || avant(obtenues.at(j), attendues.at(i)))
+        {
+            std::cout << "Divergence avant l'événement " << position << " : inattendu "
+                      << qPrintable(decrire(obtenues.at(j))) << std::endl;
+            nbreDivergences++;
+            j++;
+        }
+        else
+        {
+            i++;
+            j++;
+        }
+    }
+}
+
+void BackendRejeu::activer(int no_contact)
+{
+    mutex.lock();
+    if (no_contact > 0 && no_contact < generations.size())
+        generations[no_contact]++;
+    mutex.unlock();
+    activation.wakeAll();
+}
+
+void BackendRejeu::franchir(int no_declencheur)
+{
+    mutex.lock();
+    franchissements[no_declencheur]++;
+    mutex.unlock();
+    activation.wakeAll();
+}
+
+void BackendRejeu::Pilote::run()
+{
+    const QVector<Evenement> &evenements = backend->evenements;
+    QVector<Evenement> attendues;
+    int i = 0;
+
+    while (i <= evenements.size() && !backend->arret.load())
+    {
+        attendues.clear();
+        while (i < evenements.size() && evenements.at(i).type != CONTACT && evenements.at(i).type != FRANCHISSEMENT)
+            attendues.append(evenements.at(i++));
+
+        backend->attendreCommandes(attendues.size());
+        backend->comparer(attendues, i);
+
+        if (i < evenements.size() && evenements.at(i).type == CONTACT)
+            backend->activer(evenements.at(i).a);
+        else if (i < evenements.size())
+            backend->franchir(evenements.at(i).a);
+        i++;
+    }
+
+    std::cout << "Rejeu terminé : " << evenements.size() << " événements, "
+              << backend->nbreDivergences.load() << " divergence(s)" << std::endl;
+
+    QMetaObject::invokeMethod(QCoreApplication::instance(), "quit", Qt::QueuedConnection);
+}
@@ -0,0 +1,136 @@
+#ifndef BACKENDREJEU_H
+#define BACKENDREJEU_H
+
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <atomic>
+
+#include "backendnul.h"
+#include "tracecommandes.h"
+
+/**
+ * Backend rejouant une trace de commandes enregistrée dans le simulateur (voir
+ * TraceCommandes), sans simulation, le plus vite possible.
+ *
+ * La trace est découpée en intervalles par les activations de contacts et les
+ * franchissements de déclencheurs virtuels. Pour chaque intervalle, le backend attend que
+ * le programme client ait émis autant de commandes, d'attentes et de lectures que lors de
+ * l'enregistrement, les compare à celles de la trace, puis active le contact ou le
+ * déclencheur suivant. Les lectures (longueur d'un segment, vitesse réelle) reçoivent les
+ * réponses enregistrées, et les déclencheurs créés les numéros enregistrés. Toute
+ * commande manquante ou inattendue est signalée comme une divergence. Le délai
+ * d'attente ne s'écoule que si le programme client émet moins de commandes que prévu.
+ *
+ * A la fin de la trace, le bilan est affiché et l'application se termine.
+ *
+ * La graine et les décisions d'ordonnancement de la trace ne sont pas comparées : elles
+ * sont transmises à l'Ordonnanceur, qui impose le même ordre aux threads du client.
+ */
+class BackendRejeu : public BackendNul
+{
+public:
+    BackendRejeu();
+    ~BackendRejeu();
+
+    /** lit la trace à rejouer.
+      * \param fichier le fichier de la trace (.qtt).
+      * \return vrai si la trace a pu être lue.
+      */
+    bool charger(const QString &fichier);
+
+    /** retourne le nombre de divergences constatées.
+      * \return le nombre de commandes manquantes ou inattendues.
+      */
+    int getNbreDivergences() const;
+
+    /** retourne les décisions d'ordonnancement de la trace (événements SYNCHRO).
+      */
+    const QVector<TraceCommandes::Evenement> &getDecisions() const;
+
+    /** retourne la graine de la simulation enregistrée.
+      * \param graine la graine, si la trace en contient une.
+      * \return vrai si la trace contient une graine.
+      */
+    bool getGraine(quint32 &graine) const;
+
+    /**
+     * Démarre le rejeu de la trace.
+     */
+    void init_maquette() override;
+
+    void diriger_aiguillage(int no_aiguillage, int direction, int politique) override;
+    void attendre_contact(int no_contact) override;
+    void mettre_vitesse_loco(int no_loco, int vitesse) override;
+    void mettre_vitesse_progressive(int no_loco, int vitesse_future) override;
+    void inverser_sens_loco(int no_loco) override;
+    int lire_vitesse_reelle(int no_loco) override;
+    int creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance, bool depuisPrecedent) override;
+    void attendre_declencheur(int no_declencheur) override;
+    void supprimer_declencheur(int no_declencheur) override;
+    double longueur_segment(int contact_a, int contact_b) override;
+
+private:
+    //! Délai accordé au programme client pour émettre les commandes d'un intervalle
+    static const int DELAI_MS = 500;
+
+    class Pilote : public QThread
+    {
+    public:
+        explicit Pilote(BackendRejeu *backend) : backend(backend) {}
+    protected:
+        void run() override;
+    private:
+        BackendRejeu *backend;
+    };
+
+    /** note une commande émise par le programme client.
+      */
+    void observer(TraceCommandes::TypeEvenement type, int loco, int a, int b = 0, int c = 0, int d = 0);
+
+    /** attend que le programme client ait émis au moins n commandes depuis la dernière
+      * comparaison, au plus DELAI_MS.
+      */
+    void attendreCommandes(int n);
+
+    /** compare les commandes émises depuis la dernière comparaison à celles attendues.
+      * \param attendues les commandes de la trace.
+      * \param position l'indice, dans la trace, de la fin de l'intervalle comparé.
+      */
+    void comparer(QVector<TraceCommandes::Evenement> attendues, int position);
+
+    /** active un contact : réveille les threads qui l'attendent.
+      */
+    void activer(int no_contact);
+
+    /** franchit un déclencheur virtuel : réveille les threads qui l'attendent.
+      */
+    void franchir(int no_declencheur);
+
+    QVector<TraceCommandes::Evenement> evenements;
+    QVector<TraceCommandes::Evenement> decisions;
+    bool avecGraine;
+    quint32 graine;
+    Pilote pilote;
+    std::atomic<bool> arret;
+    std::atomic<int> nbreDivergences;
+    QMutex mutex;
+    QWaitCondition commandeEmise;
+    QVector<TraceCommandes::Evenement> emises;
+    QVector<quint64> generations;
+    QWaitCondition activation;
+    QVector<TraceCommandes::Evenement> creations;           //!> Créations de déclencheurs, non encore rejouées
+    QHash<int, quint64> franchissements;                    //!> Par déclencheur, nombre de franchissements
+    QHash<QPair<int, Qt::HANDLE>, quint64> franchissementsVus; //!> Par déclencheur et thread, franchissements pris en compte
+    QSet<int> supprimes;
+    QHash<QPair<int, int>, int> longueurs;                  //!> Par segment, longueur lue en µm
+    QHash<int, QVector<int> > vitessesReelles;              //!> Par loco, vitesses réelles lues, dans l'ordre
+    QHash<int, int> lecturesVitesse;                        //!> Par loco, nombre de vitesses réelles rejouées
+};
+
+#endif // BACKENDREJEU_H
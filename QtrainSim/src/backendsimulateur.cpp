@@ -0,0 +1,191 @@
+#include <QApplication>
+
+#include "backendsimulateur.h"
+#include "mainwindow.h"
+#include "trainsimsettings.h"
+
+
+BackendSimulateur::BackendSimulateur()
+{
+    mainwindow = nullptr;
+    simView = nullptr;
+}
+
+void BackendSimulateur::setSansFenetre(bool sansFenetre)
+{
+    TrainSimSettings::getInstance()->setSansFenetre(sansFenetre);
+}
+
+bool BackendSimulateur::interactif() const
+{
+    return !TrainSimSettings::getInstance()->getSansFenetre();
+}
+
+void BackendSimulateur::init_maquette()
+{
+    mainwindow=new MainWindow();
+
+    simView = mainwindow->getSimView();
+
+    if (TrainSimSettings::getInstance()->getSansFenetre())
+    {
+        // Personne n'est là pour lancer la simulation, ni pour la regarder s'arrêter
+        CONNECT(simView, SIGNAL(simulationArretee()), qApp, SLOT(quit()));
+        mainwindow->toggleSimulation();
+    }
+    else
+        mainwindow->show();
+
+    CONNECT(this, SIGNAL(setLoco(int,int,int,int)), simView, SLOT(setLoco(int,int,int,int)));
+    CONNECT(this, SIGNAL(askLoco(int,int)), simView, SLOT(askLoco(int,int)));
+    CONNECT(this, SIGNAL(setVitesseLoco(int,int)), simView, SLOT(setVitesseLoco(int,int)));
+    CONNECT(this, SIGNAL(reverseLoco(int)), simView, SLOT(reverseLoco(int)));
+    CONNECT(this, SIGNAL(setVitesseProgressiveLoco(int,int)), simView, SLOT(setVitesseProgressiveLoco(int,int)));
+    CONNECT(this, SIGNAL(setVoieVariable(int,int,int)), simView, SLOT(setVoieVariable(int,int,int)));
+    CONNECT(this, SIGNAL(addLoco(int)),mainwindow,SLOT(addLoco(int)));
+    CONNECT(this, SIGNAL(selectMaquette(QString)),mainwindow,SLOT(selectionMaquette(QString)));
+    CONNECT(this, SIGNAL(afficheMessage(QString)),mainwindow,SLOT(afficherMessage(QString)));
+    CONNECT(this, SIGNAL(afficheMessageLoco(int,QString)),mainwindow,SLOT(afficherMessageLoco(int,QString)));
+}
+
+void BackendSimulateur::selection_maquette(const QString &maquette)
+{
+    emit selectMaquette(maquette);
+    mainwindow->semWaitMaquette.acquire();
+    mainwindow->maquetteFinie.acquire();
+}
+
+void BackendSimulateur::ajouter_loco(int no_loco)
+{
+    emit addLoco(no_loco);
+}
+
+void BackendSimulateur::diriger_aiguillage(int no_aiguillage, int direction, int politique)
+{
+    emit setVoieVariable(no_aiguillage, direction, politique);
+}
+
+void BackendSimulateur::attendre_contact(int no_contact)
+{
+    Contact *c=simView->getContact(no_contact);
+    if (c == nullptr)
+    {
+        MainWindow::signalerErreur(nullptr,"Error",QString("Attention, le numéro de contact %1 n'est pas valide").arg(no_contact));
+    }
+    else
+        c->attendContact();
+}
+
+void BackendSimulateur::mettre_vitesse_loco(int no_loco, int vitesse)
+{
+    emit setVitesseLoco(no_loco, vitesse);
+}
+
+void BackendSimulateur::mettre_vitesse_progressive(int no_loco, int vitesse_future)
+{
+    emit setVitesseProgressiveLoco(no_loco, vitesse_future);
+}
+
+void BackendSimulateur::inverser_sens_loco(int no_loco)
+{
+    emit reverseLoco(no_loco);
+}
+
+void BackendSimulateur::demander_loco(int contact_a, int contact_b)
+{
+    emit askLoco(contact_a, contact_b); //a refaire... pas adapte!
+}
+
+void BackendSimulateur::assigner_loco(int contact_a,int contact_b,int no_loco,int vitesse)
+{
+    emit addLoco(no_loco);
+    emit setLoco(contact_a, contact_b, no_loco, vitesse);
+}
+
+int BackendSimulateur::lire_position_loco(int no_loco, int *contact_prec, int *contact_suiv, double *distance)
+{
+    PositionLoco p;
+
+    if (!simView->getInstantaneMonde()->lire(no_loco, p))
+        return 0;
+
+    if (contact_prec != nullptr)
+        *contact_prec = p.contactPrecedent;
+    if (contact_suiv != nullptr)
+        *contact_suiv = p.contactSuivant;
+    if (distance != nullptr)
+        *distance = p.distance;
+    return 1;
+}
+
+int BackendSimulateur::lire_vitesse_reelle(int no_loco)
+{
+    PositionLoco p;
+
+    if (!simView->getInstantaneMonde()->lire(no_loco, p))
+        return VITESSE_NULLE;
+    return p.vitesse;
+}
+
+int BackendSimulateur::creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance, bool depuisPrecedent)
+{
+    return simView->ajouterDeclencheur(no_loco, contact_prec, contact_suiv, distance, depuisPrecedent);
+}
+
+void BackendSimulateur::attendre_declencheur(int no_declencheur)
+{
+    QSharedPointer<DeclencheurVirtuel> d = simView->getDeclencheur(no_declencheur);
+    if (d.isNull())
+    {
+        MainWindow::signalerErreur(nullptr,"Error",QString("Attention, le numéro de déclencheur %1 n'est pas valide").arg(no_declencheur));
+    }
+    else
+        d->attendDeclenchement();
+}
+
+void BackendSimulateur::supprimer_declencheur(int no_declencheur)
+{
+    simView->supprimerDeclencheur(no_declencheur);
+}
+
+double BackendSimulateur::longueur_segment(int contact_a, int contact_b)
+{
+    return simView->longueurSegment(contact_a, contact_b);
+}
+
+double BackendSimulateur::distance_contacts(int contact_a, int contact_b)
+{
+    return simView->getTableDistances()->lireMin(contact_a, contact_b);
+}
+
+double BackendSimulateur::eta_contact(int no_loco, int contact)
+{
+    PositionLoco p;
+
+    if (!simView->getInstantaneMonde()->lire(no_loco, p))
+        return -1.0;
+    if (p.vitesse == VITESSE_NULLE || p.contactSuivant == 0)
+        return -1.0;
+
+    double distance = p.distance;
+    if (contact != p.contactSuivant)
+    {
+        double reste = simView->getTableDistances()->lire(p.sortie, p.contactSuivant, contact);
+        if (reste < 0.0)
+            return -1.0;
+        distance += reste;
+    }
+
+    // Une loco parcourt vitesse * FACTEUR_VITESSE mm par milliseconde
+    return distance / (p.vitesse * 1000.0 * FACTEUR_VITESSE);
+}
+
+void BackendSimulateur::afficher_message(const QString &message)
+{
+    emit afficheMessage(message);
+}
+
+void BackendSimulateur::afficher_message_loco(int no_loco, const QString &message)
+{
+    emit afficheMessageLoco(no_loco, message);
+}
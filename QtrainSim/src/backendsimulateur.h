@@ -0,0 +1,78 @@
+#ifndef BACKENDSIMULATEUR_H
+#define BACKENDSIMULATEUR_H
+
+#include <QObject>
+
+#include "backendtrain.h"
+
+class MainWindow;
+class SimView;
+
+/**
+ * Backend par défaut : les commandes sont transmises au simulateur, sous forme
+ * de signaux traités dans le thread de l'interface.
+ */
+class BackendSimulateur : public QObject, public BackendTrain
+{
+    Q_OBJECT
+public:
+    BackendSimulateur();
+
+    /**
+     * Fait tourner le simulateur sans afficher sa fenêtre. La simulation démarre
+     * d'elle-même, et l'application se termine avec le programme client, ou dès
+     * que la simulation s'arrête (collision, durée maximale du bilan atteinte).
+     * A appeler avant init_maquette.
+     * \param sansFenetre vrai pour ne pas afficher la fenêtre.
+     */
+    void setSansFenetre(bool sansFenetre);
+
+    /**
+     * Retourne faux si la fenêtre n'est pas affichée.
+     */
+    bool interactif() const override;
+
+    /**
+     * Ouvre la fenêtre du simulateur et y connecte les signaux de commande.
+     */
+    void init_maquette() override;
+
+    void selection_maquette(const QString &maquette) override;
+    void ajouter_loco(int no_loco) override;
+    void diriger_aiguillage(int no_aiguillage, int direction, int politique) override;
+    void attendre_contact(int no_contact) override;
+    void mettre_vitesse_loco(int no_loco, int vitesse) override;
+    void mettre_vitesse_progressive(int no_loco, int vitesse_future) override;
+    void inverser_sens_loco(int no_loco) override;
+    void demander_loco(int contact_a, int contact_b) override;
+    void assigner_loco(int contact_a, int contact_b, int no_loco, int vitesse) override;
+    int lire_position_loco(int no_loco, int *contact_prec, int *contact_suiv, double *distance) override;
+    int lire_vitesse_reelle(int no_loco) override;
+    int creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance, bool depuisPrecedent) override;
+    void attendre_declencheur(int no_declencheur) override;
+    void supprimer_declencheur(int no_declencheur) override;
+    double longueur_segment(int contact_a, int contact_b) override;
+    double distance_contacts(int contact_a, int contact_b) override;
+    double eta_contact(int no_loco, int contact) override;
+    void afficher_message(const QString &message) override;
+    void afficher_message_loco(int no_loco, const QString &message) override;
+
+signals:
+    void addLoco(int no_loco);
+    void setLoco(int contactA, int contactB, int numLoco, int vitesseLoco);
+    void askLoco(int contactA, int contactB);
+    void setVitesseLoco(int numLoco, int vitesseLoco);
+    void reverseLoco(int numLoco);
+    void setVitesseProgressiveLoco(int numLoco, int vitesseLoco);
+    void stopLoco(int numLoco);
+    void setVoieVariable(int numVoieVariable, int direction, int politique);
+    void selectMaquette(QString maquette);
+    void afficheMessage(QString message);
+    void afficheMessageLoco(int numLoco,QString message);
+
+private:
+    MainWindow *mainwindow;
+    SimView *simView;
+};
+
+#endif // BACKENDSIMULATEUR_H
@@ -0,0 +1,188 @@
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+#include <cstring>
+
+#include "backendtrace.h"
+#include "tracecommandes.h"
+
+
+BackendTrace::BackendTrace(double cadence) :
+    cadence(cadence), lecteur(this), arret(false)
+{
+}
+
+BackendTrace::~BackendTrace()
+{
+    // Les threads qui attendent un contact, même absent de la trace, sont libérés
+    arret.store(true);
+    mutex.lock();
+    for(const std::unique_ptr<QWaitCondition> &activation : activations)
+        activation->wakeAll();
+    mutex.unlock();
+    lecteur.wait();
+}
+
+bool BackendTrace::charger(const QString &fichier)
+{
+    QFile f(fichier);
+    if(!f.open(QIODevice::ReadOnly))
+        return false;
+
+    int contactMax = 0;
+
+    // Trace enregistrée par le simulateur : seules les activations de contacts sont rejouées
+    TraceCommandes::EnTete entete;
+    bool enregistree = f.peek(reinterpret_cast<char*>(&entete), sizeof(entete)) == sizeof(entete) &&
+                       std::memcmp(entete.signature, TraceCommandes::SIGNATURE, sizeof(entete.signature)) == 0;
+
+    if(enregistree)
+    {
+        if(entete.version != TraceCommandes::VERSION || entete.boutisme != TraceCommandes::BOUTISME)
+            return false;
+
+        f.seek(sizeof(entete));
+        TraceCommandes::Evenement e;
+        while(f.read(reinterpret_cast<char*>(&e), sizeof(e)) == sizeof(e))
+        {
+            if(e.type == TraceCommandes::CONTACT && e.a > 0)
+            {
+                evenements.append(e.a);
+                contactMax = qMax(contactMax, int(e.a));
+            }
+        }
+    }
+
+    QTextStream flux(&f);
+
+    while(!enregistree && !flux.atEnd())
+    {
+        QString ligne = flux.readLine().trimmed();
+        if(ligne.isEmpty() || ligne.startsWith('#'))
+            continue;
+
+        bool ok;
+        int contact = ligne.simplified().section(' ', 0, 0).toInt(&ok);
+        if(!ok || contact <= 0)
+        {
+            qDebug() << "Trace" << fichier << ": ligne ignorée :" << ligne;
+            continue;
+        }
+
+        evenements.append(contact);
+        contactMax = qMax(contactMax, contact);
+    }
+
+    generations.fill(0, contactMax + 1);
+    activations.clear();
+    for(int i = 0; i <= contactMax; i++)
+        activations.emplace_back(new QWaitCondition());
+
+    return !evenements.isEmpty();
+}
+
+void BackendTrace::init_maquette()
+{
+    lecteur.start();
+}
+
+void BackendTrace::attendre_contact(int no_contact)
+{
+    BackendNul::attendre_contact(no_contact);
+
+    QMutexLocker locker(&mutex);
+    attendreActivation(no_contact, 0);
+}
+
+int BackendTrace::creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance, bool depuisPrecedent)
+{
+    int no_declencheur = BackendNul::creer_declencheur(no_loco, contact_prec, contact_suiv, distance, depuisPrecedent);
+
+    QMutexLocker locker(&mutex);
+    contactsDeclencheurs.insert(no_declencheur, contact_suiv);
+    return no_declencheur;
+}
+
+void BackendTrace::attendre_declencheur(int no_declencheur)
+{
+    BackendNul::attendre_declencheur(no_declencheur);
+
+    QMutexLocker locker(&mutex);
+    if(!contactsDeclencheurs.contains(no_declencheur))
+    {
+        qDebug() << "Le déclencheur" << no_declencheur << "n'existe pas";
+        return;
+    }
+    attendreActivation(contactsDeclencheurs.value(no_declencheur), no_declencheur);
+}
+
+void BackendTrace::supprimer_declencheur(int no_declencheur)
+{
+    BackendNul::supprimer_declencheur(no_declencheur);
+
+    QMutexLocker locker(&mutex);
+    if(!contactsDeclencheurs.contains(no_declencheur))
+        return;
+
+    int contact = contactsDeclencheurs.take(no_declencheur);
+    declencheursSupprimes.insert(no_declencheur);
+    activations[contact > 0 && contact < generations.size() ? contact : 0]->wakeAll();
+}
+
+void BackendTrace::attendreActivation(int no_contact, int no_declencheur)
+{
+    if(no_contact <= 0 || no_contact >= generations.size())
+    {
+        qDebug() << "Le contact" << no_contact << "n'apparaît pas dans la trace, il ne sera jamais activé";
+        while(!arret.load() && !declencheursSupprimes.contains(no_declencheur))
+            activations[0]->wait(&mutex);
+        return;
+    }
+
+    quint64 generation = generations.at(no_contact);
+    while(generations.at(no_contact) == generation && !arret.load() && !declencheursSupprimes.contains(no_declencheur))
+        activations[no_contact]->wait(&mutex);
+}
+
+void BackendTrace::activer(int no_contact)
+{
+    mutex.lock();
+    generations[no_contact]++;
+    mutex.unlock();
+    activations[no_contact]->wakeAll();
+}
+
+void BackendTrace::Lecteur::run()
+{
+    QElapsedTimer chrono;
+    chrono.start();
+    quint64 rejoues = 0;
+
+    while(!backend->arret.load())
+    {
+        foreach(int contact, backend->evenements)
+        {
+            if(backend->arret.load())
+                break;
+
+            if(backend->cadence > 0.0)
+            {
+                qint64 echeance = qint64(rejoues * 1e9 / backend->cadence);
+                qint64 reste;
+                while((reste = echeance - chrono.nsecsElapsed()) > 0)
+                {
+                    // Au-delà d'une milliseconde, on dort ; en deçà, on cède la main
+                    if(reste > 1000000)
+                        QThread::usleep(reste / 1000 - 500);
+                    else
+                        QThread::yieldCurrentThread();
+                }
+            }
+
+            backend->activer(contact);
+            rejoues++;
+        }
+    }
+}
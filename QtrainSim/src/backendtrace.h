@@ -0,0 +1,101 @@
+#ifndef BACKENDTRACE_H
+#define BACKENDTRACE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "backendnul.h"
+
+/**
+ * Backend rejouant des activations de contacts depuis un fichier, à une cadence
+ * choisie, sans simulateur. Les autres commandes se comportent comme celles du
+ * backend nul.
+ *
+ * Le fichier est un texte dont chaque ligne non vide donne, en premier champ, le
+ * numéro du contact activé ; les champs suivants et les lignes commençant par '#'
+ * sont ignorés. Une trace enregistrée par le simulateur (.qtt) est aussi acceptée,
+ * seules ses activations de contacts sont alors rejouées. La trace est rejouée en
+ * boucle tant que l'application tourne.
+ * Comme sur la maquette, une activation n'est vue que par les threads qui
+ * attendent déjà le contact.
+ * La trace ne donne pas la position des locos entre deux contacts : un déclencheur
+ * virtuel est considéré comme franchi à l'activation du contact qui termine son segment.
+ */
+class BackendTrace : public BackendNul
+{
+public:
+    /** Constructeur de classe.
+      * \param cadence le nombre d'activations par seconde, 0 pour rejouer au plus vite.
+      */
+    explicit BackendTrace(double cadence);
+    ~BackendTrace();
+
+    /** lit la trace à rejouer.
+      * \param fichier le fichier de la trace.
+      * \return vrai si la trace a été lue et contient au moins une activation.
+      */
+    bool charger(const QString &fichier);
+
+    /**
+     * Démarre le rejeu de la trace.
+     */
+    void init_maquette() override;
+
+    /**
+     * Attend que le rejeu active le contact.
+     */
+    void attendre_contact(int no_contact) override;
+
+    int creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance, bool depuisPrecedent) override;
+
+    /**
+     * Attend que le rejeu active le contact qui termine le segment du déclencheur,
+     * ou que le déclencheur soit supprimé.
+     */
+    void attendre_declencheur(int no_declencheur) override;
+    void supprimer_declencheur(int no_declencheur) override;
+
+private:
+    class Lecteur : public QThread
+    {
+    public:
+        explicit Lecteur(BackendTrace *backend) : backend(backend) {}
+    protected:
+        void run() override;
+    private:
+        BackendTrace *backend;
+    };
+
+    /** active un contact : réveille les threads qui l'attendent.
+      * \param no_contact le numéro du contact.
+      */
+    void activer(int no_contact);
+
+    /** attend la prochaine activation d'un contact, jusqu'à l'arrêt du rejeu. Le mutex
+      * doit être verrouillé.
+      * \param no_contact le numéro du contact.
+      * \param no_declencheur le déclencheur attendu, dont la suppression termine
+      *        l'attente, 0 pour une attente de contact.
+      */
+    void attendreActivation(int no_contact, int no_declencheur);
+
+    double cadence;
+    QVector<int> evenements;
+    Lecteur lecteur;
+    std::atomic<bool> arret;
+    QMutex mutex;
+    QVector<quint64> generations;
+    std::vector<std::unique_ptr<QWaitCondition> > activations;
+    QHash<int, int> contactsDeclencheurs;       //!> Contact terminant le segment de chaque déclencheur
+    QSet<int> declencheursSupprimes;
+};
+
+#endif // BACKENDTRACE_H
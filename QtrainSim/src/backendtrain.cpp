@@ -0,0 +1,39 @@
+#include "backendtrain.h"
+#include "backendnul.h"
+#include "backendrejeu.h"
+#include "backendsimulateur.h"
+#include "backendtrace.h"
+
+
+BackendTrain *BackendTrain::creer(const QString &nom, const QString &trace, double cadence)
+{
+    if (nom == "simulateur")
+        return new BackendSimulateur();
+
+    if (nom == "nul")
+        return new BackendNul();
+
+    if (nom == "trace")
+    {
+        BackendTrace *backend = new BackendTrace(cadence);
+        if (!backend->charger(trace))
+        {
+            delete backend;
+            return nullptr;
+        }
+        return backend;
+    }
+
+    if (nom == "rejeu")
+    {
+        BackendRejeu *backend = new BackendRejeu();
+        if (!backend->charger(trace))
+        {
+            delete backend;
+            return nullptr;
+        }
+        return backend;
+    }
+
+    return nullptr;
+}
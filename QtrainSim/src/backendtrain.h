@@ -0,0 +1,90 @@
+#ifndef BACKENDTRAIN_H
+#define BACKENDTRAIN_H
+
+#include <QString>
+
+/**
+ * Exécute les commandes du programme client. CommandeTrain délègue chacune de ses
+ * méthodes au backend installé, ce qui permet de faire tourner le programme client
+ * sans le simulateur :
+ * - BackendSimulateur : le simulateur et sa fenêtre (par défaut) ;
+ * - BackendNul : chaque commande retourne immédiatement, les contacts sont
+ *   considérés comme activés dès qu'on les attend ;
+ * - BackendTrace : les activations de contacts sont rejouées depuis un fichier,
+ *   à une cadence choisie ;
+ * - BackendRejeu : une trace enregistrée dans le simulateur est rejouée le plus vite
+ *   possible, et les commandes émises sont comparées à celles de la trace.
+ * Les méthodes ont la sémantique de leurs homonymes de CommandeTrain. Toutes,
+ * sauf init_maquette, doivent être réentrantes.
+ */
+class BackendTrain
+{
+public:
+    virtual ~BackendTrain() {}
+
+    /**
+     * Construit un backend d'après son nom.
+     * \param nom      "simulateur", "nul", "trace" ou "rejeu".
+     * \param trace    Fichier de la trace à rejouer (backends "trace" et "rejeu").
+     * \param cadence  Activations de contacts par seconde, 0 pour rejouer au plus vite (backend "trace").
+     * \return le backend, nullptr si le nom n'est pas connu ou la trace illisible.
+     */
+    static BackendTrain *creer(const QString &nom, const QString &trace = QString(), double cadence = 0.0);
+
+    /**
+     * Indique si le backend affiche le simulateur. Sinon, l'application se termine
+     * avec le programme client.
+     */
+    virtual bool interactif() const = 0;
+
+    /**
+     * Prépare le backend, avant le lancement du programme client. Appelée depuis
+     * le thread principal.
+     */
+    virtual void init_maquette() = 0;
+
+    virtual void selection_maquette(const QString &maquette) = 0;
+
+    virtual void ajouter_loco(int no_loco) = 0;
+
+    /**
+     * Change la direction d'un aiguillage.
+     * \param politique le sort de la commande si l'aiguillage est occupé
+     *        (ENCLENCHEMENT_APPLIQUER, ENCLENCHEMENT_REFUSER ou ENCLENCHEMENT_DIFFERER).
+     */
+    virtual void diriger_aiguillage(int no_aiguillage, int direction, int politique) = 0;
+
+    virtual void attendre_contact(int no_contact) = 0;
+
+    virtual void mettre_vitesse_loco(int no_loco, int vitesse) = 0;
+
+    virtual void mettre_vitesse_progressive(int no_loco, int vitesse_future) = 0;
+
+    virtual void inverser_sens_loco(int no_loco) = 0;
+
+    virtual void demander_loco(int contact_a, int contact_b) = 0;
+
+    virtual void assigner_loco(int contact_a, int contact_b, int no_loco, int vitesse) = 0;
+
+    virtual int lire_position_loco(int no_loco, int *contact_prec, int *contact_suiv, double *distance) = 0;
+
+    virtual int lire_vitesse_reelle(int no_loco) = 0;
+
+    virtual int creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance, bool depuisPrecedent) = 0;
+
+    virtual void attendre_declencheur(int no_declencheur) = 0;
+
+    virtual void supprimer_declencheur(int no_declencheur) = 0;
+
+    virtual double longueur_segment(int contact_a, int contact_b) = 0;
+
+    virtual double distance_contacts(int contact_a, int contact_b) = 0;
+
+    virtual double eta_contact(int no_loco, int contact) = 0;
+
+    virtual void afficher_message(const QString &message) = 0;
+
+    virtual void afficher_message_loco(int no_loco, const QString &message) = 0;
+};
+
+#endif // BACKENDTRAIN_H
@@ -0,0 +1,145 @@
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+#include "bilansimulation.h"
+#include "general.h"
+
+
+BilanSimulation::BilanSimulation() :
+    nbrePas(0), pasMax(0), nbreCollisions(0), nbreDeraillements(0),
+    nbreAiguillagesRefuses(0), nbreAiguillagesDifferes(0), nbreFreinagesAutomatiques(0)
+{
+}
+
+void BilanSimulation::setDureeMax(double secondes)
+{
+    pasMax = qint64(secondes * FRAME_RATE);
+}
+
+void BilanSimulation::avancer()
+{
+    nbrePas++;
+}
+
+double BilanSimulation::getTempsSimule() const
+{
+    return double(nbrePas.load()) / FRAME_RATE;
+}
+
+bool BilanSimulation::echeanceAtteinte() const
+{
+    return pasMax > 0 && nbrePas.load() >= pasMax;
+}
+
+void BilanSimulation::collision(int no_loco_a, int no_loco_b)
+{
+    QMutexLocker locker(&mutex);
+    nbreCollisions++;
+    locos[no_loco_a];
+    locos[no_loco_b];
+}
+
+void BilanSimulation::deraillement(int no_loco)
+{
+    QMutexLocker locker(&mutex);
+    nbreDeraillements++;
+    locos[no_loco];
+}
+
+void BilanSimulation::aiguillageRefuse()
+{
+    QMutexLocker locker(&mutex);
+    nbreAiguillagesRefuses++;
+}
+
+void BilanSimulation::aiguillageDiffere()
+{
+    QMutexLocker locker(&mutex);
+    nbreAiguillagesDifferes++;
+}
+
+void BilanSimulation::freinageAutomatique(int no_loco)
+{
+    QMutexLocker locker(&mutex);
+    nbreFreinagesAutomatiques++;
+    locos[no_loco];
+}
+
+void BilanSimulation::tourTermine(int no_loco)
+{
+    QMutexLocker locker(&mutex);
+    locos[no_loco].tours++;
+}
+
+void BilanSimulation::debutAttente(int no_loco)
+{
+    QMutexLocker locker(&mutex);
+    locos[no_loco].debutAttente = nbrePas.load();
+}
+
+void BilanSimulation::finAttente(int no_loco)
+{
+    QMutexLocker locker(&mutex);
+    BilanLoco &loco = locos[no_loco];
+    if (loco.debutAttente < 0)
+        return;
+    loco.attentes.append(nbrePas.load() - loco.debutAttente);
+    loco.debutAttente = -1;
+}
+
+int BilanSimulation::getNbreCollisions() const
+{
+    QMutexLocker locker(&mutex);
+    return nbreCollisions;
+}
+
+int BilanSimulation::getNbreDeraillements() const
+{
+    QMutexLocker locker(&mutex);
+    return nbreDeraillements;
+}
+
+bool BilanSimulation::ecrire(const QString &fichier, const QJsonObject &entete) const
+{
+    QMutexLocker locker(&mutex);
+
+    QJsonObject bilan = entete;
+    bilan["version"] = VERSION;
+    bilan["duree_simulee"] = getTempsSimule();
+
+    // Raison de la fin de la simulation : la première collision l'arrête
+    if (nbreCollisions > 0)
+        bilan["fin"] = "collision";
+    else if (echeanceAtteinte())
+        bilan["fin"] = "duree";
+    else
+        bilan["fin"] = "client";
+
+    bilan["collisions"] = nbreCollisions;
+    bilan["deraillements"] = nbreDeraillements;
+    bilan["aiguillagesRefuses"] = nbreAiguillagesRefuses;
+    bilan["aiguillagesDifferes"] = nbreAiguillagesDifferes;
+    bilan["freinagesAutomatiques"] = nbreFreinagesAutomatiques;
+
+    QJsonArray listeLocos;
+    for (QMap<int, BilanLoco>::const_iterator it = locos.constBegin(); it != locos.constEnd(); ++it)
+    {
+        QJsonArray attentes;
+        foreach (qint64 pas, it->attentes)
+            attentes.append(double(pas) / FRAME_RATE);
+
+        QJsonObject loco;
+        loco["numero"] = it.key();
+        loco["tours"] = it->tours;
+        loco["attentes"] = attentes;
+        listeLocos.append(loco);
+    }
+    bilan["locos"] = listeLocos;
+
+    QFile f(fichier);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    f.write(QJsonDocument(bilan).toJson());
+    return true;
+}
@@ -0,0 +1,115 @@
+#ifndef BILANSIMULATION_H
+#define BILANSIMULATION_H
+
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+
+#include <atomic>
+
+/**
+ * Bilan d'une simulation : durée simulée, collisions, déraillements, commandes
+ * d'aiguillage refusées ou différées par l'enclenchement, freinages automatiques,
+ * et pour chaque
+ * loco le nombre de tours effectués et les attentes de la section partagée.
+ *
+ * Le temps est compté en pas d'animation (voir FRAME_RATE), et non en temps réel :
+ * le bilan d'une simulation accélérée est comparable à celui d'une simulation à
+ * vitesse normale. Les collisions et les déraillements sont relevés par la
+ * simulation, les tours et les attentes sont signalés par le programme client.
+ * Peut être appelé depuis n'importe quel thread.
+ */
+class BilanSimulation
+{
+public:
+    //! Version du format du fichier de bilan
+    static const int VERSION = 1;
+
+    BilanSimulation();
+
+    /** fixe la durée simulée au bout de laquelle la simulation est terminée.
+      * \param secondes la durée, 0 pour ne pas limiter la simulation.
+      */
+    void setDureeMax(double secondes);
+
+    /** compte un pas d'animation. Appelée par la simulation.
+      */
+    void avancer();
+
+    /** retourne le temps simulé depuis le début de la simulation, en secondes.
+      */
+    double getTempsSimule() const;
+
+    /** indique si la durée maximale de la simulation est atteinte.
+      */
+    bool echeanceAtteinte() const;
+
+    /** compte une collision entre deux locos.
+      */
+    void collision(int no_loco_a, int no_loco_b);
+
+    /** compte le déraillement d'une loco.
+      */
+    void deraillement(int no_loco);
+
+    /** compte une commande d'aiguillage refusée, ou différée, parce que l'aiguillage
+      * était occupé (voir SimView::setVoieVariable).
+      */
+    void aiguillageRefuse();
+    void aiguillageDiffere();
+
+    /** compte un freinage automatique d'une loco trop proche de la loco qui la précède.
+      */
+    void freinageAutomatique(int no_loco);
+
+    /** compte un tour effectué par une loco.
+      */
+    void tourTermine(int no_loco);
+
+    /** note le début de l'attente de la section partagée par une loco.
+      */
+    void debutAttente(int no_loco);
+
+    /** note la fin de l'attente de la section partagée par une loco, et en
+      * retient la durée. Sans effet si l'attente n'a pas commencé.
+      */
+    void finAttente(int no_loco);
+
+    /** retourne le nombre de collisions.
+      */
+    int getNbreCollisions() const;
+
+    /** retourne le nombre de déraillements.
+      */
+    int getNbreDeraillements() const;
+
+    /** écrit le bilan au format JSON.
+      * \param fichier le fichier à créer.
+      * \param entete les paramètres de la simulation (scénario, graine, ...), repris
+      *        tels quels dans le bilan.
+      * \return vrai si le fichier a pu être écrit.
+      */
+    bool ecrire(const QString &fichier, const QJsonObject &entete) const;
+
+private:
+    struct BilanLoco
+    {
+        int tours = 0;                  //!> Tours effectués
+        qint64 debutAttente = -1;       //!> Pas du début de l'attente en cours, -1 sinon
+        QVector<qint64> attentes;       //!> Durées des attentes terminées, en pas
+    };
+
+    mutable QMutex mutex;
+    std::atomic<qint64> nbrePas;
+    qint64 pasMax;
+    int nbreCollisions;
+    int nbreDeraillements;
+    int nbreAiguillagesRefuses;
+    int nbreAiguillagesDifferes;
+    int nbreFreinagesAutomatiques;
+    QMap<int, BilanLoco> locos;
+};
+
+#endif // BILANSIMULATION_H
@@ -0,0 +1,757 @@
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QVector>
+#include <cstring>
+#ifdef USING_QT5
+#include <QRegExp>
+#else
+#include <QRegularExpression>
+#endif
+
+#include "chargeurmaquette.h"
+#include "maquettecompilee.h"
+#include "voieaiguillage.h"
+#include "voieaiguillageenroule.h"
+#include "voieaiguillagetriple.h"
+#include "voiebuttoir.h"
+#include "voiecourbe.h"
+#include "voiecroisement.h"
+#include "voiedroite.h"
+#include "voietraverseejonction.h"
+
+ChargeurMaquette::ChargeurMaquette()
+{
+    QString cache = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if(!cache.isEmpty())
+        repertoireCache = cache + "/maquettes";
+}
+
+ChargeurMaquette::~ChargeurMaquette()
+{
+    qDeleteAll(infosVoies);
+}
+
+bool ChargeurMaquette::chargerInfosVoies(const QString &nomFichier)
+{
+    QFile fichierInfosVoies(nomFichier);
+    if (!fichierInfosVoies.open(QIODevice::ReadOnly))
+        return false;
+
+    this->nomFichierInfosVoies = nomFichier;
+
+    QTextStream lecture(&fichierInfosVoies);
+
+    QString ligne;
+
+    QStringList ligneDecoupee;
+
+    QList<double>* description;
+
+    ligne = lecture.readLine();
+
+    while(!ligne.startsWith("EOF"))
+    {
+#ifdef USING_QT5
+        ligneDecoupee = ligne.split(QRegExp("\\s+"), Qt::SkipEmptyParts);
+#else
+        ligneDecoupee = ligne.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
+#endif
+        description = new QList<double>();
+
+        /* En l'etat, le programme gere 6 types de voies differentes :
+         * - droite : caracterisees par leur longueur.
+         * - courbe : caracterisees par leur rayon de courbure, et l'angle parcouru.
+         * - aiguillage : caracterisees par leur rayon de courbure et l'angle parcouru (pour la partie courbe)
+         *                et par leur longueur (pour la partie droite).
+         * - croisement : caracterisees par leur longueur (pour les deux parties droites) et l'angle aigu entre les deux parties droites.
+         *                Les parties droites se croisent toujours en leur milieu.
+         * - traversee-jonction : caracterisees par leur longueur (pour les deux parties droites, le rayon de courbure des parties courbes,
+         *                        et l'angle parcouru.
+         * - buttoir : caracterisees par leur longueur (utile uniquement pour le dessin.
+         *
+         * Il est possible d'ajouter des types de voies. Referez-vous a la documentation.
+         */
+        if(ligneDecoupee.at(1) == "droite")
+            description->append(1.0);
+        else if(ligneDecoupee.at(1) == "courbe")
+            description->append(2.0);
+        else if(ligneDecoupee.at(1) == "aiguillage")
+            description->append(3.0);
+        else if(ligneDecoupee.at(1) == "croisement")
+            description->append(4.0);
+        else if(ligneDecoupee.at(1) == "traversee-jonction")
+            description->append(5.0);
+        else if(ligneDecoupee.at(1) == "buttoir")
+            description->append(6.0);
+        else if(ligneDecoupee.at(1) == "aiguillageEnroule")
+            description->append(7.0);
+        else if(ligneDecoupee.at(1) == "aiguillageTriple")
+            description->append(8.0);
+
+
+        for(int i =2; i < ligneDecoupee.length(); i++)
+        {
+            description->append(ligneDecoupee.at(i).toDouble());
+        }
+
+        //chargement des informations des voies dans la QMap idoine.
+        infosVoies.insert(ligneDecoupee.at(0).toInt(), description);
+
+        ligne = lecture.readLine();
+
+    }
+
+    return true;
+}
+
+bool ChargeurMaquette::chargerMaquette(const QString &filename, SimView *simView)
+{
+    // stockage temporaire des voies, avec les identifiants des voies a lier.
+    QMap <Voie*, QList<int>*> voiesALier;
+    // stockage temporaire des voies, indexees par identifiants.
+    QMap <int, Voie*> IDVoies;
+
+    QStringList listeTemporaire;
+    QList<qreal>* infosVoieEnTraitement;
+    int IDvoie;
+    qreal directionVoieEnTraitement;
+
+    descriptions.clear();
+
+    QFile fichier(filename);
+
+    if(!fichier.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    QTextStream lecture(&fichier);
+    QString ligne;
+    bool premiereInfoValide;
+    int limite;
+
+    //avance rapide pour passer une eventuelle introduction.
+
+    ligne = lecture.readLine();
+
+    listeTemporaire = ligne.split(" ", Qt::SkipEmptyParts);
+
+    limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
+
+    while((listeTemporaire.length() != 1) && !premiereInfoValide)
+    {
+        if(lecture.atEnd())
+            qDebug() << "Erreur de lecture de fichier : fichier non standard. (nombre de voies mal indique)";
+        ligne = lecture.readLine();
+
+        listeTemporaire = ligne.split(" ", Qt::SkipEmptyParts);
+
+        limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
+
+    }
+
+    // lecture des informations relatives aux voies, creation des voies.
+
+    VoieDroite* vd;
+    VoieCourbe* vc;
+    VoieAiguillage* va;
+    VoieAiguillageEnroule* vae;
+    VoieAiguillageTriple* vat;
+    VoieCroisement* vcr;
+    VoieTraverseeJonction* vt;
+    VoieButtoir* vb;
+
+    for(int i =0; i < limite; i++)
+    {
+        ligne = lecture.readLine();
+
+        listeTemporaire = ligne.split(" ", Qt::SkipEmptyParts);
+
+        IDvoie = listeTemporaire.at(0).toInt();
+        directionVoieEnTraitement = 0.0;
+
+        //recuperation des infos de la voie en traitement.
+        infosVoieEnTraitement = infosVoies.value(listeTemporaire.at(1).toInt(), nullptr);
+        if(infosVoieEnTraitement == nullptr)
+        {
+            qDebug() << "Erreur de lecture de fichier : type de voie inconnu" << listeTemporaire.at(1);
+            qDeleteAll(voiesALier);
+            return false;
+        }
+
+        if(infosVoieEnTraitement->at(0) == 1.0)//voie Droite
+        {
+            //Creation et insertion de la voie dans les stockages temporaires.
+            vd = new VoieDroite(infosVoieEnTraitement->at(1));
+            vd->setIdVoie(IDvoie);
+            IDVoies.insert(IDvoie, vd);
+            voiesALier.insert(vd, new QList<int>());
+            voiesALier[vd]->append(listeTemporaire.at(2).toInt());
+            voiesALier[vd]->append(listeTemporaire.at(3).toInt());
+            simView->addVoie(vd, listeTemporaire.at(0).toInt());
+        }
+        else if(infosVoieEnTraitement->at(0) == 2.0)//voie Courbe
+        {
+            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
+            // NE CHANGER SOUS AUCUN PRETEXTE.
+            if(listeTemporaire.at(4).toLower() == "gauche")
+            {
+                directionVoieEnTraitement = 1.0;
+            }
+            else if(listeTemporaire.at(4).toLower() == "droite")
+            {
+                directionVoieEnTraitement = -1.0;
+            }
+            else //en cas d'erreur dans le fichier...
+                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction de courbe). ";
+
+            //Creation et insertion de la voie dans les stockages temporaires.
+            vc = new VoieCourbe(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), directionVoieEnTraitement);
+            vc->setIdVoie(IDvoie);
+            IDVoies.insert(IDvoie, vc);
+            voiesALier.insert(vc, new QList<int>());
+            voiesALier[vc]->append(listeTemporaire.at(2).toInt());
+            voiesALier[vc]->append(listeTemporaire.at(3).toInt());
+            simView->addVoie(vc, listeTemporaire.at(0).toInt());
+        }
+        else if(infosVoieEnTraitement->at(0) == 3.0)//voie Aiguillage
+        {
+            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
+            // NE CHANGER SOUS AUCUN PRETEXTE.
+            if(listeTemporaire.at(5).toLower() == "gauche")
+                directionVoieEnTraitement = 1.0;
+            else if(listeTemporaire.at(5).toLower() == "droite")
+                directionVoieEnTraitement = -1.0;
+            else
+                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction d'aiguillage). ";
+
+            //Creation et insertion de la voie dans les stockages temporaires.
+            va = new VoieAiguillage(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3), directionVoieEnTraitement);
+            va->setIdVoie(IDvoie);
+            IDVoies.insert(IDvoie, va);
+            voiesALier.insert(va, new QList<int>());
+            voiesALier[va]->append(listeTemporaire.at(2).toInt());
+            voiesALier[va]->append(listeTemporaire.at(3).toInt());
+            voiesALier[va]->append(listeTemporaire.at(4).toInt());
+            simView->addVoie(va, listeTemporaire.at(0).toInt());
+        }
+        else if(infosVoieEnTraitement->at(0) == 4.0)//voie Croisement
+        {
+            //Creation et insertion de la voie dans les stockages temporaires.
+            vcr = new VoieCroisement(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2));
+            vcr->setIdVoie(IDvoie);
+            IDVoies.insert(IDvoie, vcr);
+            voiesALier.insert(vcr, new QList<int>());
+            voiesALier[vcr]->append(listeTemporaire.at(2).toInt());
+            voiesALier[vcr]->append(listeTemporaire.at(3).toInt());
+            voiesALier[vcr]->append(listeTemporaire.at(4).toInt());
+            voiesALier[vcr]->append(listeTemporaire.at(5).toInt());
+            simView->addVoie(vcr, listeTemporaire.at(0).toInt());
+        }
+        else if(infosVoieEnTraitement->at(0) == 5.0)//voie Traversee-Jonction
+        {
+            //Creation et insertion de la voie dans les stockages temporaires.
+            vt= new VoieTraverseeJonction(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3));
+            vt->setIdVoie(IDvoie);
+            IDVoies.insert(IDvoie, vt);
+            voiesALier.insert(vt, new QList<int>());
+            voiesALier[vt]->append(listeTemporaire.at(2).toInt());
+            voiesALier[vt]->append(listeTemporaire.at(3).toInt());
+            voiesALier[vt]->append(listeTemporaire.at(4).toInt());
+            voiesALier[vt]->append(listeTemporaire.at(5).toInt());
+            simView->addVoie(vt, listeTemporaire.at(0).toInt());
+        }
+        else if(infosVoieEnTraitement->at(0) == 6.0)//voie Buttoir
+        {
+            //Creation et insertion de la voie dans les stockages temporaires.
+            vb = new VoieButtoir(infosVoieEnTraitement->at(1));
+            vb->setIdVoie(IDvoie);
+            IDVoies.insert(IDvoie, vb);
+            voiesALier.insert(vb, new QList<int>());
+            voiesALier[vb]->append(listeTemporaire.at(2).toInt());
+            simView->addVoie(vb, listeTemporaire.at(0).toInt());
+        }
+        else if(infosVoieEnTraitement->at(0) == 7.0)//voie Aiguillage Enroule
+        {
+            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
+            // NE CHANGER SOUS AUCUN PRETEXTE.
+            if(listeTemporaire.at(5).toLower() == "gauche")
+                directionVoieEnTraitement = 1.0;
+            else if(listeTemporaire.at(5).toLower() == "droite")
+                directionVoieEnTraitement = -1.0;
+            else
+                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction d'aiguillage). ";
+
+            //Creation et insertion de la voie dans les stockages temporaires.
+            vae = new VoieAiguillageEnroule(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3), directionVoieEnTraitement);
+            vae->setIdVoie(IDvoie);
+            IDVoies.insert(IDvoie, vae);
+            voiesALier.insert(vae, new QList<int>());
+            voiesALier[vae]->append(listeTemporaire.at(2).toInt());
+            voiesALier[vae]->append(listeTemporaire.at(4).toInt()); //ordre inversé, pour la cohérence du code...
+            voiesALier[vae]->append(listeTemporaire.at(3).toInt());
+            simView->addVoie(vae, listeTemporaire.at(0).toInt());
+        }
+        else if(infosVoieEnTraitement->at(0) == 8.0)//voie Aiguillage Triple
+        {
+            //Creation et insertion de la voie dans les stockages temporaires.
+            vat = new VoieAiguillageTriple(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3));
+            vat->setIdVoie(IDvoie);
+            IDVoies.insert(IDvoie, vat);
+            voiesALier.insert(vat, new QList<int>());
+            voiesALier[vat]->append(listeTemporaire.at(2).toInt());
+            voiesALier[vat]->append(listeTemporaire.at(3).toInt());
+            voiesALier[vat]->append(listeTemporaire.at(4).toInt());
+            voiesALier[vat]->append(listeTemporaire.at(5).toInt());
+            simView->addVoie(vat, listeTemporaire.at(0).toInt());
+        }
+
+        // Description conservée pour une éventuelle compilation de la maquette
+        DescriptionVoie description;
+        description.type = int(infosVoieEnTraitement->at(0));
+        for(int j = 0; j < 3; j++)
+            description.parametres[j] = j + 1 < infosVoieEnTraitement->length() ? infosVoieEnTraitement->at(j + 1) : 0.0;
+        description.parametres[3] = directionVoieEnTraitement;
+        descriptions.insert(IDvoie, description);
+    }
+    //finalisation de la creation des voies.
+
+    for(int i = 1; i <= IDVoies.size(); i++)
+    {
+        for(int j = 0; j < voiesALier[IDVoies[i]]->length(); j++)
+        {
+            IDVoies[i]->lier(IDVoies[voiesALier[IDVoies[i]]->at(j)], j);
+        }
+    }
+
+    //debut de la lecture des contacts.
+
+    limite = lecture.readLine().toInt();
+
+    Contact* c;
+
+    for(int i=0; i < limite;i++)
+    {
+        ligne = lecture.readLine();
+
+        listeTemporaire = ligne.split(" ", Qt::SkipEmptyParts);
+
+        //creation des contacts.
+        c = new Contact(listeTemporaire.at(0).toInt(), listeTemporaire.at(1).toInt());
+
+        IDVoies[listeTemporaire.at(1).toInt()]->setContact(c);
+        simView->addContact(c, listeTemporaire.at(0).toInt());
+    }
+
+    //debut de la lecture des aiguillages.
+
+    limite = lecture.readLine().toInt();
+
+    for(int i=0; i < limite;i++)
+    {
+        ligne = lecture.readLine();
+
+        listeTemporaire = ligne.split(" ", Qt::SkipEmptyParts);
+
+        VoieVariable *v=dynamic_cast<VoieVariable *>(IDVoies[listeTemporaire.at(1).toInt()]);
+
+        simView->addVoieVariable(v, listeTemporaire.at(0).toInt());
+
+        v->setNumVoieVariable(listeTemporaire.at(0).toInt());
+
+    }
+
+    //indication de la premiere voie a poser.
+
+    Voie * premiereVoie = IDVoies[lecture.readLine().toInt()];
+
+    simView->setPremiereVoie(premiereVoie);
+
+    // On détruit la map qui contient des pointeurs sur des QList
+    QMapIterator<Voie*, QList<int>*> it(voiesALier);
+    while (it.hasNext()) {
+        it.next();
+        delete it.value();
+    }
+
+    return true;
+}
+
+Voie* ChargeurMaquette::creerVoie(int type, const double description[])
+{
+    switch(type)
+    {
+    case 1:
+        return new VoieDroite(description[0]);
+    case 2:
+        return new VoieCourbe(description[0], description[1], int(description[3]));
+    case 3:
+        return new VoieAiguillage(description[0], description[1], description[2], description[3]);
+    case 4:
+        return new VoieCroisement(description[0], description[1]);
+    case 5:
+        return new VoieTraverseeJonction(description[0], description[1], description[2]);
+    case 6:
+        return new VoieButtoir(description[0]);
+    case 7:
+        return new VoieAiguillageEnroule(description[0], description[1], description[2], description[3]);
+    case 8:
+        return new VoieAiguillageTriple(description[0], description[1], description[2]);
+    default:
+        return nullptr;
+    }
+}
+
+quint64 ChargeurMaquette::calculerEmpreinte(const QString &fichierMaquette, const QString &fichierInfosVoies)
+{
+    // FNV-1a 64 bits sur le contenu des deux fichiers
+    quint64 empreinte = 14695981039346656037ULL;
+
+    foreach(QString nom, QStringList() << fichierMaquette << fichierInfosVoies)
+    {
+        QFile fichier(nom);
+        if(!fichier.open(QIODevice::ReadOnly))
+            return 0;
+
+        QByteArray contenu = fichier.readAll();
+        for(int i = 0; i < contenu.size(); i++)
+        {
+            empreinte ^= quint8(contenu.at(i));
+            empreinte *= 1099511628211ULL;
+        }
+    }
+
+    return empreinte;
+}
+
+bool ChargeurMaquette::compilerMaquette(const QString &fichierCompile, const QString &fichierSource, SimView *simView) const
+{
+    using namespace MaquetteCompilee;
+
+    const QMap<int, Voie*> &voies = simView->getVoies();
+    const QMap<int, Contact*> &contacts = simView->getContacts();
+    const QMap<int, VoieVariable*> &aiguillages = simView->getVoiesVariables();
+    const QList<Segment*> &segments = simView->getSegments();
+
+    if(simView->getPremiereVoie() == nullptr)
+        return false;
+
+    QVector<EnregistrementVoie> enregistrementsVoies;
+    enregistrementsVoies.reserve(voies.size());
+    for(QMap<int, Voie*>::const_iterator it = voies.constBegin(); it != voies.constEnd(); ++it)
+    {
+        if(!descriptions.contains(it.key()) || it.value()->getNbreLiaisons() > GeometrieVoie::MAX_LIAISONS)
+            return false;
+
+        EnregistrementVoie e;
+        std::memset(&e, 0, sizeof(e));
+        e.id = it.key();
+        e.type = descriptions.value(it.key()).type;
+        e.nbreLiaisons = it.value()->getNbreLiaisons();
+        for(int i = 0; i < e.nbreLiaisons; i++)
+            e.voisins[i] = it.value()->getVoieVoisineDOrdre(i)->getIdVoie();
+        std::memcpy(e.description, descriptions.value(it.key()).parametres, sizeof(e.description));
+        it.value()->sauverGeometrie(e.geometrie);
+        enregistrementsVoies.append(e);
+    }
+
+    QVector<EnregistrementContact> enregistrementsContacts;
+    for(QMap<int, Contact*>::const_iterator it = contacts.constBegin(); it != contacts.constEnd(); ++it)
+        enregistrementsContacts.append({it.key(), it.value()->getNumVoiePorteuse()});
+
+    QVector<EnregistrementAiguillage> enregistrementsAiguillages;
+    for(QMap<int, VoieVariable*>::const_iterator it = aiguillages.constBegin(); it != aiguillages.constEnd(); ++it)
+        enregistrementsAiguillages.append({it.key(), it.value()->getIdVoie()});
+
+    QVector<EnregistrementSegment> enregistrementsSegments;
+    QVector<qint32> voiesSegments;
+    foreach(Segment* s, segments)
+    {
+        EnregistrementSegment e;
+        e.contact1 = s->getContact1()->getNumContact();
+        e.contact2 = s->getContact2() != nullptr ? s->getContact2()->getNumContact() : 0;
+        e.premiereVoie = voiesSegments.size();
+        e.nbreVoies = s->getVoies().size();
+        foreach(Voie* v, s->getVoies())
+            voiesSegments.append(v->getIdVoie());
+        enregistrementsSegments.append(e);
+    }
+
+    // Chaque section commence sur un multiple de 8 octets
+    auto aligner = [](quint64 position) { return (position + 7) & ~quint64(7); };
+
+    EnTete enTete;
+    std::memset(&enTete, 0, sizeof(enTete));
+    std::memcpy(enTete.signature, SIGNATURE, sizeof(enTete.signature));
+    enTete.version = VERSION;
+    enTete.boutisme = BOUTISME;
+    enTete.empreinteSources = calculerEmpreinte(fichierSource, nomFichierInfosVoies);
+    enTete.premiereVoie = simView->getPremiereVoie()->getIdVoie();
+    enTete.nbreVoies = enregistrementsVoies.size();
+    enTete.nbreContacts = enregistrementsContacts.size();
+    enTete.nbreAiguillages = enregistrementsAiguillages.size();
+    enTete.nbreSegments = enregistrementsSegments.size();
+    enTete.nbreVoiesSegments = voiesSegments.size();
+    enTete.positionVoies = sizeof(EnTete);
+    enTete.positionContacts = aligner(enTete.positionVoies + enregistrementsVoies.size() * sizeof(EnregistrementVoie));
+    enTete.positionAiguillages = aligner(enTete.positionContacts + enregistrementsContacts.size() * sizeof(EnregistrementContact));
+    enTete.positionSegments = aligner(enTete.positionAiguillages + enregistrementsAiguillages.size() * sizeof(EnregistrementAiguillage));
+    enTete.positionVoiesSegments = aligner(enTete.positionSegments + enregistrementsSegments.size() * sizeof(EnregistrementSegment));
+    enTete.tailleFichier = aligner(enTete.positionVoiesSegments + voiesSegments.size() * sizeof(qint32));
+
+    QByteArray donnees(int(enTete.tailleFichier), '\0');
+    std::memcpy(donnees.data(), &enTete, sizeof(enTete));
+    std::memcpy(donnees.data() + enTete.positionVoies, enregistrementsVoies.constData(), enregistrementsVoies.size() * sizeof(EnregistrementVoie));
+    std::memcpy(donnees.data() + enTete.positionContacts, enregistrementsContacts.constData(), enregistrementsContacts.size() * sizeof(EnregistrementContact));
+    std::memcpy(donnees.data() + enTete.positionAiguillages, enregistrementsAiguillages.constData(), enregistrementsAiguillages.size() * sizeof(EnregistrementAiguillage));
+    std::memcpy(donnees.data() + enTete.positionSegments, enregistrementsSegments.constData(), enregistrementsSegments.size() * sizeof(EnregistrementSegment));
+    std::memcpy(donnees.data() + enTete.positionVoiesSegments, voiesSegments.constData(), voiesSegments.size() * sizeof(qint32));
+
+    // Le fichier n'est remplacé qu'une fois entièrement écrit
+    QSaveFile fichier(fichierCompile);
+    if(!fichier.open(QIODevice::WriteOnly))
+        return false;
+    if(fichier.write(donnees) != donnees.size())
+    {
+        fichier.cancelWriting();
+        return false;
+    }
+    return fichier.commit();
+}
+
+bool ChargeurMaquette::chargerMaquetteCompilee(const QString &fichierCompile, SimView *simView, quint64 empreinteAttendue)
+{
+    QFile fichier(fichierCompile);
+
+    if(!fichier.open(QIODevice::ReadOnly))
+        return false;
+
+    qint64 taille = fichier.size();
+    if(taille < qint64(sizeof(MaquetteCompilee::EnTete)))
+        return false;
+
+    uchar* donnees = fichier.map(0, taille);
+    if(donnees == nullptr)
+        return false;
+
+    bool resultat = lireMaquetteCompilee(donnees, quint64(taille), simView, empreinteAttendue);
+
+    fichier.unmap(donnees);
+    return resultat;
+}
+
+bool ChargeurMaquette::lireMaquetteCompilee(const uchar *donnees, quint64 taille, SimView *simView, quint64 empreinteAttendue)
+{
+    using namespace MaquetteCompilee;
+
+    const EnTete* enTete = reinterpret_cast<const EnTete*>(donnees);
+
+    if(std::memcmp(enTete->signature, SIGNATURE, sizeof(enTete->signature)) != 0 ||
+       enTete->version != VERSION || enTete->boutisme != BOUTISME || enTete->tailleFichier != taille)
+    {
+        qDebug() << "Maquette compilée : en-tête invalide ou version non supportée.";
+        return false;
+    }
+
+    if(empreinteAttendue != 0 && enTete->empreinteSources != empreinteAttendue)
+        return false;
+
+    // Vérifie qu'une section est alignée et entièrement contenue dans le fichier
+    auto sectionValide = [taille](quint64 position, qint32 nombre, quint64 tailleEnregistrement) {
+        return nombre >= 0 && position % 8 == 0 && position <= taille &&
+               quint64(nombre) * tailleEnregistrement <= taille - position;
+    };
+
+    if(!sectionValide(enTete->positionVoies, enTete->nbreVoies, sizeof(EnregistrementVoie)) ||
+       !sectionValide(enTete->positionContacts, enTete->nbreContacts, sizeof(EnregistrementContact)) ||
+       !sectionValide(enTete->positionAiguillages, enTete->nbreAiguillages, sizeof(EnregistrementAiguillage)) ||
+       !sectionValide(enTete->positionSegments, enTete->nbreSegments, sizeof(EnregistrementSegment)) ||
+       !sectionValide(enTete->positionVoiesSegments, enTete->nbreVoiesSegments, sizeof(qint32)))
+    {
+        qDebug() << "Maquette compilée : sections invalides.";
+        return false;
+    }
+
+    const EnregistrementVoie* enregistrementsVoies = reinterpret_cast<const EnregistrementVoie*>(donnees + enTete->positionVoies);
+    const EnregistrementContact* enregistrementsContacts = reinterpret_cast<const EnregistrementContact*>(donnees + enTete->positionContacts);
+    const EnregistrementAiguillage* enregistrementsAiguillages = reinterpret_cast<const EnregistrementAiguillage*>(donnees + enTete->positionAiguillages);
+    const EnregistrementSegment* enregistrementsSegments = reinterpret_cast<const EnregistrementSegment*>(donnees + enTete->positionSegments);
+    const qint32* voiesSegments = reinterpret_cast<const qint32*>(donnees + enTete->positionVoiesSegments);
+
+    QHash<int, Voie*> IDVoies;
+    IDVoies.reserve(enTete->nbreVoies);
+    descriptions.clear();
+
+    // Création des voies
+    for(int i = 0; i < enTete->nbreVoies; i++)
+    {
+        const EnregistrementVoie &e = enregistrementsVoies[i];
+
+        Voie* v = creerVoie(e.type, e.description);
+        if(v == nullptr || e.nbreLiaisons < 0 || e.nbreLiaisons > GeometrieVoie::MAX_LIAISONS)
+        {
+            delete v;
+            qDebug() << "Maquette compilée : voie" << e.id << "invalide.";
+            return false;
+        }
+
+        v->setIdVoie(e.id);
+        IDVoies.insert(e.id, v);
+        simView->addVoie(v, e.id);
+
+        DescriptionVoie description;
+        description.type = e.type;
+        std::memcpy(description.parametres, e.description, sizeof(description.parametres));
+        descriptions.insert(e.id, description);
+    }
+
+    // Liaisons entre voies
+    for(int i = 0; i < enTete->nbreVoies; i++)
+    {
+        const EnregistrementVoie &e = enregistrementsVoies[i];
+
+        for(int j = 0; j < e.nbreLiaisons; j++)
+        {
+            if(!IDVoies.contains(e.voisins[j]))
+            {
+                qDebug() << "Maquette compilée : liaison de la voie" << e.id << "invalide.";
+                return false;
+            }
+            IDVoies.value(e.id)->lier(IDVoies.value(e.voisins[j]), j);
+        }
+    }
+
+    // Contacts
+    for(int i = 0; i < enTete->nbreContacts; i++)
+    {
+        const EnregistrementContact &e = enregistrementsContacts[i];
+
+        if(!IDVoies.contains(e.voie))
+            return false;
+
+        Contact* c = new Contact(e.numero, e.voie);
+        IDVoies.value(e.voie)->setContact(c);
+        simView->addContact(c, e.numero);
+    }
+
+    // Aiguillages
+    for(int i = 0; i < enTete->nbreAiguillages; i++)
+    {
+        const EnregistrementAiguillage &e = enregistrementsAiguillages[i];
+
+        VoieVariable *v = dynamic_cast<VoieVariable *>(IDVoies.value(e.voie));
+        if(v == nullptr)
+            return false;
+
+        simView->addVoieVariable(v, e.numero);
+        v->setNumVoieVariable(e.numero);
+    }
+
+    // Géométrie calculée lors de la compilation
+    for(int i = 0; i < enTete->nbreVoies; i++)
+        IDVoies.value(enregistrementsVoies[i].id)->restaurerGeometrie(enregistrementsVoies[i].geometrie);
+
+    if(!IDVoies.contains(enTete->premiereVoie))
+        return false;
+    simView->setPremiereVoie(IDVoies.value(enTete->premiereVoie));
+
+    // Segments
+    QList<Segment*> segments;
+    for(int i = 0; i < enTete->nbreSegments; i++)
+    {
+        const EnregistrementSegment &e = enregistrementsSegments[i];
+        Contact* c1 = simView->getContact(e.contact1);
+        Contact* c2 = e.contact2 != 0 ? simView->getContact(e.contact2) : nullptr;
+
+        if(c1 == nullptr || (e.contact2 != 0 && c2 == nullptr) || e.premiereVoie < 0 || e.nbreVoies < 1 ||
+           e.premiereVoie > enTete->nbreVoiesSegments - e.nbreVoies)
+        {
+            qDeleteAll(segments);
+            qDebug() << "Maquette compilée : segment" << i << "invalide.";
+            return false;
+        }
+
+        QList<Voie*> voies;
+        voies.reserve(e.nbreVoies);
+        for(int j = 0; j < e.nbreVoies; j++)
+            voies.append(IDVoies.value(voiesSegments[e.premiereVoie + j]));
+        if(voies.contains(nullptr))
+        {
+            qDeleteAll(segments);
+            return false;
+        }
+
+        segments.append(new Segment(c1, c2, voies));
+    }
+    simView->setSegments(segments);
+
+    return true;
+}
+
+void ChargeurMaquette::setRepertoireCache(const QString &repertoire)
+{
+    this->repertoireCache = repertoire;
+}
+
+QString ChargeurMaquette::getRepertoireCache() const
+{
+    return this->repertoireCache;
+}
+
+QString ChargeurMaquette::fichierCache(const QString &filename, quint64 empreinte) const
+{
+    return QDir(repertoireCache).filePath(QString("%1-%2%3").arg(QFileInfo(filename).completeBaseName())
+                                                            .arg(empreinte, 16, 16, QChar('0'))
+                                                            .arg(MaquetteCompilee::EXTENSION));
+}
+
+bool ChargeurMaquette::chargerMaquetteConstruite(const QString &filename, SimView *simView, bool *depuisCache)
+{
+    if(depuisCache != nullptr)
+        *depuisCache = false;
+
+    quint64 empreinte = repertoireCache.isEmpty() ? 0 : calculerEmpreinte(filename, nomFichierInfosVoies);
+    QString cache = empreinte != 0 ? fichierCache(filename, empreinte) : QString();
+
+    if(!cache.isEmpty() && QFile::exists(cache))
+    {
+        if(chargerMaquetteCompilee(cache, simView, empreinte))
+        {
+            if(depuisCache != nullptr)
+                *depuisCache = true;
+            return true;
+        }
+
+        // Format modifié ou fichier corrompu : l'entrée est reconstruite
+        qDebug() << "Cache de maquette invalide, reconstruction de" << cache;
+        simView->viderMaquette();
+    }
+
+    if(!chargerMaquette(filename, simView))
+        return false;
+
+    simView->construireMaquette();
+
+    simView->genererSegments();
+
+    if(!cache.isEmpty())
+    {
+        // Les entrées calculées pour d'anciennes versions de la maquette sont périmées
+        QDir repertoire(repertoireCache);
+        repertoire.mkpath(".");
+        QString prefixe = QFileInfo(filename).completeBaseName() + "-";
+        QString extension = MaquetteCompilee::EXTENSION;
+        foreach(QString ancien, repertoire.entryList(QStringList() << prefixe + "*" + extension, QDir::Files))
+        {
+            if(ancien.length() == prefixe.length() + 16 + extension.length() && repertoire.filePath(ancien) != cache)
+                repertoire.remove(ancien);
+        }
+
+        if(!compilerMaquette(cache, filename, simView))
+            qDebug() << "Impossible d'écrire le cache de maquette" << cache;
+    }
+
+    return true;
+}
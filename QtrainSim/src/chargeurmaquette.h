@@ -0,0 +1,129 @@
+#ifndef CHARGEURMAQUETTE_H
+#define CHARGEURMAQUETTE_H
+
+#include <QString>
+#include <QMap>
+#include <QList>
+#include <QHash>
+
+#include "simview.h"
+
+/**
+ * Lecture des fichiers de description des voies et des maquettes.
+ *
+ * Le chargeur lit une fois pour toutes infosVoies.txt, puis crée les voies, contacts
+ * et aiguillages d'une maquette dans une SimView. Pour une maquette au format texte,
+ * la pose des voies (SimView::construireMaquette) et la génération des segments
+ * (SimView::genererSegments) restent à la charge de l'appelant.
+ *
+ * Une maquette construite peut être compilée dans un fichier binaire (voir
+ * maquettecompilee.h), dont le chargement restaure directement la géométrie et les
+ * segments. Ce même format sert de cache aux maquettes texte déjà construites
+ * (voir chargerMaquetteConstruite).
+ */
+class ChargeurMaquette
+{
+public:
+    ChargeurMaquette();
+    ~ChargeurMaquette();
+
+    ChargeurMaquette(const ChargeurMaquette &) = delete;
+    ChargeurMaquette &operator=(const ChargeurMaquette &) = delete;
+
+    /** Lit le fichier de description des types de voies.
+      * \param nomFichier le chemin du fichier infosVoies.txt.
+      * \return vrai si le fichier a pu être lu, faux sinon.
+      */
+    bool chargerInfosVoies(const QString &nomFichier);
+
+    /** Lit un fichier maquette et ajoute ses voies, contacts et aiguillages à la simulation.
+      * \param filename le chemin du fichier maquette.
+      * \param simView la vue de simulation à remplir (préalablement vidée).
+      * \return vrai si le fichier a pu être lu, faux s'il n'a pu être ouvert ou s'il
+      *         utilise un type de voie inconnu.
+      */
+    bool chargerMaquette(const QString &filename, SimView* simView);
+
+    /** Compile une maquette chargée depuis un fichier texte, puis construite
+      * (SimView::construireMaquette et SimView::genererSegments).
+      * \param fichierCompile le fichier binaire à écrire.
+      * \param fichierSource le fichier texte dont la maquette est issue.
+      * \param simView la vue de simulation contenant la maquette construite.
+      * \return vrai si le fichier a pu être écrit, faux sinon.
+      */
+    bool compilerMaquette(const QString &fichierCompile, const QString &fichierSource, SimView* simView) const;
+
+    /** Charge une maquette compilée par projection du fichier en mémoire. La maquette
+      * est prête à l'emploi : ni construireMaquette ni genererSegments ne doivent être appelées.
+      * \param fichierCompile le fichier binaire à lire.
+      * \param simView la vue de simulation à remplir (préalablement vidée).
+      * \param empreinteAttendue si non nulle, le fichier est refusé avant toute création
+      *        si l'empreinte des sources enregistrée lors de la compilation diffère.
+      * \return vrai si le fichier est une maquette compilée valide, faux sinon.
+      */
+    bool chargerMaquetteCompilee(const QString &fichierCompile, SimView* simView, quint64 empreinteAttendue = 0);
+
+    /** Charge et construit une maquette au format texte, en réutilisant si possible la
+      * géométrie et les segments mis en cache lors d'un précédent chargement.
+      * Le cache est indexé par l'empreinte du fichier maquette et de infosVoies.txt : toute
+      * modification de l'un d'eux, ou du format compilé, provoque sa reconstruction.
+      * \param filename le chemin du fichier maquette.
+      * \param simView la vue de simulation à remplir (préalablement vidée).
+      * \param depuisCache si non nul, indique si la maquette a été reprise du cache.
+      * \return vrai si la maquette a pu être chargée, faux sinon.
+      */
+    bool chargerMaquetteConstruite(const QString &filename, SimView* simView, bool* depuisCache = nullptr);
+
+    /** Modifie le répertoire du cache de maquettes. Par défaut, le répertoire de cache
+      * de l'application. Une chaîne vide désactive le cache.
+      * \param repertoire le répertoire du cache.
+      */
+    void setRepertoireCache(const QString &repertoire);
+
+    /** retourne le répertoire du cache de maquettes.
+      * \return le répertoire, vide si le cache est désactivé.
+      */
+    QString getRepertoireCache() const;
+
+    /** Calcule l'empreinte du contenu d'un fichier maquette et du fichier de
+      * description des voies.
+      * \param fichierMaquette le fichier maquette.
+      * \param fichierInfosVoies le fichier infosVoies.txt.
+      * \return l'empreinte, 0 si l'un des fichiers ne peut être lu.
+      */
+    static quint64 calculerEmpreinte(const QString &fichierMaquette, const QString &fichierInfosVoies);
+
+private:
+    //! Paramètres de construction d'une voie, tels que lus dans infosVoies.txt
+    struct DescriptionVoie
+    {
+        int type;
+        double parametres[4];   //!> trois dimensions, puis la direction (1 gauche, -1 droite)
+    };
+
+    /** crée une voie à partir de sa description.
+      * \param type le type de voie (1 = droite, 2 = courbe, ...).
+      * \param description les paramètres de construction.
+      * \return la voie, nullptr si le type est inconnu.
+      */
+    static Voie* creerVoie(int type, const double description[]);
+
+    /** crée la maquette décrite par le contenu d'un fichier compilé, après en avoir
+      * vérifié l'en-tête et les limites de chaque section.
+      */
+    bool lireMaquetteCompilee(const uchar* donnees, quint64 taille, SimView* simView, quint64 empreinteAttendue);
+
+    /** retourne le fichier du cache correspondant à une maquette.
+      * \param filename le fichier maquette.
+      * \param empreinte l'empreinte du fichier maquette et de infosVoies.txt.
+      * \return le chemin du fichier compilé dans le cache.
+      */
+    QString fichierCache(const QString &filename, quint64 empreinte) const;
+
+    QMap <int, QList<double>*> infosVoies;
+    QString nomFichierInfosVoies;
+    QString repertoireCache;
+    QHash<int, DescriptionVoie> descriptions;
+};
+
+#endif // CHARGEURMAQUETTE_H
@@ -1,26 +1,29 @@
 
+#include <atomic>
 #include <iostream>
 #include <QApplication>
 #include <QThread>
+#include <QTimer>
 
 #include "commandetrain.h"
-#include "mainwindow.h"
-
-
-
-static MainWindow *mainwindow;
-static SimView* simView;
-
-
-
+#include "backendsimulateur.h"
+#include "loco.h"
+#include "trainsimsettings.h"
+#include "connect.h"
 
 
 CommandeTrain::CommandeTrain()
 {
     command = "";
-    mutex = new QMutex();
+    mutex = new MutexInstrumente<QMutex>("commande");
     VarCond = new QWaitCondition();
     waitingOn=false;
+    backend = new BackendSimulateur();
+    enregistreur = nullptr;
+    ordonnanceur = new Ordonnanceur();
+    bilan = new BilanSimulation();
+    latences = new LatencesReveil();
+    enclenchement = ENCLENCHEMENT_APPLIQUER;
 }
 
 CommandeTrain* CommandeTrain::getInstance()
@@ -29,23 +32,67 @@ CommandeTrain* CommandeTrain::getInstance()
     return &instance;
 }
 
-void CommandeTrain::init_maquette(void)
+void CommandeTrain::setBackend(BackendTrain *backend)
+{
+    delete this->backend;
+    this->backend = backend;
+}
+
+BackendTrain *CommandeTrain::getBackend() const
+{
+    return backend;
+}
+
+bool CommandeTrain::enregistrer(const QString &fichier)
+{
+    delete enregistreur;
+    enregistreur = new EnregistreurTrace();
+    if (!enregistreur->ouvrir(fichier))
+    {
+        delete enregistreur;
+        enregistreur = nullptr;
+        ordonnanceur->enregistrer(nullptr);
+        return false;
+    }
+    ordonnanceur->enregistrer(enregistreur);
+    return true;
+}
+
+void CommandeTrain::setScenario(const QString &fichier)
+{
+    scenario = fichier;
+}
+
+QString CommandeTrain::getScenario() const
 {
-    mainwindow=new MainWindow();
-    mainwindow->show();
+    return scenario;
+}
+
+Ordonnanceur *CommandeTrain::getOrdonnanceur() const
+{
+    return ordonnanceur;
+}
 
-    simView = mainwindow->getSimView();
+BilanSimulation *CommandeTrain::getBilan() const
+{
+    return bilan;
+}
 
-    CONNECT(this, SIGNAL(setLoco(int,int,int,int)), simView, SLOT(setLoco(int,int,int,int)));
-    CONNECT(this, SIGNAL(askLoco(int,int)), simView, SLOT(askLoco(int,int)));
-    CONNECT(this, SIGNAL(setVitesseLoco(int,int)), simView, SLOT(setVitesseLoco(int,int)));
-    CONNECT(this, SIGNAL(reverseLoco(int)), simView, SLOT(reverseLoco(int)));
-    CONNECT(this, SIGNAL(setVitesseProgressiveLoco(int,int)), simView, SLOT(setVitesseProgressiveLoco(int,int)));
-    CONNECT(this, SIGNAL(setVoieVariable(int,int)), simView, SLOT(setVoieVariable(int,int)));
-    CONNECT(this, SIGNAL(addLoco(int)),mainwindow,SLOT(addLoco(int)));
-    CONNECT(this, SIGNAL(selectMaquette(QString)),mainwindow,SLOT(selectionMaquette(QString)));
-    CONNECT(this, SIGNAL(afficheMessage(QString)),mainwindow,SLOT(afficherMessage(QString)));
-    CONNECT(this, SIGNAL(afficheMessageLoco(int,QString)),mainwindow,SLOT(afficherMessageLoco(int,QString)));
+LatencesReveil *CommandeTrain::getLatences() const
+{
+    return latences;
+}
+
+void CommandeTrain::contact_active(int no_contact, int no_loco)
+{
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::CONTACT, no_loco, no_contact);
+    latences->activation(no_contact, no_loco);
+}
+
+void CommandeTrain::init_maquette(void)
+{
+    backend->init_maquette();
 
     QTimer::singleShot(10, this, SLOT(timerTrigger()));
 }
@@ -61,6 +108,9 @@ class UserThread : public QThread
 {
 public:
 
+    //! Valeur retournée par le programme client, -1 tant qu'il n'est pas terminé
+    std::atomic<int> resultat{-1};
+
     // L'ouverture de dialogues est autorisee dans cette fonction
     virtual bool initialize() {
 //        QMessageBox::warning(0,"coucou","Hello les amis");
@@ -75,7 +125,7 @@ protected:
     // L'ouverture de dialogues n'est pas autorisee dans cette fonction
     virtual void run() {
 
-        cmain();
+        resultat = cmain();
     }
 };
 
@@ -88,6 +138,16 @@ CommandeTrain::~CommandeTrain()
         userThread->wait();
         delete userThread;
     }
+    delete backend;
+    delete ordonnanceur;
+    delete enregistreur;
+    delete bilan;
+    delete latences;
+}
+
+int CommandeTrain::getResultatClient() const
+{
+    return userThread != nullptr && userThread->isFinished() ? userThread->resultat.load() : -1;
 }
 
 void CommandeTrain::timerTrigger()
@@ -98,6 +158,11 @@ void CommandeTrain::timerTrigger()
     if (!userThread->initialize()) {
         exit(0);
     }
+
+    // Sans simulateur, l'application se termine avec le programme client
+    if (!backend->interactif())
+        CONNECT(userThread, SIGNAL(finished()), qApp, SLOT(quit()));
+
     userThread->start();
 
 }
@@ -114,33 +179,52 @@ void CommandeTrain::mettre_maquette_en_service(void)
 
 void CommandeTrain::ajouter_loco(int no_loco)
 {
-    emit addLoco(no_loco);
+    backend->ajouter_loco(no_loco);
 }
 
 void CommandeTrain::diriger_aiguillage(int no_aiguillage, int direction, int /*temps_alim*/)
 {
-    emit setVoieVariable(no_aiguillage, direction);
+    diriger_aiguillage_enclenche(no_aiguillage, direction, enclenchement);
+}
+
+void CommandeTrain::diriger_aiguillage_enclenche(int no_aiguillage, int direction, int politique)
+{
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::AIGUILLAGE, 0, no_aiguillage, direction);
+    backend->diriger_aiguillage(no_aiguillage, direction, politique);
+}
+
+void CommandeTrain::setEnclenchement(int politique)
+{
+    enclenchement = politique;
 }
 
 void CommandeTrain::attendre_contact(int no_contact)
 {
-    Contact *c=simView->getContact(no_contact);
-    if (c == nullptr)
-    {
-        QMessageBox::warning(nullptr,"Error",QString("Attention, le numéro de contact %1 n'est pas valide").arg(no_contact));
-    }
-    else
-        c->attendContact();
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::ATTENTE, 0, no_contact);
+    backend->attendre_contact(no_contact);
+
+    // Les threads réveillés par un même contact repartent dans l'ordre enregistré
+    ordonnanceur->attendreTour(-no_contact);
+    ordonnanceur->consigner(-no_contact);
+
+    // Le thread reprend ici : la latence comprend aussi l'attente de son tour
+    latences->reveil(no_contact);
 }
 
 void CommandeTrain::arreter_loco(int no_loco)
 {
-    emit setVitesseLoco(no_loco, 0);
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::VITESSE, no_loco, 0);
+    backend->mettre_vitesse_loco(no_loco, 0);
 }
 
 void CommandeTrain::mettre_vitesse_progressive(int no_loco, int vitesse_future)
 {
-    emit setVitesseProgressiveLoco(no_loco, vitesse_future);
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::VITESSE_PROGRESSIVE, no_loco, vitesse_future);
+    backend->mettre_vitesse_progressive(no_loco, vitesse_future);
 }
 
 void CommandeTrain::mettre_fonction_loco(int /*no_loco*/, char /*etat*/)
@@ -150,43 +234,118 @@ void CommandeTrain::mettre_fonction_loco(int /*no_loco*/, char /*etat*/)
 
 void CommandeTrain::inverser_sens_loco(int no_loco)
 {
-    emit reverseLoco(no_loco);
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::INVERSION, no_loco, 0);
+    backend->inverser_sens_loco(no_loco);
 }
 
 void CommandeTrain::mettre_vitesse_loco(int no_loco, int vitesse)
 {
-    emit setVitesseLoco(no_loco, vitesse);
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::VITESSE, no_loco, vitesse);
+    backend->mettre_vitesse_loco(no_loco, vitesse);
 }
 
 void CommandeTrain::demander_loco(int contact_a, int contact_b, int */*no_loco*/, int */*vitesse*/)
 {
-    askLoco(contact_a, contact_b); //a refaire... pas adapte!
+    backend->demander_loco(contact_a, contact_b);
 }
 
 void CommandeTrain::assigner_loco(int contact_a,int contact_b,int no_loco,int vitesse)
 {
-    emit addLoco(no_loco);
-    emit setLoco(contact_a, contact_b, no_loco, vitesse);
+    backend->assigner_loco(contact_a, contact_b, no_loco, vitesse);
+}
+
+int CommandeTrain::lire_position_loco(int no_loco, int *contact_prec, int *contact_suiv, double *distance)
+{
+    return backend->lire_position_loco(no_loco, contact_prec, contact_suiv, distance);
+}
+
+int CommandeTrain::lire_vitesse_reelle(int no_loco)
+{
+    int vitesse = backend->lire_vitesse_reelle(no_loco);
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::VITESSE_REELLE, no_loco, vitesse);
+    return vitesse;
+}
+
+int CommandeTrain::creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance_avant)
+{
+    int no_declencheur = backend->creer_declencheur(no_loco, contact_prec, contact_suiv, distance_avant, false);
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::DECLENCHEUR, no_loco, no_declencheur,
+                                  contact_prec, contact_suiv, qRound(distance_avant * 1000.0));
+    return no_declencheur;
+}
+
+int CommandeTrain::creer_declencheur_segment(int no_loco, int contact_a, int contact_b, double distance_depuis_a)
+{
+    int no_declencheur = backend->creer_declencheur(no_loco, contact_a, contact_b, distance_depuis_a, true);
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::DECLENCHEUR_SEGMENT, no_loco, no_declencheur,
+                                  contact_a, contact_b, qRound(distance_depuis_a * 1000.0));
+    return no_declencheur;
+}
+
+void CommandeTrain::declencheur_active(int no_declencheur, int no_loco)
+{
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::FRANCHISSEMENT, no_loco, no_declencheur);
+}
+
+void CommandeTrain::attendre_declencheur(int no_declencheur)
+{
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::ATTENTE_DECLENCHEUR, 0, no_declencheur);
+    backend->attendre_declencheur(no_declencheur);
+}
+
+void CommandeTrain::supprimer_declencheur(int no_declencheur)
+{
+    backend->supprimer_declencheur(no_declencheur);
+}
+
+double CommandeTrain::longueur_segment(int contact_a, int contact_b)
+{
+    double longueur = backend->longueur_segment(contact_a, contact_b);
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(TraceCommandes::LONGUEUR, 0, contact_a, contact_b,
+                                  longueur < 0.0 ? -1 : qRound(longueur * 1000.0));
+    return longueur;
+}
+
+double CommandeTrain::distance_contacts(int contact_a, int contact_b)
+{
+    return backend->distance_contacts(contact_a, contact_b);
+}
+
+double CommandeTrain::eta_contact(int no_loco, int contact)
+{
+    return backend->eta_contact(no_loco, contact);
+}
+
+double CommandeTrain::distance_freinage(int vitesse)
+{
+    // La physique des locos est celle du simulateur, quel que soit le backend
+    return Loco::distanceFreinage(vitesse, TrainSimSettings::getInstance()->getInertie());
 }
 
 void CommandeTrain::selection_maquette(QString maquette)
 {
-    emit selectMaquette(maquette);
-    mainwindow->semWaitMaquette.acquire();
-    mainwindow->maquetteFinie.acquire();
+    backend->selection_maquette(maquette);
 }
 
 void CommandeTrain::afficher_message(const char *message)
 {
     QString mess=QString("%1").arg(message);
-    emit afficheMessage(mess);
+    backend->afficher_message(mess);
 }
 
 
 void CommandeTrain::afficher_message_loco(int numLoco,const char *message)
 {
     QString mess=QString("%1").arg(message);
-    emit afficheMessageLoco(numLoco,mess);
+    backend->afficher_message_loco(numLoco,mess);
 }
 
 void CommandeTrain::commandSent(QString command)
@@ -199,7 +358,7 @@ QString CommandeTrain::getCommand()
 {
     mutex->lock();
     waitingOn=true;
-    VarCond->wait(mutex);
+    mutex->attendre(*VarCond);
     QString tmp = command;
     command = "";
     waitingOn=false;
@@ -6,7 +6,15 @@
 #include <QMutex>
 #include <QWaitCondition>
 
+#include <atomic>
+
 #include "general.h"
+#include "backendtrain.h"
+#include "enregistreurtrace.h"
+#include "ordonnanceur.h"
+#include "bilansimulation.h"
+#include "latencesreveil.h"
+#include "profilverrous.h"
 
 /**
   Toutes les methodes de cette classe doivent être reentrantes!!!!!!!
@@ -33,7 +41,78 @@ public:
      */
     static CommandeTrain *getInstance();
 
+    /**
+     * Installe le backend exécutant les commandes, à la place du simulateur.
+     * A appeler avant init_maquette. La commande de train devient propriétaire
+     * du backend, et détruit le précédent.
+     * \param backend Le backend à installer.
+     */
+    void setBackend(BackendTrain *backend);
+
+    /**
+     * Retourne le backend exécutant les commandes.
+     */
+    BackendTrain *getBackend() const;
+
+    /**
+     * Enregistre les activations de contacts, les attentes de contacts et les
+     * commandes de vitesse, de sens et d'aiguillage dans une trace (voir
+     * TraceCommandes), qui pourra être rejouée par BackendRejeu. Les décisions de
+     * l'ordonnanceur y sont aussi enregistrées.
+     * A appeler avant init_maquette.
+     * \param fichier Fichier de la trace à créer.
+     * \return vrai si le fichier a pu être créé.
+     */
+    bool enregistrer(const QString &fichier);
+
+    /**
+     * Fixe le fichier de scénario que le programme client doit charger.
+     * \param fichier Le fichier de scénario, vide pour la configuration par défaut du client.
+     */
+    void setScenario(const QString &fichier);
+
+    /**
+     * Retourne le fichier de scénario que le programme client doit charger.
+     */
+    QString getScenario() const;
+
+    /**
+     * Retourne l'ordonnanceur rendant l'exécution du programme client reproductible.
+     */
+    Ordonnanceur *getOrdonnanceur() const;
+
+    /**
+     * Retourne le bilan de la simulation, alimenté par la simulation et par le
+     * programme client.
+     */
+    BilanSimulation *getBilan() const;
+
+    /**
+     * Retourne les latences de réveil des threads du programme client.
+     */
+    LatencesReveil *getLatences() const;
+
+    /**
+     * Retourne la valeur retournée par le programme client.
+     * \return la valeur, -1 si le programme client ne s'est pas terminé.
+     */
+    int getResultatClient() const;
+
+    /**
+     * Signale l'activation d'un contact par une loco, pour l'enregistrement.
+     * Appelée par la simulation.
+     * \param no_contact  Numéro du contact activé.
+     * \param no_loco     Numéro de la loco l'ayant activé.
+     */
+    void contact_active(int no_contact, int no_loco);
 
+    /**
+     * Signale le franchissement d'un déclencheur virtuel par une loco, pour l'enregistrement.
+     * Appelée par la simulation.
+     * \param no_declencheur  Numéro du déclencheur franchi.
+     * \param no_loco         Numéro de la loco l'ayant franchi.
+     */
+    void declencheur_active(int no_declencheur, int no_loco);
 
     /**
      * Initialise la communication avec la maquette/simulateur.
@@ -69,9 +148,27 @@ public:
      */
     void diriger_aiguillage(int no_aiguillage, int direction, int);
 
+    /**
+     * Change la direction d'un aiguillage, en choisissant le sort de la commande si
+     * une loco se trouve sur l'aiguillage (voir SimView::setVoieVariable).
+     * \param no_aiguillage  No de l'aiguillage a diriger.
+     * \param direction      Nouvelle direction. (DEVIE ou TOUT_DROIT)
+     * \param politique      ENCLENCHEMENT_APPLIQUER, ENCLENCHEMENT_REFUSER ou ENCLENCHEMENT_DIFFERER.
+     */
+    void diriger_aiguillage_enclenche(int no_aiguillage, int direction, int politique);
+
+    /**
+     * Fixe la politique d'enclenchement des commandes de diriger_aiguillage.
+     * \param politique      ENCLENCHEMENT_APPLIQUER (par défaut), ENCLENCHEMENT_REFUSER
+     *                       ou ENCLENCHEMENT_DIFFERER.
+     */
+    void setEnclenchement(int politique);
+
     /**
      * Méthode bloquante, permettant d'attendre l'activation du contact voulu.
      * Remarque : le contact peut être activé par n'importe quelle locomotive.
+     * Remarque bis : la reprise du thread est un point de synchronisation de
+     *                l'ordonnanceur, d'identifiant -no_contact.
      * \param no_contact  Numéro du contact dont on attend l'activation.
      */
     void attendre_contact(int no_contact);
@@ -141,10 +238,100 @@ public:
      */
     void assigner_loco(int contact_a,int contact_b,int no_loco,int vitesse);
 
+    /**
+     * Lit la dernière position publiée d'une loco, sans bloquer.
+     * \param no_loco        Numéro de la loco.
+     * \param contact_prec   Dernier contact franchi par la loco (0 si inconnu).
+     * \param contact_suiv   Prochain contact devant la loco (0 si buttoir).
+     * \param distance       Distance restante jusqu'à contact_suiv, en mm.
+     * \return 1 si la loco a été placée sur la maquette, 0 sinon.
+     */
+    int lire_position_loco(int no_loco, int *contact_prec, int *contact_suiv, double *distance);
+
+    /**
+     * Retourne la vitesse réelle d'une loco, qui peut différer de la vitesse
+     * demandée tant que l'inertie n'a pas été absorbée. Ne bloque pas.
+     * \param no_loco Numéro de la loco.
+     * \return la vitesse réelle, VITESSE_NULLE si la loco n'est pas placée.
+     */
+    int lire_vitesse_reelle(int no_loco);
+
+    /**
+     * Crée un déclencheur virtuel placé à une distance donnée avant un contact.
+     * \param no_loco         Loco qui active le déclencheur (0 pour n'importe laquelle).
+     * \param contact_prec    Contact précédant le point (0 pour n'importe lequel).
+     * \param contact_suiv    Contact suivant le point.
+     * \param distance_avant  Distance entre le point et contact_suiv, en mm.
+     * \return le numéro du déclencheur, -1 si les contacts ne sont pas valides.
+     */
+    int creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance_avant);
+
+    /**
+     * Crée un déclencheur virtuel placé à une distance donnée après un contact,
+     * sur le segment allant de contact_a vers contact_b.
+     * \param no_loco            Loco qui active le déclencheur (0 pour n'importe laquelle).
+     * \param contact_a          Contact de départ du segment.
+     * \param contact_b          Contact d'arrivée du segment.
+     * \param distance_depuis_a  Distance entre contact_a et le point, en mm.
+     * \return le numéro du déclencheur, -1 si les contacts ne sont pas valides.
+     */
+    int creer_declencheur_segment(int no_loco, int contact_a, int contact_b, double distance_depuis_a);
+
+    /**
+     * Méthode bloquante, permettant d'attendre le franchissement d'un déclencheur virtuel.
+     * Remarque : un déclencheur créé pour n'importe quelle loco peut être franchi par
+     * chacune d'elles.
+     * \param no_declencheur Numéro du déclencheur.
+     */
+    void attendre_declencheur(int no_declencheur);
+
+    /**
+     * Supprime un déclencheur virtuel.
+     * \param no_declencheur Numéro du déclencheur.
+     */
+    void supprimer_declencheur(int no_declencheur);
+
+    /**
+     * Retourne la longueur de voie entre deux contacts voisins.
+     * \param contact_a  Contact de départ.
+     * \param contact_b  Contact d'arrivée.
+     * \return la longueur en mm, entre le déclenchement des deux contacts en roulant
+     *         de contact_a vers contact_b. -1 si les contacts ne sont pas voisins.
+     */
+    double longueur_segment(int contact_a, int contact_b);
+
+    /**
+     * Retourne la plus courte distance de voie entre deux contacts quelconques,
+     * selon l'état actuel des aiguillages. Ne bloque pas.
+     * \param contact_a  Contact de départ.
+     * \param contact_b  Contact d'arrivée.
+     * \return la distance en mm, entre le déclenchement des deux contacts.
+     *         -1 si contact_b n'est pas accessible depuis contact_a.
+     */
+    double distance_contacts(int contact_a, int contact_b);
+
+    /**
+     * Estime le temps qu'il faudra à une loco pour atteindre un contact, à sa
+     * vitesse réelle actuelle et selon l'état actuel des aiguillages. Ne bloque pas.
+     * \param no_loco  Numéro de la loco.
+     * \param contact  Contact à atteindre.
+     * \return le temps en secondes, -1 si la loco est arrêtée, n'est pas placée
+     *         ou ne peut pas atteindre le contact dans son sens de marche.
+     */
+    double eta_contact(int no_loco, int contact);
+
+    /**
+     * Retourne la distance parcourue par une loco avant de s'arrêter, freinée à la
+     * vitesse donnée, selon l'option "Inertie". Ne bloque pas.
+     * \param vitesse  La vitesse de la loco.
+     * \return la distance en mm.
+     */
+    double distance_freinage(int vitesse);
+
     /**
       * Sélectionne la maquette à  utiliser.
       * Cette fonction termine l'application si la maquette n'est pas trouvée.
-      * \param maquette Nom de la maquette.
+      * \param maquette Nom de la maquette, ou chemin de son fichier.
       */
     void selection_maquette(QString maquette);
 
@@ -160,24 +347,18 @@ public slots:
 protected slots:
     void timerTrigger();
 
-signals:
-    void addLoco(int no_loco);
-    void setLoco(int contactA, int contactB, int numLoco, int vitesseLoco);
-    void askLoco(int contactA, int contactB);
-    void setVitesseLoco(int numLoco, int vitesseLoco);
-    void reverseLoco(int numLoco);
-    void setVitesseProgressiveLoco(int numLoco, int vitesseLoco);
-    void stopLoco(int numLoco);
-    void setVoieVariable(int numVoieVariable, int direction);
-    void selectMaquette(QString maquette);
-    void afficheMessage(QString message);
-    void afficheMessageLoco(int numLoco,QString message);
-
 private:
     QString command;
     QWaitCondition* VarCond;
-    QMutex* mutex;
+    MutexInstrumente<QMutex>* mutex;
     bool waitingOn;
+    BackendTrain* backend;
+    EnregistreurTrace* enregistreur;
+    Ordonnanceur* ordonnanceur;
+    BilanSimulation* bilan;
+    LatencesReveil* latences;
+    std::atomic<int> enclenchement;
+    QString scenario;
 };
 
 #endif // COMMANDETRAIN_H
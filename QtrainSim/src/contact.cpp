@@ -12,7 +12,7 @@ Contact::Contact(int numContact, int numVoiePorteuse, QObject *parent) :
 {
     this->numContact = numContact;
     this->numVoiePorteuse = numVoiePorteuse;
-    mutex = new QMutex();
+    mutex = new MutexInstrumente<QMutex>(QString("contact %1").arg(numContact));
     VarCond = new QWaitCondition();
     setZValue(ZVAL_CONTACT);
     waitingOn=false;
@@ -29,7 +29,7 @@ void Contact::attendContact()
     mutex->lock();
     waitingOn=true;
     update();
-    VarCond->wait(mutex);
+    mutex->attendre(*VarCond);
     waitingOn=false;
     update();
     mutex->unlock();
@@ -10,6 +10,7 @@
 #include <math.h>
 
 #include "general.h"
+#include "profilverrous.h"
 
 class Contact : public QObject, public QAbstractGraphicsShapeItem
 {
@@ -63,7 +64,7 @@ private:
     int numVoiePorteuse;
     int numContact;
     QWaitCondition* VarCond;
-    QMutex* mutex;
+    MutexInstrumente<QMutex>* mutex;
     qreal angle;
     bool waitingOn;
 };
@@ -11,6 +11,7 @@
  
 #include "ctrain_handler.h"
 #include "commandetrain.h"
+#include "profilverrous.h"
 
 #define CMD_TRAIN CommandeTrain::getInstance()
 
@@ -49,6 +50,21 @@ void diriger_aiguillage(int no_aiguillage, int direction, int temps_alim) {
     CMD_TRAIN->diriger_aiguillage(no_aiguillage,direction,temps_alim);
 }
 
+/*
+ * Change la direction d'un aiguillage, selon la politique d'enclenchement donnee
+ * si l'aiguillage est occupe.
+ */
+void diriger_aiguillage_enclenche(int no_aiguillage, int direction, int politique) {
+    CMD_TRAIN->diriger_aiguillage_enclenche(no_aiguillage,direction,politique);
+}
+
+/*
+ * Fixe la politique d'enclenchement de diriger_aiguillage().
+ */
+void fixer_enclenchement(int politique) {
+    CMD_TRAIN->setEnclenchement(politique);
+}
+
 /*
  * Attend l'activation du contact donne.
  *   no_contact : No du contact dont on attend l'activation.
@@ -135,6 +151,160 @@ void assigner_loco(int contact_a, int contact_b, int no_loco, int vitesse) {
     CMD_TRAIN->assigner_loco(contact_a,contact_b,no_loco,vitesse);
 }
 
+/*
+ * Lit la derniere position connue d'une loco, sans bloquer.
+ */
+int lire_position_loco(int no_loco, int *contact_prec, int *contact_suiv, double *distance)
+{
+    return CMD_TRAIN->lire_position_loco(no_loco, contact_prec, contact_suiv, distance);
+}
+
+/*
+ * Retourne la vitesse reelle d'une loco, sans bloquer.
+ */
+int lire_vitesse_reelle(int no_loco)
+{
+    return CMD_TRAIN->lire_vitesse_reelle(no_loco);
+}
+/*
+ * Cree un declencheur virtuel a une distance donnee avant un contact.
+ */
+int creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance_avant)
+{
+    return CMD_TRAIN->creer_declencheur(no_loco, contact_prec, contact_suiv, distance_avant);
+}
+
+/*
+ * Cree un declencheur virtuel a une distance donnee apres un contact.
+ */
+int creer_declencheur_segment(int no_loco, int contact_a, int contact_b, double distance_depuis_a)
+{
+    return CMD_TRAIN->creer_declencheur_segment(no_loco, contact_a, contact_b, distance_depuis_a);
+}
+
+/*
+ * Attend le franchissement d'un declencheur virtuel.
+ */
+void attendre_declencheur(int no_declencheur)
+{
+    CMD_TRAIN->attendre_declencheur(no_declencheur);
+}
+
+/*
+ * Supprime un declencheur virtuel.
+ */
+void supprimer_declencheur(int no_declencheur)
+{
+    CMD_TRAIN->supprimer_declencheur(no_declencheur);
+}
+/*
+ * Retourne la longueur de voie entre deux contacts voisins.
+ */
+double longueur_segment(int contact_a, int contact_b)
+{
+    return CMD_TRAIN->longueur_segment(contact_a, contact_b);
+}
+
+/*
+ * Retourne la plus courte distance de voie entre deux contacts.
+ */
+double distance_contacts(int contact_a, int contact_b)
+{
+    return CMD_TRAIN->distance_contacts(contact_a, contact_b);
+}
+
+/*
+ * Estime le temps d'arrivee d'une loco a un contact.
+ */
+double eta_contact(int no_loco, int contact)
+{
+    return CMD_TRAIN->eta_contact(no_loco, contact);
+}
+
+/*
+ * Retourne la distance de freinage d'une loco.
+ */
+double distance_freinage(int vitesse)
+{
+    return CMD_TRAIN->distance_freinage(vitesse);
+}
+
+/*
+ * Associe le thread appelant a une loco.
+ */
+void identifier_thread_loco(int no_loco)
+{
+    CMD_TRAIN->getOrdonnanceur()->identifierThread(no_loco);
+}
+
+/*
+ * Attend son tour pour franchir un point de synchronisation.
+ */
+void attendre_tour(int point)
+{
+    CMD_TRAIN->getOrdonnanceur()->attendreTour(point);
+}
+
+/*
+ * Signale le franchissement d'un point de synchronisation.
+ */
+void consigner_decision(int point)
+{
+    CMD_TRAIN->getOrdonnanceur()->consigner(point);
+}
+
+/*
+ * Retourne la graine de la simulation.
+ */
+unsigned int graine_simulation(void)
+{
+    return CMD_TRAIN->getOrdonnanceur()->getGraine();
+}
+
+/*
+ * Retourne le fichier de scenario passe au simulateur.
+ */
+const char *fichier_scenario(void)
+{
+    static QByteArray fichier;
+
+    fichier = CMD_TRAIN->getScenario().toLocal8Bit();
+    return fichier.constData();
+}
+
+/*
+ * Compte un tour d'une loco dans le bilan de la simulation.
+ */
+void signaler_tour(int no_loco)
+{
+    CMD_TRAIN->getBilan()->tourTermine(no_loco);
+}
+
+/*
+ * Note le debut de l'attente de la section partagee par une loco.
+ */
+void debut_attente_section(int no_loco)
+{
+    CMD_TRAIN->getBilan()->debutAttente(no_loco);
+}
+
+/*
+ * Note la fin de l'attente de la section partagee par une loco.
+ */
+void fin_attente_section(int no_loco)
+{
+    CMD_TRAIN->getBilan()->finAttente(no_loco);
+}
+
+/*
+ * Affiche le rapport du profil des verrous dans la console.
+ */
+void afficher_profil_verrous(int nbre)
+{
+    if (!ProfilVerrous::estActif())
+        return;
+    CMD_TRAIN->afficher_message(qPrintable(ProfilVerrous::getInstance()->rapport(nbre)));
+}
 
 void selection_maquette(const char *maquette)
 {
@@ -33,19 +33,30 @@ extern "C" {
 // Vitesse maximum
 #define	VITESSE_MAXIMUM 14
 
-// Numero max. d'aiguillage
+// Numero max. d'aiguillage, de contact et de loco.
+// Ces limites peuvent etre relevees a la compilation (options CMake QTRAINSIM_MAX_*).
+#ifndef MAX_AIGUILLAGES
 #define	MAX_AIGUILLAGES 80
+#endif
 
-// Numero max. de contact
+#ifndef MAX_CONTACTS
 #define MAX_CONTACTS 64
+#endif
 
-// Numero max. de loco
+#ifndef MAX_LOCOS
 #define	MAX_LOCOS 80
+#endif
 
 // Direction des aiguillages
 #define DEVIE 0
 #define TOUT_DROIT 1
 
+// Enclenchement des aiguillages : sort d'une commande visant un aiguillage occupe
+// par une loco (qui deraille si l'aiguillage change sous elle)
+#define ENCLENCHEMENT_APPLIQUER 0
+#define ENCLENCHEMENT_REFUSER 1
+#define ENCLENCHEMENT_DIFFERER 2
+
 // Etat des phares
 #define ETEINT 0
 #define ALLUME 1
@@ -74,6 +85,27 @@ void mettre_maquette_en_service(void);
  */
 void diriger_aiguillage(int no_aiguillage, int direction, int temps_alim);
 
+/*
+ * Change la direction d'un aiguillage, en choisissant le sort de la commande si
+ * une loco se trouve sur l'aiguillage : appliquee (la loco deraille), refusee,
+ * ou differee jusqu'a ce que l'aiguillage soit libre. Une commande qui ne change
+ * pas la direction de l'aiguillage est sans effet. Une commande plus recente
+ * remplace la commande differee du meme aiguillage.
+ *   no_aiguillage : No de l'aiguillage a diriger.
+ *   direction     : Nouvelle direction. (DEVIE ou TOUT_DROIT)
+ *   politique     : ENCLENCHEMENT_APPLIQUER, ENCLENCHEMENT_REFUSER ou
+ *                   ENCLENCHEMENT_DIFFERER.
+ */
+void diriger_aiguillage_enclenche(int no_aiguillage, int direction, int politique);
+
+/*
+ * Fixe la politique d'enclenchement des commandes de diriger_aiguillage(). Par
+ * defaut, les commandes sont appliquees.
+ *   politique : ENCLENCHEMENT_APPLIQUER, ENCLENCHEMENT_REFUSER ou
+ *               ENCLENCHEMENT_DIFFERER.
+ */
+void fixer_enclenchement(int politique);
+
 /*
  * Attend l'activation du contact donne.
  *   no_contact : No du contact dont on attend l'activation.
@@ -144,12 +176,175 @@ void demander_loco(int contact_a, int contact_b, int *no_loco, int *vitesse);
  */
 void assigner_loco(int contact_a, int contact_b, int no_loco, int vitesse);
 
+/*
+ * Lit la derniere position connue d'une loco. Cette fonction ne bloque pas :
+ * elle lit l'instantane publie par le simulateur a chaque pas d'animation.
+ *   no_loco      : No de la loco.
+ *   contact_prec : Dernier contact franchi par la loco (0 si inconnu).
+ *   contact_suiv : Prochain contact devant la loco (0 si la loco va vers un buttoir).
+ *   distance     : Distance restante jusqu'a contact_suiv, en mm.
+ *   return       : 1 si la loco est placee sur la maquette, 0 sinon.
+ * Remarque : les pointeurs peuvent etre nuls si la valeur n'interesse pas l'appelant.
+ */
+int lire_position_loco(int no_loco, int *contact_prec, int *contact_suiv, double *distance);
+
+/*
+ * Retourne la vitesse reelle d'une loco. Avec l'option "Inertie", elle peut
+ * differer de la derniere vitesse demandee. Cette fonction ne bloque pas.
+ *   no_loco : No de la loco.
+ *   return  : La vitesse reelle, VITESSE_NULLE si la loco n'est pas placee.
+ */
+int lire_vitesse_reelle(int no_loco);
+
+/*
+ * Cree un declencheur virtuel, place a une distance donnee avant un contact.
+ * Il se comporte comme un contact : attendre_declencheur() est libere lorsque la
+ * loco no_loco franchit le point en roulant de contact_prec vers contact_suiv.
+ *   no_loco        : Loco qui active le declencheur (0 pour n'importe laquelle).
+ *   contact_prec   : Contact precedant le point (0 pour n'importe lequel).
+ *   contact_suiv   : Contact suivant le point.
+ *   distance_avant : Distance entre le point et contact_suiv, en mm.
+ *   return         : No du declencheur, -1 si les contacts ne sont pas valides.
+ */
+int creer_declencheur(int no_loco, int contact_prec, int contact_suiv, double distance_avant);
+
+/*
+ * Cree un declencheur virtuel, place a une distance donnee apres contact_a, sur
+ * le segment allant de contact_a vers contact_b (dans ce sens de marche).
+ *   no_loco           : Loco qui active le declencheur (0 pour n'importe laquelle).
+ *   contact_a         : Contact de depart du segment.
+ *   contact_b         : Contact d'arrivee du segment.
+ *   distance_depuis_a : Distance entre contact_a et le point, en mm.
+ *   return            : No du declencheur, -1 si les contacts ne sont pas valides.
+ */
+int creer_declencheur_segment(int no_loco, int contact_a, int contact_b, double distance_depuis_a);
+
+/*
+ * Attend le franchissement d'un declencheur virtuel.
+ *   no_declencheur : No du declencheur dont on attend le franchissement.
+ */
+void attendre_declencheur(int no_declencheur);
+
+/*
+ * Supprime un declencheur virtuel. Il ne sera plus evalue par le simulateur.
+ *   no_declencheur : No du declencheur a supprimer.
+ */
+void supprimer_declencheur(int no_declencheur);
+
+/*
+ * Retourne la longueur de voie entre deux contacts voisins, mesuree entre le
+ * declenchement de contact_a et celui de contact_b en roulant de a vers b.
+ *   contact_a : Contact de depart.
+ *   contact_b : Contact d'arrivee.
+ *   return    : La longueur en mm, -1 si les contacts ne sont pas voisins.
+ */
+double longueur_segment(int contact_a, int contact_b);
+
+/*
+ * Retourne la plus courte distance de voie entre deux contacts quelconques,
+ * selon l'etat actuel des aiguillages. Cette fonction ne bloque pas.
+ *   contact_a : Contact de depart.
+ *   contact_b : Contact d'arrivee.
+ *   return    : La distance en mm, -1 si contact_b n'est pas accessible.
+ * Seuls les 256 premiers contacts sont pris en compte sur les grandes maquettes.
+ */
+double distance_contacts(int contact_a, int contact_b);
+
+/*
+ * Estime le temps qu'il faudra a une loco pour atteindre un contact, a sa
+ * vitesse reelle actuelle et selon l'etat actuel des aiguillages. Cette
+ * fonction ne bloque pas.
+ *   no_loco : No de la loco.
+ *   contact : Contact a atteindre.
+ *   return  : Le temps en secondes, -1 si la loco est arretee ou si le contact
+ *             n'est pas accessible dans son sens de marche.
+ */
+double eta_contact(int no_loco, int contact);
+
+/*
+ * Retourne la distance parcourue par une loco avant de s'arreter, si on lui
+ * commande l'arret a la vitesse donnee. Elle depend de l'option "Inertie" dans
+ * le menu ad hoc. Cette fonction ne bloque pas.
+ *   vitesse : Vitesse de la loco.
+ *   return  : La distance en mm.
+ */
+double distance_freinage(int vitesse);
+
+/*
+ * Associe le thread appelant a une loco, pour l'ordonnancement deterministe.
+ * A appeler au debut du thread de chaque loco.
+ *   no_loco : No de la loco.
+ */
+void identifier_thread_loco(int no_loco);
+
+/*
+ * Lors du rejeu d'une trace, bloque le thread appelant jusqu'a ce que ce soit son
+ * tour de franchir un point de synchronisation, dans l'ordre enregistre. Sans effet
+ * sinon. A appeler juste avant la decision (par exemple avant de prendre un mutex).
+ *   point : Identifiant du point de synchronisation (strictement positif, les
+ *           identifiants negatifs sont reserves aux contacts).
+ */
+void attendre_tour(int point);
+
+/*
+ * Signale que le thread appelant a franchi un point de synchronisation. Lors d'un
+ * enregistrement, l'ordre de passage est ajoute a la trace. A appeler la ou la
+ * decision est prise (par exemple juste apres avoir pris le mutex).
+ *   point : Identifiant du point de synchronisation.
+ */
+void consigner_decision(int point);
+
+/*
+ * Retourne la graine de la simulation, a utiliser pour initialiser les generateurs
+ * aleatoires du programme client. Elle est enregistree dans les traces et restauree
+ * lors du rejeu.
+ *   return : La graine.
+ */
+unsigned int graine_simulation(void);
+
+
+/*
+ * Retourne le fichier de scenario passe au simulateur (option --scenario), que le
+ * programme client peut charger a la place de sa configuration par defaut.
+ *   return : Le chemin du fichier, une chaine vide si aucun scenario n'a ete donne.
+ */
+const char *fichier_scenario(void);
+
+/*
+ * Signale qu'une loco a termine un tour de son parcours, pour le bilan de la
+ * simulation (option --bilan du simulateur).
+ *   no_loco : No de la loco.
+ */
+void signaler_tour(int no_loco);
+
+/*
+ * Signale qu'une loco commence a attendre l'acces a la section partagee, pour le
+ * bilan de la simulation. L'attente est mesuree en temps simule.
+ *   no_loco : No de la loco.
+ */
+void debut_attente_section(int no_loco);
+
+/*
+ * Signale qu'une loco a obtenu l'acces a la section partagee. La duree de
+ * l'attente commencee par debut_attente_section() est ajoutee au bilan.
+ *   no_loco : No de la loco.
+ */
+void fin_attente_section(int no_loco);
+
+/*
+ * Affiche dans la console le rapport du profil des verrous (option
+ * --profil-verrous du simulateur) : attente, detention et contentions des
+ * verrous dont l'attente totale est la plus longue.
+ *   nbre : nombre de verrous du rapport.
+ */
+void afficher_profil_verrous(int nbre);
 
 /*
  * Selectionne la maquette a utiliser.
  * Cette fonction termine l'application si la maquette n'est pas trouvee.
- * La maquette est cherchee dans le repertoire contenant les maquettes.
- *   maquette : Nom de la maquette.
+ * La maquette est cherchee dans le repertoire contenant les maquettes, sauf si
+ * maquette est le chemin d'un fichier existant (relatif au repertoire courant).
+ *   maquette : Nom de la maquette, ou chemin de son fichier.
  */
 void selection_maquette(const char *maquette);
 
@@ -0,0 +1,73 @@
+#include <QMutexLocker>
+
+#include "declencheurvirtuel.h"
+
+DeclencheurVirtuel::DeclencheurVirtuel(int numDeclencheur, int numLoco, int contactPrecedent, int contactSuivant,
+                                       qreal distance, bool depuisPrecedent)
+{
+    this->numDeclencheur = numDeclencheur;
+    this->numLoco = numLoco;
+    this->contactPrecedent = contactPrecedent;
+    this->contactSuivant = contactSuivant;
+    this->distance = distance;
+    this->depuisPrecedent = depuisPrecedent;
+    this->generation = 0;
+    this->estSupprime = false;
+}
+
+void DeclencheurVirtuel::attendDeclenchement()
+{
+    QMutexLocker locker(&mutex);
+    Qt::HANDLE thread = QThread::currentThreadId();
+    quint64 generationVue = generationsVues.value(thread);
+    while(generation == generationVue && !estSupprime)
+        varCond.wait(&mutex);
+    generationsVues.insert(thread, generation);
+}
+
+void DeclencheurVirtuel::active()
+{
+    QMutexLocker locker(&mutex);
+    generation++;
+    varCond.wakeAll();
+}
+
+void DeclencheurVirtuel::supprime()
+{
+    QMutexLocker locker(&mutex);
+    estSupprime = true;
+    varCond.wakeAll();
+}
+
+bool DeclencheurVirtuel::estFranchi(int contactPrecedent, int contactSuivant, bool memeSegment,
+                                    qreal restantAvant, qreal restantApres, qreal longueurSegment) const
+{
+    if(contactSuivant != this->contactSuivant)
+        return false;
+    if(this->contactPrecedent != 0 && contactPrecedent != this->contactPrecedent)
+        return false;
+
+    // Distance restante jusqu'au contact suivant à laquelle se trouve le point
+    qreal seuil = depuisPrecedent ? longueurSegment - distance : distance;
+
+    if(restantApres > seuil)
+        return false;
+
+    // En arrivant sur le segment, un point déjà dépassé se déclenche immédiatement
+    return !memeSegment || restantAvant > seuil;
+}
+
+int DeclencheurVirtuel::getNumDeclencheur() const
+{
+    return numDeclencheur;
+}
+
+int DeclencheurVirtuel::getNumLoco() const
+{
+    return numLoco;
+}
+
+int DeclencheurVirtuel::getContactSuivant() const
+{
+    return contactSuivant;
+}
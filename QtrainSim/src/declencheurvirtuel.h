@@ -0,0 +1,98 @@
+#ifndef DECLENCHEURVIRTUEL_H
+#define DECLENCHEURVIRTUEL_H
+
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+/**
+ * Point de déclenchement virtuel, placé à une distance arbitraire le long de la voie.
+ * Il se comporte comme un Contact : les threads en attente sont libérés lorsqu'une
+ * loco franchit le point, mais il n'a aucune existence physique sur la maquette.
+ *
+ * Le déclencheur peut être réservé à une loco : seul son passage l'active alors.
+ *
+ * Le point est défini sur le segment allant de contactPrecedent à contactSuivant,
+ * dans ce sens de marche, et peut être mesuré de deux manières :
+ * - avant le contact suivant : le déclencheur s'active lorsque la distance restante
+ *   jusqu'à contactSuivant devient inférieure ou égale à la distance donnée ;
+ * - depuis le contact précédent : il s'active lorsque la distance parcourue depuis
+ *   contactPrecedent devient supérieure ou égale à la distance donnée.
+ */
+class DeclencheurVirtuel
+{
+public:
+    /** Constructeur de classe.
+      * \param numDeclencheur le numéro du déclencheur.
+      * \param numLoco la loco qui active le point, 0 pour n'importe laquelle.
+      * \param contactPrecedent le contact précédant le point, 0 pour n'importe lequel
+      *        (uniquement si la distance est mesurée avant le contact suivant).
+      * \param contactSuivant le contact suivant le point.
+      * \param distance la distance définissant le point, en mm.
+      * \param depuisPrecedent vrai si la distance est mesurée depuis contactPrecedent,
+      *        faux si elle est mesurée avant contactSuivant.
+      */
+    DeclencheurVirtuel(int numDeclencheur, int numLoco, int contactPrecedent, int contactSuivant,
+                       qreal distance, bool depuisPrecedent);
+
+    /** Méthode bloquante, permettant d'attendre le franchissement du point par une loco.
+      * Chaque thread a son propre suivi : un franchissement survenu depuis la création
+      * du déclencheur, ou depuis la fin de la dernière attente de ce thread, n'est pas
+      * perdu et l'attente se termine aussitôt. Un franchissement libère ainsi tous les
+      * threads en attente. Se termine aussi lorsque le déclencheur est supprimé.
+      */
+    void attendDeclenchement();
+
+    /** Méthode appelée quand une loco franchit le point.
+      * Libère les threads en attente.
+      */
+    void active();
+
+    /** Méthode appelée quand le déclencheur est supprimé.
+      * Libère les threads en attente, et ceux qui l'attendront.
+      */
+    void supprime();
+
+    /** Détermine si une loco franchit le point pendant un pas d'animation.
+      * \param contactPrecedent le contact précédant la loco après le pas.
+      * \param contactSuivant le contact suivant la loco après le pas.
+      * \param memeSegment vrai si la loco est restée sur le même segment pendant le pas.
+      * \param restantAvant la distance restante jusqu'au contact suivant avant le pas.
+      * \param restantApres la distance restante jusqu'au contact suivant après le pas.
+      * \param longueurSegment la distance entre les deux contacts du segment.
+      * \return vrai si le point a été franchi pendant le pas.
+      */
+    bool estFranchi(int contactPrecedent, int contactSuivant, bool memeSegment,
+                    qreal restantAvant, qreal restantApres, qreal longueurSegment) const;
+
+    /** retourne le numéro du déclencheur.
+      * \return le numéro du déclencheur.
+      */
+    int getNumDeclencheur() const;
+
+    /** retourne la loco qui active le point.
+      * \return le numéro de la loco, 0 pour n'importe laquelle.
+      */
+    int getNumLoco() const;
+
+    /** retourne le contact suivant le point.
+      * \return le numéro du contact suivant.
+      */
+    int getContactSuivant() const;
+
+private:
+    int numDeclencheur;
+    int numLoco;
+    int contactPrecedent;
+    int contactSuivant;
+    qreal distance;
+    bool depuisPrecedent;
+    quint64 generation;         //!> Nombre de franchissements
+    QHash<Qt::HANDLE, quint64> generationsVues; //!> Par thread, franchissements pris en compte
+    bool estSupprime;
+    QWaitCondition varCond;
+    QMutex mutex;
+};
+
+#endif // DECLENCHEURVIRTUEL_H
@@ -0,0 +1,76 @@
+#include <cstring>
+
+#include "enregistreurtrace.h"
+
+
+EnregistreurTrace::EnregistreurTrace()
+{
+    tampon.reserve(TAILLE_TAMPON);
+}
+
+EnregistreurTrace::~EnregistreurTrace()
+{
+    vider();
+    fichier.close();
+}
+
+bool EnregistreurTrace::ouvrir(const QString &nom)
+{
+    QMutexLocker locker(&mutex);
+
+    fichier.setFileName(nom);
+    if (!fichier.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    TraceCommandes::EnTete entete;
+    std::memcpy(entete.signature, TraceCommandes::SIGNATURE, sizeof(entete.signature));
+    entete.version = TraceCommandes::VERSION;
+    entete.boutisme = TraceCommandes::BOUTISME;
+
+    if (fichier.write(reinterpret_cast<const char*>(&entete), sizeof(entete)) != sizeof(entete))
+    {
+        fichier.close();
+        return false;
+    }
+
+    chrono.start();
+    return true;
+}
+
+void EnregistreurTrace::enregistrer(TraceCommandes::TypeEvenement type, int loco, int a, int b, int c, int d)
+{
+    QMutexLocker locker(&mutex);
+
+    if (!fichier.isOpen())
+        return;
+
+    TraceCommandes::Evenement e;
+    e.tempsMs = quint32(chrono.elapsed());
+    e.type = quint8(type);
+    e.reserve = 0;
+    e.loco = quint16(loco);
+    e.a = a;
+    e.b = b;
+    e.c = c;
+    e.d = d;
+    tampon.append(e);
+
+    if (tampon.size() >= TAILLE_TAMPON)
+        viderSansVerrou();
+}
+
+void EnregistreurTrace::vider()
+{
+    QMutexLocker locker(&mutex);
+    viderSansVerrou();
+}
+
+void EnregistreurTrace::viderSansVerrou()
+{
+    if (fichier.isOpen() && !tampon.isEmpty())
+    {
+        fichier.write(reinterpret_cast<const char*>(tampon.constData()), tampon.size() * sizeof(TraceCommandes::Evenement));
+        fichier.flush();
+    }
+    tampon.clear();
+}
@@ -0,0 +1,55 @@
+#ifndef ENREGISTREURTRACE_H
+#define ENREGISTREURTRACE_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QVector>
+
+#include "tracecommandes.h"
+
+/**
+ * Enregistre une trace de commandes (voir TraceCommandes) dans un fichier.
+ * Les événements sont accumulés en mémoire et écrits par blocs. Peut être appelé
+ * depuis n'importe quel thread.
+ */
+class EnregistreurTrace
+{
+public:
+    EnregistreurTrace();
+
+    /** Destructeur de classe. Ecrit les derniers événements et ferme le fichier.
+      */
+    ~EnregistreurTrace();
+
+    /** crée le fichier de trace et écrit son en-tête. Le temps des événements est
+      * compté à partir de cet appel.
+      * \param fichier le fichier à créer.
+      * \return vrai si le fichier a pu être créé.
+      */
+    bool ouvrir(const QString &fichier);
+
+    /** enregistre un événement.
+      * \param type le type de l'événement.
+      * \param loco le numéro de la loco, 0 si l'événement n'en concerne pas.
+      * \param a, b, c et d les paramètres de l'événement (voir TraceCommandes::TypeEvenement).
+      */
+    void enregistrer(TraceCommandes::TypeEvenement type, int loco, int a, int b = 0, int c = 0, int d = 0);
+
+    /** écrit les événements en attente dans le fichier.
+      */
+    void vider();
+
+private:
+    //! Nombre d'événements accumulés avant écriture
+    static const int TAILLE_TAMPON = 4096;
+
+    void viderSansVerrou();
+
+    QMutex mutex;
+    QFile fichier;
+    QElapsedTimer chrono;
+    QVector<TraceCommandes::Evenement> tampon;
+};
+
+#endif // ENREGISTREURTRACE_H
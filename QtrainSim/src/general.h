@@ -22,6 +22,11 @@
 //! Inertie des locos. indiqué en millièmes de secondes entre chaque changement
 //! de la valeur de vitesse de 1.
 #define INERTIE_LOCO 100
+//! Inertie des locos, en pas d'animation entre chaque changement de la valeur de vitesse de 1.
+//! Comptée en pas, elle suit la simulation accélérée.
+#define PAS_INERTIE (INERTIE_LOCO * FRAME_RATE / 1000)
+//! Marge du freinage automatique, en mm : distance minimale laissée entre deux locos
+#define MARGE_FREINAGE 60.0
 
 //! NE PAS CHANGER!!! nécessaire au calcul des poses de voies.
 #define DIRECTION_VOIE_GAUCHE 1.0
@@ -70,19 +75,36 @@
 //! Vitesse maximum
 #define	VITESSE_MAXIMUM 14
 
-//! Numero max. d'aiguillage
+//! Numero max. d'aiguillage, de contact et de loco.
+//! Ces limites peuvent être relevées à la compilation (options CMake QTRAINSIM_MAX_*),
+//! par exemple pour les maquettes synthétiques produites par qtrainsim_generateur.
+#ifndef MAX_AIGUILLAGES
 #define	MAX_AIGUILLAGES 80
+#endif
 
-//! Numero max. de contact
+#ifndef MAX_CONTACTS
 #define MAX_CONTACTS 64
+#endif
 
-//! Numero max. de loco
+#ifndef MAX_LOCOS
 #define	MAX_LOCOS 80
+#endif
+
+//! Numero max. de contact figurant dans la table des distances, dont la taille croît
+//! avec le carré de ce nombre. Au-delà, les distances ne sont pas calculées.
+#ifndef MAX_CONTACTS_DISTANCES
+#define MAX_CONTACTS_DISTANCES (MAX_CONTACTS < 256 ? MAX_CONTACTS : 256)
+#endif
 
 //! Direction des aiguillages
 #define DEVIE 0
 #define TOUT_DROIT 1
 
+//! Enclenchement des aiguillages : sort d'une commande visant un aiguillage occupé
+#define ENCLENCHEMENT_APPLIQUER 0
+#define ENCLENCHEMENT_REFUSER 1
+#define ENCLENCHEMENT_DIFFERER 2
+
 //! Etat des phares
 #define ETEINT 0
 #define ALLUME 1
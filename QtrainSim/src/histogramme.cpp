@@ -0,0 +1,126 @@
+#include <QtAlgorithms>
+
+#include <cmath>
+#include <limits>
+
+#include "histogramme.h"
+
+
+Histogramme::Histogramme()
+{
+    reinitialiser();
+}
+
+int Histogramme::indice(qint64 valeur)
+{
+    // Les premières valeurs ont chacune leur intervalle
+    if (valeur < (qint64(2) << BITS_PRECISION))
+        return int(valeur);
+
+    // Au-delà, on garde les BITS_PRECISION bits suivant le bit de poids fort
+    int poidsFort = 63 - qCountLeadingZeroBits(quint64(valeur));
+    int decalage = poidsFort - BITS_PRECISION;
+    return (decalage << BITS_PRECISION) + int(valeur >> decalage);
+}
+
+qint64 Histogramme::borneInferieure(int indice)
+{
+    if (indice < (2 << BITS_PRECISION))
+        return indice;
+
+    int decalage = (indice >> BITS_PRECISION) - 1;
+    return (qint64(indice & ((1 << BITS_PRECISION) - 1)) + (qint64(1) << BITS_PRECISION)) << decalage;
+}
+
+qint64 Histogramme::largeur(int indice)
+{
+    if (indice < (2 << BITS_PRECISION))
+        return 1;
+
+    return qint64(1) << ((indice >> BITS_PRECISION) - 1);
+}
+
+void Histogramme::enregistrer(qint64 valeur, quint64 nbre)
+{
+    if (valeur < 0)
+        valeur = 0;
+    if (valeur >= (qint64(1) << BITS_MAX))
+        valeur = (qint64(1) << BITS_MAX) - 1;
+
+    compteurs[indice(valeur)].fetch_add(nbre, std::memory_order_relaxed);
+    this->nbre.fetch_add(nbre, std::memory_order_relaxed);
+    somme.fetch_add(valeur * qint64(nbre), std::memory_order_relaxed);
+
+    qint64 actuel = min.load(std::memory_order_relaxed);
+    while (valeur < actuel && !min.compare_exchange_weak(actuel, valeur, std::memory_order_relaxed))
+        ;
+    actuel = max.load(std::memory_order_relaxed);
+    while (valeur > actuel && !max.compare_exchange_weak(actuel, valeur, std::memory_order_relaxed))
+        ;
+}
+
+quint64 Histogramme::getNbre() const
+{
+    return nbre.load(std::memory_order_relaxed);
+}
+
+qint64 Histogramme::getMin() const
+{
+    return getNbre() == 0 ? 0 : min.load(std::memory_order_relaxed);
+}
+
+qint64 Histogramme::getMax() const
+{
+    return getNbre() == 0 ? 0 : max.load(std::memory_order_relaxed);
+}
+
+double Histogramme::getMoyenne() const
+{
+    quint64 n = getNbre();
+    return n == 0 ? 0.0 : double(somme.load(std::memory_order_relaxed)) / n;
+}
+
+qint64 Histogramme::centile(double proportion) const
+{
+    quint64 n = getNbre();
+    if (n == 0)
+        return 0;
+
+    quint64 rang = quint64(std::ceil(proportion * n));
+    if (rang < 1)
+        rang = 1;
+
+    // On retourne la plus grande valeur de l'intervalle, sans dépasser le maximum enregistré
+    quint64 cumul = 0;
+    for (int i = 0; i < NBRE_INTERVALLES; i++)
+    {
+        cumul += compteurs[i].load(std::memory_order_relaxed);
+        if (cumul >= rang)
+            return qMin(borneInferieure(i) + largeur(i) - 1, getMax());
+    }
+    return getMax();
+}
+
+void Histogramme::reinitialiser()
+{
+    for (int i = 0; i < NBRE_INTERVALLES; i++)
+        compteurs[i].store(0, std::memory_order_relaxed);
+    nbre.store(0, std::memory_order_relaxed);
+    somme.store(0, std::memory_order_relaxed);
+    min.store(std::numeric_limits<qint64>::max(), std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+QString Histogramme::resume(double echelle, const QString &unite) const
+{
+    auto valeur = [echelle](double v) { return QString::number(v / echelle, 'f', echelle > 1.0 ? 1 : 0); };
+
+    return QString("n=%1 moy=%2 p50=%3 p90=%4 p99=%5 max=%6%7")
+            .arg(getNbre())
+            .arg(valeur(getMoyenne()))
+            .arg(valeur(centile(0.50)))
+            .arg(valeur(centile(0.90)))
+            .arg(valeur(centile(0.99)))
+            .arg(valeur(getMax()))
+            .arg(unite.isEmpty() ? QString() : " " + unite);
+}
@@ -0,0 +1,93 @@
+#ifndef HISTOGRAMME_H
+#define HISTOGRAMME_H
+
+#include <QString>
+
+#include <atomic>
+
+/**
+ * Histogramme de valeurs entières positives (des durées en µs, par exemple), dans
+ * l'esprit de HdrHistogram : les intervalles sont de largeur constante à l'intérieur
+ * de chaque puissance de deux, ce qui garde une précision relative d'environ 3 %
+ * (2^-BITS_PRECISION) sur toute la plage, de 0 à 2^BITS_MAX, pour une taille fixe.
+ *
+ * L'enregistrement est sans verrou, et assez peu coûteux pour rester actif en
+ * permanence : il peut être appelé depuis n'importe quel thread. Les lectures faites
+ * pendant des enregistrements donnent un état approché, mais cohérent.
+ */
+class Histogramme
+{
+public:
+    Histogramme();
+
+    /** enregistre une valeur. Les valeurs négatives sont comptées comme 0, celles
+      * qui dépassent la plage comme la plus grande valeur de la plage.
+      * \param valeur la valeur.
+      * \param nbre le nombre d'occurrences de la valeur (son poids).
+      */
+    void enregistrer(qint64 valeur, quint64 nbre = 1);
+
+    /** retourne le nombre de valeurs enregistrées.
+      */
+    quint64 getNbre() const;
+
+    /** retourne la plus petite valeur enregistrée, 0 si l'histogramme est vide.
+      */
+    qint64 getMin() const;
+
+    /** retourne la plus grande valeur enregistrée, 0 si l'histogramme est vide.
+      */
+    qint64 getMax() const;
+
+    /** retourne la moyenne des valeurs enregistrées, 0 si l'histogramme est vide.
+      */
+    double getMoyenne() const;
+
+    /** retourne la valeur en dessous de laquelle se trouve une proportion des valeurs
+      * enregistrées, à la précision de l'histogramme près.
+      * \param proportion la proportion, entre 0 et 1 (0.99 pour le 99e centile).
+      * \return la valeur, 0 si l'histogramme est vide.
+      */
+    qint64 centile(double proportion) const;
+
+    /** vide l'histogramme.
+      */
+    void reinitialiser();
+
+    /** retourne un résumé de l'histogramme sur une ligne : nombre de valeurs, moyenne,
+      * médiane, 90e et 99e centiles et maximum.
+      * \param echelle le diviseur appliqué aux valeurs affichées (1000 pour afficher
+      *        en ms des valeurs en µs).
+      * \param unite l'unité des valeurs affichées.
+      */
+    QString resume(double echelle = 1.0, const QString &unite = QString()) const;
+
+private:
+    //! Les intervalles d'une puissance de deux sont au nombre de 2^BITS_PRECISION
+    static const int BITS_PRECISION = 5;
+
+    //! Les valeurs enregistrées sont inférieures à 2^BITS_MAX
+    static const int BITS_MAX = 40;
+
+    static const int NBRE_INTERVALLES = (BITS_MAX - BITS_PRECISION + 1) << BITS_PRECISION;
+
+    /** retourne l'indice de l'intervalle contenant une valeur de la plage.
+      */
+    static int indice(qint64 valeur);
+
+    /** retourne la plus petite valeur d'un intervalle.
+      */
+    static qint64 borneInferieure(int indice);
+
+    /** retourne la largeur d'un intervalle.
+      */
+    static qint64 largeur(int indice);
+
+    std::atomic<quint64> compteurs[NBRE_INTERVALLES];
+    std::atomic<quint64> nbre;
+    std::atomic<qint64> somme;
+    std::atomic<qint64> min;
+    std::atomic<qint64> max;
+};
+
+#endif // HISTOGRAMME_H
@@ -0,0 +1,55 @@
+#include "instantanemonde.h"
+
+InstantaneMonde::InstantaneMonde()
+{
+}
+
+void InstantaneMonde::publier(int numLoco, const PositionLoco &position)
+{
+    if(numLoco < 0 || numLoco > MAX_LOCOS)
+        return;
+
+    Emplacement &e = emplacements[numLoco];
+    unsigned seq = e.sequence.load(std::memory_order_relaxed);
+
+    e.sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    e.contactPrecedent.store(position.contactPrecedent, std::memory_order_relaxed);
+    e.contactSuivant.store(position.contactSuivant, std::memory_order_relaxed);
+    e.distance.store(position.distance, std::memory_order_relaxed);
+    e.vitesse.store(position.vitesse, std::memory_order_relaxed);
+    e.sortie.store(position.sortie, std::memory_order_relaxed);
+    e.valide.store(true, std::memory_order_relaxed);
+
+    e.sequence.store(seq + 2, std::memory_order_release);
+}
+
+bool InstantaneMonde::lire(int numLoco, PositionLoco &position) const
+{
+    if(numLoco < 0 || numLoco > MAX_LOCOS)
+        return false;
+
+    const Emplacement &e = emplacements[numLoco];
+    unsigned avant, apres;
+    bool valide = false;
+
+    do
+    {
+        avant = e.sequence.load(std::memory_order_acquire);
+        if(avant & 1u)
+            continue;
+
+        valide = e.valide.load(std::memory_order_relaxed);
+        position.contactPrecedent = e.contactPrecedent.load(std::memory_order_relaxed);
+        position.contactSuivant = e.contactSuivant.load(std::memory_order_relaxed);
+        position.distance = e.distance.load(std::memory_order_relaxed);
+        position.vitesse = e.vitesse.load(std::memory_order_relaxed);
+        position.sortie = e.sortie.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        apres = e.sequence.load(std::memory_order_relaxed);
+    } while((avant & 1u) || avant != apres);
+
+    return valide;
+}
@@ -0,0 +1,61 @@
+#ifndef INSTANTANEMONDE_H
+#define INSTANTANEMONDE_H
+
+#include <atomic>
+
+#include "general.h"
+
+/**
+ * Position d'une loco telle que publiée par la simulation.
+ */
+struct PositionLoco
+{
+    int contactPrecedent;   //!> Dernier contact franchi (0 si inconnu)
+    int contactSuivant;     //!> Prochain contact devant la loco (0 si buttoir)
+    double distance;        //!> Distance restante jusqu'au contact suivant, en mm
+    int vitesse;            //!> Vitesse réelle (tient compte de l'inertie)
+    int sortie;             //!> Extrémité par laquelle la loco quittera la voie du contact suivant
+};
+
+/**
+ * Instantané de l'état du monde, publié par le thread de simulation à chaque
+ * pas d'animation et lu sans verrou par les threads des programmes clients.
+ *
+ * Chaque emplacement est protégé par un compteur de séquence (seqlock) :
+ * l'unique écrivain rend le compteur impair le temps de l'écriture, et un
+ * lecteur recommence sa lecture si le compteur a changé entre-temps.
+ */
+class InstantaneMonde
+{
+public:
+    InstantaneMonde();
+
+    /** Publie la position d'une loco. A n'appeler que depuis le thread de simulation.
+      * \param numLoco le numéro de la loco.
+      * \param position la position à publier.
+      */
+    void publier(int numLoco, const PositionLoco &position);
+
+    /** Lit la dernière position publiée d'une loco. Ne bloque jamais.
+      * \param numLoco le numéro de la loco.
+      * \param position la position lue.
+      * \return vrai si une position a été publiée pour cette loco, faux sinon.
+      */
+    bool lire(int numLoco, PositionLoco &position) const;
+
+private:
+    struct Emplacement
+    {
+        std::atomic<unsigned> sequence{0};
+        std::atomic<bool> valide{false};
+        std::atomic<int> contactPrecedent{0};
+        std::atomic<int> contactSuivant{0};
+        std::atomic<double> distance{0.0};
+        std::atomic<int> vitesse{0};
+        std::atomic<int> sortie{0};
+    };
+
+    Emplacement emplacements[MAX_LOCOS + 1];
+};
+
+#endif // INSTANTANEMONDE_H
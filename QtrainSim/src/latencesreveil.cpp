@@ -0,0 +1,133 @@
+#include <QJsonArray>
+
+#include <chrono>
+
+#include "latencesreveil.h"
+
+
+namespace
+{
+
+qint64 maintenant()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+QJsonObject resumeJson(int numero, const Histogramme *h)
+{
+    QJsonObject resume;
+    resume["numero"] = numero;
+    resume["n"] = qint64(h->getNbre());
+    resume["moyenne"] = h->getMoyenne() / 1000.0;
+    resume["p50"] = h->centile(0.50) / 1000.0;
+    resume["p99"] = h->centile(0.99) / 1000.0;
+    resume["max"] = h->getMax() / 1000.0;
+    return resume;
+}
+
+}
+
+LatencesReveil::LatencesReveil()
+{
+    for (int i = 0; i <= MAX_CONTACTS; i++)
+    {
+        instants[i] = -1;
+        locosActivation[i] = -1;
+        contacts[i] = nullptr;
+    }
+    for (int i = 0; i <= MAX_LOCOS; i++)
+        locos[i] = nullptr;
+}
+
+LatencesReveil::~LatencesReveil()
+{
+    for (int i = 0; i <= MAX_CONTACTS; i++)
+        delete contacts[i].load();
+    for (int i = 0; i <= MAX_LOCOS; i++)
+        delete locos[i].load();
+}
+
+Histogramme *LatencesReveil::obtenir(std::atomic<Histogramme*> &histogramme)
+{
+    Histogramme *h = histogramme.load(std::memory_order_acquire);
+    if (h == nullptr)
+    {
+        // Deux threads peuvent créer l'histogramme en même temps : un seul est gardé
+        Histogramme *nouveau = new Histogramme();
+        if (histogramme.compare_exchange_strong(h, nouveau, std::memory_order_acq_rel))
+            h = nouveau;
+        else
+            delete nouveau;
+    }
+    return h;
+}
+
+void LatencesReveil::activation(int no_contact, int no_loco)
+{
+    if (no_contact < 0 || no_contact > MAX_CONTACTS)
+        return;
+    locosActivation[no_contact].store(no_loco, std::memory_order_relaxed);
+    instants[no_contact].store(maintenant(), std::memory_order_release);
+}
+
+void LatencesReveil::reveil(int no_contact)
+{
+    if (no_contact < 0 || no_contact > MAX_CONTACTS)
+        return;
+
+    qint64 instant = instants[no_contact].load(std::memory_order_acquire);
+    if (instant < 0)
+        return;
+
+    qint64 latence = maintenant() - instant;
+    obtenir(contacts[no_contact])->enregistrer(latence);
+
+    int no_loco = locosActivation[no_contact].load(std::memory_order_relaxed);
+    if (no_loco >= 0 && no_loco <= MAX_LOCOS)
+        obtenir(locos[no_loco])->enregistrer(latence);
+}
+
+const Histogramme *LatencesReveil::parContact(int no_contact) const
+{
+    if (no_contact < 0 || no_contact > MAX_CONTACTS)
+        return nullptr;
+    return contacts[no_contact].load(std::memory_order_acquire);
+}
+
+const Histogramme *LatencesReveil::parLoco(int no_loco) const
+{
+    if (no_loco < 0 || no_loco > MAX_LOCOS)
+        return nullptr;
+    return locos[no_loco].load(std::memory_order_acquire);
+}
+
+QString LatencesReveil::rapport() const
+{
+    QString texte = "Latences de réveil (activation du contact -> retour de attendre_contact)";
+    for (int i = 0; i <= MAX_LOCOS; i++)
+        if (const Histogramme *h = parLoco(i))
+            texte += QString("\n  loco %1 : %2").arg(i, 3).arg(h->resume(1000.0, "µs"));
+    for (int i = 0; i <= MAX_CONTACTS; i++)
+        if (const Histogramme *h = parContact(i))
+            texte += QString("\n  contact %1 : %2").arg(i, 3).arg(h->resume(1000.0, "µs"));
+    return texte;
+}
+
+QJsonObject LatencesReveil::versJson() const
+{
+    QJsonArray listeLocos;
+    for (int i = 0; i <= MAX_LOCOS; i++)
+        if (const Histogramme *h = parLoco(i))
+            listeLocos.append(resumeJson(i, h));
+
+    QJsonArray listeContacts;
+    for (int i = 0; i <= MAX_CONTACTS; i++)
+        if (const Histogramme *h = parContact(i))
+            listeContacts.append(resumeJson(i, h));
+
+    QJsonObject latences;
+    latences["locos"] = listeLocos;
+    latences["contacts"] = listeContacts;
+    return latences;
+}
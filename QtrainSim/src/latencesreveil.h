@@ -0,0 +1,69 @@
+#ifndef LATENCESREVEIL_H
+#define LATENCESREVEIL_H
+
+#include <QJsonObject>
+#include <QString>
+
+#include <atomic>
+
+#include "general.h"
+#include "histogramme.h"
+
+/**
+ * Latences de réveil des threads du programme client : durée entre l'activation d'un
+ * contact par une loco, dans la simulation, et le retour de attendre_contact() dans le
+ * thread qui attendait ce contact. Elle comprend le réveil du thread, son
+ * ordonnancement par le système, et l'ordre de passage imposé par l'ordonnanceur.
+ *
+ * Les latences sont gardées par contact et par loco (celle qui a activé le contact),
+ * en ns de temps réel. Les enregistrements sont sans verrou : les histogrammes sont
+ * créés à la première latence de leur contact ou de leur loco.
+ */
+class LatencesReveil
+{
+public:
+    LatencesReveil();
+    ~LatencesReveil();
+
+    /** note l'instant de l'activation d'un contact. Appelée par la simulation.
+      * \param no_contact le contact activé.
+      * \param no_loco la loco qui l'a activé.
+      */
+    void activation(int no_contact, int no_loco);
+
+    /** enregistre la latence du réveil d'un thread qui attendait un contact. Sans effet
+      * si le contact n'a pas été activé par la simulation (autres backends).
+      * \param no_contact le contact attendu.
+      */
+    void reveil(int no_contact);
+
+    /** retourne les latences d'un contact, nullptr si aucune n'est enregistrée.
+      */
+    const Histogramme *parContact(int no_contact) const;
+
+    /** retourne les latences des contacts activés par une loco, nullptr si aucune
+      * n'est enregistrée.
+      */
+    const Histogramme *parLoco(int no_loco) const;
+
+    /** retourne le rapport des latences, par loco puis par contact, en µs.
+      */
+    QString rapport() const;
+
+    /** retourne les latences au format du bilan : nombre, moyenne, médiane, 99e
+      * centile et maximum en µs, par loco et par contact.
+      */
+    QJsonObject versJson() const;
+
+private:
+    /** retourne l'histogramme pointé, en le créant s'il n'existe pas encore.
+      */
+    static Histogramme *obtenir(std::atomic<Histogramme*> &histogramme);
+
+    std::atomic<qint64> instants[MAX_CONTACTS + 1];
+    std::atomic<int> locosActivation[MAX_CONTACTS + 1];
+    std::atomic<Histogramme*> contacts[MAX_CONTACTS + 1];
+    std::atomic<Histogramme*> locos[MAX_LOCOS + 1];
+};
+
+#endif // LATENCESREVEIL_H
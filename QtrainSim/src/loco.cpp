@@ -34,6 +34,11 @@ int panneauNumLoco::getNumLoco()
     return numLoco;
 }
 
+int Loco::getNumero()
+{
+    return numLoco1->getNumLoco();
+}
+
 Loco::Loco(int numLoco, QObject *parent) :
     QObject(parent)
 {
@@ -54,20 +59,23 @@ Loco::Loco(int numLoco, QObject *parent) :
     this->alerteProximite = false;
     this->inverser = false;
     this->deraille = false;
-    this->timer = new QTimer(this);
     this->mutex = new QMutex();
     this->VarCond = new QWaitCondition();
     setZValue(ZVAL_LOCO);
-
-    CONNECT(timer, SIGNAL(timeout()), this, SLOT(adapterVitesse()));
 }
 
 void Loco::setVitesse(int v)
 {
+    if(freinAutomatique)
+    {
+        this->vitesseCommandee = v;
+        return;
+    }
+
     if(TrainSimSettings::getInstance()->getInertie())
     {
         this->vitesseFuture = v;
-        this->timer->start(INERTIE_LOCO);
+        demarrerInertie();
     }
     else
     {
@@ -75,6 +83,34 @@ void Loco::setVitesse(int v)
     }
 }
 
+void Loco::setFreinAutomatique(bool b)
+{
+    if(b == freinAutomatique)
+        return;
+
+    if(b)
+    {
+        vitesseCommandee = vitesseFuture;
+        setVitesse(0);
+        freinAutomatique = true;
+    }
+    else
+    {
+        freinAutomatique = false;
+        setVitesse(vitesseCommandee);
+    }
+}
+
+bool Loco::getFreinAutomatique() const
+{
+    return freinAutomatique;
+}
+
+int Loco::getVitesseCommandee() const
+{
+    return freinAutomatique ? vitesseCommandee : vitesseFuture;
+}
+
 int Loco::getVitesse()
 {
     return this->vitesse;
@@ -163,7 +199,11 @@ void Loco::paint(QPainter *painter, const QStyleOptionGraphicsItem */*option*/,
 
 void Loco::setVoie(Voie *v)
 {
+    if(this->voieActuelle != nullptr)
+        this->voieActuelle->sortieLoco(this);
     this->voieActuelle = v;
+    if(v != nullptr)
+        v->entreeLoco(this);
 }
 
 Voie* Loco::getVoie()
@@ -191,6 +231,11 @@ bool Loco::getActive()
     return active;
 }
 
+bool Loco::getDeraille() const
+{
+    return deraille;
+}
+
 #include <iostream>
 #include "mainwindow.h"
 
@@ -211,33 +256,34 @@ void Loco::avanceDUneVoie()
     Voie* viensDe = voieActuelle;
 
     CHECK(voieSuivante != nullptr);
+    voieActuelle->sortieLoco(this);
     voieActuelle = voieSuivante;
+    voieActuelle->entreeLoco(this);
 
     voieSuivante = voieActuelle->getVoieSuivante(viensDe);
     CHECK(voieSuivante != nullptr);
 
     setPos(voieActuelle->getPosAbsLiaison(viensDe));
+    distanceFinVoie = voieActuelle->getLongueurAParcourir();
 
     corrigerAngle(voieActuelle->getNouvelAngle(viensDe));
 
     if(voieActuelle->getContact() != nullptr)
     {
         Contact* ctc1 = voieActuelle->getContact();
-        Contact* ctc2 = nullptr;
-        viensDe = voieActuelle;
-        Voie* v1 = voieSuivante;
-        Voie* v2 = v1->getVoieSuivante(viensDe);
-
-        CHECK(v2 != nullptr);
-
-        while (ctc2 == nullptr)
-        {
-            ctc2 = v1->getContact();
-            viensDe = v1;
-            v1 = v2;
-            v2 = v1->getVoieSuivante(viensDe);
-            CHECK(v2 != nullptr);
-        }
+        Voie* voieContact = nullptr;
+        Voie* avantContact = nullptr;
+
+        distanceEntreContacts = voieActuelle->getLongueurAParcourir() +
+                                longueurJusquAuContact(voieActuelle, voieSuivante, voieContact, avantContact);
+        Contact* ctc2 = voieContact != nullptr ? voieContact->getContact() : nullptr;
+        distanceContactSuivant = distanceEntreContacts;
+        contactPrecedent = ctc1->getNumContact();
+        contactSuivant = ctc2 != nullptr ? ctc2->getNumContact() : 0;
+        sortieContactPrecedent = extremiteVers(voieActuelle, voieSuivante);
+        if(voieContact != nullptr)
+            sortieContactSuivant = extremiteVers(voieContact, voieContact->getVoieSuivante(avantContact));
+        nbreContactsFranchis++;
 
         nouveauSegment(ctc1, ctc2, this);
 
@@ -252,13 +298,18 @@ void Loco::avanceDUneVoie()
 
 void Loco::avancer(qreal distance)
 {
+    distanceParcourue += distance;
+
     qreal dist = distance;
     qreal angle = 0.0;
     qreal rayon = 0.0;
 
     while(true)
     {
+        qreal avant = dist;
         this->voieActuelle->avanceLoco(dist, angle, rayon, this->angleCumule, this->pos(), this->voieSuivante);
+        distanceContactSuivant -= avant - dist;
+        distanceFinVoie -= avant - dist;
 
         if(rayon == 0.0)
         {
@@ -319,6 +370,115 @@ void Loco::setSegmentActuel(Segment *s)
     this->segmentActuel = s;
 }
 
+void Loco::initialiserPosition()
+{
+    Voie* devant = nullptr;
+    Voie* avantDevant = nullptr;
+    Voie* derriere = nullptr;
+    Voie* avantDerriere = nullptr;
+    qreal demiVoie = voieActuelle->getLongueurAParcourir() / 2.0;
+    distanceFinVoie = demiVoie;
+
+    distanceContactSuivant = demiVoie + longueurJusquAuContact(voieActuelle, voieSuivante, devant, avantDevant);
+    distanceEntreContacts = distanceContactSuivant + demiVoie;
+
+    Voie* voiePrecedente = voieActuelle->getVoieSuivante(voieSuivante);
+    if(voiePrecedente != nullptr)
+        distanceEntreContacts += longueurJusquAuContact(voieActuelle, voiePrecedente, derriere, avantDerriere);
+    if(derriere != nullptr)
+        distanceEntreContacts += derriere->getLongueurAParcourir();
+
+    contactSuivant = devant != nullptr ? devant->getContact()->getNumContact() : 0;
+    contactPrecedent = derriere != nullptr ? derriere->getContact()->getNumContact() : 0;
+    if(devant != nullptr)
+        sortieContactSuivant = extremiteVers(devant, devant->getVoieSuivante(avantDevant));
+    if(derriere != nullptr)
+        sortieContactPrecedent = extremiteVers(derriere, avantDerriere);
+}
+
+int Loco::getContactPrecedent()
+{
+    return this->contactPrecedent;
+}
+
+int Loco::getContactSuivant()
+{
+    return this->contactSuivant;
+}
+
+qreal Loco::getDistanceContactSuivant()
+{
+    return this->distanceContactSuivant > 0.0 ? this->distanceContactSuivant : 0.0;
+}
+
+qreal Loco::getDistanceEntreContacts()
+{
+    return this->distanceEntreContacts;
+}
+
+unsigned Loco::getNbreContactsFranchis()
+{
+    return this->nbreContactsFranchis;
+}
+
+qreal Loco::longueurJusquAuContact(Voie* voieDepart, Voie* v, Voie* &voieContact, Voie* &avantContact)
+{
+    qreal longueur = 0.0;
+    Voie* viensDe = voieDepart;
+
+    voieContact = nullptr;
+    while(v != nullptr && v != voieDepart)
+    {
+        if(v->getContact() != nullptr)
+        {
+            voieContact = v;
+            avantContact = viensDe;
+            break;
+        }
+        longueur += v->getLongueurAParcourir();
+        Voie* suivante = v->getVoieSuivante(viensDe);
+        viensDe = v;
+        v = suivante;
+    }
+    return longueur;
+}
+
+qreal Loco::getDistanceFinVoie() const
+{
+    return distanceFinVoie > 0.0 ? distanceFinVoie : 0.0;
+}
+
+qreal Loco::getDistanceParcourue() const
+{
+    return distanceParcourue;
+}
+
+int Loco::getSortieContactSuivant()
+{
+    return this->sortieContactSuivant;
+}
+
+int Loco::extremiteVers(Voie* v, Voie* voisine)
+{
+    return v->getVoieVoisineDOrdre(0) == voisine ? 0 : 1;
+}
+
+void Loco::inverserPosition()
+{
+    int c = contactPrecedent;
+    contactPrecedent = contactSuivant;
+    contactSuivant = c;
+
+    // En sens inverse, la loco quitte chaque voie de contact par l'autre extrémité
+    int e = sortieContactPrecedent;
+    sortieContactPrecedent = 1 - sortieContactSuivant;
+    sortieContactSuivant = 1 - e;
+    distanceContactSuivant = distanceEntreContacts - distanceContactSuivant;
+    if(distanceContactSuivant < 0.0)
+        distanceContactSuivant = 0.0;
+    distanceFinVoie = qMax(qreal(0.0), voieActuelle->getLongueurAParcourir() - distanceFinVoie);
+}
+
 void Loco::setAlerteProximite(bool b)
 {
     this->alerteProximite = b;
@@ -334,12 +494,21 @@ QPolygonF Loco::getContour()
     return mapToScene(QRectF(-LONGUEUR_LOCO / 2.0, -LARGEUR_LOCO / 2.0, LONGUEUR_LOCO, LARGEUR_LOCO));
 }
 
+void Loco::getCoins(QPointF coins[4]) const
+{
+    QTransform t = sceneTransform();
+    coins[0] = t.map(QPointF(-LONGUEUR_LOCO / 2.0, -LARGEUR_LOCO / 2.0));
+    coins[1] = t.map(QPointF(LONGUEUR_LOCO / 2.0, -LARGEUR_LOCO / 2.0));
+    coins[2] = t.map(QPointF(LONGUEUR_LOCO / 2.0, LARGEUR_LOCO / 2.0));
+    coins[3] = t.map(QPointF(-LONGUEUR_LOCO / 2.0, LARGEUR_LOCO / 2.0));
+}
+
 void Loco::inverserSens()
 {
     if(TrainSimSettings::getInstance()->getInertie())
     {
         inverser = true;
-        this->timer->start(INERTIE_LOCO);
+        demarrerInertie();
     }
     else
     {
@@ -348,6 +517,7 @@ void Loco::inverserSens()
         voieSuivante = voieActuelle->getVoieSuivante(viensDe);
         CHECK(voieSuivante != nullptr);
         this->angleCumule -= 180.0;
+        inverserPosition();
     }
 }
 
@@ -377,11 +547,34 @@ void Loco::voieVariableModifiee(Voie *v)
     if(v == voieActuelle)
     {
         deraille = true;
-        vitesse = vitesseFuture = 0;
+        vitesse = vitesseFuture = vitesseCommandee = 0;
         setRotation(rotation()+20.0);
     }
 }
 
+void Loco::demarrerInertie()
+{
+    inertieEnCours = true;
+    pasAvantCran = PAS_INERTIE;
+}
+
+void Loco::pasInertie()
+{
+    if(!inertieEnCours || --pasAvantCran > 0)
+        return;
+
+    pasAvantCran = PAS_INERTIE;
+    adapterVitesse();
+}
+
+qreal Loco::distanceFreinage(int vitesse, bool inertie)
+{
+    qreal distance = vitesse * 1000.0 / FRAME_RATE * FACTEUR_VITESSE;
+    if(inertie)
+        distance += FACTEUR_VITESSE * PAS_INERTIE * 1000.0 / FRAME_RATE * vitesse * (vitesse + 1) / 2.0;
+    return distance;
+}
+
 void Loco::adapterVitesse()
 {
     if(inverser)
@@ -396,6 +589,7 @@ void Loco::adapterVitesse()
             voieSuivante = voieActuelle->getVoieSuivante(viensDe);
             CHECK(voieSuivante != nullptr);
             this->angleCumule -= 180.0;
+            inverserPosition();
             inverser = false;
         }
     }
@@ -406,6 +600,6 @@ void Loco::adapterVitesse()
         else if(vitesse - vitesseFuture > 0)
             vitesse--;
         else
-            timer->stop();
+            inertieEnCours = false;
     }
 }
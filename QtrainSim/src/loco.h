@@ -5,7 +5,6 @@
 #include <QAbstractGraphicsShapeItem>
 #include <QStaticText>
 #include <QPainter>
-#include <QTimer>
 
 #include "general.h"
 #include "voie.h"
@@ -51,6 +50,10 @@ public:
       */
     explicit Loco(int numLoco, QObject *parent = 0);
 
+    /** retourne le numéro de la loco.
+      */
+    int getNumero();
+
     /** Permet de changer la vitesse de la loco.
       * Le comportement dépend de l'option "Inertie" :
       * avec l'inertie, le changement sera progressif.
@@ -59,6 +62,22 @@ public:
       */
     void setVitesse(int v);
 
+    /** serre ou desserre le frein automatique. Serré, il arrête la loco (progressivement
+      * avec l'inertie) quelle que soit la vitesse commandée ; celle-ci est retenue, et
+      * reprise au desserrage.
+      * \param b vrai pour serrer le frein.
+      */
+    void setFreinAutomatique(bool b);
+
+    /** indique si le frein automatique est serré.
+      */
+    bool getFreinAutomatique() const;
+
+    /** retourne la vitesse commandée, retenue tant que le frein automatique est serré.
+      * \return la vitesse commandée.
+      */
+    int getVitesseCommandee() const;
+
     /** Retourne la vitesse actuelle de la loco.
       * \return la vitesse actuelle de la loco.
       */
@@ -127,6 +146,11 @@ public:
       */
     bool getActive();
 
+    /** indique si la loco a déraillé (aiguillage changé sous elle).
+      * \return vrai si la loco a déraillé.
+      */
+    bool getDeraille() const;
+
     /** effectue la transition d'une voie à l'autre et repositionne la loco (corrige les imprécisions de calcul).
       *
       */
@@ -178,6 +202,12 @@ public:
       */
     QPolygonF getContour();
 
+    /** donne les quatre coins du contour de la loco en coordonnées de la scène,
+      * dans l'ordre du contour, sans réserver de mémoire.
+      * \param coins le tableau des coins à remplir.
+      */
+    void getCoins(QPointF coins[4]) const;
+
     /** Inverse le sens de la loco en conservant ou retrouvant la vitesse initiale.
       * Le comportement dépend de l'option "Inertie" :
       * avec l'inertie, le changement sera progressif.
@@ -190,6 +220,68 @@ public:
       */
     void corrigerAngle(qreal nouvelAngle);
 
+    /** Fait avancer l'inertie de la loco d'un pas d'animation : la vitesse (ou
+      * l'inversion en cours) progresse d'un cran tous les PAS_INERTIE pas.
+      */
+    void pasInertie();
+
+    /** retourne la distance parcourue par une loco avant de s'arrêter, freinée à la
+      * vitesse donnée : un pas d'animation sans inertie, un cran de vitesse tous les
+      * PAS_INERTIE pas avec l'inertie.
+      * \param vitesse la vitesse de la loco.
+      * \param inertie vrai si l'inertie est active.
+      * \return la distance en mm.
+      */
+    static qreal distanceFreinage(int vitesse, bool inertie);
+
+    /** Initialise le suivi de position lorsque la loco est posée au milieu de sa voie
+      * actuelle, entre deux contacts.
+      */
+    void initialiserPosition();
+
+    /** retourne le numéro du dernier contact franchi par la loco.
+      * \return le numéro du contact, 0 s'il n'est pas connu.
+      */
+    int getContactPrecedent();
+
+    /** retourne le numéro du prochain contact devant la loco.
+      * \return le numéro du contact, 0 si la loco se dirige vers un buttoir.
+      */
+    int getContactSuivant();
+
+    /** retourne la distance restant à parcourir jusqu'au prochain contact.
+      * \return la distance en mm.
+      */
+    qreal getDistanceContactSuivant();
+
+    /** retourne la distance entre le contact précédent et le contact suivant,
+      * dans le sens de marche actuel de la loco.
+      * \return la distance en mm.
+      */
+    qreal getDistanceEntreContacts();
+
+    /** retourne le nombre de contacts franchis par la loco depuis qu'elle a été posée.
+      * Permet de détecter un changement de segment entre deux pas d'animation.
+      * \return le nombre de contacts franchis.
+      */
+    unsigned getNbreContactsFranchis();
+
+    /** retourne la distance restant à parcourir sur la voie actuelle.
+      * \return la distance en mm.
+      */
+    qreal getDistanceFinVoie() const;
+
+    /** retourne la distance parcourue par la loco depuis sa création, dans un sens ou
+      * dans l'autre.
+      * \return la distance en mm.
+      */
+    qreal getDistanceParcourue() const;
+
+    /** retourne l'extrémité par laquelle la loco quittera la voie du contact suivant.
+      * \return l'ordre de l'extrémité (0 ou 1).
+      */
+    int getSortieContactSuivant();
+
     LocoCtrl *controller;
 signals:
 
@@ -211,15 +303,41 @@ public slots:
       */
     void locoSurSegment(Segment* s);
 
-    /** Reçoit l'indication qu'une voie variable a été modifiée.
+    /** Reçoit l'indication que la voie variable sur laquelle se trouve la loco a été modifiée.
       * \param v la voie variable modifiée.
       */
     void voieVariableModifiee(Voie* v);
-
-    /** Reçoit le signal qu'il faut adapter la vitesse d'un incrément / décrément.
+private:
+    /** Adapte la vitesse d'un incrément / décrément.
       */
     void adapterVitesse();
-private:
+
+    /** (Re)démarre l'adaptation progressive de la vitesse : le prochain cran aura lieu
+      * dans PAS_INERTIE pas d'animation.
+      */
+    void demarrerInertie();
+
+    /** Parcourt les voies depuis voieDepart (exclue) dans le sens de voieDepart vers v,
+      * jusqu'à la prochaine voie portant un contact.
+      * \param voieDepart la voie de départ.
+      * \param v la voie suivant voieDepart.
+      * \param voieContact la voie portant le contact trouvé, nullptr s'il n'y en a pas (buttoir ou boucle).
+      * \param avantContact la voie parcourue juste avant la voie du contact.
+      * \return la longueur des voies parcourues, voie du contact exclue.
+      */
+    qreal longueurJusquAuContact(Voie* voieDepart, Voie* v, Voie* &voieContact, Voie* &avantContact);
+
+    /** Met à jour le suivi de position lorsque la loco change de sens.
+      */
+    void inverserPosition();
+
+    /** retourne l'ordre de l'extrémité de la voie v reliée à la voie voisine.
+      * \param v la voie.
+      * \param voisine la voie voisine.
+      * \return 0 si voisine est liée à l'extrémité d'ordre 0, 1 sinon.
+      */
+    static int extremiteVers(Voie* v, Voie* voisine);
+
     panneauNumLoco* numLoco1{nullptr};
     panneauNumLoco* numLoco2{nullptr};
     qreal angleCumule;
@@ -231,10 +349,22 @@ private:
     Voie* voieActuelle{nullptr};
     Voie* voieSuivante{nullptr};
     Segment* segmentActuel{nullptr};
+    int contactPrecedent{0};
+    int contactSuivant{0};
+    qreal distanceContactSuivant{0.0};
+    qreal distanceEntreContacts{0.0};
+    unsigned nbreContactsFranchis{0};
+    int sortieContactPrecedent{0};
+    int sortieContactSuivant{0};
+    qreal distanceFinVoie{0.0};
+    qreal distanceParcourue{0.0};
+    bool freinAutomatique{false};
+    int vitesseCommandee{0};
     bool alerteProximite;
     bool inverser;
     bool deraille;
-    QTimer* timer{nullptr};
+    bool inertieEnCours{false};
+    int pasAvantCran{0};
     QWaitCondition* VarCond{nullptr};
     QMutex* mutex{nullptr};
 };
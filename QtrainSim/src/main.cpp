@@ -1,4 +1,6 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QJsonObject>
 #include <QSettings>
 #include <QDebug>
 
@@ -12,21 +14,142 @@ using namespace std;
 
 //Header for CommandeTrain
 #include "commandetrain.h"
+#include "backendnul.h"
+#include "backendrejeu.h"
+#include "backendsimulateur.h"
+#include "trainsimsettings.h"
+#include "profilverrous.h"
 
 /**
  * Programme principal
  */
 int main(int argc, char *argv[])
 {
+    //Without the simulator, or without its window, no window is shown
+    for (int i = 1; i < argc; i++)
+    {
+        QString arg(argv[i]);
+        bool sansSimulateur = (arg == "--backend" && i + 1 < argc && QString(argv[i + 1]) != "simulateur") ||
+                              (arg.startsWith("--backend=") && arg != "--backend=simulateur") ||
+                              arg == "--sans-fenetre";
+        if (sansSimulateur && qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
 
     QApplication app(argc,argv);
 
+    //Backend executing the client commands (simulator by default)
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption optionBackend("backend", "Backend des commandes : simulateur, nul, trace ou rejeu.", "nom", "simulateur");
+    QCommandLineOption optionTrace("trace", "Trace à rejouer (backends trace et rejeu).", "fichier");
+    QCommandLineOption optionCadence("cadence", "Activations rejouées par seconde, 0 au plus vite (backend trace).", "n", "0");
+    QCommandLineOption optionEnregistrer("enregistrer", "Enregistre les contacts et les commandes dans une trace, à rejouer avec le backend rejeu.", "fichier");
+    QCommandLineOption optionGraine("graine", "Graine de la simulation, transmise au programme client (tirée au hasard par défaut).", "n");
+    QCommandLineOption optionScenario("scenario", "Scénario à charger par le programme client, à la place de sa configuration par défaut.", "fichier");
+    QCommandLineOption optionSansFenetre("sans-fenetre", "Simulation sans fenêtre, démarrée d'office. Elle se termine avec le programme client, à la première collision ou après --duree.");
+    QCommandLineOption optionAcceleration("acceleration", "Pas de simulation calculés par affichage (1 par défaut).", "n", "1");
+    QCommandLineOption optionDuree("duree", "Durée simulée maximale, en secondes (0 par défaut, sans limite).", "secondes", "0");
+    QCommandLineOption optionBilan("bilan", "Ecrit le bilan de la simulation (tours, attentes de la section partagée, collisions, déraillements) au format JSON.", "fichier");
+    QCommandLineOption optionLatences("latences", "Affiche à la fin les latences de réveil des threads du programme client, par loco et par contact.");
+    QCommandLineOption optionFreinageAuto("freinage-auto", "Freine automatiquement les locos trop proches de la loco qui les précède, indépendamment du programme client.");
+    QCommandLineOption optionProfilVerrous("profil-verrous", "Mesure l'attente, la détention et les contentions des verrous, et affiche à la fin les n dont l'attente totale est la plus longue.", "n");
+    parser.addOption(optionBackend);
+    parser.addOption(optionTrace);
+    parser.addOption(optionCadence);
+    parser.addOption(optionEnregistrer);
+    parser.addOption(optionGraine);
+    parser.addOption(optionScenario);
+    parser.addOption(optionSansFenetre);
+    parser.addOption(optionAcceleration);
+    parser.addOption(optionDuree);
+    parser.addOption(optionBilan);
+    parser.addOption(optionLatences);
+    parser.addOption(optionProfilVerrous);
+    parser.addOption(optionFreinageAuto);
+    parser.process(app);
+
+    BackendTrain *backend = BackendTrain::creer(parser.value(optionBackend), parser.value(optionTrace),
+                                                parser.value(optionCadence).toDouble());
+    if (backend == nullptr)
+    {
+        cerr << "Backend " << qPrintable(parser.value(optionBackend)) << " inconnu, ou trace illisible." << endl;
+        return -1;
+    }
+    CommandeTrain::getInstance()->setBackend(backend);
+
+    BackendSimulateur *simulateur = dynamic_cast<BackendSimulateur*>(backend);
+    if (simulateur != nullptr)
+        simulateur->setSansFenetre(parser.isSet(optionSansFenetre));
+
+    //Simulated time, not wall-clock time, drives the duration and the report
+    TrainSimSettings::getInstance()->setAcceleration(parser.value(optionAcceleration).toInt());
+    TrainSimSettings::getInstance()->setFreinageAutomatique(parser.isSet(optionFreinageAuto));
+    BilanSimulation *bilan = CommandeTrain::getInstance()->getBilan();
+    bilan->setDureeMax(parser.value(optionDuree).toDouble());
+
+    CommandeTrain::getInstance()->setScenario(parser.value(optionScenario));
+
+    ProfilVerrous::getInstance()->setActif(parser.isSet(optionProfilVerrous));
+
+    //The seed must be known before the trace is recorded
+    Ordonnanceur *ordonnanceur = CommandeTrain::getInstance()->getOrdonnanceur();
+    if (parser.isSet(optionGraine))
+        ordonnanceur->setGraine(parser.value(optionGraine).toUInt());
+
+    //A replay restores the seed and the scheduling of the recorded run
+    BackendRejeu *rejeu = dynamic_cast<BackendRejeu*>(backend);
+    if (rejeu != nullptr)
+    {
+        quint32 graine;
+        if (rejeu->getGraine(graine))
+            ordonnanceur->setGraine(graine);
+        ordonnanceur->rejouer(rejeu->getDecisions());
+    }
+
+    if (parser.isSet(optionEnregistrer) && !CommandeTrain::getInstance()->enregistrer(parser.value(optionEnregistrer)))
+    {
+        cerr << "Impossible de créer la trace " << qPrintable(parser.value(optionEnregistrer)) << endl;
+        return -1;
+    }
+
     //Init the marklin maquette
 #ifdef MAQUETTE
     init_maquette();
 #endif
 
-    //Init the simulator GUI
+    //Init the backend (the simulator GUI by default)
     CommandeTrain::getInstance()->init_maquette();
-    return app.exec();
+    int resultat = app.exec();
+
+    if (parser.isSet(optionBilan))
+    {
+        QJsonObject entete;
+        entete["scenario"] = parser.value(optionScenario);
+        entete["graine"] = qint64(ordonnanceur->getGraine());
+        entete["acceleration"] = TrainSimSettings::getInstance()->getAcceleration();
+        entete["resultat_client"] = CommandeTrain::getInstance()->getResultatClient();
+        entete["latences_reveil"] = CommandeTrain::getInstance()->getLatences()->versJson();
+        if (!bilan->ecrire(parser.value(optionBilan), entete))
+        {
+            cerr << "Impossible d'écrire le bilan " << qPrintable(parser.value(optionBilan)) << endl;
+            return -1;
+        }
+    }
+
+    if (parser.isSet(optionLatences))
+        cout << qPrintable(CommandeTrain::getInstance()->getLatences()->rapport()) << endl;
+
+    if (ProfilVerrous::estActif())
+        cout << qPrintable(ProfilVerrous::getInstance()->rapport(parser.value(optionProfilVerrous).toInt())) << endl;
+
+    BackendNul *nul = dynamic_cast<BackendNul*>(backend);
+    if (nul != nullptr)
+        cout << "Contacts attendus : " << nul->getNbreContacts() << ", commandes : " << nul->getNbreCommandes() << endl;
+
+    //A replay that diverged from its trace is a failure
+    if (rejeu != nullptr && rejeu->getNbreDivergences() + ordonnanceur->getNbreDivergences() > 0)
+        return 1;
+
+    return resultat;
 }
@@ -15,6 +15,7 @@
 #include "mainwindow.h"
 #include "trainsimsettings.h"
 #include "maquettemanager.h"
+#include "maquettecompilee.h"
 
  void outcallback( const char* ptr, std::streamsize count, void* pTextBox )
  {
@@ -57,74 +58,11 @@ MainWindow::MainWindow(QWidget *parent) :
     myRedirector = new StdRedirector<>( std::cout, outcallback, generalConsole );
 
     //Lecture des informations des voies.
-    QFile fichierInfosVoies(DATADIR+"/infosVoies.txt");
-    if (!fichierInfosVoies.open(QIODevice::ReadOnly))
+    if (!chargeur.chargerInfosVoies(DATADIR+"/infosVoies.txt"))
     {
-        QMessageBox::critical(0,"Erreur",QString("Le fichier de description des voies ne peut être trouvé. Vérifiez qu'il est bien présent dans le répertoire parent de l'exécutable.\n Le nom du fichier est: %1.\nAvez-vous effectué un \"make install\"?").arg(fichierInfosVoies.fileName()));
-        exit(0);
+        signalerErreur(0,"Erreur",QString("Le fichier de description des voies ne peut être trouvé. Vérifiez qu'il est bien présent dans le répertoire parent de l'exécutable.\n Le nom du fichier est: %1.\nAvez-vous effectué un \"make install\"?").arg(DATADIR+"/infosVoies.txt"));
+        exit(-1);
     }
-    QTextStream lecture(&fichierInfosVoies);
-
-    QString ligne;
-
-    QStringList ligneDecoupee;
-
-    QList<double>* description;
-
-    ligne = lecture.readLine();
-
-    while(!ligne.startsWith("EOF"))
-    {
-#ifdef USING_QT5
-        ligneDecoupee = ligne.split(QRegExp("\\s+"), Qt::SkipEmptyParts);
-#else
-        ligneDecoupee = ligne.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-#endif
-        description = new QList<double>();
-
-        /* En l'etat, le programme gere 6 types de voies differentes :
-         * - droite : caracterisees par leur longueur.
-         * - courbe : caracterisees par leur rayon de courbure, et l'angle parcouru.
-         * - aiguillage : caracterisees par leur rayon de courbure et l'angle parcouru (pour la partie courbe)
-         *                et par leur longueur (pour la partie droite).
-         * - croisement : caracterisees par leur longueur (pour les deux parties droites) et l'angle aigu entre les deux parties droites.
-         *                Les parties droites se croisent toujours en leur milieu.
-         * - traversee-jonction : caracterisees par leur longueur (pour les deux parties droites, le rayon de courbure des parties courbes,
-         *                        et l'angle parcouru.
-         * - buttoir : caracterisees par leur longueur (utile uniquement pour le dessin.
-         *
-         * Il est possible d'ajouter des types de voies. Referez-vous a la documentation.
-         */
-        if(ligneDecoupee.at(1) == "droite")
-            description->append(1.0);
-        else if(ligneDecoupee.at(1) == "courbe")
-            description->append(2.0);
-        else if(ligneDecoupee.at(1) == "aiguillage")
-            description->append(3.0);
-        else if(ligneDecoupee.at(1) == "croisement")
-            description->append(4.0);
-        else if(ligneDecoupee.at(1) == "traversee-jonction")
-            description->append(5.0);
-        else if(ligneDecoupee.at(1) == "buttoir")
-            description->append(6.0);
-        else if(ligneDecoupee.at(1) == "aiguillageEnroule")
-            description->append(7.0);
-        else if(ligneDecoupee.at(1) == "aiguillageTriple")
-            description->append(8.0);
-
-
-        for(int i =2; i < ligneDecoupee.length(); i++)
-        {
-            description->append(ligneDecoupee.at(i).toDouble());
-        }
-
-        //chargement des informations des voies dans la QMap idoine.
-        infosVoies.insert(ligneDecoupee.at(0).toInt(), description);
-
-        ligne = lecture.readLine();
-
-    }
-
 
     m_state=PAUSE;
 
@@ -149,6 +87,12 @@ MainWindow::MainWindow(QWidget *parent) :
     QStatusBar *status=new QStatusBar(this);
     setStatusBar(status);
     status->addPermanentWidget(statusLabel);
+
+    profilLabel=new QLabel(this);
+    profilLabel->setVisible(false);
+    status->addWidget(profilLabel);
+    profilTimer=new QTimer(this);
+    CONNECT(profilTimer, SIGNAL(timeout()), this, SLOT(updateProfil()));
     status->showMessage(tr("Pret a l'utilisation"));
 
     readSettings();
@@ -329,15 +273,24 @@ void MainWindow::toggleLoco(QObject *locoCtrl)
 
 #include <QMessageBox>
 
+void MainWindow::signalerErreur(QWidget *parent, const QString &titre, const QString &message)
+{
+    if (TrainSimSettings::getInstance()->getSansFenetre())
+        std::cerr << qPrintable(titre) << " : " << qPrintable(message) << std::endl;
+    else
+        QMessageBox::warning(parent, titre, message);
+}
+
 void MainWindow::afficherMessageLoco(int numLoco,QString message)
 {
     for(int i=0;i<locoCtrls.size();i++)
         if (locoCtrls.at(i)->loco==numLoco)
         {
+            MesurePhase mesure(simView->getProfil(), ProfilImages::CONSOLE);
             locoCtrls.at(i)->console->append(message);
             return;
         }
-    QMessageBox::warning(this,"Numéro de loco",QString(
+    signalerErreur(this,"Numéro de loco",QString(
                              "Attention, pour l'affichage dans la console, le\
                              numero de loco %1 n'est pas valide").arg(numLoco));
 }
@@ -470,6 +423,19 @@ void MainWindow::createActions()
     viewLocoLogAct->setCheckable(true);
     CONNECT(viewLocoLogAct, SIGNAL(triggered()), this, SLOT(viewLocoLog()));
 
+    viewLatencesAct = new QAction(tr("View wake-up latencies"), this);
+    viewLatencesAct->setStatusTip(tr("Print the wake-up latencies of the client threads in the console"));
+    CONNECT(viewLatencesAct, SIGNAL(triggered()), this, SLOT(viewLatences()));
+
+    viewProfilAct = new QAction(tr("View frame profile"), this);
+    viewProfilAct->setStatusTip(tr("Show the mean duration of each phase of a frame, and the worst frame"));
+    viewProfilAct->setCheckable(true);
+    CONNECT(viewProfilAct, SIGNAL(triggered()), this, SLOT(viewProfil()));
+
+    saveTraceImagesAct = new QAction(tr("Save frame trace..."), this);
+    saveTraceImagesAct->setStatusTip(tr("Save the last frames in a Chrome trace (chrome://tracing)"));
+    CONNECT(saveTraceImagesAct, SIGNAL(triggered()), this, SLOT(saveTraceImages()));
+
     viewInputAct = inputDock->toggleViewAction();
 
     inertieAct = new QAction(tr("Inertia"), this);
@@ -477,6 +443,13 @@ void MainWindow::createActions()
     inertieAct->setStatusTip(tr("Enable inertia"));
     inertieAct->setCheckable(true);
     CONNECT(inertieAct, SIGNAL(triggered()), this, SLOT(toggleInertie()));
+
+    // Non enregistré dans les réglages : il masquerait les erreurs de synchronisation
+    freinageAutoAct = new QAction(tr("Automatic train protection"), this);
+    freinageAutoAct->setStatusTip(tr("Brake the locos that come too close to the loco ahead"));
+    freinageAutoAct->setCheckable(true);
+    freinageAutoAct->setChecked(TrainSimSettings::getInstance()->getFreinageAutomatique());
+    CONNECT(freinageAutoAct, SIGNAL(triggered()), this, SLOT(toggleFreinageAuto()));
 }
 
 void MainWindow::createMenus()
@@ -505,9 +478,13 @@ void MainWindow::createMenus()
     view->addAction(viewContactNumberAct);
     view->addAction(viewAiguillageNumberAct);
     view->addAction(viewInputAct);
+    view->addAction(viewLatencesAct);
+    view->addAction(viewProfilAct);
+    view->addAction(saveTraceImagesAct);
 
     QMenu *settings=menuBar()->addMenu(tr("&Settings"));
     settings->addAction(inertieAct);
+    settings->addAction(freinageAutoAct);
 }
 
 #include <QPrintDialog>
@@ -558,11 +535,47 @@ void MainWindow::viewLocoLog()
     TrainSimSettings::getInstance()->setViewLocoLog(viewLocoLogAct->isChecked());
 }
 
+void MainWindow::viewLatences()
+{
+    afficherMessage(CMD_TRAIN->getLatences()->rapport());
+}
+
+void MainWindow::viewProfil()
+{
+    profilLabel->setVisible(viewProfilAct->isChecked());
+    if (viewProfilAct->isChecked())
+    {
+        updateProfil();
+        profilTimer->start(500);
+    }
+    else
+        profilTimer->stop();
+}
+
+void MainWindow::updateProfil()
+{
+    profilLabel->setText(simView->getProfil().resume());
+}
+
+void MainWindow::saveTraceImages()
+{
+    QString fichier = QFileDialog::getSaveFileName(this, tr("Save frame trace"), "images.json", tr("Chrome trace (*.json)"));
+    if (fichier.isEmpty())
+        return;
+    if (!simView->getProfil().ecrireTrace(fichier))
+        QMessageBox::warning(this, tr("Error"), tr("Cannot write %1").arg(fichier));
+}
+
 void MainWindow::toggleInertie()
 {
     TrainSimSettings::getInstance()->setInertie(inertieAct->isChecked());
 }
 
+void MainWindow::toggleFreinageAuto()
+{
+    TrainSimSettings::getInstance()->setFreinageAutomatique(freinageAutoAct->isChecked());
+}
+
 SimView* MainWindow::getSimView()
 {
     return simView;
@@ -570,7 +583,7 @@ SimView* MainWindow::getSimView()
 
 void MainWindow::on_actionCharger_Maquette_triggered()
 {
-    QString filename = QFileDialog::getOpenFileName(this, tr("Ouvrir un fichier Maquette"), DATADIR+"/Maquettes", tr("Text Files (*.txt)"));
+    QString filename = QFileDialog::getOpenFileName(this, tr("Ouvrir un fichier Maquette"), DATADIR+"/Maquettes", tr("Maquettes (*.txt *.qtm)"));
     chargerMaquette(filename);
 }
 
@@ -578,276 +591,40 @@ void MainWindow::chargerMaquette(QString filename)
 {
     this->simView->viderMaquette();
 
-    // stockage temporaire des voies, avec les identifiants des voies a lier.
-    QMap <Voie*, QList<int>*> voiesALier;
-    // stockage temporaire des voies, indexees par identifiants.
-    QMap <int, Voie*> IDVoies;
-
-    QStringList listeTemporaire;
-    QList<qreal>* infosVoieEnTraitement;
-    int IDvoie;
-    qreal directionVoieEnTraitement;
+    // Une maquette compilée est déjà construite
+    bool compilee = filename.endsWith(MaquetteCompilee::EXTENSION, Qt::CaseInsensitive);
 
-    QFile fichier(filename);
-
-    if(!fichier.open(QIODevice::ReadOnly | QIODevice::Text))
-    {
-        //declaration d'erreur.
-    }
-
-    QTextStream lecture(&fichier);
-    QString ligne;
-    bool premiereInfoValide;
-    int limite;
-
-    //avance rapide pour passer une eventuelle introduction.
-
-    ligne = lecture.readLine();
-
-    listeTemporaire = ligne.split(" ", Qt::SkipEmptyParts);
-
-    limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
-
-    while((listeTemporaire.length() != 1) && !premiereInfoValide)
+    // Une maquette texte est reprise du cache si ni elle ni infosVoies.txt n'ont changé
+    if(compilee ? !chargeur.chargerMaquetteCompilee(filename, this->simView)
+                : !chargeur.chargerMaquetteConstruite(filename, this->simView))
     {
-        if(lecture.atEnd())
-            qDebug() << "Erreur de lecture de fichier : fichier non standard. (nombre de voies mal indique)";
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", Qt::SkipEmptyParts);
-
-        limite = listeTemporaire.at(0).toInt(&premiereInfoValide);
-
+        signalerErreur(this,"Erreur",QString("Le fichier maquette %1 ne peut être lu!\nL'application va se terminer.").arg(filename));
+        exit(-1);
     }
 
-    // lecture des informations relatives aux voies, creation des voies.
-
-    VoieDroite* vd;
-    VoieCourbe* vc;
-    VoieAiguillage* va;
-    VoieAiguillageEnroule* vae;
-    VoieAiguillageTriple* vat;
-    VoieCroisement* vcr;
-    VoieTraverseeJonction* vt;
-    VoieButtoir* vb;
-
-    for(int i =0; i < limite; i++)
-    {
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", Qt::SkipEmptyParts);
-
-        IDvoie = listeTemporaire.at(0).toInt();
-
-        //recuperation des infos de la voie en traitement.
-        infosVoieEnTraitement = infosVoies[listeTemporaire.at(1).toInt()];
-
-        if(infosVoieEnTraitement->at(0) == 1.0)//voie Droite
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vd = new VoieDroite(infosVoieEnTraitement->at(1));
-            vd->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vd);
-            voiesALier.insert(vd, new QList<int>());
-            voiesALier[vd]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vd]->append(listeTemporaire.at(3).toInt());
-            this->simView->addVoie(vd, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 2.0)//voie Courbe
-        {
-            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
-            // NE CHANGER SOUS AUCUN PRETEXTE.
-            if(listeTemporaire.at(4).toLower() == "gauche")
-            {
-                directionVoieEnTraitement = 1.0;
-            }
-            else if(listeTemporaire.at(4).toLower() == "droite")
-            {
-                directionVoieEnTraitement = -1.0;
-            }
-            else //en cas d'erreur dans le fichier...
-                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction de courbe). ";
-
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vc = new VoieCourbe(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), directionVoieEnTraitement);
-            vc->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vc);
-            voiesALier.insert(vc, new QList<int>());
-            voiesALier[vc]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vc]->append(listeTemporaire.at(3).toInt());
-            this->simView->addVoie(vc, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 3.0)//voie Aiguillage
-        {
-            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
-            // NE CHANGER SOUS AUCUN PRETEXTE.
-            if(listeTemporaire.at(5).toLower() == "gauche")
-                directionVoieEnTraitement = 1.0;
-            else if(listeTemporaire.at(5).toLower() == "droite")
-                directionVoieEnTraitement = -1.0;
-            else
-                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction d'aiguillage). ";
-
-            //Creation et insertion de la voie dans les stockages temporaires.
-            va = new VoieAiguillage(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3), directionVoieEnTraitement);
-            va->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, va);
-            voiesALier.insert(va, new QList<int>());
-            voiesALier[va]->append(listeTemporaire.at(2).toInt());
-            voiesALier[va]->append(listeTemporaire.at(3).toInt());
-            voiesALier[va]->append(listeTemporaire.at(4).toInt());
-            this->simView->addVoie(va, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 4.0)//voie Croisement
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vcr = new VoieCroisement(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2));
-            vcr->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vcr);
-            voiesALier.insert(vcr, new QList<int>());
-            voiesALier[vcr]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vcr]->append(listeTemporaire.at(3).toInt());
-            voiesALier[vcr]->append(listeTemporaire.at(4).toInt());
-            voiesALier[vcr]->append(listeTemporaire.at(5).toInt());
-            this->simView->addVoie(vcr, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 5.0)//voie Traversee-Jonction
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vt= new VoieTraverseeJonction(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3));
-            vt->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vt);
-            voiesALier.insert(vt, new QList<int>());
-            voiesALier[vt]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vt]->append(listeTemporaire.at(3).toInt());
-            voiesALier[vt]->append(listeTemporaire.at(4).toInt());
-            voiesALier[vt]->append(listeTemporaire.at(5).toInt());
-            this->simView->addVoie(vt, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 6.0)//voie Buttoir
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vb = new VoieButtoir(infosVoieEnTraitement->at(1));
-            vb->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vb);
-            voiesALier.insert(vb, new QList<int>());
-            voiesALier[vb]->append(listeTemporaire.at(2).toInt());
-            this->simView->addVoie(vb, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 7.0)//voie Aiguillage Enroule
-        {
-            // les valeurs numeriques choisies pour representer gauche et droite sont utiles pour les calculs trigonometriques lors du placement des voies.
-            // NE CHANGER SOUS AUCUN PRETEXTE.
-            if(listeTemporaire.at(5).toLower() == "gauche")
-                directionVoieEnTraitement = 1.0;
-            else if(listeTemporaire.at(5).toLower() == "droite")
-                directionVoieEnTraitement = -1.0;
-            else
-                qDebug() << "Erreur de lecture de fichier : fichier non standard (direction d'aiguillage). ";
-
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vae = new VoieAiguillageEnroule(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3), directionVoieEnTraitement);
-            vae->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vae);
-            voiesALier.insert(vae, new QList<int>());
-            voiesALier[vae]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vae]->append(listeTemporaire.at(4).toInt()); //ordre inversé, pour la cohérence du code...
-            voiesALier[vae]->append(listeTemporaire.at(3).toInt());
-            this->simView->addVoie(vae, listeTemporaire.at(0).toInt());
-        }
-        else if(infosVoieEnTraitement->at(0) == 8.0)//voie Aiguillage Triple
-        {
-            //Creation et insertion de la voie dans les stockages temporaires.
-            vat = new VoieAiguillageTriple(infosVoieEnTraitement->at(1), infosVoieEnTraitement->at(2), infosVoieEnTraitement->at(3));
-            vat->setIdVoie(IDvoie);
-            IDVoies.insert(IDvoie, vat);
-            voiesALier.insert(vat, new QList<int>());
-            voiesALier[vat]->append(listeTemporaire.at(2).toInt());
-            voiesALier[vat]->append(listeTemporaire.at(3).toInt());
-            voiesALier[vat]->append(listeTemporaire.at(4).toInt());
-            voiesALier[vat]->append(listeTemporaire.at(5).toInt());
-            this->simView->addVoie(vat, listeTemporaire.at(0).toInt());
-        }
-    }
-    //finalisation de la creation des voies.
-
-    for(int i = 1; i <= IDVoies.size(); i++)
-    {
-        for(int j = 0; j < voiesALier[IDVoies[i]]->length(); j++)
-        {
-            IDVoies[i]->lier(IDVoies[voiesALier[IDVoies[i]]->at(j)], j);
-        }
-    }
-
-    //debut de la lecture des contacts.
-
-    limite = lecture.readLine().toInt();
-
-    Contact* c;
-
-    for(int i=0; i < limite;i++)
-    {
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", Qt::SkipEmptyParts);
-
-        //creation des contacts.
-        c = new Contact(listeTemporaire.at(0).toInt(), listeTemporaire.at(1).toInt());
-
-        IDVoies[listeTemporaire.at(1).toInt()]->setContact(c);
-        this->simView->addContact(c, listeTemporaire.at(0).toInt());
-    }
-
-    //debut de la lecture des aiguillages.
-
-    limite = lecture.readLine().toInt();
-
-    for(int i=0; i < limite;i++)
-    {
-        ligne = lecture.readLine();
-
-        listeTemporaire = ligne.split(" ", Qt::SkipEmptyParts);
-
-        VoieVariable *v=dynamic_cast<VoieVariable *>(IDVoies[listeTemporaire.at(1).toInt()]);
-
-        this->simView->addVoieVariable(v, listeTemporaire.at(0).toInt());
-
-        v->setNumVoieVariable(listeTemporaire.at(0).toInt());
-
-    }
-
-    //indication de la premiere voie a poser.
-
-    Voie * premiereVoie = IDVoies[lecture.readLine().toInt()];
-
-    this->simView->setPremiereVoie(premiereVoie);
-
-    this->simView->construireMaquette();
-
-    this->simView->genererSegments();
-
     this->simView->zoomFit();
 
     this->simView->repaint();
 
-    // On détruit la map qui contient des pointeurs sur des QList
-    QMapIterator<Voie*, QList<int>*> it(voiesALier);
-    while (it.hasNext()) {
-        it.next();
-        delete it.value();
-    }
-
     this->maquetteFinie.release();
 }
 
 void MainWindow::afficherMessage(QString message)
 {
+    MesurePhase mesure(simView->getProfil(), ProfilImages::CONSOLE);
     this->generalConsole->append(message);
 }
 
 
 void MainWindow::selectionMaquette(QString maquette)
 {
+    // Une maquette peut aussi être désignée par son fichier, relatif au répertoire courant
+    if (QFileInfo(maquette).isFile())
+    {
+        chargerMaquette(QFileInfo(maquette).absoluteFilePath());
+        semWaitMaquette.release();
+        return;
+    }
 
     MaquetteManager manager;
 
@@ -865,7 +642,7 @@ void MainWindow::selectionMaquette(QString maquette)
             foreach(QString maq,list)
                 message+=QString("\n\t%1").arg(maq);
         }
-        QMessageBox::warning(0,"La maquette n'existe pas",message);
+        signalerErreur(0,"La maquette n'existe pas",message);
         exit(1);
     }
     chargerMaquette(manager.fichierMaquette(maquette));
@@ -19,6 +19,7 @@
 #include "voiedroite.h"
 #include "voietraverseejonction.h"
 #include "simview.h"
+#include "chargeurmaquette.h"
 #include "contact.h"
 #include "connect.h"
 
@@ -104,6 +105,15 @@ public:
       */
     explicit MainWindow(QWidget *parent = 0);
 
+    /** Signale une erreur : dans une boîte de dialogue, ou sur la sortie d'erreur sans
+      * fenêtre (voir BackendSimulateur::setSansFenetre), où personne ne pourrait fermer
+      * la boîte de dialogue.
+      * \param parent le widget parent de la boîte de dialogue.
+      * \param titre le titre de la boîte de dialogue.
+      * \param message le message d'erreur.
+      */
+    static void signalerErreur(QWidget *parent, const QString &titre, const QString &message);
+
     /** Destructeur de classe.
       *
       */
@@ -155,8 +165,12 @@ public:
     QAction *viewContactNumberAct;
     QAction *viewAiguillageNumberAct;
     QAction *viewLocoLogAct;
+    QAction *viewLatencesAct;
+    QAction *viewProfilAct;
+    QAction *saveTraceImagesAct;
     QAction *viewInputAct;
     QAction *inertieAct;
+    QAction *freinageAutoAct;
     QAction *emergencyStopAct;
     QAction *printAct;
 
@@ -168,6 +182,8 @@ public:
     QList<LocoCtrl *> locoCtrls;
 
     QLabel *statusLabel;
+    QLabel *profilLabel;
+    QTimer *profilTimer;
 
 signals:
     void commandSent(QString command);
@@ -177,7 +193,7 @@ private slots:
 
 private:
     SimView *simView;
-    QMap <int, QList<double>*> infosVoies;
+    ChargeurMaquette chargeur;
 
 public slots:
     void selectionMaquette(QString maquette);
@@ -195,8 +211,13 @@ public slots:
     void viewContactNumber();
     void viewAiguillageNumber();
     void viewLocoLog();
+    void viewLatences();
+    void viewProfil();
+    void updateProfil();
+    void saveTraceImages();
     void toggleLoco(QObject *locoCtrls);
     void toggleInertie();
+    void toggleFreinageAuto();
     void afficherMessage(QString message);
     void afficherMessageLoco(int numLoco,QString message);
     void print();
@@ -0,0 +1,95 @@
+#ifndef MAQUETTECOMPILEE_H
+#define MAQUETTECOMPILEE_H
+
+#include <QtGlobal>
+#include <type_traits>
+
+#include "voie.h"
+
+/**
+ * Format binaire d'une maquette compilée (fichier .qtm).
+ *
+ * Le fichier contient la maquette entièrement construite : voies avec leur description,
+ * leurs liaisons et leur géométrie après la pose, contacts, aiguillages et segments.
+ * Il est produit à partir d'un fichier Maquet_*.txt et de infosVoies.txt, puis projeté
+ * en mémoire au chargement, sans analyse de texte ni calcul de géométrie.
+ *
+ * Toutes les sections sont des tableaux d'enregistrements de taille fixe, alignés sur
+ * 8 octets. Les entiers et flottants sont stockés dans l'ordre d'octets de la machine
+ * ayant compilé la maquette, vérifié au chargement grâce au champ boutisme.
+ */
+namespace MaquetteCompilee
+{
+    //! Signature en tête de fichier
+    const char SIGNATURE[8] = {'Q', 'T', 'R', 'S', 'M', 'A', 'Q', '\0'};
+
+    //! Version du format, à incrémenter à chaque modification des enregistrements
+    const quint32 VERSION = 1;
+
+    //! Valeur du champ boutisme telle qu'écrite par la machine ayant compilé la maquette
+    const quint32 BOUTISME = 0x01020304;
+
+    //! Extension des fichiers de maquette compilée
+    const char EXTENSION[] = ".qtm";
+
+    struct EnTete
+    {
+        char signature[8];
+        quint32 version;
+        quint32 boutisme;
+        quint64 tailleFichier;          //!> Taille totale du fichier, en octets
+        quint64 empreinteSources;       //!> Empreinte du fichier maquette et de infosVoies.txt
+        qint32 premiereVoie;            //!> Voie posée en premier
+        qint32 nbreVoies;
+        qint32 nbreContacts;
+        qint32 nbreAiguillages;
+        qint32 nbreSegments;
+        qint32 nbreVoiesSegments;       //!> Nombre total de voies, tous segments confondus
+        quint64 positionVoies;          //!> Position de chaque section depuis le début du fichier
+        quint64 positionContacts;
+        quint64 positionAiguillages;
+        quint64 positionSegments;
+        quint64 positionVoiesSegments;
+    };
+
+    struct EnregistrementVoie
+    {
+        qint32 id;
+        qint32 type;                    //!> Type de voie, tel que codé par le chargeur (1 = droite, ...)
+        qint32 nbreLiaisons;
+        qint32 voisins[GeometrieVoie::MAX_LIAISONS]; //!> Voie liée à chaque extrémité, par ordre
+        qint32 reserve;
+        double description[4];          //!> Paramètres de construction (dimensions, direction)
+        GeometrieVoie geometrie;
+    };
+
+    struct EnregistrementContact
+    {
+        qint32 numero;
+        qint32 voie;
+    };
+
+    struct EnregistrementAiguillage
+    {
+        qint32 numero;
+        qint32 voie;
+    };
+
+    struct EnregistrementSegment
+    {
+        qint32 contact1;
+        qint32 contact2;                //!> 0 si le segment aboutit à un buttoir
+        qint32 premiereVoie;            //!> Indice de la première voie dans la section des voies des segments
+        qint32 nbreVoies;
+    };
+
+    static_assert(std::is_trivially_copyable<EnTete>::value, "EnTete doit pouvoir être copié tel quel");
+    static_assert(std::is_trivially_copyable<EnregistrementVoie>::value, "EnregistrementVoie doit pouvoir être copié tel quel");
+    static_assert(sizeof(EnTete) % 8 == 0, "EnTete doit être aligné sur 8 octets");
+    static_assert(sizeof(EnregistrementVoie) % 8 == 0, "EnregistrementVoie doit être aligné sur 8 octets");
+    static_assert(sizeof(EnregistrementContact) % 8 == 0, "EnregistrementContact doit être aligné sur 8 octets");
+    static_assert(sizeof(EnregistrementAiguillage) % 8 == 0, "EnregistrementAiguillage doit être aligné sur 8 octets");
+    static_assert(sizeof(EnregistrementSegment) % 8 == 0, "EnregistrementSegment doit être aligné sur 8 octets");
+}
+
+#endif // MAQUETTECOMPILEE_H
@@ -1,6 +1,7 @@
 
 #include <QStringList>
 #include <QDir>
+#include <QDateTime>
 #include <QApplication>
 
 #include "maquettemanager.h"
@@ -70,12 +71,30 @@ bool MaquetteManager::chargerListeMaquettes()
     for (int i = 0; i < list.size(); ++i) {
         QFileInfo fileInfo = list.at(i);
 
-        MaquetteDesc *desc=new MaquetteDesc();
-        desc->nomFichier=fileInfo.absoluteFilePath();
         QString s=fileInfo.fileName();
         if (s.indexOf("Maquet_")==0)
             s=s.right(s.length()-7);
         s=s.left(s.length()-4);
+
+        // Une maquette compilee remplace le fichier texte du meme nom, s'il n'a pas ete modifie depuis
+        MaquetteDesc *existante = nullptr;
+        foreach (MaquetteDesc *desc,maquettes)
+            if (desc->nomMaquette.compare(s)==0)
+                existante = desc;
+        if (existante != nullptr)
+        {
+            QFileInfo autre(existante->nomFichier);
+            bool estCompilee = fileInfo.suffix().compare("qtm", Qt::CaseInsensitive)==0;
+            bool autreCompilee = autre.suffix().compare("qtm", Qt::CaseInsensitive)==0;
+            if (estCompilee && !autreCompilee && fileInfo.lastModified() >= autre.lastModified())
+                existante->nomFichier=fileInfo.absoluteFilePath();
+            else if (!estCompilee && autreCompilee && autre.lastModified() < fileInfo.lastModified())
+                existante->nomFichier=fileInfo.absoluteFilePath();
+            continue;
+        }
+
+        MaquetteDesc *desc=new MaquetteDesc();
+        desc->nomFichier=fileInfo.absoluteFilePath();
         desc->nomMaquette=s;
         maquettes << desc;
 //        std::cout << "Maquette. Nom: " << qPrintable(desc->nomMaquette) << ". Fichier: " << qPrintable(desc->nomFichier) << std::endl;
@@ -0,0 +1,129 @@
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+#include "ordonnanceur.h"
+
+using namespace TraceCommandes;
+
+thread_local int Ordonnanceur::locoCourante = -1;
+
+
+Ordonnanceur::Ordonnanceur() :
+    mode(LIBRE), enregistreur(nullptr), nbreDivergences(0)
+{
+    std::random_device rd;
+    graine = rd();
+}
+
+void Ordonnanceur::enregistrer(EnregistreurTrace *enregistreur)
+{
+    this->enregistreur = enregistreur;
+    mode = enregistreur != nullptr ? ENREGISTREMENT : LIBRE;
+    points.clear();
+
+    if (enregistreur != nullptr)
+        enregistreur->enregistrer(GRAINE, 0, qint32(graine));
+}
+
+void Ordonnanceur::rejouer(const QVector<Evenement> &decisions)
+{
+    QVector<Evenement> triees = decisions;
+
+    // Le rang du passage fait foi, pas l'ordre d'écriture dans la trace
+    std::stable_sort(triees.begin(), triees.end(), [](const Evenement &x, const Evenement &y) {
+        return x.a != y.a ? x.a < y.a : x.b < y.b;
+    });
+
+    points.clear();
+    foreach (const Evenement &e, triees)
+        points[e.a].ordre.append(e.loco);
+
+    enregistreur = nullptr;
+    mode = REJEU;
+}
+
+void Ordonnanceur::setGraine(quint32 graine)
+{
+    this->graine = graine;
+}
+
+quint32 Ordonnanceur::getGraine() const
+{
+    return graine;
+}
+
+void Ordonnanceur::identifierThread(int no_loco)
+{
+    locoCourante = no_loco;
+}
+
+void Ordonnanceur::attendreTour(int point)
+{
+    if (mode != REJEU)
+        return;
+
+    QMutexLocker locker(&mutex);
+
+    // Les points absents de la trace ne sont pas ordonnés
+    QHash<int, Point>::iterator it = points.find(point);
+    if (it == points.end())
+        return;
+
+    QElapsedTimer chrono;
+    chrono.start();
+
+    while (!it->libre && it->rang < it->ordre.size() && it->ordre.at(it->rang) != quint16(locoCourante))
+    {
+        qint64 reste = DELAI_MS - chrono.elapsed();
+        if (reste <= 0)
+        {
+            diverger(point, *it, "attente de son tour trop longue");
+            break;
+        }
+        tour.wait(&mutex, quint64(reste));
+    }
+}
+
+void Ordonnanceur::consigner(int point)
+{
+    if (mode == LIBRE)
+        return;
+
+    QMutexLocker locker(&mutex);
+
+    if (mode == ENREGISTREMENT)
+    {
+        int rang = points[point].rang++;
+        enregistreur->enregistrer(SYNCHRO, locoCourante, point, rang);
+        return;
+    }
+
+    QHash<int, Point>::iterator it = points.find(point);
+    if (it == points.end() || it->libre || it->rang >= it->ordre.size())
+        return;
+
+    if (it->ordre.at(it->rang) != quint16(locoCourante))
+        diverger(point, *it, "passage hors de son tour");
+    else
+        it->rang++;
+
+    tour.wakeAll();
+}
+
+int Ordonnanceur::getNbreDivergences() const
+{
+    return nbreDivergences.load();
+}
+
+void Ordonnanceur::diverger(int point, Point &p, const char *raison)
+{
+    std::cout << "Divergence au point de synchronisation " << point << ", passage " << p.rang
+              << " : loco " << qint16(locoCourante) << " au lieu de la loco " << qint16(p.ordre.at(p.rang))
+              << " (" << raison << ")" << std::endl;
+    nbreDivergences++;
+    p.libre = true;
+    tour.wakeAll();
+}
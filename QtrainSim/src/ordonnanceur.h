@@ -0,0 +1,115 @@
+#ifndef ORDONNANCEUR_H
+#define ORDONNANCEUR_H
+
+#include <QHash>
+#include <QMutex>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <atomic>
+
+#include "enregistreurtrace.h"
+#include "tracecommandes.h"
+
+/**
+ * Rend l'exécution du programme client reproductible.
+ *
+ * Le programme client signale ses points de synchronisation, c'est-à-dire les endroits
+ * où l'ordre d'arrivée des threads décide de la suite (prise d'un mutex protégeant un
+ * état partagé, tirage aléatoire commun) : attendreTour avant la décision, consigner
+ * une fois la décision prise. La reprise d'un thread après l'attente d'un contact est
+ * un point de synchronisation géré par CommandeTrain. Chaque thread s'identifie par le
+ * numéro de sa loco.
+ * - Lors d'un enregistrement, l'ordre dans lequel les threads franchissent chaque point
+ *   est ajouté à la trace (événements SYNCHRO), ainsi que la graine de la simulation.
+ * - Lors d'un rejeu, chaque thread attend son tour pour franchir un point, dans l'ordre
+ *   de la trace. Un thread qui attend son tour plus de DELAI_MS, ou qui franchit un
+ *   point hors de son tour, est compté comme une divergence, et l'ordre de ce point
+ *   n'est alors plus imposé.
+ * Sinon, les points de synchronisation n'ont aucun effet.
+ */
+class Ordonnanceur
+{
+public:
+    /** Constructeur de classe. Tire une graine au hasard.
+      */
+    Ordonnanceur();
+
+    /** ajoute les décisions d'ordonnancement à une trace en cours d'enregistrement,
+      * à commencer par la graine. A appeler avant le lancement du programme client.
+      * \param enregistreur l'enregistreur de la trace.
+      */
+    void enregistrer(EnregistreurTrace *enregistreur);
+
+    /** impose l'ordre des décisions d'une trace enregistrée. A appeler avant le
+      * lancement du programme client.
+      * \param decisions les événements SYNCHRO de la trace.
+      */
+    void rejouer(const QVector<TraceCommandes::Evenement> &decisions);
+
+    /** fixe la graine de la simulation, que le programme client utilise pour
+      * initialiser ses générateurs aléatoires. A appeler avant enregistrer.
+      * \param graine la graine.
+      */
+    void setGraine(quint32 graine);
+
+    /** retourne la graine de la simulation.
+      */
+    quint32 getGraine() const;
+
+    /** associe le thread appelant à une loco.
+      * \param no_loco le numéro de la loco.
+      */
+    void identifierThread(int no_loco);
+
+    /** lors d'un rejeu, bloque le thread appelant jusqu'à ce que ce soit son tour de
+      * franchir le point de synchronisation.
+      * \param point le point de synchronisation.
+      */
+    void attendreTour(int point);
+
+    /** signale que le thread appelant a franchi le point de synchronisation. A appeler
+      * là où la décision est prise, par exemple juste après avoir pris le mutex.
+      * \param point le point de synchronisation.
+      */
+    void consigner(int point);
+
+    /** retourne le nombre de divergences constatées lors d'un rejeu.
+      */
+    int getNbreDivergences() const;
+
+private:
+    enum Mode
+    {
+        LIBRE,
+        ENREGISTREMENT,
+        REJEU
+    };
+
+    //! Attente maximale de son tour par un thread, lors d'un rejeu
+    static const int DELAI_MS = 1000;
+
+    struct Point
+    {
+        QVector<quint16> ordre;         //!> Locos dans l'ordre où elles ont franchi le point
+        int rang = 0;                   //!> Nombre de passages du point
+        bool libre = false;             //!> Vrai si l'ordre n'est plus imposé
+    };
+
+    /** signale une divergence et cesse d'imposer l'ordre d'un point.
+      */
+    void diverger(int point, Point &p, const char *raison);
+
+    Mode mode;
+    EnregistreurTrace *enregistreur;
+    quint32 graine;
+    QMutex mutex;
+    QWaitCondition tour;
+    QHash<int, Point> points;
+    std::atomic<int> nbreDivergences;
+
+    //! Numéro de la loco du thread courant, -1 s'il ne s'est pas identifié
+    static thread_local int locoCourante;
+};
+
+#endif // ORDONNANCEUR_H
@@ -0,0 +1,130 @@
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "profilimages.h"
+
+
+ProfilImages::ProfilImages(int nbreImages) :
+    images(nbreImages > 0 ? nbreImages : 1), courante(0)
+{
+    horloge.start();
+}
+
+const char *ProfilImages::nomPhase(Phase phase)
+{
+    switch (phase)
+    {
+    case IMAGE:       return "image";
+    case MOUVEMENT:   return "mouvement";
+    case COLLISIONS:  return "collisions";
+    case PROXIMITE:   return "proximite";
+    case PUBLICATION: return "publication";
+    case PEINTURE:    return "peinture";
+    case CONSOLE:     return "console";
+    default:          return "?";
+    }
+}
+
+qint64 ProfilImages::maintenant() const
+{
+    return horloge.nsecsElapsed();
+}
+
+void ProfilImages::debutImage()
+{
+    courante = (courante + 1) % int(images.size());
+
+    // clear() garde la capacité du vecteur : une fois les images remplies, plus rien n'est réservé
+    Image &i = images[courante];
+    i.debut = maintenant();
+    for (int p = 0; p < NBRE_PHASES; p++)
+        i.totaux[p] = 0;
+    i.evenements.clear();
+}
+
+void ProfilImages::finImage()
+{
+    ajouterPhase(IMAGE, images[courante].debut);
+}
+
+void ProfilImages::ajouterPhase(Phase phase, qint64 debut)
+{
+    Image &i = images[courante];
+    if (i.debut < 0)
+        return;
+
+    qint64 duree = maintenant() - debut;
+    i.totaux[phase] += duree;
+    i.evenements.push_back({phase, debut, duree});
+}
+
+const ProfilImages::Image &ProfilImages::image(int indice) const
+{
+    int n = int(images.size());
+    return images[((courante - indice) % n + n) % n];
+}
+
+QString ProfilImages::resume(int nbreImages) const
+{
+    qint64 totaux[NBRE_PHASES] = {};
+    qint64 pire = 0;
+    int n = 0;
+
+    for (int indice = 0; indice < nbreImages && indice < int(images.size()); indice++)
+    {
+        const Image &i = image(indice);
+        if (i.debut < 0)
+            break;
+
+        for (int p = 0; p < NBRE_PHASES; p++)
+            totaux[p] += i.totaux[p];
+        pire = qMax(pire, i.totaux[IMAGE] + i.totaux[PEINTURE] + i.totaux[CONSOLE]);
+        n++;
+    }
+
+    if (n == 0)
+        return QString();
+
+    // Durées moyennes par image, en ms
+    QString texte = QString("%1 %2 ms").arg(nomPhase(IMAGE)).arg(totaux[IMAGE] / 1e6 / n, 0, 'f', 2);
+    for (int p = MOUVEMENT; p < NBRE_PHASES; p++)
+        texte += QString(", %1 %2").arg(nomPhase(Phase(p))).arg(totaux[p] / 1e6 / n, 0, 'f', 2);
+    texte += QString(" | pire %1 ms").arg(pire / 1e6, 0, 'f', 2);
+    return texte;
+}
+
+bool ProfilImages::ecrireTrace(const QString &fichier) const
+{
+    // Format "Trace Event" : des événements complets (ph X), en µs
+    QJsonArray evenements;
+    for (int indice = int(images.size()) - 1; indice >= 0; indice--)
+    {
+        const Image &i = image(indice);
+        if (i.debut < 0)
+            continue;
+
+        for (const Evenement &e : i.evenements)
+        {
+            QJsonObject evenement;
+            evenement["name"] = nomPhase(e.phase);
+            evenement["ph"] = "X";
+            evenement["ts"] = e.debut / 1000.0;
+            evenement["dur"] = e.duree / 1000.0;
+            evenement["pid"] = 1;
+            evenement["tid"] = 1;
+            evenements.append(evenement);
+        }
+    }
+
+    QJsonObject trace;
+    trace["traceEvents"] = evenements;
+    trace["displayTimeUnit"] = "ms";
+
+    QFile f(fichier);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    f.write(QJsonDocument(trace).toJson(QJsonDocument::Compact));
+    return true;
+}
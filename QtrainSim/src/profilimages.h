@@ -0,0 +1,121 @@
+#ifndef PROFILIMAGES_H
+#define PROFILIMAGES_H
+
+#include <QElapsedTimer>
+#include <QString>
+
+#include <vector>
+
+/**
+ * Profil des images de la simulation : durée de chaque phase d'un pas d'animation
+ * (déplacement des locos, collisions, alerte de proximité, publication des
+ * positions), du dessin de la vue et des ajouts aux consoles.
+ *
+ * Les dernières images sont gardées : leur résumé (moyennes par phase et pire
+ * image) est affiché dans la barre d'état, et elles peuvent être écrites dans une
+ * trace au format Chrome (chrome://tracing, Perfetto). Les mesures sont faites dans
+ * le thread de l'interface, et ne réservent pas de mémoire une fois les images
+ * remplies.
+ */
+class ProfilImages
+{
+public:
+    enum Phase
+    {
+        IMAGE,          //!> Pas d'animation complet (ou plusieurs, en simulation accélérée)
+        MOUVEMENT,
+        COLLISIONS,
+        PROXIMITE,
+        PUBLICATION,
+        PEINTURE,
+        CONSOLE,
+        NBRE_PHASES
+    };
+
+    /** Constructeur.
+      * \param nbreImages le nombre d'images gardées pour la trace.
+      */
+    explicit ProfilImages(int nbreImages = 600);
+
+    /** retourne le nom d'une phase.
+      */
+    static const char *nomPhase(Phase phase);
+
+    /** retourne l'instant actuel, en ns depuis la création du profil.
+      */
+    qint64 maintenant() const;
+
+    /** commence une nouvelle image, qui remplace la plus ancienne gardée.
+      */
+    void debutImage();
+
+    /** termine l'image en cours.
+      */
+    void finImage();
+
+    /** ajoute une phase à l'image en cours. Les phases mesurées entre deux images
+      * (dessin, console) sont rattachées à la précédente.
+      * \param phase la phase.
+      * \param debut son début, donné par maintenant().
+      */
+    void ajouterPhase(Phase phase, qint64 debut);
+
+    /** retourne le résumé des dernières images : durée moyenne de chaque phase par
+      * image, et durée de la pire image (phases hors pas d'animation comprises).
+      * \param nbreImages le nombre d'images résumées.
+      */
+    QString resume(int nbreImages = 60) const;
+
+    /** écrit les images gardées dans une trace au format Chrome.
+      * \param fichier le fichier à créer.
+      * \return vrai si le fichier a pu être écrit.
+      */
+    bool ecrireTrace(const QString &fichier) const;
+
+private:
+    struct Evenement
+    {
+        Phase phase;
+        qint64 debut;
+        qint64 duree;
+    };
+
+    struct Image
+    {
+        qint64 debut = -1;      //!> -1 si l'image n'a pas encore été utilisée
+        qint64 totaux[NBRE_PHASES] = {};
+        std::vector<Evenement> evenements;
+    };
+
+    /** retourne l'image gardée d'indice donné, 0 étant la plus récente.
+      */
+    const Image &image(int indice) const;
+
+    QElapsedTimer horloge;
+    std::vector<Image> images;
+    int courante;
+};
+
+/**
+ * Mesure la durée d'une phase, de sa construction à sa destruction.
+ */
+class MesurePhase
+{
+public:
+    MesurePhase(ProfilImages &profil, ProfilImages::Phase phase) :
+        profil(profil), phase(phase), debut(profil.maintenant())
+    {
+    }
+
+    ~MesurePhase()
+    {
+        profil.ajouterPhase(phase, debut);
+    }
+
+private:
+    ProfilImages &profil;
+    ProfilImages::Phase phase;
+    qint64 debut;
+};
+
+#endif // PROFILIMAGES_H
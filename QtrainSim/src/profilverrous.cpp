@@ -0,0 +1,86 @@
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <vector>
+
+#include "profilverrous.h"
+
+
+std::atomic<bool> ProfilVerrous::actif(false);
+
+ProfilVerrous *ProfilVerrous::getInstance()
+{
+    static ProfilVerrous instance;
+    return &instance;
+}
+
+void ProfilVerrous::setActif(bool actif)
+{
+#ifdef PROFIL_VERROUS
+    ProfilVerrous::actif = actif;
+#else
+    Q_UNUSED(actif);
+#endif
+}
+
+StatistiquesVerrou *ProfilVerrous::statistiques(const QString &nom)
+{
+    QMutexLocker locker(&mutex);
+    std::unique_ptr<StatistiquesVerrou> &stats = verrous[nom];
+    if (!stats)
+        stats.reset(new StatistiquesVerrou(nom));
+    return stats.get();
+}
+
+QString ProfilVerrous::rapport(int nbre) const
+{
+    QMutexLocker locker(&mutex);
+
+    auto attenteTotale = [](const StatistiquesVerrou *stats) {
+        return stats->attente.getMoyenne() * stats->attente.getNbre();
+    };
+
+    std::vector<const StatistiquesVerrou*> tries;
+    for (const auto &verrou : verrous)
+        if (verrou.second->attente.getNbre() > 0)
+            tries.push_back(verrou.second.get());
+    std::sort(tries.begin(), tries.end(), [&attenteTotale](const StatistiquesVerrou *a, const StatistiquesVerrou *b) {
+        return attenteTotale(a) > attenteTotale(b);
+    });
+
+    QString texte = QString("Verrous (%1 sur %2, par attente totale)")
+            .arg(qMin(nbre, int(tries.size())))
+            .arg(tries.size());
+
+    for (int i = 0; i < nbre && i < int(tries.size()); i++)
+    {
+        const StatistiquesVerrou *stats = tries[i];
+        quint64 acquisitions = stats->attente.getNbre();
+        quint64 contentions = stats->contentions.load();
+
+        texte += QString("\n%1 : %2 acquisitions, %3 contentions (%4 %), attente totale %5 ms")
+                .arg(stats->nom)
+                .arg(acquisitions)
+                .arg(contentions)
+                .arg(100.0 * contentions / acquisitions, 0, 'f', 1)
+                .arg(attenteTotale(stats) / 1e6, 0, 'f', 1);
+        texte += "\n  attente   " + stats->attente.resume(1000.0, "µs");
+        if (stats->detention.getNbre() > 0)
+            texte += "\n  détention " + stats->detention.resume(1000.0, "µs");
+        if (stats->attenteCondition.getNbre() > 0)
+            texte += "\n  condition " + stats->attenteCondition.resume(1e6, "ms");
+    }
+    return texte;
+}
+
+void ProfilVerrous::reinitialiser()
+{
+    QMutexLocker locker(&mutex);
+    for (auto &verrou : verrous)
+    {
+        verrou.second->attente.reinitialiser();
+        verrou.second->detention.reinitialiser();
+        verrou.second->attenteCondition.reinitialiser();
+        verrou.second->contentions = 0;
+    }
+}
@@ -0,0 +1,234 @@
+#ifndef PROFILVERROUS_H
+#define PROFILVERROUS_H
+
+#include <QMutex>
+#include <QString>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+
+#include "histogramme.h"
+
+/**
+ * Mesures d'un verrou, ou de tous les verrous portant le même nom. Les durées sont
+ * en ns. Le nombre d'acquisitions est celui des valeurs de l'histogramme attente.
+ */
+struct StatistiquesVerrou
+{
+    explicit StatistiquesVerrou(const QString &nom) : nom(nom) {}
+
+    const QString nom;
+
+    //! Attente des acquisitions, contendues ou non
+    Histogramme attente;
+
+    //! Durée de détention des mutex (pas de sens pour un sémaphore)
+    Histogramme detention;
+
+    //! Attente sur une condition, pendant laquelle le mutex est libéré
+    Histogramme attenteCondition;
+
+    //! Acquisitions qui ont trouvé le verrou pris
+    std::atomic<quint64> contentions{0};
+};
+
+/**
+ * Profil des verrous du simulateur et du programme client : pour chaque verrou nommé,
+ * l'attente des acquisitions, la durée de détention et le nombre de contentions.
+ *
+ * Les mesures sont faites par MutexInstrumente et SemaphoreInstrumente. Elles sont
+ * compilées si PROFIL_VERROUS est défini (option QTRAINSIM_PROFIL_VERROUS de CMake),
+ * et relevées seulement une fois activées (option --profil-verrous du simulateur) :
+ * désactivées, elles ne coûtent qu'une lecture atomique par acquisition.
+ */
+class ProfilVerrous
+{
+public:
+    static ProfilVerrous *getInstance();
+
+    /** active ou désactive les mesures. Sans effet si PROFIL_VERROUS n'est pas défini.
+      */
+    void setActif(bool actif);
+
+    /** indique si les mesures sont actives.
+      */
+    static bool estActif()
+    {
+        return actif.load(std::memory_order_relaxed);
+    }
+
+    /** retourne l'instant actuel, en ns, pour les mesures.
+      */
+    static qint64 maintenant()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /** retourne les mesures d'un verrou, créées au premier appel. Les verrous de même
+      * nom partagent leurs mesures.
+      * \param nom le nom du verrou.
+      * \return les mesures, valables jusqu'à la fin du programme.
+      */
+    StatistiquesVerrou *statistiques(const QString &nom);
+
+    /** retourne le rapport des verrous dont l'attente totale est la plus longue.
+      * \param nbre le nombre de verrous du rapport.
+      */
+    QString rapport(int nbre = 10) const;
+
+    /** vide les mesures de tous les verrous.
+      */
+    void reinitialiser();
+
+private:
+    ProfilVerrous() {}
+
+    static std::atomic<bool> actif;
+
+    mutable QMutex mutex;
+    std::map<QString, std::unique_ptr<StatistiquesVerrou> > verrous;
+};
+
+/**
+ * Mutex instrumenté, qui remplace un QMutex ou un PcoMutex (lock et unlock), et mesure
+ * l'attente, la détention et les contentions quand le profil est actif.
+ */
+template<class Mutex>
+class MutexInstrumente
+{
+public:
+    /** Constructeur.
+      * \param nom le nom du verrou dans le rapport.
+      */
+    explicit MutexInstrumente(const QString &nom) :
+        stats(ProfilVerrous::getInstance()->statistiques(nom))
+    {
+    }
+
+    void lock()
+    {
+#ifdef PROFIL_VERROUS
+        if (ProfilVerrous::estActif())
+        {
+            bool contention = occupants.fetch_add(1) > 0;
+            qint64 debut = ProfilVerrous::maintenant();
+            mutex.lock();
+            // Le mutex est acquis : les deux champs suivants ne sont écrits que par son détenteur
+            debutDetention = ProfilVerrous::maintenant();
+            mesure = true;
+            stats->attente.enregistrer(debutDetention - debut);
+            if (contention)
+                stats->contentions++;
+            return;
+        }
+#endif
+        mutex.lock();
+    }
+
+    void unlock()
+    {
+#ifdef PROFIL_VERROUS
+        if (mesure)
+        {
+            mesure = false;
+            occupants--;
+            stats->detention.enregistrer(ProfilVerrous::maintenant() - debutDetention);
+        }
+#endif
+        mutex.unlock();
+    }
+
+    /** attend sur une condition (QWaitCondition ou PcoConditionVariable) associée au
+      * mutex, qui doit être verrouillé. L'attente ne compte pas dans la détention.
+      */
+    template<class Condition>
+    void attendre(Condition &condition)
+    {
+#ifdef PROFIL_VERROUS
+        if (mesure)
+        {
+            qint64 debut = ProfilVerrous::maintenant();
+            stats->detention.enregistrer(debut - debutDetention);
+            mesure = false;
+            occupants--;
+            condition.wait(&mutex);
+            occupants++;
+            mesure = true;
+            debutDetention = ProfilVerrous::maintenant();
+            stats->attenteCondition.enregistrer(debutDetention - debut);
+            return;
+        }
+#endif
+        condition.wait(&mutex);
+    }
+
+private:
+    Mutex mutex;
+    StatistiquesVerrou *stats;
+
+    //! Threads qui détiennent le mutex ou attendent de l'acquérir, comptés seulement
+    //! quand le profil est actif
+    std::atomic<int> occupants{0};
+
+    qint64 debutDetention{0};
+    bool mesure{false};
+};
+
+/**
+ * Sémaphore instrumenté, qui remplace un QSemaphore ou un PcoSemaphore (acquire et
+ * release), et mesure l'attente et les contentions quand le profil est actif.
+ */
+template<class Semaphore>
+class SemaphoreInstrumente
+{
+public:
+    /** Constructeur.
+      * \param nom le nom du verrou dans le rapport.
+      * \param valeur la valeur initiale du sémaphore.
+      */
+    SemaphoreInstrumente(const QString &nom, unsigned int valeur) :
+        semaphore(valeur), disponibles(int(valeur)),
+        stats(ProfilVerrous::getInstance()->statistiques(nom))
+    {
+    }
+
+    void acquire()
+    {
+#ifdef PROFIL_VERROUS
+        if (ProfilVerrous::estActif())
+        {
+            bool contention = disponibles.fetch_sub(1) <= 0;
+            qint64 debut = ProfilVerrous::maintenant();
+            semaphore.acquire();
+            stats->attente.enregistrer(ProfilVerrous::maintenant() - debut);
+            if (contention)
+                stats->contentions++;
+            return;
+        }
+#endif
+        semaphore.acquire();
+    }
+
+    void release()
+    {
+#ifdef PROFIL_VERROUS
+        if (ProfilVerrous::estActif())
+            disponibles++;
+#endif
+        semaphore.release();
+    }
+
+private:
+    Semaphore semaphore;
+
+    //! Valeur du sémaphore, négative si des threads attendent. Tenue à jour seulement
+    //! quand le profil est actif, ce qu'il est dès le démarrage du programme client
+    std::atomic<int> disponibles;
+
+    StatistiquesVerrou *stats;
+};
+
+#endif // PROFILVERROUS_H
@@ -55,3 +55,32 @@ bool Segment::relie(Contact *c1, Contact *c2)
         return true;
     return false;
 }
+
+qreal Segment::getLongueur(Contact *depart)
+{
+    qreal longueur = 0.0;
+
+    // La voie du contact d'arrivée n'est pas parcourue avant son déclenchement
+    int premier = depart == contact1 ? 0 : 1;
+    int dernier = depart == contact1 ? voies.length() - 1 : voies.length();
+
+    for(int i = premier; i < dernier; i++)
+        longueur += voies.at(i)->getLongueurAParcourir();
+
+    return longueur;
+}
+
+Contact* Segment::getContact1() const
+{
+    return contact1;
+}
+
+Contact* Segment::getContact2() const
+{
+    return contact2;
+}
+
+const QList<Voie*> &Segment::getVoies() const
+{
+    return voies;
+}
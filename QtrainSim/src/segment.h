@@ -39,6 +39,29 @@ public:
       * \return vrai si le segment relie c1 et c2, faux sinon.
       */
     bool relie(Contact* c1, Contact* c2);
+
+    /** retourne la longueur à parcourir entre le déclenchement du contact de départ
+      * et celui de l'autre contact du segment. Un contact se déclenche à l'entrée de
+      * sa voie : la voie du contact de départ est comptée, celle de l'autre contact non.
+      * \param depart le contact de départ (contact1 ou contact2).
+      * \return la longueur en mm.
+      */
+    qreal getLongueur(Contact* depart);
+
+    /** retourne le premier contact du segment.
+      * \return le premier contact.
+      */
+    Contact* getContact1() const;
+
+    /** retourne le second contact du segment, nullptr si le segment aboutit à un buttoir.
+      * \return le second contact.
+      */
+    Contact* getContact2() const;
+
+    /** retourne les voies du segment, de la voie du premier contact à celle du second.
+      * \return la liste des voies.
+      */
+    const QList<Voie*> &getVoies() const;
 signals:
 
 public slots:
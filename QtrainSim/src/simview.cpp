@@ -1,9 +1,16 @@
+#include <algorithm>
+
 #include "simview.h"
+#include "commandetrain.h"
+#include "trainsimsettings.h"
+#include "mainwindow.h"
 
 SimView::SimView(QWidget */*parent*/)
     : QGraphicsView()
 {
     scene = new QGraphicsScene();
+    // Les locos bougent à chaque pas : un index BSP serait reconstruit (et réalloué) sans cesse
+    scene->setItemIndexMethod(QGraphicsScene::NoIndex);
     this->setScene(scene);
     this->setRenderHints(QPainter::Antialiasing);
     timer = new QTimer(this);
@@ -15,6 +22,17 @@ void SimView::redraw()
     scene->update(sceneRect());
 }
 
+ProfilImages &SimView::getProfil()
+{
+    return profil;
+}
+
+void SimView::paintEvent(QPaintEvent *event)
+{
+    MesurePhase mesure(profil, ProfilImages::PEINTURE);
+    QGraphicsView::paintEvent(event);
+}
+
 void SimView::addVoie(Voie *v, int ID)
 {
     this->Voies.insert(ID, v);
@@ -56,38 +74,91 @@ void SimView::viderMaquette()
         delete v;
 
     this->Voies.clear();
+
+    qDeleteAll(this->segments);
+    this->segments.clear();
+    this->segmentsParContacts.clear();
+
+    // Les contacts ont été détruits avec les voies qui les portent
+    this->contacts.clear();
+    this->VoiesVariables.clear();
+    this->commandesDifferees.clear();
+    this->premiereVoie = nullptr;
 }
 
 void SimView::genererSegments()
 {
-    for(int i = 1; i <= this->contacts.size(); i++)
+    // Etape du parcours : voie atteinte, voie d'où l'on vient, et longueur du chemin avant elle
+    struct Etape
     {
-        QList<QList<Voie*>*> parcours;
-        parcours = this->Voies.value(contacts.value(i)->getNumVoiePorteuse())->startExplorationContactAContact();
+        Voie* voie;
+        Voie* viensDe;
+        int profondeur;
+    };
+
+    QVector<Etape> pile;
+    QList<Voie*> chemin;
+    Voie* sorties[Voie::MAX_SORTIES];
 
-        foreach(QList<Voie*>* lv, parcours)
+    for(QMap<int, Contact*>::const_iterator it = contacts.constBegin(); it != contacts.constEnd(); ++it)
+    {
+        Voie* depart = this->Voies.value(it.value()->getNumVoiePorteuse());
+        if(depart == nullptr)
+            continue;
+
+        chemin.clear();
+        chemin.append(depart);
+
+        // Empilées à l'envers pour parcourir les liaisons dans l'ordre
+        for(int i = depart->getNbreLiaisons() - 1; i >= 0; i--)
+            pile.append({depart->getVoieVoisineDOrdre(i), depart, 1});
+
+        while(!pile.isEmpty())
         {
-            if(lv->last()->getContact() != nullptr)
+            Etape e = pile.takeLast();
+
+            while(chemin.length() > e.profondeur)
+                chemin.removeLast();
+            chemin.append(e.voie);
+
+            if(e.voie->getContact() != nullptr)
             {
-                if(contacts.key(lv->first()->getContact()) < contacts.key(lv->last()->getContact()))
-                {
-                    segments.append(new Segment(lv->first()->getContact(), lv->last()->getContact(), *lv));
-                }
+                // Chaque segment est trouvé depuis ses deux contacts : on ne le garde que
+                // depuis le plus petit.
+                int fin = e.voie->getContact()->getNumContact();
+                if(it.key() < fin)
+                    ajouterSegment(new Segment(it.value(), e.voie->getContact(), chemin));
+                continue;
             }
-            else
+
+            int nbreSorties = e.voie->getVoiesSortie(e.viensDe, sorties);
+            if(nbreSorties == 0)
             {
                 //gestion de segments entre un contact et une voie buttoir...
-                segments.append(new Segment(lv->first()->getContact(), nullptr, *lv));
+                ajouterSegment(new Segment(it.value(), nullptr, chemin));
+                continue;
             }
-        }
 
-        // On détruit les QList*
-        while (!parcours.isEmpty()) {
-            QList<Voie*> *l = parcours.at(0);
-            delete l;
-            parcours.pop_front();
+            if(e.profondeur >= this->Voies.size())
+            {
+                qDebug() << "Boucle sans contact depuis le contact" << it.key();
+                continue;
+            }
+
+            for(int i = nbreSorties - 1; i >= 0; i--)
+                pile.append({sorties[i], e.voie, e.profondeur + 1});
         }
     }
+
+    calculerDistances();
+}
+
+void SimView::setSegments(const QList<Segment*> &segments)
+{
+    foreach(Segment* s, segments)
+        ajouterSegment(s);
+
+    calculerDistances();
 }
 
 void SimView::addLoco(Loco *l, int ID)
@@ -95,9 +166,24 @@ void SimView::addLoco(Loco *l, int ID)
     this->Locos.insert(ID, l);
     this->scene->addItem(l);
 
+    // Les indices changent : les locos déjà présentes seront recherchées à nouveau
+    for(int i = 0; i < listeLocos.size(); i++)
+    {
+        for(Voie* v : suivisProximite[i].voies)
+            v->retirerObservateur(listeLocos.at(i));
+    }
+
+    listeLocos = Locos.values().toVector();
+    numerosLocos = Locos.keys().toVector();
+    coinsLocos.resize(4 * listeLocos.size());
+
+    indicesLocos.clear();
+    for(int i = 0; i < listeLocos.size(); i++)
+        indicesLocos.insert(listeLocos.at(i), i);
+    suivisProximite.assign(listeLocos.size(), SuiviProximite());
+
     CONNECT(l, SIGNAL(nouveauSegment(Contact*,Contact*,Loco*)), this, SLOT(locoSurNouveauSegment(Contact*,Contact*,Loco*)));
     CONNECT(this, SIGNAL(locoSurSegment(Segment*)), l, SLOT(locoSurSegment(Segment*)));
-    CONNECT(this, SIGNAL(notificationVoieVariableModifiee(Voie*)), l, SLOT(voieVariableModifiee(Voie*)));
 
     peintLocos();
 }
@@ -175,6 +261,213 @@ void SimView::zoomFit()
 }
 
 
+const InstantaneMonde* SimView::getInstantaneMonde() const
+{
+    return &this->instantane;
+}
+
+void SimView::publierPosition(int numLoco, Loco *l)
+{
+    PositionLoco p;
+
+    p.contactPrecedent = l->getContactPrecedent();
+    p.contactSuivant = l->getContactSuivant();
+    p.distance = l->getDistanceContactSuivant();
+    p.vitesse = l->getVitesse();
+    p.sortie = l->getSortieContactSuivant();
+
+    instantane.publier(numLoco, p);
+}
+
+int SimView::ajouterDeclencheur(int numLoco, int contactPrecedent, int contactSuivant, qreal distance, bool depuisPrecedent)
+{
+    if(!contacts.contains(contactSuivant) ||
+       (contactPrecedent != 0 && !contacts.contains(contactPrecedent)) ||
+       (contactPrecedent == 0 && depuisPrecedent))
+    {
+        qDebug() << "Déclencheur virtuel invalide entre les contacts" << contactPrecedent << "et" << contactSuivant;
+        return -1;
+    }
+
+    QMutexLocker locker(&mutexDeclencheurs);
+
+    int n = prochainDeclencheur++;
+    QSharedPointer<DeclencheurVirtuel> d(new DeclencheurVirtuel(n, numLoco, contactPrecedent, contactSuivant,
+                                                                distance, depuisPrecedent));
+
+    declencheurs.insert(n, d);
+    declencheursParContact.insert(contactSuivant, d);
+    return n;
+}
+
+void SimView::supprimerDeclencheur(int numDeclencheur)
+{
+    QMutexLocker locker(&mutexDeclencheurs);
+
+    QSharedPointer<DeclencheurVirtuel> d = declencheurs.take(numDeclencheur);
+    if(!d.isNull())
+    {
+        declencheursParContact.remove(d->getContactSuivant(), d);
+        d->supprime();
+    }
+}
+
+QSharedPointer<DeclencheurVirtuel> SimView::getDeclencheur(int n)
+{
+    QMutexLocker locker(&mutexDeclencheurs);
+
+    return declencheurs.value(n);
+}
+
+void SimView::evaluerDeclencheurs(Loco *l, unsigned franchisAvant, qreal restantAvant,
+                                  int precedentAvant, int suivantAvant, qreal longueurAvant)
+{
+    QMutexLocker locker(&mutexDeclencheurs);
+
+    if(declencheursParContact.isEmpty())
+        return;
+
+    bool memeSegment = l->getNbreContactsFranchis() == franchisAvant;
+    int numLoco = l->getNumero();
+
+    // Le pas a franchi le contact suivant : les points situés entre la loco et ce contact
+    // (jusqu'au contact lui-même, à 0 mm) ont été franchis sur le segment quitté
+    if(!memeSegment && suivantAvant != 0)
+    {
+        QMultiHash<int, QSharedPointer<DeclencheurVirtuel> >::const_iterator it = declencheursParContact.constFind(suivantAvant);
+        while(it != declencheursParContact.constEnd() && it.key() == suivantAvant)
+        {
+            if((it.value()->getNumLoco() == 0 || it.value()->getNumLoco() == numLoco) &&
+               it.value()->estFranchi(precedentAvant, suivantAvant, true, restantAvant, 0.0, longueurAvant))
+            {
+                CMD_TRAIN->declencheur_active(it.value()->getNumDeclencheur(), numLoco);
+                it.value()->active();
+            }
+            ++it;
+        }
+    }
+
+    QMultiHash<int, QSharedPointer<DeclencheurVirtuel> >::const_iterator it = declencheursParContact.constFind(l->getContactSuivant());
+    while(it != declencheursParContact.constEnd() && it.key() == l->getContactSuivant())
+    {
+        if((it.value()->getNumLoco() == 0 || it.value()->getNumLoco() == numLoco) &&
+           it.value()->estFranchi(l->getContactPrecedent(), l->getContactSuivant(), memeSegment,
+                                  restantAvant, l->getDistanceContactSuivant(), l->getDistanceEntreContacts()))
+        {
+            CMD_TRAIN->declencheur_active(it.value()->getNumDeclencheur(), numLoco);
+            it.value()->active();
+        }
+        ++it;
+    }
+}
+
+qreal SimView::longueurSegment(int contactA, int contactB)
+{
+    Segment* s = getSegmentByContacts(contactA, contactB);
+
+    if(s == nullptr)
+        return -1.0;
+    return s->getLongueur(contacts.value(contactA));
+}
+
+const TableDistances* SimView::getTableDistances() const
+{
+    return &this->tableDistances;
+}
+
+void SimView::calculerDistances()
+{
+    distancesCalculees.assign(TableDistances::TAILLE, -1.0f);
+    arriveesContacts.assign(2 * (MAX_CONTACTS_DISTANCES + 1), nullptr);
+
+    indicesAiguillages.clear();
+    for(VoieVariable* vv : qAsConst(VoiesVariables))
+        indicesAiguillages.insert(vv, indicesAiguillages.size());
+    parcoursAiguillages.assign(indicesAiguillages.size() * TableDistances::NBRE_PARCOURS, 0);
+
+    for(QMap<int, Contact*>::const_iterator it = contacts.constBegin(); it != contacts.constEnd(); ++it)
+    {
+        if(TableDistances::indice(0, it.key(), 0) < 0)
+            continue;
+
+        for(int sortie = 0; sortie < 2; sortie++)
+            parcourirDistances(it.key(), sortie);
+    }
+
+    tableDistances.publier(distancesCalculees);
+}
+
+void SimView::recalculerDistances(Voie *v)
+{
+    int aiguillage = indicesAiguillages.value(v, -1);
+    if(aiguillage < 0)
+        return;
+
+    // Un parcours refait peut ne plus traverser l'aiguillage : sa marque est alors de trop,
+    // ce qui ne coûte qu'un parcours inutile au prochain changement
+    char* parcours = &parcoursAiguillages[aiguillage * TableDistances::NBRE_PARCOURS];
+    for(int p = 0; p < TableDistances::NBRE_PARCOURS; p++)
+    {
+        if(parcours[p])
+            parcourirDistances(p % (MAX_CONTACTS_DISTANCES + 1), p / (MAX_CONTACTS_DISTANCES + 1));
+    }
+
+    tableDistances.publier(distancesCalculees);
+}
+
+void SimView::parcourirDistances(int contact, int sortie)
+{
+    int debut = TableDistances::indice(sortie, contact, 0);
+    std::fill(distancesCalculees.begin() + debut, distancesCalculees.begin() + debut + MAX_CONTACTS_DISTANCES + 1, -1.0f);
+    std::fill(arriveesContacts.begin(), arriveesContacts.end(), nullptr);
+
+    Contact* depart = contacts.value(contact);
+    Voie* voieDepart = depart == nullptr ? nullptr : this->Voies.value(depart->getNumVoiePorteuse());
+    if(voieDepart == nullptr)
+        return;
+
+    distancesCalculees[debut + contact] = 0.0f;
+
+    int numParcours = sortie * (MAX_CONTACTS_DISTANCES + 1) + contact;
+
+    // Garde-fou pour une boucle sans aucun contact numéroté dans la table
+    int limite = 4 * this->Voies.size();
+
+    // Le contact se déclenche à l'entrée de sa voie : on compte donc sa longueur
+    qreal longueur = voieDepart->getLongueurAParcourir();
+    Voie* precedente = voieDepart;
+    Voie* v = voieDepart->getVoieVoisineDOrdre(sortie);
+
+    for(int n = 0; v != nullptr && v != voieDepart && n < limite; n++)
+    {
+        int aiguillage = indicesAiguillages.value(v, -1);
+        if(aiguillage >= 0)
+            parcoursAiguillages[aiguillage * TableDistances::NBRE_PARCOURS + numParcours] = 1;
+
+        Contact* c = v->getContact();
+        if(c != nullptr && TableDistances::indice(sortie, contact, c->getNumContact()) >= 0)
+        {
+            // Un contact peut être atteint dans les deux sens (boucle de retournement) ;
+            // retrouvé en venant de la même voie, le parcours boucle
+            Voie** arrivees = &arriveesContacts[2 * c->getNumContact()];
+            if(arrivees[0] == precedente || arrivees[1] == precedente)
+                break;
+            if(arrivees[0] == nullptr)
+            {
+                arrivees[0] = precedente;
+                distancesCalculees[debut + c->getNumContact()] = longueur;
+            }
+            else
+                arrivees[1] = precedente;
+        }
+
+        longueur += v->getLongueurAParcourir();
+        Voie* suivante = v->getVoieSuivante(precedente);
+        precedente = v;
+        v = suivante;
+    }
+}
+
 Contact* SimView::getContact(int n)
 {
     return this->contacts.value(n);
@@ -182,15 +475,59 @@ Contact* SimView::getContact(int n)
 
 Segment* SimView::getSegmentByContacts(int contactA, int contactB)
 {
-    int min = contactA < contactB ? contactA : contactB;
-    int max = contactA < contactB ? contactB : contactA;
+    return this->segmentsParContacts.value(cleSegment(contactA, contactB), nullptr);
+}
 
-    foreach(Segment* s, this->segments)
-    {
-        if(s->relie(this->contacts.value(min), this->contacts.value(max)))
-            return s;
-    }
-    return nullptr;
+int SimView::getNbreSegments() const
+{
+    return this->segments.length();
+}
+
+const QMap<int, Voie*> &SimView::getVoies() const
+{
+    return this->Voies;
+}
+
+const QMap<int, Contact*> &SimView::getContacts() const
+{
+    return this->contacts;
+}
+
+const QMap<int, VoieVariable*> &SimView::getVoiesVariables() const
+{
+    return this->VoiesVariables;
+}
+
+const QList<Segment*> &SimView::getSegments() const
+{
+    return this->segments;
+}
+
+Voie* SimView::getPremiereVoie() const
+{
+    return this->premiereVoie;
+}
+
+quint64 SimView::cleSegment(int contactA, int contactB)
+{
+    quint32 min = contactA < contactB ? contactA : contactB;
+    quint32 max = contactA < contactB ? contactB : contactA;
+
+    return (quint64(min) << 32) | max;
+}
+
+void SimView::ajouterSegment(Segment *s)
+{
+    this->segments.append(s);
+
+    // Les segments aboutissant à un buttoir ne sont pas indexés
+    if(s->getContact2() == nullptr)
+        return;
+
+    // S'il existe plusieurs chemins entre deux contacts, le premier trouvé est retenu
+    quint64 cle = cleSegment(s->getContact1()->getNumContact(), s->getContact2()->getNumContact());
+    if(!this->segmentsParContacts.contains(cle))
+        this->segmentsParContacts.insert(cle, s);
 }
 
 void SimView::animationStart()
@@ -231,102 +568,394 @@ protected:
 
 void SimView::animationStep()
 {
-    QList<Loco*> listeLocos = this->Locos.values();
+    BilanSimulation *bilan = CMD_TRAIN->getBilan();
 
-    bool tropProche;
+    profil.debutImage();
 
-    QList<Voie*> prochainesVoies;
+    // En simulation accélérée, plusieurs pas sont calculés pour un seul affichage.
+    // Une collision arrête le timer, et donc les pas restants
+    int nbrePas = TrainSimSettings::getInstance()->getAcceleration();
+    for(int i = 0; i < nbrePas && timer->isActive(); i++)
+    {
+        pasAnimation();
+        bilan->avancer();
+    }
+
+    profil.finImage();
+
+    if(bilan->echeanceAtteinte())
+    {
+        animationStop();
+        emit simulationArretee();
+    }
+}
+
+void SimView::pasAnimation()
+{
+    // Chaque phase porte sur toutes les locos, et est mesurée séparément (voir ProfilImages)
+    {
+        MesurePhase mesure(profil, ProfilImages::MOUVEMENT);
+        deplacerLocos();
+        appliquerCommandesDifferees();
+    }
+    {
+        MesurePhase mesure(profil, ProfilImages::COLLISIONS);
+        detecterCollisions();
+    }
+    {
+        MesurePhase mesure(profil, ProfilImages::PROXIMITE);
+        alerterProximite();
+    }
+    {
+        MesurePhase mesure(profil, ProfilImages::PUBLICATION);
+        for(int i = 0; i < listeLocos.size(); i++)
+        {
+            if(listeLocos.at(i)->getVoie() != nullptr)
+                publierPosition(numerosLocos.at(i), listeLocos.at(i));
+        }
+    }
+}
 
-    foreach(Loco* l, listeLocos)
+void SimView::deplacerLocos()
+{
+    for(Loco* l : qAsConst(listeLocos))
     {
-        if(l->getActive() && l->getVoie() != nullptr)
+        Voie* voieAvant = l->getVoie();
+        Voie* suivanteAvant = l->getVoieSuivante();
+
+        l->pasInertie();
+
+        if(l->getActive() && l->getVoie() != nullptr && l->getVitesse() != 0)
+        {
+            unsigned franchisAvant = l->getNbreContactsFranchis();
+            qreal restantAvant = l->getDistanceContactSuivant();
+            int precedentAvant = l->getContactPrecedent();
+            int suivantAvant = l->getContactSuivant();
+            qreal longueurAvant = l->getDistanceEntreContacts();
+
+            l->avancer((l->getVitesse() * 1000.0 / FRAME_RATE) * FACTEUR_VITESSE);
+
+            evaluerDeclencheurs(l, franchisAvant, restantAvant, precedentAvant, suivantAvant, longueurAvant);
+        }
+
+        // Changement de voie, ou de sens (la voie suivante change alors aussi)
+        if(l->getVoie() != voieAvant || l->getVoieSuivante() != suivanteAvant)
         {
-            if(l->getVitesse() != 0)
-                l->avancer((l->getVitesse() * 1000.0 / FRAME_RATE) * FACTEUR_VITESSE);
+            signalerChangementVoie(l, voieAvant);
+            if(l->getVoie() != voieAvant)
+                signalerChangementVoie(l, l->getVoie());
+        }
+    }
+}
+
+void SimView::appliquerCommandesDifferees()
+{
+    QHash<VoieVariable*, int>::iterator it = commandesDifferees.begin();
+    while(it != commandesDifferees.end())
+    {
+        if(it.key()->getLocos().isEmpty())
+        {
+            VoieVariable* vv = it.key();
+            int direction = it.value();
+            it = commandesDifferees.erase(it);
+            vv->setEtat(direction);
+        }
+        else
+            ++it;
+    }
+}
 
-            QPolygonF contourLoco = l->getContour();
-            QPolygonF contourAutreLoco;
-            //test de collision
-            foreach(Loco* otherLoco, listeLocos)
+namespace
+{
+
+/** indique si deux rectangles, donnés par leurs quatre coins dans l'ordre du contour,
+  * se chevauchent (théorème de l'axe séparateur). Des rectangles qui se touchent
+  * seulement ne se chevauchent pas.
+  */
+bool rectanglesSeChevauchent(const QPointF *a, const QPointF *b)
+{
+    const QPointF *rectangles[2] = {a, b};
+
+    // Les axes à tester sont les normales aux côtés des deux rectangles
+    for(const QPointF *r : rectangles)
+    {
+        for(int i = 0; i < 2; i++)
+        {
+            QPointF axe(r[i].y() - r[i + 1].y(), r[i + 1].x() - r[i].x());
+
+            qreal minA = QPointF::dotProduct(a[0], axe), maxA = minA;
+            qreal minB = QPointF::dotProduct(b[0], axe), maxB = minB;
+            for(int j = 1; j < 4; j++)
             {
-                if(l != otherLoco)
-                {
-                    contourAutreLoco = otherLoco->getContour();
-
-                    if(contourLoco.subtracted(contourAutreLoco) != contourLoco)
-                    {
-                        animationStop();
-                        l->setActive(false);
-                        otherLoco->setActive(false);
-                        ExplosionItem *item=new ExplosionItem();
-                        QPixmap img(":images/explosion.png");
-                        item->setPixmap(img);
-                        scene->addItem(item);
-                        QPointF debPoint((l->pos().x()+otherLoco->pos().x())/2,
-                                    (l->pos().y()+otherLoco->pos().y())/2);
-                        QPointF endPoint((l->pos().x()+otherLoco->pos().x())/2-256,
-                                    (l->pos().y()+otherLoco->pos().y())/2-256);
-                        item->setPos(endPoint);
-
-                        QPropertyAnimation *animation1=new QPropertyAnimation(item, "pos");
-                        animation1->setDuration(500);
-                        animation1->setStartValue(debPoint);
-                        animation1->setEndValue(endPoint);
-
-                        QPropertyAnimation *animation2=new QPropertyAnimation(item, "scale");
-                        animation2->setDuration(500);
-                        animation2->setStartValue(0.0);
-                        animation2->setEndValue(1.0);
-
-                        QParallelAnimationGroup *animationGroup=new QParallelAnimationGroup();
-
-                        animationGroup->addAnimation(animation1);
-                        animationGroup->addAnimation(animation2);
-
-                        item->setZValue(ZVAL_EXPLOSION);
-                        item->show();
-                        animationGroup->start();
+                minA = qMin(minA, QPointF::dotProduct(a[j], axe));
+                maxA = qMax(maxA, QPointF::dotProduct(a[j], axe));
+                minB = qMin(minB, QPointF::dotProduct(b[j], axe));
+                maxB = qMax(maxB, QPointF::dotProduct(b[j], axe));
+            }
+
+            if(maxA <= minB || maxB <= minA)
+                return false;
+        }
+    }
+    return true;
+}
+
+}
+
+void SimView::detecterCollisions()
+{
+    for(int i = 0; i < listeLocos.size(); i++)
+        listeLocos.at(i)->getCoins(coinsLocos.data() + 4 * i);
+
+    for(int i = 0; i < listeLocos.size(); i++)
+    {
+        Loco* l = listeLocos.at(i);
+        if(!l->getActive() || l->getVoie() == nullptr)
+            continue;
+
+        //test de collision
+        for(int j = 0; j < listeLocos.size(); j++)
+        {
+            if(j != i && rectanglesSeChevauchent(coinsLocos.constData() + 4 * i, coinsLocos.constData() + 4 * j))
+                collision(l, listeLocos.at(j), numerosLocos.at(i), numerosLocos.at(j));
+        }
+    }
+}
+
+void SimView::collision(Loco* l, Loco* autreLoco, int numLoco, int numAutreLoco)
+{
+    animationStop();
+    CMD_TRAIN->getBilan()->collision(numLoco, numAutreLoco);
+    emit simulationArretee();
+    l->setActive(false);
+    autreLoco->setActive(false);
+    ExplosionItem *item=new ExplosionItem();
+    QPixmap img(":images/explosion.png");
+    item->setPixmap(img);
+    scene->addItem(item);
+    QPointF debPoint((l->pos().x()+autreLoco->pos().x())/2,
+                (l->pos().y()+autreLoco->pos().y())/2);
+    QPointF endPoint((l->pos().x()+autreLoco->pos().x())/2-256,
+                (l->pos().y()+autreLoco->pos().y())/2-256);
+    item->setPos(endPoint);
+
+    QPropertyAnimation *animation1=new QPropertyAnimation(item, "pos");
+    animation1->setDuration(500);
+    animation1->setStartValue(debPoint);
+    animation1->setEndValue(endPoint);
+
+    QPropertyAnimation *animation2=new QPropertyAnimation(item, "scale");
+    animation2->setDuration(500);
+    animation2->setStartValue(0.0);
+    animation2->setEndValue(1.0);
+
+    QParallelAnimationGroup *animationGroup=new QParallelAnimationGroup();
+
+    animationGroup->addAnimation(animation1);
+    animationGroup->addAnimation(animation2);
+
+    item->setZValue(ZVAL_EXPLOSION);
+    item->show();
+    animationGroup->start();
 #ifdef WITHSOUND
-                        SoundThread *thread=new SoundThread(this);
-                        thread->start();
+    SoundThread *thread=new SoundThread(this);
+    thread->start();
 #endif // WITHSOUND
-                    }
-                }
-            }
+}
 
+namespace
+{
 
-            //alerte proximite. Pas encore optimal.
-            qreal distanceSecurite = l->getVitesse() * 2000.0 * FACTEUR_VITESSE;
+/** retourne la distance en deçà de laquelle une loco roulant à la vitesse donnée est
+  * signalée comme trop proche de la loco qui la précède.
+  */
+qreal distanceAlerte(int vitesse, bool inertie)
+{
+    return qMax(vitesse * 2000.0 * FACTEUR_VITESSE, Loco::distanceFreinage(vitesse, inertie) + 2 * MARGE_FREINAGE);
+}
 
-            prochainesVoies.append(l->getVoie());
-            prochainesVoies.append(l->getVoieSuivante());
-            distanceSecurite -= prochainesVoies.last()->getLongueurAParcourir();
+/** retourne la distance jusqu'à laquelle la loco qui précède une loco est recherchée :
+  * assez loin, quelle que soit la vitesse de la loco et même avec l'inertie, pour une
+  * loco en face roulant à la vitesse maximale.
+  */
+qreal horizonProximite()
+{
+    return distanceAlerte(VITESSE_MAXIMUM, true) + Loco::distanceFreinage(VITESSE_MAXIMUM, true) + LONGUEUR_LOCO;
+}
+
+}
+
+qreal SimView::distanceLocoDevant(Loco* l, qreal limite, Loco* &devant, bool &enFace, std::vector<Voie*> &voies) const
+{
+    Voie* precedente = l->getVoie();
+    Voie* v = l->getVoieSuivante();
+    qreal position = l->getDistanceFinVoie();
+    qreal plusProche = -1.0;
 
-            while(distanceSecurite > 0)
+    devant = nullptr;
+    enFace = false;
+    voies.push_back(precedente);
+
+    // Sur la voie de la loco, les positions sont comptées depuis l'extrémité vers laquelle elle roule
+    for(Loco* autreLoco : precedente->getLocos())
+    {
+        if(autreLoco == l || !autreLoco->getActive())
+            continue;
+
+        bool autreEnFace = autreLoco->getVoieSuivante() != v;
+        qreal d = autreEnFace ? precedente->getLongueurAParcourir() - autreLoco->getDistanceFinVoie()
+                              : autreLoco->getDistanceFinVoie();
+        if(d < position && (devant == nullptr || position - d < plusProche))
+        {
+            devant = autreLoco;
+            enFace = autreEnFace;
+            plusProche = position - d;
+        }
+    }
+
+    // Sur les voies suivantes, depuis l'extrémité par laquelle la loco y entrera
+    qreal parcouru = position;
+    for(int n = 0; devant == nullptr && v != nullptr && parcouru < limite && n < Voies.size(); n++)
+    {
+        Voie* suivante = v->getVoieSuivante(precedente);
+        voies.push_back(v);
+
+        for(Loco* autreLoco : v->getLocos())
+        {
+            if(autreLoco == l || !autreLoco->getActive())
+                continue;
+
+            bool autreEnFace = autreLoco->getVoieSuivante() != suivante;
+            qreal d = autreEnFace ? autreLoco->getDistanceFinVoie()
+                                  : v->getLongueurAParcourir() - autreLoco->getDistanceFinVoie();
+            if(devant == nullptr || parcouru + d < plusProche)
             {
-                prochainesVoies.append(prochainesVoies.last()->getVoieSuivante(prochainesVoies.at(prochainesVoies.length()-2)));
-                distanceSecurite -= prochainesVoies.last()->getLongueurAParcourir();
+                devant = autreLoco;
+                enFace = autreEnFace;
+                plusProche = parcouru + d;
             }
+        }
+
+        parcouru += v->getLongueurAParcourir();
+        precedente = v;
+        v = suivante;
+    }
+
+    return plusProche;
+}
+
+void SimView::rechercherLocoDevant(int i)
+{
+    Loco* l = listeLocos.at(i);
+    SuiviProximite &s = suivisProximite[i];
+
+    for(Voie* v : s.voies)
+        v->retirerObservateur(l);
+    s.voies.clear();
+
+    s.aRechercher = false;
+    s.devant = nullptr;
+    if(!l->getActive() || l->getVoie() == nullptr)
+        return;
+
+    // Les voies parcourues couvrent l'horizon tant que la loco n'a pas changé de voie
+    s.distance = distanceLocoDevant(l, l->getDistanceFinVoie() + horizonProximite(), s.devant, s.enFace, s.voies);
+    s.parcoursLoco = l->getDistanceParcourue();
+    s.parcoursDevant = s.devant != nullptr ? s.devant->getDistanceParcourue() : 0.0;
+
+    for(Voie* v : s.voies)
+        v->ajouterObservateur(l);
+}
+
+void SimView::signalerChangementVoie(Loco *l, Voie *v)
+{
+    if(v != nullptr)
+    {
+        for(Loco* observateur : v->getObservateurs())
+            suivisProximite[indicesLocos.value(observateur)].aRechercher = true;
+    }
+
+    // La loco quitte les voies parcourues par sa recherche, et peut entrer sur une voie
+    // que n'a pas parcourue celle des locos qui la suivent
+    suivisProximite[indicesLocos.value(l)].aRechercher = true;
+    for(SuiviProximite &s : suivisProximite)
+    {
+        if(s.devant == l)
+            s.aRechercher = true;
+    }
+}
+
+void SimView::reinitialiserProximite()
+{
+    for(SuiviProximite &s : suivisProximite)
+        s.aRechercher = true;
+}
+
+void SimView::alerterProximite()
+{
+    bool freinage = TrainSimSettings::getInstance()->getFreinageAutomatique();
+    bool inertie = TrainSimSettings::getInstance()->getInertie();
 
-            tropProche = false;
+    // Une loco arrêtée ou relancée depuis les commandes n'est plus, ou à nouveau, un obstacle
+    for(int i = 0; i < listeLocos.size(); i++)
+    {
+        if(listeLocos.at(i)->getActive() != suivisProximite[i].active)
+        {
+            suivisProximite[i].active = listeLocos.at(i)->getActive();
+            reinitialiserProximite();
+        }
+    }
+
+    for(int i = 0; i < listeLocos.size(); i++)
+    {
+        Loco* l = listeLocos.at(i);
+        if(!l->getActive() || l->getVoie() == nullptr)
+            continue;
+
+        // Le frein serré, la distance nécessaire est celle de la vitesse commandée :
+        // il n'est desserré que si la loco peut reprendre cette vitesse sans danger
+        int vitesse = qMax(l->getVitesse(), l->getVitesseCommandee());
+        qreal alerte = distanceAlerte(vitesse, inertie);
+
+        SuiviProximite &s = suivisProximite[i];
+        if(s.aRechercher)
+            rechercherLocoDevant(i);
+
+        Loco* devant = s.devant;
+        bool enFace = s.enFace;
+        qreal distance = -1.0;
+        if(devant != nullptr)
+        {
+            // Une loco en face se rapproche en avançant, une loco devant s'éloigne
+            qreal parcoursDevant = devant->getDistanceParcourue() - s.parcoursDevant;
+            distance = s.distance - (l->getDistanceParcourue() - s.parcoursLoco) +
+                       (enFace ? -parcoursDevant : parcoursDevant);
+            distance = qMax(qreal(0.0), distance - LONGUEUR_LOCO);
+        }
 
-            foreach(Voie* v, prochainesVoies)
+        l->setAlerteProximite(devant != nullptr && distance < alerte);
+
+        if(!freinage)
+        {
+            l->setFreinAutomatique(false);
+            continue;
+        }
+
+        // Deux locos qui se font face freinent toutes deux : il faut la place pour les deux arrêts
+        qreal distanceArret = Loco::distanceFreinage(vitesse, inertie) + MARGE_FREINAGE;
+        if(devant != nullptr && enFace)
+            distanceArret += Loco::distanceFreinage(qMax(devant->getVitesse(), devant->getVitesseCommandee()), inertie);
+
+        if(devant != nullptr && distance <= distanceArret && vitesse > 0)
+        {
+            if(!l->getFreinAutomatique())
             {
-                foreach(Loco* autreLoco, listeLocos)
-                {
-                    if(autreLoco != l && v == autreLoco->getVoie())
-                    {
-                        tropProche = true;
-                    }
-                }
+                l->setFreinAutomatique(true);
+                CMD_TRAIN->getBilan()->freinageAutomatique(numerosLocos.at(i));
             }
-            if(tropProche)
-                l->setAlerteProximite(true);
-            else
-                l->setAlerteProximite(false);
-
-            prochainesVoies.clear();
         }
+        else if(devant == nullptr || distance > distanceArret + MARGE_FREINAGE)
+            l->setFreinAutomatique(false);
     }
 }
 
@@ -341,7 +970,7 @@ void SimView::setLoco(int contactA, int contactB, int numLoco, int vitesseLoco)
 
     if (s == nullptr)
     {
-        QMessageBox::warning(this,"Error",QString("Les numéros de contact (%1,%2) entre lesquels se trouve la loco ne sont pas valides. Ils doivent être directement voisins.\nL'application va se terminer.").arg(contactA).arg(contactB));
+        MainWindow::signalerErreur(this,"Error",QString("Les numéros de contact (%1,%2) entre lesquels se trouve la loco ne sont pas valides. Ils doivent être directement voisins.\nL'application va se terminer.").arg(contactA).arg(contactB));
         exit(-1);
     }
 
@@ -368,6 +997,12 @@ void SimView::setLoco(int contactA, int contactB, int numLoco, int vitesseLoco)
         l->setRotation(l->rotation() + (- v->getAngleDeg(0) - 180.0) < 0.0 ? (- v->getAngleDeg(0) + 180.0) : (- v->getAngleDeg(0) - 180.0));
         l->setAngleCumule(l->getAngleCumule() + ((v->getAngleDeg(0) - 180.0) < 0.0 ? (v->getAngleDeg(0) + 180.0) : (v->getAngleDeg(0) - 180.0)));
     }
+
+    l->setSegmentActuel(s);
+    l->initialiserPosition();
+    publierPosition(numLoco, l);
+
+    reinitialiserProximite();
 }
 
 void SimView::askLoco(int /*contactA*/, int /*contactB*/)
@@ -386,7 +1021,12 @@ void SimView::reverseLoco(int numLoco)
 {
     if (!checkLoco(numLoco))
         return;
-    this->Locos.value(numLoco)->inverserSens();
+    Loco* l = this->Locos.value(numLoco);
+    l->inverserSens();
+
+    // Sans inertie, le sens change immédiatement, hors du pas d'animation
+    if(l->getVoie() != nullptr)
+        signalerChangementVoie(l, l->getVoie());
 }
 
 void SimView::setVitesseProgressiveLoco(int numLoco, int vitesseLoco)
@@ -403,21 +1043,62 @@ void SimView::stopLoco(int numLoco)
     this->Locos.value(numLoco)->setVitesse(0);
 }
 
-void SimView::setVoieVariable(int numVoieVariable, int direction)
+void SimView::setVoieVariable(int numVoieVariable, int direction, int politique)
 {
     if (!checkVoieVariable(numVoieVariable))
         return;
-    this->VoiesVariables.value(numVoieVariable)->setEtat(direction);
+
+    VoieVariable* vv = this->VoiesVariables.value(numVoieVariable);
+
+    // La commande remplace toujours la commande différée de la voie
+    commandesDifferees.remove(vv);
+
+    if (politique != ENCLENCHEMENT_APPLIQUER && !vv->getLocos().isEmpty())
+    {
+        if (vv->getEtat() == direction)
+            return;
+
+        if (politique == ENCLENCHEMENT_DIFFERER)
+        {
+            commandesDifferees.insert(vv, direction);
+            CMD_TRAIN->getBilan()->aiguillageDiffere();
+        }
+        else
+        {
+            CMD_TRAIN->getBilan()->aiguillageRefuse();
+            CMD_TRAIN->afficher_message(qPrintable(QString("Aiguillage %1 occupé : commande refusée").arg(numVoieVariable)));
+        }
+        return;
+    }
+
+    vv->setEtat(direction);
 }
 
 void SimView::locoSurNouveauSegment(Contact *ctc1, Contact *ctc2, Loco *l)
 {
-    l->setSegmentActuel(getSegmentByContacts(contacts.key(ctc1), contacts.key(ctc2)));
+    if(ctc1 != nullptr)
+        CMD_TRAIN->contact_active(ctc1->getNumContact(), l->getNumero());
+
+    l->setSegmentActuel(getSegmentByContacts(ctc1 != nullptr ? ctc1->getNumContact() : 0,
+                                             ctc2 != nullptr ? ctc2->getNumContact() : 0));
 }
 
 void SimView::voieVariableModifiee(Voie *v)
 {
-    notificationVoieVariableModifiee(v);
+    // Une loco se trouvant sur l'aiguillage déraille. Seules les locos présentes sur la
+    // voie sont prévenues : le coût d'un changement ne dépend pas du nombre de locos.
+    for(Loco* l : v->getLocos())
+    {
+        if(!l->getDeraille())
+            CMD_TRAIN->getBilan()->deraillement(l->getNumero());
+        l->voieVariableModifiee(v);
+    }
+
+    // Le chemin suivi par les recherches passant par l'aiguillage change
+    for(Loco* l : v->getObservateurs())
+        suivisProximite[indicesLocos.value(l)].aRechercher = true;
+
+    recalculerDistances(v);
 }
 
 
@@ -425,7 +1106,7 @@ bool SimView::checkLoco(int numLoco)
 {
     if (!this->Locos.contains(numLoco))
     {
-        QMessageBox::critical(this,"Erreur",QString("La loco %1 n'existe pas!\nL'application va se terminer.").arg(numLoco));
+        MainWindow::signalerErreur(this,"Erreur",QString("La loco %1 n'existe pas!\nL'application va se terminer.").arg(numLoco));
         exit(-1);
     }
     return true;
@@ -435,7 +1116,7 @@ bool SimView::checkVoieVariable(int numVoie)
 {
     if (!this->VoiesVariables.contains(numVoie))
     {
-        QMessageBox::critical(this,"Erreur",QString("La voie variable %1 n'existe pas sur la maquette sélectionnée!\nL'application va se terminer.").arg(numVoie));
+        MainWindow::signalerErreur(this,"Erreur",QString("La voie variable %1 n'existe pas sur la maquette sélectionnée!\nL'application va se terminer.").arg(numVoie));
         exit(-1);
     }
     return true;
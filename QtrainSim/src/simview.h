@@ -4,12 +4,21 @@
 #include <QGraphicsView>
 #include <QGraphicsScene>
 #include <QTimer>
+#include <QHash>
+#include <QMultiHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
 
 #include "connect.h"
 #include "voie.h"
 #include "voievariable.h"
 #include "loco.h"
 #include "segment.h"
+#include "instantanemonde.h"
+#include "declencheurvirtuel.h"
+#include "tabledistances.h"
+#include "profilimages.h"
 
 
 class ExplosionItem :  public QObject, public QGraphicsPixmapItem
@@ -77,6 +86,12 @@ public:
       */
     void genererSegments();
 
+    /** Installe des segments déjà calculés (maquette compilée), en lieu et place de
+      * genererSegments(). La simulation devient propriétaire des segments.
+      * \param segments les segments de la maquette.
+      */
+    void setSegments(const QList<Segment*> &segments);
+
     /** Ajoute une locomotive.
       * \param l la loco à ajouter.
       * \param ID le numéro de la loco.
@@ -114,6 +129,96 @@ public:
       *
       */
     void redraw();
+
+    /** retourne l'instantané du monde publié à chaque pas d'animation.
+      * Peut être lu depuis n'importe quel thread sans verrou.
+      * \return l'instantané du monde.
+      */
+    const InstantaneMonde* getInstantaneMonde() const;
+
+    /** Enregistre un déclencheur virtuel sur le segment allant de contactPrecedent
+      * à contactSuivant. Peut être appelé depuis n'importe quel thread.
+      * \param numLoco la loco qui active le point, 0 pour n'importe laquelle.
+      * \param contactPrecedent le contact précédant le point, 0 pour n'importe lequel.
+      * \param contactSuivant le contact suivant le point.
+      * \param distance la distance définissant le point, en mm.
+      * \param depuisPrecedent vrai si la distance est mesurée depuis contactPrecedent,
+      *        faux si elle est mesurée avant contactSuivant.
+      * \return le numéro du déclencheur, -1 si les contacts ne sont pas valides.
+      */
+    int ajouterDeclencheur(int numLoco, int contactPrecedent, int contactSuivant, qreal distance, bool depuisPrecedent);
+
+    /** Retire un déclencheur virtuel. Il ne sera plus évalué.
+      * \param numDeclencheur le numéro du déclencheur.
+      */
+    void supprimerDeclencheur(int numDeclencheur);
+
+    /** retourne le déclencheur virtuel ayant le numéro n.
+      * \param n le numéro du déclencheur.
+      * \return le déclencheur, nul s'il n'existe pas.
+      */
+    QSharedPointer<DeclencheurVirtuel> getDeclencheur(int n);
+
+    /** retourne la longueur de voie entre deux contacts voisins, dans le sens de
+      * contactA vers contactB.
+      * \param contactA le contact de départ.
+      * \param contactB le contact d'arrivée.
+      * \return la longueur en mm, -1 si les contacts ne sont pas voisins.
+      */
+    qreal longueurSegment(int contactA, int contactB);
+
+    /** retourne la table des distances entre contacts, tenue à jour selon l'état
+      * des aiguillages. Peut être lue depuis n'importe quel thread sans verrou.
+      * \return la table des distances.
+      */
+    const TableDistances* getTableDistances() const;
+
+    /** retourne le segment correspondant à la paire de contacts passée en paramètre
+      * \param contactA et contactB les contacts définissant les segment.
+      * \return le segment correspondant, nullptr s'il n'existe pas.
+      */
+    Segment* getSegmentByContacts(int contactA, int contactB);
+
+    /** retourne le nombre de segments de la maquette.
+      * \return le nombre de segments.
+      */
+    int getNbreSegments() const;
+
+    /** retourne les voies de la maquette, indexées par numéro.
+      * \return les voies.
+      */
+    const QMap<int, Voie*> &getVoies() const;
+
+    /** retourne les contacts de la maquette, indexés par numéro.
+      * \return les contacts.
+      */
+    const QMap<int, Contact*> &getContacts() const;
+
+    /** retourne les voies variables de la maquette, indexées par numéro de voie variable.
+      * \return les voies variables.
+      */
+    const QMap<int, VoieVariable*> &getVoiesVariables() const;
+
+    /** retourne les segments de la maquette.
+      * \return les segments.
+      */
+    const QList<Segment*> &getSegments() const;
+
+    /** retourne la première voie posée.
+      * \return la première voie.
+      */
+    Voie* getPremiereVoie() const;
+
+    /** retourne le profil des images de la simulation. A n'utiliser que depuis le
+      * thread de l'interface.
+      * \return le profil.
+      */
+    ProfilImages &getProfil();
+
+protected:
+    /** dessine la vue, en mesurant la durée du dessin.
+      */
+    void paintEvent(QPaintEvent *event) override;
 signals:
 
     /** Signale qu'une loco a changé de segment, et se trouve que le segment s.
@@ -121,14 +226,14 @@ signals:
       */
     void locoSurSegment(Segment* s);
 
-    /** Signale le changment d'état d'une voie variable.
-      * \param v la voie variable ayant changé.
+    /** Signale que la simulation s'est arrêtée d'elle-même : collision entre deux
+      * locos, ou durée maximale du bilan atteinte.
       */
-    void notificationVoieVariableModifiee(Voie* v);
+    void simulationArretee();
 public slots:
 
-    /** effectue un nouveau pas d'animation.
-      *
+    /** effectue un nouveau pas d'animation par période du timer, ou plusieurs
+      * pas en simulation accélérée (voir TrainSimSettings::getAcceleration).
       */
     void animationStep();
 
@@ -177,11 +282,16 @@ public slots:
       */
     void stopLoco(int numLoco);
 
-    /** modifie l'etat d'une voie variable.
+    /** modifie l'etat d'une voie variable. Si une loco se trouve sur la voie, la
+      * politique d'enclenchement choisit le sort de la commande : appliquée (la loco
+      * déraille), refusée, ou différée jusqu'à ce que la voie soit libre. Une commande
+      * qui ne change pas l'état d'une voie occupée est sans effet, et une commande plus
+      * récente remplace la commande différée de la même voie.
       * \param numVoieVariable le numéro de la voie variable.
       * \param direction la nouvelle direction de la voie (DEVIE ou TOUT_DROIT)
+      * \param politique ENCLENCHEMENT_APPLIQUER, ENCLENCHEMENT_REFUSER ou ENCLENCHEMENT_DIFFERER.
       */
-    void setVoieVariable(int numVoieVariable, int direction);
+    void setVoieVariable(int numVoieVariable, int direction, int politique = ENCLENCHEMENT_APPLIQUER);
 
     /** reçoit l'information qu'une loco a changé de segment.
       * \param ctc1 et ctc2 définissent le segment.
@@ -201,15 +311,156 @@ private:
     QMap<int, Voie*> Voies;
     QMap<int, VoieVariable*> VoiesVariables;
     QMap<int, Contact*> contacts;
-    Voie* premiereVoie;
+    Voie* premiereVoie{nullptr};
     QMap<int, Loco*> Locos;
     QList<Segment*> segments;
+    QHash<quint64, Segment*> segmentsParContacts;
+    InstantaneMonde instantane;
+    QMutex mutexDeclencheurs;
+    QHash<int, QSharedPointer<DeclencheurVirtuel> > declencheurs;
+    QMultiHash<int, QSharedPointer<DeclencheurVirtuel> > declencheursParContact;
+    int prochainDeclencheur{1};
+    TableDistances tableDistances;
+
+    // Etat du calcul de la table des distances, conservé d'un changement d'aiguillage à l'autre
+    std::vector<float> distancesCalculees;      //!> La table publiée
+    QHash<Voie*, int> indicesAiguillages;       //!> Indice de chaque voie variable
+    std::vector<char> parcoursAiguillages;      //!> Par voie variable et par parcours, vrai si le parcours la traverse
+    std::vector<Voie*> arriveesContacts;        //!> Par contact, les voies d'où le parcours en cours l'a atteint (une par sens)
+    ProfilImages profil;
+
+    // Tampons du pas d'animation, dimensionnés à l'ajout des locos : un pas ne réserve pas de mémoire
+    QVector<Loco*> listeLocos;          //!> Les locos, dans l'ordre de leur numéro
+    QVector<int> numerosLocos;          //!> Les numéros des locos de listeLocos
+    QVector<QPointF> coinsLocos;        //!> Les quatre coins de chaque loco, recalculés à chaque pas
+
+    //! Loco précédant une loco, tenue à jour par événements (voir alerterProximite)
+    struct SuiviProximite
+    {
+        Loco* devant{nullptr};
+        bool enFace{false};
+        qreal distance{0.0};                //!> Distance entre les centres lors de la recherche
+        qreal parcoursLoco{0.0};            //!> Distances parcourues par les deux locos lors de la recherche
+        qreal parcoursDevant{0.0};
+        bool active{true};
+        bool aRechercher{true};
+        std::vector<Voie*> voies;           //!> Voies sur lesquelles la loco est inscrite
+    };
+    std::vector<SuiviProximite> suivisProximite;    //!> Dans l'ordre de listeLocos
+    QHash<Loco*, int> indicesLocos;                 //!> Indice de chaque loco dans listeLocos
+
+    QHash<VoieVariable*, int> commandesDifferees;   //!> Etat attendu des voies variables occupées
+
+    /** retourne la clé d'indexation du segment reliant deux contacts, indépendante de leur ordre.
+      * \param contactA et contactB les contacts définissant le segment.
+      * \return la clé du segment.
+      */
+    static quint64 cleSegment(int contactA, int contactB);
 
-    /** retourne le segment correspondant à la paire de contacts passée en paramètre
-      * \param contactA et contactB les contacts définissant les segment.
-      * \return le segment correspondant.
+    /** ajoute un segment à la liste des segments et l'indexe par sa paire de contacts.
+      * \param s le segment à ajouter.
       */
-    Segment* getSegmentByContacts(int contactA, int contactB);
+    void ajouterSegment(Segment* s);
+
+    /** effectue un pas d'animation : avance les locos, détecte les collisions et
+      * publie les positions.
+      */
+    void pasAnimation();
+
+    /** avance les locos actives et évalue les déclencheurs virtuels franchis.
+      */
+    void deplacerLocos();
+
+    /** applique les commandes différées des voies variables devenues libres.
+      */
+    void appliquerCommandesDifferees();
+
+    /** arrête la simulation si deux locos se touchent.
+      */
+    void detecterCollisions();
+
+    /** signale les locos qui s'approchent trop de la loco qui les précède, et, si le
+      * freinage automatique est actif, les freine lorsque la distance qui les en sépare
+      * n'excède plus leur distance de freinage. Le frein est desserré, et la vitesse
+      * commandée reprise, lorsque la voie est à nouveau libre.
+      * La loco qui précède chaque loco n'est recherchée à nouveau qu'après un changement
+      * de voie ou de sens d'une loco, ou d'un aiguillage, sur le chemin parcouru par la
+      * recherche (voir signalerChangementVoie) ; entre deux recherches, la distance est
+      * tenue à jour d'après les distances parcourues par les deux locos.
+      */
+    void alerterProximite();
+
+    /** cherche à nouveau la loco qui précède une loco, et inscrit la loco sur les voies
+      * parcourues par la recherche.
+      * \param i l'indice de la loco dans listeLocos.
+      */
+    void rechercherLocoDevant(int i);
+
+    /** signale que l'occupation d'une voie a changé : une loco y est entrée, l'a quittée,
+      * ou y a changé de sens. Les locos dont la recherche passe par la voie, la loco
+      * elle-même et celles qu'elle précède seront recherchées à nouveau.
+      * \param l la loco.
+      * \param v la voie.
+      */
+    void signalerChangementVoie(Loco* l, Voie* v);
+
+    /** demande une nouvelle recherche de la loco qui précède chaque loco.
+      */
+    void reinitialiserProximite();
+
+    /** cherche la loco qui précède une loco, en suivant les voies dans son sens de
+      * marche selon l'état des aiguillages. Seules les voies situées à moins de limite
+      * sont parcourues : le coût ne dépend que de la longueur des voies parcourues, et
+      * non du nombre de locos.
+      * \param l la loco.
+      * \param limite la distance au-delà de laquelle la recherche s'arrête, en mm.
+      * \param devant la loco trouvée, nullptr s'il n'y en a pas.
+      * \param enFace vrai si la loco trouvée roule vers l.
+      * \param voies les voies parcourues, y compris celle de la loco.
+      * \return la distance entre les centres des deux locos, en mm.
+      */
+    qreal distanceLocoDevant(Loco* l, qreal limite, Loco* &devant, bool &enFace, std::vector<Voie*> &voies) const;
+
+    /** affiche la collision de deux locos, et arrête la simulation.
+      * \param l et autreLoco les locos entrées en collision.
+      * \param numLoco et numAutreLoco leurs numéros.
+      */
+    void collision(Loco* l, Loco* autreLoco, int numLoco, int numAutreLoco);
+
+    /** publie la position de la loco dans l'instantané du monde.
+      * \param numLoco le numéro de la loco.
+      * \param l la loco.
+      */
+    void publierPosition(int numLoco, Loco* l);
+
+    /** active les déclencheurs virtuels franchis par une loco pendant le pas d'animation.
+      * \param l la loco.
+      * \param franchisAvant le nombre de contacts franchis par la loco avant le pas.
+      * \param restantAvant la distance jusqu'au contact suivant avant le pas.
+      * \param precedentAvant et suivantAvant les contacts précédent et suivant avant le pas.
+      * \param longueurAvant la distance entre ces deux contacts.
+      */
+    void evaluerDeclencheurs(Loco* l, unsigned franchisAvant, qreal restantAvant,
+                             int precedentAvant, int suivantAvant, qreal longueurAvant);
+
+    /** recalcule la table des distances entre contacts selon l'état actuel des
+      * aiguillages, en parcourant la maquette depuis chaque contact dans les deux sens.
+      */
+    void calculerDistances();
+
+    /** met à jour la table des distances après le changement d'une voie variable : seuls
+      * les parcours passés par cette voie lors de leur dernier calcul sont refaits.
+      * Ne réserve pas de mémoire.
+      * \param v la voie variable modifiée.
+      */
+    void recalculerDistances(Voie* v);
+
+    /** (re)calcule les distances depuis un contact, en quittant sa voie par une extrémité,
+      * et note les voies variables traversées.
+      * \param contact le contact de départ.
+      * \param sortie l'extrémité par laquelle le parcours quitte la voie du contact.
+      */
+    void parcourirDistances(int contact, int sortie);
 
     bool checkLoco(int numLoco);
 
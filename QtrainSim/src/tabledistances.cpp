@@ -0,0 +1,63 @@
+#include "tabledistances.h"
+
+TableDistances::TableDistances()
+{
+    for(int i = 0; i < TAILLE; i++)
+        distances[i].store(-1.0f, std::memory_order_relaxed);
+}
+
+int TableDistances::indice(int sortie, int a, int b)
+{
+    if(sortie < 0 || sortie > 1 || a < 0 || a > MAX_CONTACTS_DISTANCES || b < 0 || b > MAX_CONTACTS_DISTANCES)
+        return -1;
+    return (sortie * (MAX_CONTACTS_DISTANCES + 1) + a) * (MAX_CONTACTS_DISTANCES + 1) + b;
+}
+
+void TableDistances::publier(const std::vector<float> &distances)
+{
+    unsigned seq = sequence.load(std::memory_order_relaxed);
+
+    sequence.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    for(int i = 0; i < TAILLE; i++)
+        this->distances[i].store(distances[i], std::memory_order_relaxed);
+
+    sequence.store(seq + 2, std::memory_order_release);
+}
+
+float TableDistances::lire(int sortie, int a, int b) const
+{
+    int i = indice(sortie, a, b);
+    if(i < 0)
+        return -1.0f;
+
+    unsigned avant, apres;
+    float d = -1.0f;
+
+    do
+    {
+        avant = sequence.load(std::memory_order_acquire);
+        if(avant & 1u)
+            continue;
+
+        d = distances[i].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        apres = sequence.load(std::memory_order_relaxed);
+    } while((avant & 1u) || avant != apres);
+
+    return d;
+}
+
+float TableDistances::lireMin(int a, int b) const
+{
+    float d0 = lire(0, a, b);
+    float d1 = lire(1, a, b);
+
+    if(d0 < 0.0f)
+        return d1;
+    if(d1 < 0.0f)
+        return d0;
+    return d0 < d1 ? d0 : d1;
+}
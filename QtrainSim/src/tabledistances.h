@@ -0,0 +1,60 @@
+#ifndef TABLEDISTANCES_H
+#define TABLEDISTANCES_H
+
+#include <atomic>
+#include <vector>
+
+#include "general.h"
+
+/**
+ * Table des distances de contact à contact, dans chaque sens de marche, selon l'état
+ * actuel des aiguillages.
+ *
+ * La distance de A vers B en quittant la voie de A par son extrémité s est mesurée
+ * entre le déclenchement de A et celui de B, comme Segment::getLongueur.
+ * La table est indexée par numéro de contact et tient en cache (2 x 65 x 65 flottants
+ * pour MAX_CONTACTS = 64). Seuls les contacts numérotés jusqu'à MAX_CONTACTS_DISTANCES
+ * y figurent. Elle est recalculée par le thread de simulation et lue sans verrou par
+ * les threads clients, protégée par un compteur de séquence.
+ */
+class TableDistances
+{
+public:
+    //! Nombre d'entrées de la table
+    static const int TAILLE = 2 * (MAX_CONTACTS_DISTANCES + 1) * (MAX_CONTACTS_DISTANCES + 1);
+
+    //! Nombre de lignes de la table : une par contact de départ et par extrémité de sa voie
+    static const int NBRE_PARCOURS = 2 * (MAX_CONTACTS_DISTANCES + 1);
+
+    TableDistances();
+
+    /** retourne l'indice d'une entrée de la table.
+      * \param sortie l'extrémité par laquelle on quitte la voie du contact a (0 ou 1).
+      * \param a le contact de départ.
+      * \param b le contact d'arrivée.
+      * \return l'indice, -1 si les paramètres sont hors limites.
+      */
+    static int indice(int sortie, int a, int b);
+
+    /** Publie une nouvelle table. A n'appeler que depuis le thread de simulation.
+      * \param distances les TAILLE distances, -1 pour un contact inaccessible.
+      */
+    void publier(const std::vector<float> &distances);
+
+    /** retourne la distance de a vers b en quittant la voie de a par l'extrémité sortie.
+      * \return la distance en mm, -1 si b n'est pas accessible.
+      */
+    float lire(int sortie, int a, int b) const;
+
+    /** retourne la plus courte distance de a vers b, quelle que soit l'extrémité par
+      * laquelle on quitte la voie de a.
+      * \return la distance en mm, -1 si b n'est pas accessible.
+      */
+    float lireMin(int a, int b) const;
+
+private:
+    std::atomic<unsigned> sequence{0};
+    std::atomic<float> distances[TAILLE];
+};
+
+#endif // TABLEDISTANCES_H
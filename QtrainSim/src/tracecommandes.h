@@ -0,0 +1,77 @@
+#ifndef TRACECOMMANDES_H
+#define TRACECOMMANDES_H
+
+#include <QtGlobal>
+
+/**
+ * Format binaire d'une trace de commandes (fichier .qtt).
+ *
+ * Une trace enregistre le déroulement d'une simulation, vu du programme client :
+ * activations de contacts et franchissements de déclencheurs virtuels (avec la loco
+ * responsable), attentes, commandes de vitesse, de sens, d'aiguillage et de création de
+ * déclencheurs, ainsi que les réponses des lectures de l'état de la simulation dont
+ * dépend le programme client, dans l'ordre où elles ont eu lieu. Elle permet de rejouer
+ * le programme client sans la simulation (voir BackendRejeu). Elle contient aussi la graine de la
+ * simulation et l'ordre dans lequel les threads du programme client ont franchi ses points de
+ * synchronisation (voir Ordonnanceur), pour que le rejeu soit exact.
+ *
+ * Le fichier est un en-tête suivi d'une suite d'événements de taille fixe. Les entiers
+ * sont stockés dans l'ordre d'octets de la machine ayant enregistré la trace, vérifié
+ * au chargement grâce au champ boutisme.
+ */
+namespace TraceCommandes
+{
+    //! Signature en tête de fichier
+    const char SIGNATURE[8] = {'Q', 'T', 'R', 'S', 'T', 'R', 'C', '\0'};
+
+    //! Version du format, à incrémenter à chaque modification des enregistrements
+    const quint32 VERSION = 3;
+
+    //! Valeur du champ boutisme telle qu'écrite par la machine ayant enregistré la trace
+    const quint32 BOUTISME = 0x01020304;
+
+    //! Extension des fichiers de trace
+    const char EXTENSION[] = ".qtt";
+
+    enum TypeEvenement
+    {
+        CONTACT = 1,                    //!> Contact a activé par la loco
+        VITESSE = 2,                    //!> Vitesse a de la loco (arreter_loco : a = 0)
+        VITESSE_PROGRESSIVE = 3,        //!> Vitesse progressive a de la loco
+        INVERSION = 4,                  //!> Inversion du sens de la loco
+        AIGUILLAGE = 5,                 //!> Aiguillage a dirigé dans la direction b
+        ATTENTE = 6,                    //!> Attente du contact a par le programme client
+        SYNCHRO = 7,                    //!> Point de synchronisation a franchi par le thread de la loco, b-ième passage
+        GRAINE = 8,                     //!> Graine a de la simulation
+        DECLENCHEUR = 9,                //!> Déclencheur a créé à d µm avant le contact c, après le contact b (0 pour n'importe lequel), pour la loco (0 pour n'importe laquelle)
+        DECLENCHEUR_SEGMENT = 10,       //!> Déclencheur a créé à d µm après le contact b, vers le contact c, pour la loco
+        FRANCHISSEMENT = 11,            //!> Déclencheur a franchi par la loco
+        ATTENTE_DECLENCHEUR = 12,       //!> Attente du déclencheur a par le programme client
+        LONGUEUR = 13,                  //!> Longueur c µm (-1 si non voisins) du segment allant du contact a au contact b, lue par le programme client
+        VITESSE_REELLE = 14             //!> Vitesse réelle a de la loco, lue par le programme client
+    };
+
+    struct EnTete
+    {
+        char signature[8];
+        quint32 version;
+        quint32 boutisme;
+    };
+
+    struct Evenement
+    {
+        quint32 tempsMs;                //!> Temps écoulé depuis le début de l'enregistrement
+        quint8 type;                    //!> TypeEvenement
+        quint8 reserve;
+        quint16 loco;                   //!> Numéro de la loco, 0 pour un aiguillage
+        qint32 a;
+        qint32 b;
+        qint32 c;
+        qint32 d;
+    };
+
+    static_assert(sizeof(EnTete) == 16, "En-tête de trace mal aligné");
+    static_assert(sizeof(Evenement) == 24, "Evénement de trace mal aligné");
+}
+
+#endif // TRACECOMMANDES_H
@@ -6,6 +6,9 @@ TrainSimSettings::TrainSimSettings()
     viewContactNumber = false;
     viewAiguillageNumber = false;
     inertie = true;
+    acceleration = 1;
+    freinageAutomatique = false;
+    sansFenetre = false;
 }
 
 
@@ -55,3 +58,32 @@ void TrainSimSettings::setInertie(bool enable)
     inertie = enable;
 }
 
+int TrainSimSettings::getAcceleration()
+{
+    return acceleration;
+}
+
+void TrainSimSettings::setAcceleration(int nbrePas)
+{
+    acceleration = nbrePas < 1 ? 1 : nbrePas;
+}
+
+bool TrainSimSettings::getFreinageAutomatique()
+{
+    return freinageAutomatique;
+}
+
+void TrainSimSettings::setFreinageAutomatique(bool enable)
+{
+    freinageAutomatique = enable;
+}
+
+bool TrainSimSettings::getSansFenetre()
+{
+    return sansFenetre;
+}
+
+void TrainSimSettings::setSansFenetre(bool enable)
+{
+    sansFenetre = enable;
+}
@@ -20,6 +20,15 @@ public:
     bool getInertie();
     void setInertie(bool enable);
 
+    int getAcceleration();
+    void setAcceleration(int nbrePas);
+
+    bool getFreinageAutomatique();
+    void setFreinageAutomatique(bool enable);
+
+    bool getSansFenetre();
+    void setSansFenetre(bool enable);
+
 protected:
     TrainSimSettings();
 
@@ -27,6 +36,9 @@ protected:
     bool viewAiguillageNumber;
     bool viewLocoLog;
     bool inertie;
+    int acceleration;
+    bool freinageAutomatique;
+    bool sansFenetre;
 };
 
 
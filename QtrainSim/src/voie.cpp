@@ -1,3 +1,5 @@
+#include <QVector>
+
 #include "voie.h"
 
 
@@ -12,6 +14,38 @@ Voie::Voie()
 
 
 
+void Voie::entreeLoco(Loco *l)
+{
+    if(!locos.contains(l))
+        locos.append(l);
+}
+
+void Voie::sortieLoco(Loco *l)
+{
+    locos.removeOne(l);
+}
+
+const QVector<Loco*> &Voie::getLocos() const
+{
+    return locos;
+}
+
+void Voie::ajouterObservateur(Loco *l)
+{
+    if(!observateurs.contains(l))
+        observateurs.append(l);
+}
+
+void Voie::retirerObservateur(Loco *l)
+{
+    observateurs.removeOne(l);
+}
+
+const QVector<Loco*> &Voie::getObservateurs() const
+{
+    return observateurs;
+}
+
 void Voie::setNewPen(const QColor &color)
 {
     QPen pen;
@@ -21,7 +55,7 @@ void Voie::setNewPen(const QColor &color)
     setPen(pen);
 }
 
-void Voie::calculerPosition(Voie *v)
+void Voie::poser(Voie *v)
 {
     if(v == nullptr)
     {
@@ -36,52 +70,121 @@ void Voie::calculerPosition(Voie *v)
     }
 
     posee = true;
+}
 
+void Voie::refermerLiaison(Voie *v)
+{
     qreal deltaX, deltaY;
 
-    for(int i =0; i < ordreLiaison.size(); i++)
+    if((getPosAbsLiaison(v).x() - v->getPosAbsLiaison(this).x()) < -1e-10 ||
+       (getPosAbsLiaison(v).y() - v->getPosAbsLiaison(this).y()) < -1e-10 ||
+       (getPosAbsLiaison(v).x() - v->getPosAbsLiaison(this).x()) > 1e-10 ||
+       (getPosAbsLiaison(v).y() - v->getPosAbsLiaison(this).y()) > 1e-10)
     {
-        if(!ordreLiaison[i]->estPosee())
-            ordreLiaison[i]->calculerPosition(this);
-        else
-        {
-            if((getPosAbsLiaison(ordreLiaison[i]).x() - ordreLiaison[i]->getPosAbsLiaison(this).x()) < -1e-10 ||
-               (getPosAbsLiaison(ordreLiaison[i]).y() - ordreLiaison[i]->getPosAbsLiaison(this).y()) < -1e-10 ||
-               (getPosAbsLiaison(ordreLiaison[i]).x() - ordreLiaison[i]->getPosAbsLiaison(this).x()) > 1e-10 ||
-               (getPosAbsLiaison(ordreLiaison[i]).y() - ordreLiaison[i]->getPosAbsLiaison(this).y()) > 1e-10)
-            {
-                deltaX = getPosAbsLiaison(ordreLiaison[i]).x() - ordreLiaison[i]->getPosAbsLiaison(this).x();
-                deltaY = getPosAbsLiaison(ordreLiaison[i]).y() - ordreLiaison[i]->getPosAbsLiaison(this).y();
+        deltaX = getPosAbsLiaison(v).x() - v->getPosAbsLiaison(this).x();
+        deltaY = getPosAbsLiaison(v).y() - v->getPosAbsLiaison(this).y();
+
+        v->correctionPosition(deltaX / 2.0, deltaY / 2.0, this);
+        this->correctionPosition(- deltaX / 2.0, - deltaY / 2.0, v);
+    }
+}
+
+namespace {
+
+/** Voie en cours de parcours, et ordre de la prochaine voisine à examiner.
+  * Une pile de ces étapes reproduit exactement l'ordre de visite des versions récursives.
+  */
+struct EtapeParcours
+{
+    Voie* voie;
+    int prochaineLiaison;
+};
+
+}
+
+void Voie::calculerPosition(Voie *v)
+{
+    poser(v);
 
+    QVector<EtapeParcours> pile;
+    pile.append({this, 0});
 
-                ordreLiaison[i]->correctionPosition(deltaX / 2.0, deltaY / 2.0, this);
-                this->correctionPosition(- deltaX / 2.0, - deltaY / 2.0, ordreLiaison[i]);
+    while(!pile.isEmpty())
+    {
+        EtapeParcours &etape = pile.last();
 
-                deltaX = getPosAbsLiaison(ordreLiaison[i]).x() - ordreLiaison[i]->getPosAbsLiaison(this).x();
-                deltaY = getPosAbsLiaison(ordreLiaison[i]).y() - ordreLiaison[i]->getPosAbsLiaison(this).y();
-            }
+        if(etape.prochaineLiaison >= etape.voie->ordreLiaison.size())
+        {
+            pile.removeLast();
+            continue;
         }
+
+        Voie* courante = etape.voie;
+        Voie* voisine = courante->ordreLiaison[etape.prochaineLiaison++];
+
+        if(!voisine->estPosee())
+        {
+            voisine->poser(courante);
+            pile.append({voisine, 0});
+        }
+        else
+            courante->refermerLiaison(voisine);
     }
 }
 
-
-QList<QList<Voie*>*> Voie::startExplorationContactAContact()
+void Voie::calculerPositionRecursive(Voie *v)
 {
-    QList<QList<Voie*>*> temp;
+    poser(v);
 
-    for(int i=0; i<ordreLiaison.size(); i++)
+    for(int i =0; i < ordreLiaison.size(); i++)
     {
-        temp.append(ordreLiaison[i]->explorationContactAContact(this));
+        if(!ordreLiaison[i]->estPosee())
+            ordreLiaison[i]->calculerPositionRecursive(this);
+        else
+            refermerLiaison(ordreLiaison[i]);
     }
+}
+
+void Voie::calculerAnglesEtCoordonnees(Voie *v)
+{
+    orienter(v);
+
+    QVector<EtapeParcours> pile;
+    pile.append({this, 0});
 
-    foreach(QList<Voie*>* lv, temp)
+    while(!pile.isEmpty())
     {
-        lv->prepend(this);
+        EtapeParcours &etape = pile.last();
+
+        if(etape.prochaineLiaison >= etape.voie->ordreLiaison.size())
+        {
+            pile.removeLast();
+            continue;
+        }
+
+        Voie* courante = etape.voie;
+        Voie* voisine = courante->ordreLiaison[etape.prochaineLiaison++];
+
+        if(!voisine->estOrientee())
+        {
+            voisine->orienter(courante);
+            pile.append({voisine, 0});
+        }
     }
+}
+
+void Voie::calculerAnglesEtCoordonneesRecursif(Voie *v)
+{
+    orienter(v);
 
-    return temp;
+    for(int i = 0; i < ordreLiaison.size(); i++)
+    {
+        if(!ordreLiaison[i]->estOrientee())
+            ordreLiaison[i]->calculerAnglesEtCoordonneesRecursif(this);
+    }
 }
 
+
 void Voie::lier(Voie *v, int ordre)
 {
     ordreLiaison.insert(ordre, v);
@@ -216,6 +319,51 @@ void Voie::drawBoundingRect(QPainter *
 #endif
 }
 
+void Voie::sauverGeometrie(GeometrieVoie &g) const
+{
+    g = GeometrieVoie();
+
+    g.x = pos().x();
+    g.y = pos().y();
+
+    for(int i = 0; i < ordreLiaison.size() && i < GeometrieVoie::MAX_LIAISONS; i++)
+    {
+        g.angles[i] = angleLiaison.value(i);
+        g.liaisons[i][0] = coordonneesLiaison.value(i)->x();
+        g.liaisons[i][1] = coordonneesLiaison.value(i)->y();
+    }
+
+    sauverParametres(g.parametres);
+}
+
+void Voie::restaurerGeometrie(const GeometrieVoie &g)
+{
+    setPos(g.x, g.y);
+
+    for(int i = 0; i < ordreLiaison.size() && i < GeometrieVoie::MAX_LIAISONS; i++)
+    {
+        angleLiaison[i] = g.angles[i];
+        coordonneesLiaison[i]->setX(g.liaisons[i][0]);
+        coordonneesLiaison[i]->setY(g.liaisons[i][1]);
+    }
+
+    restaurerParametres(g.parametres);
+
+    if(this->contact != nullptr)
+        calculerPositionContact();
+
+    orientee = true;
+    posee = true;
+}
+
+void Voie::sauverParametres(double /*parametres*/[]) const
+{
+}
+
+void Voie::restaurerParametres(const double /*parametres*/[])
+{
+}
+
 void Voie::setIdVoie(int id)
 {
     idVoie=id;
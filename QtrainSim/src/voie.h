@@ -6,6 +6,7 @@
 #include <QObject>
 #include <QList>
 #include <QMap>
+#include <QVector>
 #include <QPointF>
 #include <QDebug>
 #include <QRectF>
@@ -17,6 +18,24 @@
 #include "general.h"
 #include "contact.h"
 
+class Loco;
+
+/**
+ * Etat géométrique d'une voie après sa pose, tel qu'enregistré dans une maquette compilée.
+ * Structure de taille fixe, copiable telle quelle dans un fichier.
+ */
+struct GeometrieVoie
+{
+    static const int MAX_LIAISONS = 4;
+    static const int MAX_PARAMETRES = 6;
+
+    double x;                                   //!> Position de la voie en X
+    double y;                                   //!> Position de la voie en Y
+    double angles[MAX_LIAISONS];                //!> Angle de chaque extrémité, en degrés
+    double liaisons[MAX_LIAISONS][2];           //!> Coordonnées locales de chaque extrémité
+    double parametres[MAX_PARAMETRES];          //!> Etat propre au type de voie (rayons, centres...)
+};
+
 class Voie : public QObject, public QAbstractGraphicsShapeItem
 {
     Q_OBJECT
@@ -27,18 +46,33 @@ public:
     Voie();
 
     /** Méthode permettant de calculer la position de la voie, en fonction d'une voie
-      * voisine déjà posée. S'il s'agit de la première voie posée, on lui attribue une position
-      * par défaut.
+      * voisine déjà posée, puis de poser de proche en proche toutes les voies qui lui sont
+      * reliées. S'il s'agit de la première voie posée, on lui attribue une position par défaut.
+      * Le parcours utilise une pile explicite, quelle que soit la taille de la maquette.
       * \param v pointeur sur la voie voisine déjà posée.
       */
     void calculerPosition(Voie* v = nullptr);
 
-    /** méthode virtuelle visant à calculer les angles et coordonnées (locales) de chaque extrémité
-      * de la voie.
-      * Cette méthode est appelée récursivement, jusqu'à ce que toutes les voies aient été orientées.
+    /** calcule les angles et coordonnées (locales) de chaque extrémité de la voie, puis
+      * oriente de proche en proche toutes les voies qui lui sont reliées.
+      * Le parcours utilise une pile explicite, quelle que soit la taille de la maquette.
       * \param v pointeur sur la voie voisine déjà orientée.
       */
-    virtual void calculerAnglesEtCoordonnees(Voie* v = nullptr) = 0;
+    void calculerAnglesEtCoordonnees(Voie* v = nullptr);
+
+    /** versions récursives de calculerPosition(...) et calculerAnglesEtCoordonnees(...),
+      * conservées comme référence : elles visitent les voies dans le même ordre et
+      * produisent exactement la même géométrie.
+      * \param v pointeur sur la voie voisine déjà posée, respectivement orientée.
+      */
+    void calculerPositionRecursive(Voie* v = nullptr);
+    void calculerAnglesEtCoordonneesRecursif(Voie* v = nullptr);
+
+    /** méthode virtuelle visant à calculer les angles et coordonnées (locales) de chaque extrémité
+      * de cette seule voie.
+      * \param v pointeur sur la voie voisine déjà orientée, nullptr pour la première voie.
+      */
+    virtual void orienter(Voie* v) = 0;
 
     /** permet de lier deux voies, c'est-à-dire d'indiquer qu'elles doivent se connecter l'une à l'autre,
       * et sur quelle extrémité.
@@ -80,18 +114,16 @@ public:
       */
     virtual void calculerPositionContact()=0;
 
-    /** Permet l'exploration récursive des voies en vue de la création des segments.
-      * \param voieAppelante pointeur sur la voie appelant récursivement celle-ci.
-      * \return Une liste de liste de voies, correspondant à tous chemins partant de cette voie
-      *         et terminant sur un contact, sauf le chemin partant depuis la voie appelante.
-      */
-    virtual QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante)=0;
+    //! Nombre maximal de voies de sortie d'une voie (aiguillage triple)
+    static const int MAX_SORTIES = 3;
 
-    /** Démarre l'exploration contact à contact en vue de la création des segments.
-      * \return Une liste de liste de voies, correspondant à tous chemins partant de cette voie
-      *         et terminant sur un contact.
+    /** Enumère les voies par lesquelles on peut quitter cette voie en venant de voieArrivee,
+      * quel que soit l'état des aiguillages, en vue de la création des segments.
+      * \param voieArrivee la voie par laquelle on arrive.
+      * \param sorties tableau d'au moins MAX_SORTIES éléments, rempli avec les voies de sortie.
+      * \return le nombre de voies de sortie (0 pour un buttoir).
       */
-    QList<QList<Voie*>*> startExplorationContactAContact();
+    virtual int getVoiesSortie(Voie* voieArrivee, Voie* sorties[])=0;
 
     /** retourne le nombre de liaisons (en d'autres termes d'extrémités) de la voie.
       * \return le nombre de liaisons de la voie.
@@ -188,6 +220,33 @@ public:
       */
     void setNewPen(const QColor &color);
 
+    /** signale qu'une loco arrive sur la voie, ou la quitte. La liste des locos
+      * présentes garde sa capacité : un changement de voie ne réserve pas de mémoire
+      * une fois la liste dimensionnée.
+      * \param l la loco.
+      */
+    void entreeLoco(Loco* l);
+    void sortieLoco(Loco* l);
+
+    /** retourne les locos présentes sur la voie.
+      * \return les locos dont le centre se trouve sur la voie.
+      */
+    const QVector<Loco*> &getLocos() const;
+
+    /** inscrit ou désinscrit une loco dont la recherche de la loco qui la précède passe
+      * par la voie (voir SimView::alerterProximite). Comme pour les locos présentes, la
+      * liste garde sa capacité.
+      * \param l la loco.
+      */
+    void ajouterObservateur(Loco* l);
+    void retirerObservateur(Loco* l);
+
+    /** retourne les locos inscrites par ajouterObservateur.
+      * \return les locos dont la loco devant doit être recherchée à nouveau lorsque
+      *         l'occupation de la voie change.
+      */
+    const QVector<Loco*> &getObservateurs() const;
+
     /** permet, pour les voies variables, de modifier leur etat.
       * \param nouvelEtat le nouvel etat de la voie variable.
       */
@@ -211,6 +270,29 @@ public:
       */
     virtual void correctionPositionLoco(qreal &x, qreal &y)=0;
 
+    /** exporte l'état calculé lors de la pose de la voie (position, angles et coordonnées
+      * des extrémités, état propre au type de voie).
+      * \param g la géométrie à remplir.
+      */
+    void sauverGeometrie(GeometrieVoie &g) const;
+
+    /** restaure l'état exporté par sauverGeometrie(...), en lieu et place de
+      * calculerAnglesEtCoordonnees(...) et calculerPosition(...).
+      * Les liaisons et le contact de la voie doivent déjà être en place.
+      * \param g la géométrie à restaurer.
+      */
+    void restaurerGeometrie(const GeometrieVoie &g);
+
+    /** exporte l'état géométrique propre au type de voie, modifié lors de la pose.
+      * \param parametres tableau de GeometrieVoie::MAX_PARAMETRES valeurs à remplir.
+      */
+    virtual void sauverParametres(double parametres[]) const;
+
+    /** restaure l'état géométrique propre au type de voie.
+      * \param parametres les valeurs exportées par sauverParametres(...).
+      */
+    virtual void restaurerParametres(const double parametres[]);
+
     void setIdVoie(int id);
 
     int getIdVoie();
@@ -224,6 +306,17 @@ protected:
       * \return l'angle normalisé
       */
     double normaliserAngle(double angle) const;
+
+    /** fixe la position de cette seule voie par rapport à la voie voisine déjà posée.
+      * \param v pointeur sur la voie voisine déjà posée, nullptr pour la première voie.
+      */
+    void poser(Voie* v);
+
+    /** rapproche les extrémités de cette voie et de sa voisine v, toutes deux posées,
+      * lorsqu'une boucle de la maquette se referme avec un écart.
+      * \param v la voie voisine.
+      */
+    void refermerLiaison(Voie* v);
     QPointF* position;
     QRectF* bRect;
     Contact* contact;
@@ -232,6 +325,8 @@ protected:
     //virtual void mousePressEvent ( QGraphicsSceneMouseEvent * event );
 private:
     QMap<int, qreal> angleLiaison;
+    QVector<Loco*> locos;
+    QVector<Loco*> observateurs;
 };
 
 #endif // VOIE_H
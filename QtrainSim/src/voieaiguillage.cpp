@@ -40,7 +40,7 @@ void VoieAiguillage::setNumVoieVariable(int numVoieVariable)
     this->numVoieVariable = numVoieVariable;
 }
 
-void VoieAiguillage::calculerAnglesEtCoordonnees(Voie *v)
+void VoieAiguillage::orienter(Voie *v)
 {
     int ordreVoieFixe;
     if( v== nullptr)
@@ -86,13 +86,6 @@ void VoieAiguillage::calculerAnglesEtCoordonnees(Voie *v)
         calculerPositionContact();
 
     orientee = true;
-
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[2]->estOrientee())
-        ordreLiaison[2]->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieAiguillage::calculerPositionContact()
@@ -101,35 +94,30 @@ void VoieAiguillage::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieAiguillage::explorationContactAContact(Voie* voieAppelante)
+int VoieAiguillage::getVoiesSortie(Voie *voieArrivee, Voie* sorties[])
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-        else
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
-    }
-    else
+    if(ordreLiaison.key(voieArrivee) == 0)
     {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
+        sorties[0] = ordreLiaison[1];
+        sorties[1] = ordreLiaison[2];
+        return 2;
     }
+    sorties[0] = ordreLiaison[0];
+    return 1;
+}
 
-    return temp;
+void VoieAiguillage::sauverParametres(double parametres[]) const
+{
+    parametres[0] = rayon;
+    parametres[1] = centre.x();
+    parametres[2] = centre.y();
+}
+
+void VoieAiguillage::restaurerParametres(const double parametres[])
+{
+    rayon = parametres[0];
+    centre.setX(parametres[1]);
+    centre.setY(parametres[2]);
 }
 
 qreal VoieAiguillage::getLongueurAParcourir()
@@ -27,7 +27,7 @@ void VoieAiguillageEnroule::setNumVoieVariable(int numVoieVariable)
     this->numVoieVariable = numVoieVariable;
 }
 
-void VoieAiguillageEnroule::calculerAnglesEtCoordonnees(Voie *v)
+void VoieAiguillageEnroule::orienter(Voie *v)
 {
     int ordreVoieFixe;
     if(v == nullptr)
@@ -77,13 +77,6 @@ void VoieAiguillageEnroule::calculerAnglesEtCoordonnees(Voie *v)
         calculerPositionContact();
 
     orientee = true;
-
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[2]->estOrientee())
-        ordreLiaison[2]->calculerAnglesEtCoordonnees(this);
 }
 
 
@@ -99,35 +92,36 @@ void VoieAiguillageEnroule::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieAiguillageEnroule::explorationContactAContact(Voie* voieAppelante)
+int VoieAiguillageEnroule::getVoiesSortie(Voie *voieArrivee, Voie* sorties[])
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-        else
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
-    }
-    else
+    if(ordreLiaison.key(voieArrivee) == 0)
     {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
+        sorties[0] = ordreLiaison[1];
+        sorties[1] = ordreLiaison[2];
+        return 2;
     }
+    sorties[0] = ordreLiaison[0];
+    return 1;
+}
 
-    return temp;
+void VoieAiguillageEnroule::sauverParametres(double parametres[]) const
+{
+    parametres[0] = rayonInterieur;
+    parametres[1] = rayonExterieur;
+    parametres[2] = centreInterieur.x();
+    parametres[3] = centreInterieur.y();
+    parametres[4] = centreExterieur.x();
+    parametres[5] = centreExterieur.y();
+}
+
+void VoieAiguillageEnroule::restaurerParametres(const double parametres[])
+{
+    rayonInterieur = parametres[0];
+    rayonExterieur = parametres[1];
+    centreInterieur.setX(parametres[2]);
+    centreInterieur.setY(parametres[3]);
+    centreExterieur.setX(parametres[4]);
+    centreExterieur.setY(parametres[5]);
 }
 
 qreal VoieAiguillageEnroule::getLongueurAParcourir()
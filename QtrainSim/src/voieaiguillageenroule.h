@@ -10,9 +10,11 @@ class VoieAiguillageEnroule : public VoieVariable
 public:
     explicit VoieAiguillageEnroule(qreal angle, qreal rayon, qreal longueur, qreal direction);
     void setNumVoieVariable(int numVoieVariable) override;
-    void calculerAnglesEtCoordonnees(Voie *v) override;
+    void orienter(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    int getVoiesSortie(Voie* voieArrivee, Voie* sorties[]) override;
+    void sauverParametres(double parametres[]) const override;
+    void restaurerParametres(const double parametres[]) override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
     void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal angleCumule, QPointF posActuelle, Voie *voieSuivante) override;
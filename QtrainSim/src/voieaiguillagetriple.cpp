@@ -35,7 +35,7 @@ void VoieAiguillageTriple::setNumVoieVariable(int numVoieVariable)
     this->numVoieVariable = numVoieVariable;
 }
 
-void VoieAiguillageTriple::calculerAnglesEtCoordonnees(Voie *v)
+void VoieAiguillageTriple::orienter(Voie *v)
 {
     int ordreVoieFixe;
     if(v == nullptr)
@@ -94,15 +94,6 @@ void VoieAiguillageTriple::calculerAnglesEtCoordonnees(Voie *v)
         calculerPositionContact();
 
     orientee = true;
-
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[2]->estOrientee())
-        ordreLiaison[2]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[3]->estOrientee())
-        ordreLiaison[3]->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieAiguillageTriple::calculerPositionContact()
@@ -111,36 +102,37 @@ void VoieAiguillageTriple::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieAiguillageTriple::explorationContactAContact(Voie* voieAppelante)
+int VoieAiguillageTriple::getVoiesSortie(Voie *voieArrivee, Voie* sorties[])
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-            temp.append(ordreLiaison[3]->explorationContactAContact(this));
-        }
-        else
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
-    }
-    else
+    if(ordreLiaison.key(voieArrivee) == 0)
     {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
+        sorties[0] = ordreLiaison[1];
+        sorties[1] = ordreLiaison[2];
+        sorties[2] = ordreLiaison[3];
+        return 3;
     }
+    sorties[0] = ordreLiaison[0];
+    return 1;
+}
 
-    return temp;
+void VoieAiguillageTriple::sauverParametres(double parametres[]) const
+{
+    parametres[0] = rayonGauche;
+    parametres[1] = rayonDroite;
+    parametres[2] = centreGauche.x();
+    parametres[3] = centreGauche.y();
+    parametres[4] = centreDroite.x();
+    parametres[5] = centreDroite.y();
+}
+
+void VoieAiguillageTriple::restaurerParametres(const double parametres[])
+{
+    rayonGauche = parametres[0];
+    rayonDroite = parametres[1];
+    centreGauche.setX(parametres[2]);
+    centreGauche.setY(parametres[3]);
+    centreDroite.setX(parametres[4]);
+    centreDroite.setY(parametres[5]);
 }
 
 qreal VoieAiguillageTriple::getLongueurAParcourir()
@@ -9,7 +9,7 @@ VoieButtoir::VoieButtoir(qreal longueur)
     this->posee = false;
 }
 
-void VoieButtoir::calculerAnglesEtCoordonnees(Voie *v)
+void VoieButtoir::orienter(Voie *v)
 {
     if(v == nullptr)
     {
@@ -28,9 +28,6 @@ void VoieButtoir::calculerAnglesEtCoordonnees(Voie *v)
         calculerPositionContact();
 
     orientee = true;
-
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieButtoir::calculerPositionContact()
@@ -39,14 +36,9 @@ void VoieButtoir::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieButtoir::explorationContactAContact(Voie */*voieAppelante*/)
+int VoieButtoir::getVoiesSortie(Voie */*voieArrivee*/, Voie */*sorties*/[])
 {
-    QList<QList<Voie*>*> temp;
-
-    temp.append(new QList<Voie*>);
-    temp.at(0)->append(this);
-
-    return temp;
+    return 0;
 }
 
 qreal VoieButtoir::getLongueurAParcourir()
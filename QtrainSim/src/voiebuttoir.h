@@ -10,9 +10,9 @@ class VoieButtoir : public Voie
 
 public:
     VoieButtoir(qreal longueur);
-    void calculerAnglesEtCoordonnees(Voie *v) override;
+    void orienter(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie *) override;
+    int getVoiesSortie(Voie*, Voie* sorties[]) override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie*) override;
     void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal, QPointF posActuelle, Voie *voieSuivante) override;
@@ -12,7 +12,7 @@ VoieCourbe::VoieCourbe(qreal angle, qreal rayon, int direction)
     this->lastDistDel = 1000.0;
 }
 
-void VoieCourbe::calculerAnglesEtCoordonnees(Voie *v)
+void VoieCourbe::orienter(Voie *v)
 {
     int ordreVoieFixe;
     if(v == nullptr)
@@ -52,11 +52,6 @@ void VoieCourbe::calculerAnglesEtCoordonnees(Voie *v)
     }
 
     orientee = true;
-
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieCourbe::calculerPositionContact()
@@ -66,30 +61,24 @@ void VoieCourbe::calculerPositionContact()
     this->contact->setAngle(atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) + direction * PI / 2.0);
 }
 
-QList<QList<Voie*>*> VoieCourbe::explorationContactAContact(Voie* voieAppelante)
+int VoieCourbe::getVoiesSortie(Voie *voieArrivee, Voie* sorties[])
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-            temp.append(ordreLiaison.value(1)->explorationContactAContact(this));
-        else
-            temp.append(ordreLiaison.value(0)->explorationContactAContact(this));
+    sorties[0] = ordreLiaison.key(voieArrivee) == 0 ? ordreLiaison.value(1) : ordreLiaison.value(0);
+    return 1;
+}
 
-        for(int i=0; i< temp.length(); i++)
-        {
-            temp.at(i)->prepend(this);
-        }
-    }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
+void VoieCourbe::sauverParametres(double parametres[]) const
+{
+    parametres[0] = rayon;
+    parametres[1] = centre.x();
+    parametres[2] = centre.y();
+}
 
-    return temp;
+void VoieCourbe::restaurerParametres(const double parametres[])
+{
+    rayon = parametres[0];
+    centre.setX(parametres[1]);
+    centre.setY(parametres[2]);
 }
 
 qreal VoieCourbe::getLongueurAParcourir()
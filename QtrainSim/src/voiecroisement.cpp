@@ -11,7 +11,7 @@ VoieCroisement::VoieCroisement(qreal angle, qreal longueur)
     this->lastDistDel = 1000.0;
 }
 
-void VoieCroisement::calculerAnglesEtCoordonnees(Voie *v)
+void VoieCroisement::orienter(Voie *v)
 {
     int ordreVoieFixe;
     if(v == nullptr)
@@ -64,15 +64,6 @@ void VoieCroisement::calculerAnglesEtCoordonnees(Voie *v)
         calculerPositionContact();
 
     orientee = true;
-
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[2]->estOrientee())
-        ordreLiaison[2]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[3]->estOrientee())
-        ordreLiaison[3]->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieCroisement::calculerPositionContact()
@@ -81,42 +72,17 @@ void VoieCroisement::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieCroisement::explorationContactAContact(Voie* voieAppelante)
+int VoieCroisement::getVoiesSortie(Voie *voieArrivee, Voie* sorties[])
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 1)
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 2)
-        {
-            temp.append(ordreLiaison[3]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 3)
-        {
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
-    }
-    else
+    switch(ordreLiaison.key(voieArrivee))
     {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
+    case 0: sorties[0] = ordreLiaison[1]; break;
+    case 1: sorties[0] = ordreLiaison[0]; break;
+    case 2: sorties[0] = ordreLiaison[3]; break;
+    case 3: sorties[0] = ordreLiaison[2]; break;
+    default: return 0;
     }
-
-    return temp;
+    return 1;
 }
 
 qreal VoieCroisement::getLongueurAParcourir()
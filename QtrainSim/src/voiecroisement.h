@@ -10,9 +10,9 @@ class VoieCroisement : public Voie
 
 public:
     VoieCroisement(qreal angle, qreal longueur);
-    void calculerAnglesEtCoordonnees(Voie *v) override;
+    void orienter(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    int getVoiesSortie(Voie* voieArrivee, Voie* sorties[]) override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
     void avanceLoco(qreal &dist, qreal &angle, qreal &rayon, qreal, QPointF posActuelle, Voie *voieSuivante) override;
@@ -10,7 +10,7 @@ VoieDroite::VoieDroite(qreal longueur)
     this->lastDistDel = 1000.0;
 }
 
-void VoieDroite::calculerAnglesEtCoordonnees(Voie *v)
+void VoieDroite::orienter(Voie *v)
 {
     int ordreVoieFixe;
     if(v==nullptr)
@@ -43,11 +43,6 @@ void VoieDroite::calculerAnglesEtCoordonnees(Voie *v)
         calculerPositionContact();
 
     orientee = true;
-
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieDroite::calculerPositionContact()
@@ -56,30 +51,10 @@ void VoieDroite::calculerPositionContact()
     this->contact->setAngle(atan2(- coordonneesLiaison[1]->y(), - coordonneesLiaison[1]->x()) + PI / 2.0);
 }
 
-QList<QList<Voie*>*> VoieDroite::explorationContactAContact(Voie* voieAppelante)
+int VoieDroite::getVoiesSortie(Voie *voieArrivee, Voie* sorties[])
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
-    {
-        if(ordreLiaison.key(voieAppelante) == 0)
-            temp.append(ordreLiaison.value(1)->explorationContactAContact(this));
-        else
-            temp.append(ordreLiaison.value(0)->explorationContactAContact(this));
-
-        for(int i=0; i< temp.length(); i++)
-        {
-            temp.at(i)->prepend(this);
-        }
-    }
-    else
-    {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
-    }
-
-    return temp;
+    sorties[0] = ordreLiaison.key(voieArrivee) == 0 ? ordreLiaison.value(1) : ordreLiaison.value(0);
+    return 1;
 }
 
 qreal VoieDroite::getLongueurAParcourir()
@@ -10,9 +10,9 @@ class VoieDroite : public Voie
 
 public:
     VoieDroite(qreal longueur);
-    void calculerAnglesEtCoordonnees(Voie *v = nullptr) override;
+    void orienter(Voie *v) override;
     void calculerPositionContact() override;
-    QList<QList<Voie*>*> explorationContactAContact(Voie* voieAppelante) override;
+    int getVoiesSortie(Voie* voieArrivee, Voie* sorties[]) override;
     qreal getLongueurAParcourir() override;
     Voie* getVoieSuivante(Voie* voieArrivee) override;
     void avanceLoco(qreal &dist, qreal &, qreal &, qreal, QPointF posActuelle, Voie *voieSuivante) override;
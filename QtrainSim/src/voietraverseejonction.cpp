@@ -18,7 +18,7 @@ void VoieTraverseeJonction::setNumVoieVariable(int numVoieVariable)
     this->numVoieVariable = numVoieVariable;
 }
 
-void VoieTraverseeJonction::calculerAnglesEtCoordonnees(Voie *v)
+void VoieTraverseeJonction::orienter(Voie *v)
 {
     int ordreVoieFixe;
     if(v == nullptr)
@@ -79,15 +79,6 @@ void VoieTraverseeJonction::calculerAnglesEtCoordonnees(Voie *v)
         calculerPositionContact();
 
     orientee = true;
-
-    if(!ordreLiaison[0]->estOrientee())
-        ordreLiaison[0]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[1]->estOrientee())
-        ordreLiaison[1]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[2]->estOrientee())
-        ordreLiaison[2]->calculerAnglesEtCoordonnees(this);
-    if(!ordreLiaison[3]->estOrientee())
-        ordreLiaison[3]->calculerAnglesEtCoordonnees(this);
 }
 
 void VoieTraverseeJonction::calculerPositionContact()
@@ -96,36 +87,39 @@ void VoieTraverseeJonction::calculerPositionContact()
     this->contact->setPos(0.0,0.0);
 }
 
-QList<QList<Voie*>*> VoieTraverseeJonction::explorationContactAContact(Voie* voieAppelante)
+int VoieTraverseeJonction::getVoiesSortie(Voie *voieArrivee, Voie* sorties[])
 {
-    QList<QList<Voie*>*> temp;
-
-    if(this->contact == nullptr)
+    if(ordreLiaison.key(voieArrivee) == 0 || ordreLiaison.key(voieArrivee) == 2)
     {
-        if(ordreLiaison.key(voieAppelante) == 0 || ordreLiaison.key(voieAppelante) == 2)
-        {
-            temp.append(ordreLiaison[1]->explorationContactAContact(this));
-            temp.append(ordreLiaison[3]->explorationContactAContact(this));
-        }
-        else if(ordreLiaison.key(voieAppelante) == 1 || ordreLiaison.key(voieAppelante) == 3)
-        {
-            temp.append(ordreLiaison[0]->explorationContactAContact(this));
-            temp.append(ordreLiaison[2]->explorationContactAContact(this));
-        }
-
-        foreach(QList<Voie*>* lv, temp)
-        {
-            lv->prepend(this);
-        }
+        sorties[0] = ordreLiaison[1];
+        sorties[1] = ordreLiaison[3];
     }
     else
     {
-        QList<Voie*>* temp2 = new QList<Voie*>();
-        temp2->append(this);
-        temp.append(temp2);
+        sorties[0] = ordreLiaison[0];
+        sorties[1] = ordreLiaison[2];
     }
+    return 2;
+}
 
-    return temp;
+void VoieTraverseeJonction::sauverParametres(double parametres[]) const
+{
+    parametres[0] = rayon03;
+    parametres[1] = rayon12;
+    parametres[2] = centre03.x();
+    parametres[3] = centre03.y();
+    parametres[4] = centre12.x();
+    parametres[5] = centre12.y();
+}
+
+void VoieTraverseeJonction::restaurerParametres(const double parametres[])
+{
+    rayon03 = parametres[0];
+    rayon12 = parametres[1];
+    centre03.setX(parametres[2]);
+    centre03.setY(parametres[3]);
+    centre12.setX(parametres[4]);
+    centre12.setY(parametres[5]);
 }
 
 qreal VoieTraverseeJonction::getLongueurAParcourir()
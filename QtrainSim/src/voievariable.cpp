@@ -5,6 +5,11 @@ VoieVariable::VoieVariable()
 {
 }
 
+int VoieVariable::getEtat() const
+{
+    return etat;
+}
+
 void VoieVariable::setEtat(int nouvelEtat)
 {
     this->etat = nouvelEtat;
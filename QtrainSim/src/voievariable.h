@@ -12,6 +12,10 @@ public:
     VoieVariable();
 
     void setEtat(int nouvelEtat) override;
+
+    /** retourne l'état de la voie variable.
+      */
+    int getEtat() const;
     /** permet d'indiquer à la voie variable quel est son numéro.
       * \param numVoieVariable le numéro de la voie variable.
       */
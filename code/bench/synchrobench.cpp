@@ -0,0 +1,201 @@
+//    ___  _________    ___  ___  ___ ____ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  / / / //
+//  / ___/ /__/ /_/ / / __// // / __/_  _/ //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+// ==========================================================
+// Fichier : synchrobench.cpp
+// Description : Banc de mesure du débit de SharedSection et de
+//               SharedStation (prog2) sous contention, sans
+//               simulateur. Les résultats sont écrits au format
+//               JSON de qtrainsim_bench, pour pouvoir comparer
+//               deux exécutions.
+// ==========================================================
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include <pcosynchro/pcothread.h>
+
+#include "backendnul.h"
+#include "banc.h"
+#include "commandetrain.h"
+#include "locomotive.h"
+#include "sharedsection.h"
+#include "sharedstation.h"
+
+// Le programme client n'est pas lancé par le banc
+int cmain()
+{
+    return 0;
+}
+
+namespace {
+
+using Horloge = std::chrono::steady_clock;
+
+qint64 nanosecondes(Horloge::duration d)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+/**
+ * @brief mesurerSection Chaque thread enchaîne request, access et leave sur une même
+ * section partagée. La durée mesurée est celle de request et access, attente comprise.
+ */
+void mesurerSection(Banc &banc, int nbreLocos, int iterations)
+{
+    SharedSection section;
+    std::vector<QVector<qint64>> durees(nbreLocos);
+    std::vector<std::unique_ptr<PcoThread>> threads;
+
+    Horloge::time_point debut = Horloge::now();
+
+    for (int i = 0; i < nbreLocos; ++i) {
+        threads.push_back(std::make_unique<PcoThread>([&section, &durees, i, iterations]() {
+            Locomotive loco(i + 1, 10);
+            durees[i].reserve(iterations);
+
+            for (int n = 0; n < iterations; ++n) {
+                Horloge::time_point t = Horloge::now();
+                section.request(loco, loco.numero(), loco.numero());
+                section.access(loco);
+                durees[i].append(nanosecondes(Horloge::now() - t));
+                section.leave(loco);
+            }
+        }));
+    }
+
+    for (auto &thread : threads) {
+        thread->join();
+    }
+
+    qint64 total = nanosecondes(Horloge::now() - debut);
+
+    QVector<qint64> toutes;
+    for (const auto &d : durees) {
+        toutes += d;
+    }
+
+    QJsonObject parametres;
+    parametres.insert("locos", nbreLocos);
+    parametres.insert("iterations", iterations);
+    parametres.insert("passagesParSeconde", double(nbreLocos) * iterations * 1e9 / total);
+
+    banc.ajouter("SharedSection", QString("%1 locos").arg(nbreLocos), Statistiques::calculer(toutes), parametres);
+}
+
+/**
+ * @brief mesurerStation Chaque thread arrive tour après tour à la même station. La durée
+ * mesurée est celle de trainArrived, qui comprend la pause de 2 s en gare.
+ */
+void mesurerStation(Banc &banc, int nbreLocos, int tours)
+{
+    SharedStation station(nbreLocos, std::make_shared<SharedSection>());
+    std::vector<QVector<qint64>> durees(nbreLocos);
+    std::vector<std::unique_ptr<PcoThread>> threads;
+
+    Horloge::time_point debut = Horloge::now();
+
+    for (int i = 0; i < nbreLocos; ++i) {
+        threads.push_back(std::make_unique<PcoThread>([&station, &durees, i, tours]() {
+            for (int n = 0; n < tours; ++n) {
+                Horloge::time_point t = Horloge::now();
+                station.trainArrived(i + 1);
+                durees[i].append(nanosecondes(Horloge::now() - t));
+            }
+        }));
+    }
+
+    for (auto &thread : threads) {
+        thread->join();
+    }
+
+    qint64 total = nanosecondes(Horloge::now() - debut);
+
+    QVector<qint64> toutes;
+    for (const auto &d : durees) {
+        toutes += d;
+    }
+
+    // La pause en gare est fixe : seul le surcoût par tour renseigne sur la synchronisation
+    const double pauseNs = 2e9;
+
+    QJsonObject parametres;
+    parametres.insert("locos", nbreLocos);
+    parametres.insert("tours", tours);
+    parametres.insert("pauseNs", pauseNs);
+    parametres.insert("surcoutParTourNs", double(total) / tours - pauseNs);
+
+    banc.ajouter("SharedStation", QString("%1 locos").arg(nbreLocos), Statistiques::calculer(toutes), parametres);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Banc de mesure de SharedSection et SharedStation");
+    parser.addHelpOption();
+    QCommandLineOption optionLocos("locos", "Nombres de locos en concurrence.", "n,n,...", "1,2,4,8");
+    QCommandLineOption optionIterations("iterations", "Passages dans la section partagée par loco.", "n", "2000");
+    QCommandLineOption optionTours("tours", "Arrivées en gare par loco (chaque tour dure au moins 2 s).", "n", "2");
+    QCommandLineOption optionJson("json", "Ecrit les résultats en JSON (- pour la sortie standard).", "fichier");
+    QCommandLineOption optionReference("reference", "Résultats JSON d'une exécution précédente, à comparer.", "fichier");
+    parser.addOption(optionLocos);
+    parser.addOption(optionIterations);
+    parser.addOption(optionTours);
+    parser.addOption(optionJson);
+    parser.addOption(optionReference);
+    parser.process(app);
+
+    int iterations = std::max(1, parser.value(optionIterations).toInt());
+    int tours = std::max(0, parser.value(optionTours).toInt());
+
+    QList<int> nbreLocos;
+    for (const QString &n : parser.value(optionLocos).split(',', Qt::SkipEmptyParts)) {
+        if (n.toInt() > 0) {
+            nbreLocos.append(n.toInt());
+        }
+    }
+
+    // Les messages des locos ne sont pas transmis au simulateur
+    CommandeTrain::getInstance()->setBackend(new BackendNul());
+
+    Banc banc("PCO_LAB04_bench");
+
+    if (parser.isSet(optionReference) && !banc.chargerReference(parser.value(optionReference))) {
+        std::fprintf(stderr, "Impossible de lire %s\n", qPrintable(parser.value(optionReference)));
+    }
+
+    for (int n : nbreLocos) {
+        mesurerSection(banc, n, iterations);
+    }
+
+    if (tours > 0) {
+        for (int n : nbreLocos) {
+            mesurerStation(banc, n, tours);
+        }
+    }
+
+    // Le tableau ne se mêle pas au JSON écrit sur la sortie standard
+    if (parser.value(optionJson) != "-") {
+        banc.afficher();
+    }
+
+    if (parser.isSet(optionJson) && !banc.ecrireJson(parser.value(optionJson))) {
+        std::fprintf(stderr, "Impossible d'écrire %s\n", qPrintable(parser.value(optionJson)));
+        return 1;
+    }
+
+    return 0;
+}
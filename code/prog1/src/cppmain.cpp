@@ -294,8 +294,12 @@ int cmain()
     // bool isWrittenForwardTrain0 = false;
     // bool isWrittenForwardTrain1 = false;
 
-    // Initialisation des membres statiques de locomotivebehavior pour le random
-    LocomotiveBehavior::initializeStaticMembers();
+    // Graine de la simulation, dont sont dérivés les générateurs aléatoires des locomotives
+    // Elle est fixée par l'option --graine du simulateur (tirée au hasard sinon), et restaurée lors d'un rejeu
+    // Pour reproduire une exécution, on peut aussi la fixer ici, par exemple : unsigned int runSeed = 42;
+    unsigned int runSeed = graine_simulation();
+    afficher_message(qPrintable(QString("Run seed : %1").arg(runSeed)));
+    LocomotiveBehavior::setRunSeed(runSeed);
 
     // Création des threads pour les locos
     // Cela ne change pas entre nos tests ici
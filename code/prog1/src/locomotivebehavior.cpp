@@ -30,6 +30,11 @@ LocomotiveBehavior::LocomotiveBehavior(Locomotive& loco, std::shared_ptr<SharedS
         contacts(contacts), isWrittenForward(isWrittenForward),  
         entrance(entrance), exit(exit), sharedStation(sharedStation) {
 
+    // Chaque locomotive a sa propre suite de tirages, qui ne dépend que de la graine de la simulation
+    // et de son numéro, et pas de l'ordre dans lequel les threads tirent
+    std::seed_seq seedSequence{runSeed, static_cast<unsigned int>(loco.numero())};
+    gen.seed(seedSequence);
+
     // Initialisation des indices d'entrée et de sortie de la section partagée
     calculateEntranceAndExitIndexes();
 
@@ -74,6 +79,9 @@ LocomotiveBehavior::LocomotiveBehavior(Locomotive& loco, std::shared_ptr<SharedS
 
 void LocomotiveBehavior::run()
 {
+    // Les points de synchronisation franchis par ce thread sont attribués à la locomotive
+    identifier_thread_loco(loco.numero());
+
     //Initialisation de la locomotive
     loco.allumerPhares();
     loco.demarrer();
@@ -622,14 +630,8 @@ int LocomotiveBehavior::sizeSharedSection(bool sharedSectionIsCut) {
     }
 }
 
-std::random_device LocomotiveBehavior::rd;
-std::mt19937 LocomotiveBehavior::gen;
-std::uniform_int_distribution<int> LocomotiveBehavior::turnDistribution;
-
-void LocomotiveBehavior::initializeStaticMembers() {
-    // Initialise les générateurs de nombres aléatoires
-    gen.seed(rd());
+unsigned int LocomotiveBehavior::runSeed = 0;
 
-    // On fixe les bornes pour le nombre de tours
-    turnDistribution = std::uniform_int_distribution<int>(minNbOfTurns, maxNbOfTurns);
+void LocomotiveBehavior::setRunSeed(unsigned int seed) {
+    runSeed = seed;
 }
@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <utility>
+#include <random>
 
 #define INCOMING_BUFFER 2
 #define OUTGOING_BUFFER 1
@@ -59,9 +60,11 @@ public:
                         std::shared_ptr<SharedStation> sharedStation);
 
     /*!
-     * \brief initializeStaticMembers Initialise les membres statiques de la classe
+     * \brief setRunSeed Fixe la graine de la simulation, dont sont dérivés les générateurs aléatoires
+     * des locomotives. A appeler avant de créer les comportements
+     * \param seed la graine de la simulation
      */
-    static void initializeStaticMembers();
+    static void setRunSeed(unsigned int seed);
 
 protected:
     /*!
@@ -249,20 +252,21 @@ protected:
      */
     static const int minNbOfTurns = 1;
 
-        /**
-     * @brief rd Générateur de nombres aléatoires
+    /**
+     * @brief runSeed Graine de la simulation
      */
-    static std::random_device rd;
+    static unsigned int runSeed;
 
     /**
-     * @brief gen Générateur de nombres aléatoires
+     * @brief gen Générateur de nombres aléatoires propre à la locomotive, dérivé de la graine
+     * de la simulation et du numéro de la locomotive
      */
-    static std::mt19937 gen;
+    std::mt19937 gen;
 
     /**
      * @brief turnDistribution Distribution de tours
      */
-    static std::uniform_int_distribution<int> turnDistribution;
+    std::uniform_int_distribution<int> turnDistribution{minNbOfTurns, maxNbOfTurns};
 };
 
 #endif // LOCOMOTIVEBEHAVIOR_H
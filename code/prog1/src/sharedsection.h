@@ -26,6 +26,9 @@
 #include <vector>
 #include <utility>
 
+// Point de synchronisation du mutex de la section partagée (voir attendre_tour)
+#define SYNC_POINT_SHARED_SECTION 1
+
 /**
  * @brief La classe SharedSection implémente l'interface SharedSectionInterface qui
  * propose les méthodes liées à la section partagée.
@@ -56,7 +59,7 @@ public:
         bool canGo = false;
 
         while(!canGo) {
-            mutex.lock();
+            lockMutex();
             // Si la section partagée est occupée, on met la locomotive en attente
             if(occupied) {
                 ++nbWaiting;
@@ -93,7 +96,7 @@ public:
      * @param loco La locomotive qui quitte la section partagée
      */
     void leave(Locomotive& loco) override {
-        mutex.lock();
+        lockMutex();
         occupied = false;
         for(int i = 0; i < nbWaiting; ++i) {
             waitingSemaphore.release();
@@ -108,6 +111,16 @@ public:
 
 private:
 
+    /**
+     * @brief lockMutex Verrouille le mutex. L'ordre dans lequel les locomotives obtiennent le mutex
+     * décide de l'accès à la section partagée : il est enregistré avec la trace, et imposé lors d'un rejeu
+     */
+    void lockMutex() {
+        attendre_tour(SYNC_POINT_SHARED_SECTION);
+        mutex.lock();
+        consigner_decision(SYNC_POINT_SHARED_SECTION);
+    }
+
     /**
      * @brief semaphore Sémaphore pour gérer l'accès à la section partagée
      */
@@ -15,6 +15,7 @@
 #include <chrono>
 #include <thread>
 
+#include "ctrain_handler.h"
 #include "sharedstation.h"
 
 SharedStation::SharedStation(int nbTrains) : nbTrains(nbTrains), trainsAtStation(0), 
@@ -23,7 +24,10 @@ stationSemaphore(0), stationMutex() {
 
 void SharedStation::trainArrived() {
     // Quand un train arrive, on réserve le droit de modification de la variable trainsAtStation
+    // L'ordre d'arrivée décide du train qui attend les autres : il est enregistré, et imposé lors d'un rejeu
+    attendre_tour(SYNC_POINT_STATION);
     stationMutex.lock();
+    consigner_decision(SYNC_POINT_STATION);
     ++trainsAtStation;
     if(trainsAtStation == nbTrains) { // Si tous les trains sont arrivés
         // Attendre que les passagers montent/descendent
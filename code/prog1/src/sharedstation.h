@@ -12,6 +12,9 @@
 #include <pcosynchro/pcosemaphore.h>
 #include <pcosynchro/pcomutex.h>
 
+// Point de synchronisation du mutex de la station (voir attendre_tour)
+#define SYNC_POINT_STATION 2
+
 /**
  * @brief La classe SharedStation représente un moyen de coordiner 
  * l'arrivée de plusieurs trains à leur station respective
@@ -11,10 +11,21 @@ HEADERS +=  \
     src/locomotive.h \
     src/launchable.h \
     src/locomotivebehavior.h \
-    src/sharedsection.h
+    src/sharedsection.h \
+    src/scenario.h \
+    src/syncmetrics.h
 
 SOURCES +=  \
     src/sharedstation.cpp \
     src/locomotive.cpp \
     src/cppmain.cpp \
-    src/locomotivebehavior.cpp
+    src/locomotivebehavior.cpp \
+    src/scenario.cpp \
+    src/syncmetrics.cpp
+
+OTHER_FILES += scenarios/*.txt
+
+#Deploy the scenarios next to the executable after each link, like the CMake build:
+#without scenarios/default.txt the program cannot start
+QMAKE_POST_LINK += $$sprintf($$QMAKE_MKDIR_CMD, $$shell_quote($$shell_path($$OUT_PWD/$$DESTDIR/scenarios))) $$escape_expand(\\n\\t)
+QMAKE_POST_LINK += $$QMAKE_COPY $$shell_path($$PWD/scenarios/*.txt) $$shell_quote($$shell_path($$OUT_PWD/$$DESTDIR/scenarios))
@@ -12,40 +12,33 @@
 //               Gestion des trains
 // ==========================================================
 
+#include <QCoreApplication>
+
 #include "ctrain_handler.h"
 
 #include "locomotive.h"
 #include "locomotivebehavior.h"
-#include "sharedsectioninterface.h"
-#include "sharedsection.h"
-
-// Locomotives :
-// Vous pouvez changer les vitesses initiales, ou utiliser la fonction loco.fixerVitesse(vitesse);
-// Laissez les numéros des locos à 0 et 1 pour ce laboratoire
-
-// Locomotive A
-
-static Locomotive locoA(0 /* Numéro (pour commande trains sur maquette réelle) */, 15 /* Vitesse */);
-// Versions alternatives pour différents tests
-// static Locomotive locoA(0 /* Numéro (pour commande trains sur maquette réelle) */, 4 /* Vitesse */);
-// static Locomotive locoA(0 /* Numéro (pour commande trains sur maquette réelle) */, 20 /* Vitesse */);
-
-// Locomotive B
+#include "scenario.h"
 
-static Locomotive locoB(1 /* Numéro (pour commande trains sur maquette réelle) */, 18 /* Vitesse */);
-// Versions alternatives pour différents tests
-// static Locomotive locoB(1 /* Numéro (pour commande trains sur maquette réelle) */, 3 /* Vitesse */);
-// static Locomotive locoB(1 /* Numéro (pour commande trains sur maquette réelle) */, 10 /* Vitesse */);
+// La configuration (maquette, aiguillages, locomotives, trajets, section partagée et stations) est décrite
+// dans un fichier de scénario, voir scenario.h. Le scénario est donné au simulateur avec l'option --scenario,
+// sinon scenarios/default.txt est chargé depuis le répertoire de l'application.
+// Les numéros des locos doivent rester 0 et 1 pour ce laboratoire
 
-std::vector<Locomotive> trainsExisting = {locoA, locoB};
+// Objets de la simulation construits à partir du scénario
+static std::unique_ptr<ScenarioInstance> instance;
 
 //Arret d'urgence
 void emergency_stop()
 {
-    for(auto& loco : trainsExisting) {
-        loco.arreter();
-        loco.fixerVitesse(0);
+    if (instance != nullptr) {
+        for(auto& loco : instance->locomotives) {
+            loco->arreter();
+            loco->fixerVitesse(0);
+        }
+        afficher_message(qPrintable(instance->metrics->report()));
     }
+    afficher_profil_verrous(10);
 
     afficher_message("\nSTOP!");
 }
@@ -54,181 +47,47 @@ void emergency_stop()
 int cmain()
 {
     /************
-     * Maquette *
+     * Scénario *
      ************/
 
-    //Choix de la maquette (A ou B)
-    selection_maquette(MAQUETTE_A /*MAQUETTE_B*/);
-
-    /**********************************
-     * Initialisation des aiguillages *
-     **********************************/
-
-    // Initialisation des aiguillages
-    // Positiion de base donnée comme exemple, vous pouvez la changer comme bon vous semble
-    // Vous devrez utiliser cette fonction pour la section partagée pour aiguiller les locos
-    // sur le bon parcours (par exemple à la sortie de la section partagée) vous pouvez l'
-    // appeler depuis vos thread des locos par ex.
-
-    // Les aiguillages ont été défini de tel sorte à ce qu'il marche avec notre test
-    // Si vous voulez changer les trajectoires des trains, vous devez changer les directions des aiguillages
-    // par la même occasion
-    diriger_aiguillage(1,  TOUT_DROIT, 0); // Train 1
-    diriger_aiguillage(2,  DEVIE     , 0); // Train 0
-    diriger_aiguillage(3,  DEVIE     , 0); // Train 0
-    diriger_aiguillage(4,  TOUT_DROIT, 0); // Train 1
-    diriger_aiguillage(5,  TOUT_DROIT, 0); // Train 0
-    diriger_aiguillage(6,  TOUT_DROIT, 0);
-    diriger_aiguillage(7,  TOUT_DROIT, 0); // Train 1
-    diriger_aiguillage(8,  DEVIE     , 0); // Train 0
-    diriger_aiguillage(9,  DEVIE     , 0); // Train 0
-    diriger_aiguillage(10, TOUT_DROIT, 0); // Train 1
-    diriger_aiguillage(11, TOUT_DROIT, 0); // Train 0
-    diriger_aiguillage(12, TOUT_DROIT, 0);
-    diriger_aiguillage(13, DEVIE     , 0); // Train 1
-    diriger_aiguillage(14, DEVIE     , 0); // Partagé
-    diriger_aiguillage(15, TOUT_DROIT, 0); // Train 1
-    diriger_aiguillage(16, DEVIE     , 0); // Train 0
-    diriger_aiguillage(17, TOUT_DROIT, 0);
-    diriger_aiguillage(18, TOUT_DROIT, 0);
-    diriger_aiguillage(19, DEVIE     , 0); // Train 0
-    diriger_aiguillage(20, TOUT_DROIT, 0); // Train 1
-    diriger_aiguillage(21, DEVIE     , 0); // Partagé
-    diriger_aiguillage(22, DEVIE     , 0); // Train 1
-    diriger_aiguillage(23, TOUT_DROIT, 0);
-    diriger_aiguillage(24, TOUT_DROIT, 0);
-    // diriger_aiguillage(/*NUMERO*/, /*TOUT_DROIT | DEVIE*/, /*0*/);
-
-    /**********************************
-     * Initialisation des trajets     *
-     **********************************/
-
-    // Section critique: 33, 28, 22, 24
-    // On définit que 33 est l'entrée de la section critique, et 24 la sortie. 
-    // Cela ne va jamais changer, peu importe le trajet ou la direction
-    // C'est juste que des fois la locomotive rentrera par 33 et sortira par 24, et des fois l'inverse, 
-    // mais cela ne change pas entrée et sortie
-
-    // On définit 4 tests différents pour les trajets, et on les commente/décommente selon le test qu'on veut faire
-    // On fait ça afin de pouvoir vérifier les 4 scénarios possibles pour la section partagée dans les contacts
-    // Normalement, on devrait avoir exactement les mêmes résultats pour les 4 tests
-    // On vérifie qu'on peut s'adapter à toutes les rédactions possibles de la section critique et du trajet
-
-    // Test 1 : la section critique est écrite en allant de gauche à droite dans la liste des contacts, 
-    // et elle est en un seul morceau
-
-    // std::vector<int> contactsTrain0 = {14, 7, 6, 5, 34, 33, 28, 22, 24, 23, 16, 15};
-    // std::vector<int> contactsTrain1 = {10, 4, 3, 2, 1, 31, 33, 28, 22, 24, 19, 13, 12, 11};
-
-    // Test 2 : la section critique est écrite en allant de droite à gauche dans la liste des contacts, 
-    // et elle est en un seul morceau
-
-    std::vector<int> contactsTrain0 = {15, 16, 23, 24, 22, 28, 33, 34, 5, 6, 7, 14};
-    std::vector<int> contactsTrain1 = {11, 12, 13, 19, 24, 22, 28, 33, 31, 1, 2, 3, 4, 10};
-
-    // Test 3 : la section critique est écrite en allant de gauche à droite dans la liste des contacts, 
-    // et elle est en deux morceaux
-
-    // std::vector<int> contactsTrain0 = {22, 24, 23, 16, 15, 14, 7, 6, 5, 34, 33, 28};
-    // std::vector<int> contactsTrain1 = {22, 24, 19, 13, 12, 11, 10, 4, 3, 2, 1, 31, 33, 28};
-
-    // Test 4 : la section critique est écrite en allant de droite à gauche dans la liste des contacts, 
-    // et elle est en deux morceaux
-
-    // std::vector<int> contactsTrain0 = {28, 33, 34, 5, 6, 7, 14, 15, 16, 23, 24, 22};
-    // std::vector<int> contactsTrain1 = {28, 33, 31, 1, 2, 3, 4, 10, 11, 12, 13, 19, 24, 22};
+    std::string fileName = fichier_scenario();
+    if (fileName.empty()) {
+        fileName = QCoreApplication::applicationDirPath().toStdString() + "/scenarios/default.txt";
+    }
 
-    /***************************************************************************************************
-     * Directions des aiguillages pour la section partagée (à changer selon votre maquette et trajets) *
-     **************************************************************************************************/
+    // Le scénario est validé entièrement avant de toucher à la maquette : toutes les erreurs sont affichées
+    Scenario scenario;
+    try {
+        scenario = Scenario::load(fileName);
+    } catch (const std::runtime_error& e) {
+        afficher_message(e.what());
+        return EXIT_FAILURE;
+    }
 
-    // Ceci ne change pas entre nos tests ici
+    /*****************************************
+     * Maquette et position des aiguillages *
+     *****************************************/
 
-    std::vector<std::pair<int, int>> directionsTrain0 = {{14, DEVIE}, {21, DEVIE}};
-    std::vector<std::pair<int, int>> directionsTrain1 = {{14, TOUT_DROIT}, {21, TOUT_DROIT}};
+    scenario.apply();
 
     /********************************
-     * Position de départ des locos *
+     * Locomotives et comportements *
      ********************************/
 
-    // Les positions doivent faire partie des contacts du trajet de la locomotive, 
-    // et être à une distance de 1 entre elles
-    // Elles ne doivent pas non plus être l'entrée ou la sortie de la section partagée, 
-    // ni dans le buffer d'entrée ou de sortie
-    // Ne vous en faites pas, en cas d'erreur ici, 
-    // la simulation s'arrêtera et vous affichera un message d'erreur via un throw
-
-    // On ne change pas ces valeurs entre nos tests ici, 
-    // mais on peut faire des tests avec des valeurs différentes
-
-    //int contactBehindTrain0Start  = 14; //merder ici
-    //int contactInFrontTrain0Start = 7;
-    //int contactBehindTrain1Start  = 10;
-    //int contactInFrontTrain1Start = 4;
-
-    // Si on veut aller dans l'autre sens, on change ici:
-
-    //int contactBehindTrain0Start  = 7;
-    //int contactInFrontTrain0Start = 14;
-    //int contactBehindTrain1Start  = 4;
-    //int contactInFrontTrain1Start = 10;
-
-    // Si on veut que les trains n'aillent pas dans le même sens, on change ici:
-
-    int contactBehindTrain0Start  = 14;
-    int contactInFrontTrain0Start = 7;
-    int contactBehindTrain1Start  = 4;
-    int contactInFrontTrain1Start = 10;
-
-    // Tests de la position de départ des locos - ces positions devraient causer un throw
-
-    // Pas dans la liste de contacts
-
-    // int contactBehindTrain0Start  = 4;
-    // int contactInFrontTrain0Start = 10;
-    // int contactBehindTrain1Start  = 14;
-    // int contactInFrontTrain1Start = 7;
-
-    // Dans la section partagée
-
-    // int contactBehindTrain0Start  = 22;
-    // int contactInFrontTrain0Start = 28;
-    // int contactBehindTrain1Start  = 24;
-    // int contactInFrontTrain1Start = 22;
-
-    // Dans le buffer
-
-    // int contactBehindTrain0Start  = 5;
-    // int contactInFrontTrain0Start = 34;
-    // int contactBehindTrain1Start  = 24;
-    // int contactInFrontTrain1Start = 19;
-
-    // Contacts confondus
-
-    // int contactBehindTrain0Start  = 14;
-    // int contactInFrontTrain0Start = 14;
-    // int contactBehindTrain1Start  = 3;
-    // int contactInFrontTrain1Start = 3;
-
-    // Contacts trop éloignés l'un de l'autre
-
-    // int contactBehindTrain0Start  = 15;
-    // int contactInFrontTrain0Start = 7;
-    // int contactBehindTrain1Start  = 13;
-    // int contactInFrontTrain1Start = 11;
-
-    // On remarque qu'on doit mettre celui qui est devant en premier dans les paramètres de la fonction fixerPosition,
-    // et celui qui est derrière en deuxième
-    // À noter que nous avons choisi l'autre sens pour les paramètres dans le constructeur de LocomotiveBehavior, 
-    // donc à faire attention
-
-    // Loco 0
-    // Exemple de position de départ
-    locoA.fixerPosition(contactInFrontTrain0Start, contactBehindTrain0Start);
-
-    // Loco 1
-    // Exemple de position de départ
-    locoB.fixerPosition(contactInFrontTrain1Start, contactBehindTrain1Start);
+    // Graine de la simulation, dont sont dérivés les générateurs aléatoires des locomotives
+    // Elle est donnée par le scénario, sinon par l'option --graine du simulateur (tirée au hasard sinon),
+    // et restaurée lors d'un rejeu
+    unsigned int runSeed = scenario.hasSeed ? scenario.seed : graine_simulation();
+    afficher_message(qPrintable(QString("Run seed : %1").arg(runSeed)));
+
+    // Les comportements vérifient les positions de départ, de la section partagée et des stations :
+    // en cas d'erreur, aucun thread n'est lancé
+    try {
+        instance = scenario.instantiate(runSeed);
+    } catch (const std::runtime_error& e) {
+        afficher_message(qPrintable(QString("Invalid scenario %1: %2").arg(QString::fromStdString(fileName)).arg(e.what())));
+        return EXIT_FAILURE;
+    }
 
     /***********
      * Message *
@@ -241,83 +100,24 @@ int cmain()
      * Threads des locos *
      ********************/
 
-    // Création de la section partagée
-    std::shared_ptr<SharedSectionInterface> sharedSection = std::make_shared<SharedSection>();
-
-    // Création de la station partagée
-    std::shared_ptr<SharedStation> sharedStation = std::make_shared<SharedStation>(trainsExisting.size(), sharedSection);
-
-    // On définit les contacts d'entrée et de sortie de la section partagée. Cela ne change pas entre nos tests ici
-    int entrance = 33;
-    int exit = 24;
-
-    // Tests de la position de la section partagée - ces positions devraient causer un throw
-
-    // Entrée est la même que la sortie
-
-    // int entrance = 33;
-    // int exit = 33;
-
-    // Pas dans la liste des contacts
-
-    // int entrance = 35;
-    // int exit = 77;
-
-    // On définit le contact de la station. Cela ne change pas entre nos tests ici
-    int stationTrain0 = 6;
-    int stationTrain1 = 12;
-
-    // Tests de la position initiale de la station - ces positions devraient causer un throw
-
-    // Dans le buffer
-
-    // int stationTrain0 = 5;
-    // int stationTrain1 = 13;
-
-    // Dans la section partagée
-
-    // int stationTrain0 = 22;
-    // int stationTrain1 = 28;
-
-    // Pas dans la liste de contacts
-
-    // int stationTrain0 = 50;
-    // int stationTrain1 = 0;
-
-    // Test 1 et Test 3 : la section critique est écrite en allant de gauche à droite dans la liste des contacts
-
-    // bool isWrittenForwardTrain0 = true;
-    // bool isWrittenForwardTrain1 = true;
-
-    // Test 2 et Test 4 : la section critique est écrite en allant de droite à gauche dans la liste des contacts
-
-    bool isWrittenForwardTrain0 = false;
-    bool isWrittenForwardTrain1 = false;
-
-    // Initialisation des membres statiques de locomotivebehavior pour le random
-    LocomotiveBehavior::initializeStaticMembers();
-
-    // Création des threads pour les locos
-    // Cela ne change pas entre nos tests ici
-
-    // Création du thread pour la loco 0
-    std::unique_ptr<Launchable> locoBehaveA = std::make_unique<LocomotiveBehavior>(locoA, sharedSection, directionsTrain0, 
-    isWrittenForwardTrain0, contactsTrain0, entrance, exit, 
-    contactBehindTrain0Start, contactInFrontTrain0Start, stationTrain0, sharedStation);
-    // Création du thread pour la loco 1
-    std::unique_ptr<Launchable> locoBehaveB = std::make_unique<LocomotiveBehavior>(locoB, sharedSection, directionsTrain1, 
-    isWrittenForwardTrain1, contactsTrain1, entrance, exit, 
-    contactBehindTrain1Start, contactInFrontTrain1Start, stationTrain1, sharedStation);
-
     // Lanchement des threads
-    afficher_message(qPrintable(QString("Lancement thread loco A (numéro %1)").arg(locoA.numero())));
-    locoBehaveA->startThread();
-    afficher_message(qPrintable(QString("Lancement thread loco B (numéro %1)").arg(locoB.numero())));
-    locoBehaveB->startThread();
+    for (std::size_t i = 0; i < instance->behaviors.size(); ++i) {
+        afficher_message(qPrintable(QString("Lancement thread loco numéro %1").arg(instance->locomotives[i]->numero())));
+        instance->behaviors[i]->startThread();
+    }
+    if (instance->metricsReporter) {
+        instance->metricsReporter->startThread();
+    }
 
     // Attente sur la fin des threads
-    locoBehaveA->join();
-    locoBehaveB->join();
+    for (auto& behavior : instance->behaviors) {
+        behavior->join();
+    }
+    if (instance->metricsReporter) {
+        instance->metricsReporter->stop();
+        instance->metricsReporter->join();
+    }
+    afficher_message(qPrintable(instance->metrics->report()));
 
     //Fin de la simulation
     mettre_maquette_hors_service();
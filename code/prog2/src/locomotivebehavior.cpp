@@ -23,12 +23,20 @@ LocomotiveBehavior::LocomotiveBehavior(Locomotive& loco, std::shared_ptr<SharedS
                     int entrance, int exit,
                     int trainFirstStart, int trainSecondStart,
                     int stationContact,
-                    std::shared_ptr<SharedStation> sharedStation) : 
+                    std::shared_ptr<SharedStation> sharedStation,
+                    const BehaviorSettings& settings) : 
     loco(loco), 
     sharedSection(sharedSection), 
     sharedSectionDirections(sharedSectionDirections), 
     contacts(contacts), isWrittenForward(isWrittenForward),  
-    entrance(entrance), exit(exit), sharedStation(sharedStation) {
+    entrance(entrance), exit(exit), sharedStation(sharedStation), settings(settings),
+    turnDistribution(settings.minNbOfTurns, settings.maxNbOfTurns),
+    priorityDistribution(settings.minPriority, settings.maxPriority) {
+
+    // Chaque locomotive a sa propre suite de tirages, qui ne dépend que de la graine de la simulation
+    // et de son numéro, et pas de l'ordre dans lequel les threads tirent
+    std::seed_seq seedSequence{runSeed, static_cast<unsigned int>(loco.numero())};
+    gen.seed(seedSequence);
 
     // Initialisation des indices d'entrée et de sortie de la section partagée
     calculateEntranceAndExitIndexes();
@@ -61,6 +69,10 @@ LocomotiveBehavior::LocomotiveBehavior(Locomotive& loco, std::shared_ptr<SharedS
     // Détermine le contact de la station
     setStationContact(stationContact);
 
+    // Place les points de requête, d'accès et de libération selon la distance de freinage
+    trainStartIndexes = {trainFirstIndex, trainSecondIndex};
+    updateReservationPoints(true);
+
     // Détermine si la locomotive va vers la section partagée ou vers la station
     setNextDestination(trainSecondIndex);
 
@@ -79,6 +91,9 @@ LocomotiveBehavior::LocomotiveBehavior(Locomotive& loco, std::shared_ptr<SharedS
 
 void LocomotiveBehavior::run()
 {
+    // Les points de synchronisation franchis par ce thread sont attribués à la locomotive
+    identifier_thread_loco(loco.numero());
+
     //Initialisation de la locomotive
     loco.allumerPhares();
     loco.demarrer();
@@ -93,18 +108,25 @@ void LocomotiveBehavior::run()
         // On attend le contact suivant: soit avec la shared section, soit avec la station
         if(goingTowardsSharedSection){ // Gestion de la shared section
 
-            // On attend le contact de la shared section (plus exactement, 
-            // le point de réservation de la seciton partagée calculée via la définition du incoming buffer)
-            attendre_contact(sharedSectionReserveContact);
+            // Si la vitesse ou le sens ont changé, la distance de freinage aussi : on replace les points
+            if(loco.vitesse() != triggersSpeed || directionIsForward != triggersDirectionIsForward) {
+                updateReservationPoints();
+            }
+
+            // On attend le point de réservation de la section partagée
+            // (calculé selon la distance de freinage de la locomotive)
+            attendre_declencheur(sharedSectionReserveTrigger);
 
             sharedSection->request(loco, loco.numero(), loco.priority);
             loco.afficherMessage("Shared section requested.");
 
-            // On attend le contact d'accès à la section partagée
-            attendre_contact(sharedSectionAccessContact);
+            // On attend le point d'accès à la section partagée
+            attendre_declencheur(sharedSectionAccessTrigger);
 
-            // On réserve la section partagée
+            // On réserve la section partagée. L'attente est comptée dans le bilan de la simulation
+            debut_attente_section(loco.numero());
             sharedSection->access(loco);
+            fin_attente_section(loco.numero());
             loco.afficherMessage("Shared section accessed.");
 
             // On dirige les aiguillages pour que la locomotive puisse entrer dans la section partagée, et en sortir
@@ -114,7 +136,7 @@ void LocomotiveBehavior::run()
 
             // On affiche un message pour indiquer que la locomotive est entrée dans la section partagée 
             // (donc qu'elle est sortie du buffer)
-            if(directionIsForward && isWrittenForward || !directionIsForward && !isWrittenForward) {
+            if(entersByEntrance()) {
                 attendre_contact(entrance);
             } else {
                 attendre_contact(exit);
@@ -122,15 +144,16 @@ void LocomotiveBehavior::run()
             loco.afficherMessage("Shared section entered.");
 
             // On attend le contact de sortie de la section partagée
-            if(directionIsForward && isWrittenForward || !directionIsForward && !isWrittenForward) {
+            if(entersByEntrance()) {
                 attendre_contact(exit);
             } else {
                 attendre_contact(entrance);
             }
             loco.afficherMessage("Exit from shared section.");
 
-            // On attend le contact de libération de la section partagée
-            attendre_contact(sharedSectionReleaseContact);
+            // On attend le point de libération de la section partagée (l'arrière de la locomotive l'a quittée)
+            // Seul le passage de cette locomotive active le point
+            attendre_declencheur(sharedSectionReleaseTrigger);
             loco.afficherMessage("Shared section liberated.");
 
             // On libère la section partagée
@@ -143,6 +166,7 @@ void LocomotiveBehavior::run()
             // Attendre le contact de la station
             attendre_contact(stationContact);
             loco.afficherMessage("Arrived at the station.");
+            signaler_tour(loco.numero());
 
             // Réduire le nombre de tours restants
             --nbOfTurns;
@@ -159,7 +183,7 @@ void LocomotiveBehavior::run()
                 // On attend que l'autre locomotive soit aussi à la gare, puis on attend deux secondes, 
                 // puis on démarre les deux locomotives dans le sens opposé
                 loco.afficherMessage("Stopped at station. Synchronizing...");
-                sharedStation->trainArrived();
+                sharedStation->trainArrived(loco.numero());
 
                 // Inverser le sens
                 loco.inverserSens();
@@ -176,6 +200,9 @@ void LocomotiveBehavior::run()
 
                 // On redémarre la locomotive
                 loco.fixerVitesse(vitesse);
+
+                // On replace les points de la section partagée pour le nouveau sens de marche
+                updateReservationPoints();
             }
 
             // On définit qu'on se dirige vers la section partagée
@@ -206,23 +233,23 @@ void LocomotiveBehavior::determineContactPoints() {
             // Si la locomotive va en avant et que la section partagée est écrite de gauche à droite
 
             // On recule l'indexe depuis notre point d'entrée, qui sert bien d'entrée dans cette configuration
-            targetIndexEntry  = entranceIndex - INCOMING_BUFFER; 
+            targetIndexEntry  = entranceIndex - settings.incomingBuffer; 
 
             // Même chose que ci-dessus, mais pour le point d'accès
-            targetIndexAccess = entranceIndex - ACCESS_BUFFER;   
+            targetIndexAccess = entranceIndex - settings.accessBuffer;   
 
             // On avance l'indexe depuis notre point de sortie, qui sert bien de sortie dans cette configuration
-            targetIndexExit   = exitIndex     + OUTGOING_BUFFER; 
+            targetIndexExit   = exitIndex     + settings.outgoingBuffer; 
         } else { // Si la locomotive va en arrière et que la section partagée est écrite de gauche à droite
 
              // On avance l'indexe depuis notre point de sortie, qui sert d'enrée si on va en arrière
-            targetIndexEntry  = exitIndex     + INCOMING_BUFFER;
+            targetIndexEntry  = exitIndex     + settings.incomingBuffer;
 
             // Même chose que ci-dessus, mais pour le point d'accès
-            targetIndexAccess = exitIndex     + ACCESS_BUFFER;   
+            targetIndexAccess = exitIndex     + settings.accessBuffer;   
 
             // On recule l'indexe depuis notre point d'entrée, qui sert de sortie si on va en arrière
-            targetIndexExit   = entranceIndex - OUTGOING_BUFFER; 
+            targetIndexExit   = entranceIndex - settings.outgoingBuffer; 
         }
     } else {
         if(directionIsForward) { 
@@ -230,27 +257,27 @@ void LocomotiveBehavior::determineContactPoints() {
 
              // On recule l'indexe depuis notre point de sortie, 
              // qui sert d'entrée si on va en avant alors que la section est écrite de droite à gauche
-            targetIndexEntry  = exitIndex     - INCOMING_BUFFER;
+            targetIndexEntry  = exitIndex     - settings.incomingBuffer;
 
             // Même chose que ci-dessus, mais pour le point d'accès
-            targetIndexAccess = exitIndex     - ACCESS_BUFFER;  
+            targetIndexAccess = exitIndex     - settings.accessBuffer;  
 
             // On avance l'indexe depuis notre point d'entrée, 
             // qui sert de sortie si on va en avant alors que la section est écrite de droite à gauche
-            targetIndexExit   = entranceIndex + OUTGOING_BUFFER; 
+            targetIndexExit   = entranceIndex + settings.outgoingBuffer; 
         } else { 
             // Si la locomotive va en arrière et que la section partagée est écrite de droite à gauche
 
             // On avance l'indexe depuis notre point d'entrée, 
             //  qui sert bien d'entrée dans cette configuration, même si on va en arrière
-            targetIndexEntry  = entranceIndex + INCOMING_BUFFER; 
+            targetIndexEntry  = entranceIndex + settings.incomingBuffer; 
 
             // Même chose que ci-dessus, mais pour le point d'accès
-            targetIndexAccess = entranceIndex + ACCESS_BUFFER;   
+            targetIndexAccess = entranceIndex + settings.accessBuffer;   
 
             // On recule l'indexe depuis notre point de sortie, 
             // qui sert bien de sortie dans cette configuration, même si on va en arrière
-            targetIndexExit   = exitIndex     - OUTGOING_BUFFER; 
+            targetIndexExit   = exitIndex     - settings.outgoingBuffer; 
         }
     }
 
@@ -265,6 +292,145 @@ void LocomotiveBehavior::determineContactPoints() {
     sharedSectionReleaseContact = contacts[targetIndexExit];
 }
 
+void LocomotiveBehavior::updateReservationPoints(bool checkStartingPosition) {
+    // On supprime les déclencheurs placés pour l'ancienne vitesse ou l'ancien sens
+    for(int trigger : {sharedSectionReserveTrigger, sharedSectionAccessTrigger, sharedSectionReleaseTrigger}) {
+        if(trigger >= 0) {
+            supprimer_declencheur(trigger);
+        }
+    }
+
+    // On prend la plus grande des vitesses demandée et réelle, l'inertie pouvant ne pas encore être absorbée
+    int speed = std::max(loco.vitesse(), lire_vitesse_reelle(loco.numero()));
+
+    // La locomotive doit pouvoir s'arrêter avant l'entrée si l'accès lui est refusé
+    double accessDistance = brakingDistance(speed) + settings.safetyMargin;
+
+    // La requête est faite une distance de freinage plus tôt, 
+    // pour que l'ordre de priorité soit connu au moment de l'accès
+    double reserveDistance = settings.reserveDistanceFactor * accessDistance;
+
+    // La section est libérée une fois que l'arrière de la locomotive a passé la sortie
+    double releaseDistance = LOCO_LENGTH_MM + settings.safetyMargin;
+
+    int entryIndex   = entersByEntrance() ? entranceIndex : exitIndex;
+    int leavingIndex = entersByEntrance() ? exitIndex : entranceIndex;
+
+    // Les points doivent se trouver après la station, dans l'ordre requête puis accès
+    sharedSectionReserveTrigger = createTriggerBefore(entryIndex, reserveDistance, settings.safetyMargin, checkStartingPosition);
+    sharedSectionAccessTrigger  = createTriggerBefore(entryIndex, accessDistance, 2 * settings.safetyMargin, checkStartingPosition);
+    sharedSectionReleaseTrigger = createTriggerAfter(leavingIndex, releaseDistance);
+
+    // Si la longueur des voies n'est pas connue, on se replie sur les contacts déterminés par les buffers
+    if(sharedSectionReserveTrigger < 0 || sharedSectionAccessTrigger < 0 || sharedSectionReleaseTrigger < 0) {
+        for(int trigger : {sharedSectionReserveTrigger, sharedSectionAccessTrigger, sharedSectionReleaseTrigger}) {
+            if(trigger >= 0) {
+                supprimer_declencheur(trigger);
+            }
+        }
+        sharedSectionReserveTrigger = createTriggerAtContact(getIndexOfContact(sharedSectionReserveContact));
+        sharedSectionAccessTrigger  = createTriggerAtContact(getIndexOfContact(sharedSectionAccessContact));
+        sharedSectionReleaseTrigger = createTriggerAtContact(getIndexOfContact(sharedSectionReleaseContact));
+    }
+
+    triggersSpeed = loco.vitesse();
+    triggersDirectionIsForward = directionIsForward;
+}
+
+double LocomotiveBehavior::brakingDistance(int speed) {
+    // Le simulateur connaît ses réglages d'inertie et de vitesse : on ne duplique pas sa physique
+    return distance_freinage(speed);
+}
+
+int LocomotiveBehavior::createTriggerBefore(int contactIndex, double distance, double stationMargin, bool checkStartingPosition) {
+    int current = contactIndex;
+    double remaining = distance;
+
+    // Un point à 0 mm avant le contact se déclenche au passage de celui-ci
+    if(remaining <= 0.0) {
+        return createTriggerAtContact(contactIndex);
+    }
+
+    // On recule le long du parcours depuis le contact jusqu'à avoir couvert la distance
+    for(size_t i = 0; i < contacts.size(); ++i) {
+        int previous = previousIndex(current);
+
+        // La locomotive doit passer le point après son démarrage, sinon il ne se déclencherait jamais
+        if(checkStartingPosition && previous == trainStartIndexes.first && current == trainStartIndexes.second) {
+            throw std::runtime_error("Invalid starting position -- in shared section braking distance");
+        }
+
+        double length = longueur_segment(contacts[previous], contacts[current]);
+        if(length < 0.0) {
+            return -1;
+        }
+
+        // La locomotive s'arrête à la station : le point doit se trouver après celle-ci,
+        // au plus tôt au passage de la station si le segment est plus court que la marge
+        if(contacts[previous] == stationContact && remaining > length - stationMargin) {
+            if(length - stationMargin <= 0.0) {
+                return creer_declencheur_segment(loco.numero(), contacts[previous], contacts[current], 0.0);
+            }
+            remaining = length - stationMargin;
+        }
+
+        if(remaining <= length) {
+            return creer_declencheur(loco.numero(), contacts[previous], contacts[current], remaining);
+        }
+
+        remaining -= length;
+        current = previous;
+    }
+
+    return -1;
+}
+
+int LocomotiveBehavior::createTriggerAfter(int contactIndex, double distance) {
+    int current = contactIndex;
+    double travelled = distance;
+
+    // On avance le long du parcours depuis le contact jusqu'à avoir couvert la distance
+    for(size_t i = 0; i < contacts.size(); ++i) {
+        int next = nextIndex(current);
+
+        double length = longueur_segment(contacts[current], contacts[next]);
+        if(length < 0.0) {
+            return -1;
+        }
+
+        // La locomotive s'arrête à la station : on libère au plus tard juste avant celle-ci
+        if(contacts[next] == stationContact && travelled > length - settings.safetyMargin) {
+            travelled = std::max(0.0, length - settings.safetyMargin);
+        }
+
+        if(travelled <= length) {
+            return creer_declencheur_segment(loco.numero(), contacts[current], contacts[next], travelled);
+        }
+
+        travelled -= length;
+        current = next;
+    }
+
+    return -1;
+}
+
+int LocomotiveBehavior::createTriggerAtContact(int contactIndex) {
+    // Un point placé à 0 mm après un contact se déclenche au passage du contact
+    return creer_declencheur_segment(loco.numero(), contacts[contactIndex], contacts[nextIndex(contactIndex)], 0.0);
+}
+
+int LocomotiveBehavior::nextIndex(int index) {
+    return (directionIsForward ? index + 1 : index - 1 + contacts.size()) % contacts.size();
+}
+
+int LocomotiveBehavior::previousIndex(int index) {
+    return (directionIsForward ? index - 1 + contacts.size() : index + 1) % contacts.size();
+}
+
+bool LocomotiveBehavior::entersByEntrance() {
+    return directionIsForward && isWrittenForward || !directionIsForward && !isWrittenForward;
+}
+
 void LocomotiveBehavior::calculateEntranceAndExitIndexes() {
     // On calcule les index d'entrée et de sortie de la section partagée
     entranceIndex = getIndexOfContact(entrance);
@@ -333,7 +499,7 @@ void LocomotiveBehavior::setStationContact(int contact) {
     // On vérifie que la station n'est pas dans la zone tampon de la section partagée 
     // en avançant ou reculant dans la liste des contacts, selon le sens de la section partagée
     if(isWrittenForward) {
-        for(int i = 1; i <= std::max(INCOMING_BUFFER, OUTGOING_BUFFER) && !stationError; ++i) { 
+        for(int i = 1; i <= std::max(settings.incomingBuffer, settings.outgoingBuffer) && !stationError; ++i) { 
             // Vu qu'on veut l'aller-retour, on prend le max des deux buffers
             if(contacts[(stationIndex - i + contacts.size()) % contacts.size()] == exit) {
                 stationError = true;
@@ -343,7 +509,7 @@ void LocomotiveBehavior::setStationContact(int contact) {
             }
         }
     } else {
-        for(int i = 1; i <= std::max(INCOMING_BUFFER, OUTGOING_BUFFER) && !stationError; ++i) {
+        for(int i = 1; i <= std::max(settings.incomingBuffer, settings.outgoingBuffer) && !stationError; ++i) {
             if(contacts[(stationIndex + i) % contacts.size()] == exit) {
                 stationError = true;
             }
@@ -465,13 +631,13 @@ void LocomotiveBehavior::isStartingPositionValid(int firstIndex, int secondIndex
             // On vérifie que la locomotive n'est pas dans la zone tampon de la section partagée
             // en avançant dans la liste des contacts depuis le contact juste devant la locomotive
             // et en vérifiant qu'on n'entre pas dans la section partagée (selon la taille du buffer)
-            for(int i = 1; i < INCOMING_BUFFER && !error; ++i) {
+            for(int i = 1; i < settings.incomingBuffer && !error; ++i) {
                 if(contacts[(secondIndex + i) % contacts.size()] == entrance) {
                     error = true;
                 }
             }
             // Même chose, mais en reculant dans la liste des contacts depuis le contact juste derrière la locomotive
-            for(int i = 1; i < OUTGOING_BUFFER && !error; ++i) {
+            for(int i = 1; i < settings.outgoingBuffer && !error; ++i) {
                 if(contacts[(firstIndex - i + contacts.size()) % contacts.size()] == exit) {
                     error = true;
                 }
@@ -480,12 +646,12 @@ void LocomotiveBehavior::isStartingPositionValid(int firstIndex, int secondIndex
             // On effectue le même type de vérification, 
             // mais pour le cas où la section partagée est écrite de droite à gauche dans la liste des contacts,
             // mais que la locomotive va en avant
-            for(int i = 1; i < INCOMING_BUFFER && !error; ++i) {
+            for(int i = 1; i < settings.incomingBuffer && !error; ++i) {
                 if(contacts[(secondIndex + i) % contacts.size()] == exit) {
                     error = true;
                 }
             }
-            for(int i = 1; i < OUTGOING_BUFFER && !error; ++i) {
+            for(int i = 1; i < settings.outgoingBuffer && !error; ++i) {
                 if(contacts[(firstIndex - i + contacts.size()) % contacts.size()] == entrance) {
                     error = true;
                 }
@@ -495,12 +661,12 @@ void LocomotiveBehavior::isStartingPositionValid(int firstIndex, int secondIndex
         // On effectue le même type de vérification, mais pour le cas où la locomotive va en arrière, 
         //donc en sens inverse de la liste des contacts, mais que la section partagée est écrite de gauche à droite
         if(isWrittenForward) {
-            for(int i = 1; i < INCOMING_BUFFER && !error; ++i) {
+            for(int i = 1; i < settings.incomingBuffer && !error; ++i) {
                 if(contacts[(secondIndex - i + contacts.size()) % contacts.size()] == exit) {
                     error = true;
                 }
             }
-            for(int i = 1; i < OUTGOING_BUFFER && !error; ++i) {
+            for(int i = 1; i < settings.outgoingBuffer && !error; ++i) {
                 if(contacts[(firstIndex + i) % contacts.size()] == entrance) {
                     error = true;
                 }
@@ -509,12 +675,12 @@ void LocomotiveBehavior::isStartingPositionValid(int firstIndex, int secondIndex
             // On effectue le même type de vérification, 
             // mais pour le cas où la section partagée est écrite de droite à gauche dans la liste des contacts, 
             // et que la locomotive va en arrière
-            for(int i = 1; i < INCOMING_BUFFER && !error; ++i) {
+            for(int i = 1; i < settings.incomingBuffer && !error; ++i) {
                 if(contacts[(secondIndex - i + contacts.size()) % contacts.size()] == entrance) {
                     error = true;
                 }
             }
-            for(int i = 1; i < OUTGOING_BUFFER && !error; ++i) {
+            for(int i = 1; i < settings.outgoingBuffer && !error; ++i) {
                 if(contacts[(firstIndex + i) % contacts.size()] == exit) {
                     error = true;
                 }
@@ -613,8 +779,8 @@ QString LocomotiveBehavior::toString() {
             QString("Is written forward : %1\n").arg(isWrittenForward) +
             QString("Going towards shared section : %1\n").arg(goingTowardsSharedSection) +
             QString("Number of turns : %1\n").arg(nbOfTurns) +
-            QString("Max number of turns : %1\n").arg(maxNbOfTurns) +
-            QString("Min number of turns : %1\n").arg(minNbOfTurns) +
+            QString("Max number of turns : %1\n").arg(settings.maxNbOfTurns) +
+            QString("Min number of turns : %1\n").arg(settings.minNbOfTurns) +
             QString("Priority : %1\n").arg(loco.priority);
     return str;
 }
@@ -624,10 +790,10 @@ int LocomotiveBehavior::getRandomTurnNumber() {
 }
 
 void LocomotiveBehavior::checkMinimalSizeOfContacts(int sizeOfSharedSection) {
-    // La section partagée doit être d'au moins 2 * max(INCOMING_BUFFER, OUTGOING_BUFFER) + 1, 
+    // La section partagée doit être d'au moins 2 * max(settings.incomingBuffer, settings.outgoingBuffer) + 1, 
     // car la station ne doit pas être dans la section partagée
     // ou la zone tampon de la section partagée non plus sur le chemin aller ou retour
-    if (contacts.size() < sizeOfSharedSection + 2 * std::max(INCOMING_BUFFER, OUTGOING_BUFFER) + 1) {
+    if (contacts.size() < sizeOfSharedSection + 2 * std::max(settings.incomingBuffer, settings.outgoingBuffer) + 1) {
         throw std::runtime_error("Invalid contacts size -- not enough contacts given the shared section size");
     }
 }
@@ -659,16 +825,8 @@ void LocomotiveBehavior::setRandomPriority() {
     loco.priority = priorityDistribution(gen);
 }
 
-std::random_device LocomotiveBehavior::rd;
-std::mt19937 LocomotiveBehavior::gen;
-std::uniform_int_distribution<int> LocomotiveBehavior::priorityDistribution;
-std::uniform_int_distribution<int> LocomotiveBehavior::turnDistribution;
-
-void LocomotiveBehavior::initializeStaticMembers() {
-    // Initialise les générateurs de nombres aléatoires
-    gen.seed(rd());
+unsigned int LocomotiveBehavior::runSeed = 0;
 
-    // On fixe les bornes pour la priorité et le nombre de tours
-    priorityDistribution = std::uniform_int_distribution<int>(minPriority, maxPriority);
-    turnDistribution = std::uniform_int_distribution<int>(minNbOfTurns, maxNbOfTurns);
+void LocomotiveBehavior::setRunSeed(unsigned int seed) {
+    runSeed = seed;
 }
@@ -26,12 +26,43 @@
 #include <utility>
 #include <random>
 
-// Taille des buffers
+// Taille des buffers (en nombre de contacts)
+// Les points de réservation sont calculés en distance (voir updateReservationPoints), les buffers
+// servent à valider les positions de départ et de station, et de repli si les distances sont inconnues
 #define INCOMING_BUFFER 2
 #define ACCESS_BUFFER 1
 #define OUTGOING_BUFFER 1
 
 // Le incoming buffer doit être plus grand que l'accès buffer, et tous les buffers doivent être plus grands que 0
+// Ce sont les valeurs par défaut de BehaviorSettings, qu'un scénario peut changer
+
+// Longueur d'une locomotive (en mm)
+#define LOCO_LENGTH_MM 120.0
+
+// Marge de sécurité (en mm) ajoutée aux distances de freinage et de dégagement
+#define SAFETY_MARGIN_MM 100.0
+
+// Rapport entre la distance de requête et la distance d'accès à la section partagée
+#define RESERVE_DISTANCE_FACTOR 2.0
+
+// Ce sont aussi des valeurs par défaut de BehaviorSettings : ce sont elles qui placent les points de réservation
+
+/**
+ * @brief La structure BehaviorSettings regroupe les réglages du comportement des locomotives :
+ * tailles des buffers, placement des points de réservation, nombre de tours entre deux arrêts en gare
+ * et plage des priorités
+ */
+struct BehaviorSettings {
+    int incomingBuffer{INCOMING_BUFFER};
+    int accessBuffer{ACCESS_BUFFER};
+    int outgoingBuffer{OUTGOING_BUFFER};
+    double safetyMargin{SAFETY_MARGIN_MM};
+    double reserveDistanceFactor{RESERVE_DISTANCE_FACTOR};
+    int minNbOfTurns{1};
+    int maxNbOfTurns{10};
+    int minPriority{0};
+    int maxPriority{10};
+};
 
 /**
  * @brief La classe LocomotiveBehavior représente le comportement d'une locomotive
@@ -53,6 +84,7 @@ public:
      * \param trainSecondStart le contact à l'avant de la locomotive au démarrage
      * \param stationContact le contact de la station
      * \param sharedStation la station partagée
+     * \param settings les réglages du comportement
      */
     LocomotiveBehavior(Locomotive& loco, std::shared_ptr<SharedSectionInterface> sharedSection, 
                         std::vector<std::pair<int, int>> sharedSectionDirections, 
@@ -61,12 +93,15 @@ public:
                         int entrance, int exit,
                         int trainFirstStart, int trainSecondStart,
                         int stationContact,
-                        std::shared_ptr<SharedStation> sharedStation);
+                        std::shared_ptr<SharedStation> sharedStation,
+                        const BehaviorSettings& settings = BehaviorSettings());
 
     /*!
-     * \brief initializeStaticMembers Initialise les membres statiques de la classe
+     * \brief setRunSeed Fixe la graine de la simulation, dont sont dérivés les générateurs aléatoires
+     * des locomotives. A appeler avant de créer les comportements
+     * \param seed la graine de la simulation
      */
-    static void initializeStaticMembers();
+    static void setRunSeed(unsigned int seed);
 
 protected:
     /*!
@@ -90,6 +125,65 @@ protected:
     */
     void determineContactPoints();
 
+    /*!
+     * \brief updateReservationPoints Place les points de requête, d'accès et de libération de la section
+     * partagée selon la longueur réelle des voies, la vitesse de la locomotive et sa distance de freinage
+     * \param checkStartingPosition true pour vérifier que la locomotive ne démarre pas après le point de requête
+     */
+    void updateReservationPoints(bool checkStartingPosition = false);
+
+    /*!
+     * \brief brakingDistance Calcule la distance de freinage de la locomotive
+     * \param speed la vitesse de la locomotive
+     * \return la distance de freinage en mm
+     */
+    static double brakingDistance(int speed);
+
+    /*!
+     * \brief createTriggerBefore Crée un déclencheur, propre à cette locomotive, à une distance donnée avant un contact du parcours
+     * \param contactIndex l'index du contact
+     * \param distance la distance avant le contact, en mm
+     * \param stationMargin la distance minimale entre la station et le point, en mm
+     * \param checkStartingPosition true pour vérifier que la locomotive ne démarre pas entre le point et le contact
+     * \return le numéro du déclencheur, -1 si les longueurs des voies ne sont pas connues
+     */
+    int createTriggerBefore(int contactIndex, double distance, double stationMargin, bool checkStartingPosition);
+
+    /*!
+     * \brief createTriggerAfter Crée un déclencheur, propre à cette locomotive, à une distance donnée après un contact du parcours
+     * \param contactIndex l'index du contact
+     * \param distance la distance après le contact, en mm
+     * \return le numéro du déclencheur, -1 si les longueurs des voies ne sont pas connues
+     */
+    int createTriggerAfter(int contactIndex, double distance);
+
+    /*!
+     * \brief createTriggerAtContact Crée un déclencheur, propre à cette locomotive, au passage d'un contact du parcours
+     * \param contactIndex l'index du contact
+     * \return le numéro du déclencheur
+     */
+    int createTriggerAtContact(int contactIndex);
+
+    /*!
+     * \brief nextIndex Retourne l'index du contact suivant dans le sens de marche
+     * \param index l'index du contact
+     * \return l'index du contact suivant
+     */
+    int nextIndex(int index);
+
+    /*!
+     * \brief previousIndex Retourne l'index du contact précédent dans le sens de marche
+     * \param index l'index du contact
+     * \return l'index du contact précédent
+     */
+    int previousIndex(int index);
+
+    /*!
+     * \brief entersByEntrance Détermine si la locomotive entre dans la section partagée par le contact d'entrée
+     * \return true si elle entre par le contact d'entrée, false si elle entre par le contact de sortie
+     */
+    bool entersByEntrance();
+
     /*!
      * \brief calculateEntranceAndExitIndexes Calcule les indices d'entrée et de sortie de la section partagée
      */
@@ -206,6 +300,36 @@ protected:
      */
     int sharedSectionReleaseContact;
 
+    /**
+     * @brief sharedSectionReserveTrigger Le déclencheur de réservation de la section partagée
+     */
+    int sharedSectionReserveTrigger{-1};
+
+    /**
+     * @brief sharedSectionAccessTrigger Le déclencheur d'accès à la section partagée
+     */
+    int sharedSectionAccessTrigger{-1};
+
+    /**
+     * @brief sharedSectionReleaseTrigger Le déclencheur de libération de la section partagée
+     */
+    int sharedSectionReleaseTrigger{-1};
+
+    /**
+     * @brief triggersSpeed La vitesse pour laquelle les déclencheurs ont été placés
+     */
+    int triggersSpeed{-1};
+
+    /**
+     * @brief triggersDirectionIsForward Le sens de marche pour lequel les déclencheurs ont été placés
+     */
+    bool triggersDirectionIsForward{true};
+
+    /**
+     * @brief trainStartIndexes Les index des contacts derrière et devant la locomotive à son démarrage
+     */
+    std::pair<int, int> trainStartIndexes;
+
     /**
      * @brief sharedSectionDirections Les directions des aiguillages pour la section partagée
      */
@@ -255,44 +379,30 @@ protected:
     int nbOfTurns;
 
     /**
-     * @brief maxNbOfTurns Nombre maximal de tours à effectuer
-     */
-    static const int maxNbOfTurns = 10;
-
-    /**
-     * @brief minNbOfTurns Nombre minimal de tours à effectuer
-     */
-    static const int minNbOfTurns = 1;
-
-    /**
-     * @brief minPriority Priorité minimale
-     */
-    static const int minPriority = 0;
-
-    /**
-     * @brief maxPriority Priorité maximale
+     * @brief settings Réglages du comportement (buffers, points de réservation, tours, priorités)
      */
-    static const int maxPriority = 10;
+    BehaviorSettings settings;
 
     /**
-     * @brief rd Générateur de nombres aléatoires
+     * @brief runSeed Graine de la simulation
      */
-    static std::random_device rd;
+    static unsigned int runSeed;
 
     /**
-     * @brief gen Générateur de nombres aléatoires
+     * @brief gen Générateur de nombres aléatoires propre à la locomotive, dérivé de la graine
+     * de la simulation et du numéro de la locomotive
      */
-    static std::mt19937 gen;
+    std::mt19937 gen;
 
     /**
      * @brief turnDistribution Distribution de tours
      */
-    static std::uniform_int_distribution<int> turnDistribution;
+    std::uniform_int_distribution<int> turnDistribution;
 
     /**
      * @brief priorityDistribution Distribution de priorités
      */
-    static std::uniform_int_distribution<int> priorityDistribution;
+    std::uniform_int_distribution<int> priorityDistribution;
 };
 
 #endif // LOCOMOTIVEBEHAVIOR_H
@@ -0,0 +1,321 @@
+//    ___  _________    ___  ___  ___ ____ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  / / / //
+//  / ___/ /__/ /_/ / / __// // / __/_  _/ //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+// ==========================================================
+// Fichier : scenario.cpp
+// Description : Lecture, validation et instanciation des
+//               scénarios.
+// ==========================================================
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+#include "ctrain_handler.h"
+#include "scenario.h"
+#include "sharedsection.h"
+
+namespace {
+
+/**
+ * @brief lineError Formate une erreur rattachée à une ligne du fichier
+ */
+std::string lineError(int line, const std::string& message) {
+    return "line " + std::to_string(line) + ": " + message;
+}
+
+/**
+ * @brief readDirection Lit une direction d'aiguillage (DEVIE ou TOUT_DROIT)
+ * @return true si la direction est valide
+ */
+bool readDirection(std::istringstream& values, int& direction) {
+    std::string word;
+    if (!(values >> word)) {
+        return false;
+    }
+    if (word == "DEVIE") {
+        direction = DEVIE;
+    } else if (word == "TOUT_DROIT") {
+        direction = TOUT_DROIT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief readInterlocking Lit une politique d'enclenchement (apply, refuse ou defer)
+ * @return true si la politique est valide
+ */
+bool readInterlocking(std::istringstream& values, int& interlocking) {
+    std::string word;
+    if (!(values >> word)) {
+        return false;
+    }
+    if (word == "apply") {
+        interlocking = ENCLENCHEMENT_APPLIQUER;
+    } else if (word == "refuse") {
+        interlocking = ENCLENCHEMENT_REFUSER;
+    } else if (word == "defer") {
+        interlocking = ENCLENCHEMENT_DIFFERER;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief contains Indique si un contact fait partie d'un parcours
+ */
+bool contains(const std::vector<int>& contacts, int contact) {
+    return std::find(contacts.begin(), contacts.end(), contact) != contacts.end();
+}
+
+} // namespace
+
+Scenario Scenario::load(const std::string& fileName) {
+    std::ifstream file(fileName);
+    if (!file) {
+        throw std::runtime_error("Cannot read scenario " + fileName);
+    }
+
+    Scenario scenario;
+    std::vector<std::string> errors;
+    std::string text;
+    int line = 0;
+
+    while (std::getline(file, text)) {
+        ++line;
+
+        // On ignore les commentaires
+        std::string::size_type comment = text.find('#');
+        if (comment != std::string::npos) {
+            text.erase(comment);
+        }
+
+        std::istringstream values(text);
+        std::string key;
+        if (!(values >> key)) {
+            continue;
+        }
+
+        // Les clés décrivant une locomotive s'appliquent à la dernière déclarée
+        LocoConfig* loco = scenario.locos.empty() ? nullptr : &scenario.locos.back();
+        bool valid = true;
+
+        if (key == "layout") {
+            valid = static_cast<bool>(values >> scenario.layout);
+        } else if (key == "seed") {
+            valid = static_cast<bool>(values >> scenario.seed);
+            scenario.hasSeed = valid;
+        } else if (key == "switch") {
+            std::pair<int, int> position;
+            valid = (values >> position.first) && readDirection(values, position.second);
+            scenario.switches.push_back(position);
+        } else if (key == "section") {
+            valid = static_cast<bool>(values >> scenario.entrance >> scenario.exit);
+        } else if (key == "buffers") {
+            BehaviorSettings& behavior = scenario.behavior;
+            valid = static_cast<bool>(values >> behavior.incomingBuffer >> behavior.accessBuffer >> behavior.outgoingBuffer);
+        } else if (key == "reservation") {
+            valid = static_cast<bool>(values >> scenario.behavior.safetyMargin >> scenario.behavior.reserveDistanceFactor);
+        } else if (key == "turns") {
+            valid = static_cast<bool>(values >> scenario.behavior.minNbOfTurns >> scenario.behavior.maxNbOfTurns);
+        } else if (key == "priorities") {
+            valid = static_cast<bool>(values >> scenario.behavior.minPriority >> scenario.behavior.maxPriority);
+        } else if (key == "metrics") {
+            valid = static_cast<bool>(values >> scenario.metricsPeriod);
+        } else if (key == "interlocking") {
+            valid = readInterlocking(values, scenario.interlocking);
+        } else if (key == "loco") {
+            LocoConfig config;
+            config.line = line;
+            valid = static_cast<bool>(values >> config.number >> config.speed);
+            scenario.locos.push_back(config);
+        } else if (loco == nullptr && (key == "route" || key == "start" || key == "station" ||
+                                       key == "sectionSwitch" || key == "writtenForward")) {
+            errors.push_back(lineError(line, "'" + key + "' before any 'loco'"));
+            continue;
+        } else if (key == "route") {
+            int contact;
+            loco->contacts.clear();
+            while (values >> contact) {
+                loco->contacts.push_back(contact);
+            }
+            valid = values.eof() && !loco->contacts.empty();
+        } else if (key == "start") {
+            valid = static_cast<bool>(values >> loco->contactBehind >> loco->contactInFront);
+        } else if (key == "station") {
+            valid = static_cast<bool>(values >> loco->station);
+        } else if (key == "sectionSwitch") {
+            std::pair<int, int> direction;
+            valid = (values >> direction.first) && readDirection(values, direction.second);
+            loco->sectionDirections.push_back(direction);
+        } else if (key == "writtenForward") {
+            std::string word;
+            valid = (values >> word) && (word == "true" || word == "false");
+            loco->isWrittenForward = word == "true";
+        } else {
+            errors.push_back(lineError(line, "unknown key '" + key + "'"));
+            continue;
+        }
+
+        // Une ligne ne doit contenir que les valeurs attendues
+        std::string extra;
+        if (!valid || (values.clear(), values >> extra)) {
+            errors.push_back(lineError(line, "invalid values for '" + key + "'"));
+        }
+    }
+
+    scenario.validate(errors);
+
+    if (!errors.empty()) {
+        std::string message = "Invalid scenario " + fileName + ":";
+        for (const std::string& error : errors) {
+            message += "\n  " + error;
+        }
+        throw std::runtime_error(message);
+    }
+
+    return scenario;
+}
+
+void Scenario::validate(std::vector<std::string>& errors) const {
+    if (layout.empty()) {
+        errors.push_back("missing 'layout'");
+    }
+
+    std::set<int> switchNumbers;
+    for (const auto& position : switches) {
+        if (position.first <= 0 || position.first > MAX_AIGUILLAGES) {
+            errors.push_back("invalid switch number " + std::to_string(position.first));
+        } else if (!switchNumbers.insert(position.first).second) {
+            errors.push_back("switch " + std::to_string(position.first) + " is set twice");
+        }
+    }
+
+    if (entrance < 0 || exit < 0) {
+        errors.push_back("missing 'section'");
+    } else if (entrance == exit) {
+        errors.push_back("the shared section entrance and exit are the same contact");
+    }
+
+    if (behavior.accessBuffer <= 0 || behavior.outgoingBuffer <= 0) {
+        errors.push_back("the buffers must be positive");
+    } else if (behavior.incomingBuffer <= behavior.accessBuffer) {
+        errors.push_back("the incoming buffer must be larger than the access buffer");
+    }
+    if (behavior.safetyMargin <= 0.0) {
+        errors.push_back("the safety margin must be positive");
+    }
+    if (behavior.reserveDistanceFactor <= 1.0) {
+        errors.push_back("the reserve distance factor must be larger than 1");
+    }
+    if (behavior.minNbOfTurns <= 0 || behavior.minNbOfTurns > behavior.maxNbOfTurns) {
+        errors.push_back("invalid turn range");
+    }
+    if (behavior.minPriority > behavior.maxPriority) {
+        errors.push_back("invalid priority range");
+    }
+    if (metricsPeriod < 0) {
+        errors.push_back("the metrics period must be positive or zero");
+    }
+
+    if (locos.empty()) {
+        errors.push_back("no 'loco'");
+    }
+
+    std::set<int> numbers;
+    for (const LocoConfig& loco : locos) {
+        auto error = [&errors, &loco](const std::string& message) {
+            errors.push_back(lineError(loco.line, "loco " + std::to_string(loco.number) + ": " + message));
+        };
+
+        if (loco.number < 0 || loco.number > MAX_LOCOS) {
+            error("invalid number");
+        } else if (!numbers.insert(loco.number).second) {
+            error("number already used");
+        }
+        if (loco.speed <= 0) {
+            error("the speed must be positive");
+        }
+
+        if (loco.contacts.empty()) {
+            error("missing 'route'");
+            continue;
+        }
+
+        std::set<int> contacts(loco.contacts.begin(), loco.contacts.end());
+        if (contacts.size() != loco.contacts.size()) {
+            error("a contact appears twice in the route");
+        }
+        if (!contains(loco.contacts, entrance) || !contains(loco.contacts, exit)) {
+            error("the route does not go through the shared section");
+        }
+        if (loco.contactBehind < 0) {
+            error("missing 'start'");
+        } else if (!contains(loco.contacts, loco.contactBehind) || !contains(loco.contacts, loco.contactInFront)) {
+            error("the start contacts are not in the route");
+        }
+        if (loco.station < 0) {
+            error("missing 'station'");
+        } else if (!contains(loco.contacts, loco.station)) {
+            error("the station is not in the route");
+        }
+        if (loco.sectionDirections.empty()) {
+            error("missing 'sectionSwitch'");
+        }
+    }
+}
+
+void Scenario::apply() const {
+    selection_maquette(layout.c_str());
+
+    for (const auto& position : switches) {
+        diriger_aiguillage(position.first, position.second, 0);
+    }
+
+    // Les positions initiales sont appliquées quelle que soit la politique, les locos n'étant pas encore posées
+    fixer_enclenchement(interlocking);
+}
+
+std::unique_ptr<ScenarioInstance> Scenario::instantiate(unsigned int runSeed) const {
+    auto instance = std::make_unique<ScenarioInstance>();
+
+    // On remarque qu'on doit mettre celui qui est devant en premier dans les paramètres de fixerPosition
+    for (const LocoConfig& config : locos) {
+        instance->locomotives.push_back(std::make_unique<Locomotive>(config.number, config.speed));
+        instance->locomotives.back()->fixerPosition(config.contactInFront, config.contactBehind);
+    }
+
+    // Les mesures sont toujours relevées, seul leur affichage périodique est optionnel
+    std::vector<int> numbers;
+    for (const LocoConfig& config : locos) {
+        numbers.push_back(config.number);
+    }
+    instance->metrics = std::make_shared<SyncMetrics>(numbers);
+    if (metricsPeriod > 0) {
+        instance->metricsReporter = std::make_unique<MetricsReporter>(instance->metrics, metricsPeriod);
+    }
+
+    instance->sharedSection = std::make_shared<SharedSection>(instance->metrics);
+    instance->sharedStation = std::make_shared<SharedStation>(locos.size(), instance->sharedSection, instance->metrics);
+
+    LocomotiveBehavior::setRunSeed(runSeed);
+
+    // Les comportements vérifient les positions de départ, de la section et de la station
+    for (std::size_t i = 0; i < locos.size(); ++i) {
+        const LocoConfig& config = locos[i];
+        instance->behaviors.push_back(std::make_unique<LocomotiveBehavior>(
+            *instance->locomotives[i], instance->sharedSection, config.sectionDirections,
+            config.isWrittenForward, config.contacts, entrance, exit,
+            config.contactBehind, config.contactInFront, config.station, instance->sharedStation, behavior));
+    }
+
+    return instance;
+}
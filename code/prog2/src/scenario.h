@@ -0,0 +1,174 @@
+//    ___  _________    ___  ___  ___ ____ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  / / / //
+//  / ___/ /__/ /_/ / / __// // / __/_  _/ //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+// ==========================================================
+// Fichier : scenario.h
+// Description : Description d'un scénario (maquette, aiguillages,
+//               section partagée et locomotives) lue depuis un
+//               fichier, et construction des objets de la
+//               simulation à partir de celle-ci.
+// ==========================================================
+
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ctrain_handler.h"
+#include "launchable.h"
+#include "locomotive.h"
+#include "locomotivebehavior.h"
+#include "sharedsectioninterface.h"
+#include "sharedstation.h"
+#include "syncmetrics.h"
+
+/**
+ * @brief La structure LocoConfig décrit une locomotive du scénario et son parcours
+ */
+struct LocoConfig {
+    int number{-1};
+    int speed{0};
+    std::vector<int> contacts;
+    int contactBehind{-1};
+    int contactInFront{-1};
+    int station{-1};
+    std::vector<std::pair<int, int>> sectionDirections;
+    bool isWrittenForward{true};
+
+    /**
+     * @brief line Ligne du fichier où la locomotive est déclarée, pour les messages d'erreur
+     */
+    int line{0};
+};
+
+/**
+ * @brief La structure ScenarioInstance regroupe les objets construits à partir d'un scénario.
+ * Les comportements référencent les locomotives : l'instance doit vivre tant que les threads tournent
+ */
+struct ScenarioInstance {
+    std::vector<std::unique_ptr<Locomotive>> locomotives;
+    std::shared_ptr<SharedSectionInterface> sharedSection;
+    std::shared_ptr<SharedStation> sharedStation;
+    std::vector<std::unique_ptr<Launchable>> behaviors;
+    std::shared_ptr<SyncMetrics> metrics;
+
+    /**
+     * @brief metricsReporter Thread d'affichage des mesures, nullptr si l'affichage périodique est désactivé
+     */
+    std::unique_ptr<MetricsReporter> metricsReporter;
+};
+
+/**
+ * @brief La classe Scenario décrit une configuration complète de la simulation, lue depuis un fichier
+ * texte. Chaque ligne contient un mot-clé suivi de ses valeurs, # commence un commentaire :
+ *
+ *     layout MAQUET_A              maquette à charger (nom, ou chemin de son fichier)
+ *     seed 42                      graine de la simulation (optionnelle, sinon celle du simulateur)
+ *     switch 14 DEVIE              position initiale d'un aiguillage (DEVIE ou TOUT_DROIT)
+ *     section 33 24                contacts d'entrée et de sortie de la section partagée
+ *     buffers 2 1 1                buffers d'entrée, d'accès et de sortie de la section (optionnel)
+ *     reservation 100 2            marge de sécurité en mm, et rapport des distances de requête et d'accès (optionnel)
+ *     turns 1 10                   nombres minimal et maximal de tours entre deux arrêts en gare (optionnel)
+ *     priorities 0 10              priorités minimale et maximale des locomotives (optionnel)
+ *     metrics 60                   période d'affichage des mesures en secondes, 0 pour le désactiver (optionnel)
+ *     interlocking defer           sort d'une commande d'aiguillage occupé : apply, refuse ou defer (optionnel)
+ *     loco 0 15                    numéro et vitesse d'une locomotive ; les lignes suivantes la décrivent
+ *     route 15 16 23 24 22 ...     contacts du parcours de la locomotive
+ *     start 14 7                   contacts derrière et devant la locomotive au démarrage
+ *     station 6                    contact de la station de la locomotive
+ *     sectionSwitch 14 DEVIE       direction d'un aiguillage de la section partagée pour cette locomotive
+ *     writtenForward false         sens de rédaction de la section partagée dans le parcours
+ *
+ * Le fichier est validé en une passe : toutes les erreurs sont rapportées ensemble, avec leur ligne.
+ * Les contraintes qui dépendent de la géométrie du parcours (buffers, distance entre les contacts de
+ * départ) sont vérifiées par LocomotiveBehavior lors de la construction, avant le lancement des threads.
+ */
+class Scenario {
+public:
+    /**
+     * @brief load Lit et valide un scénario
+     * @param fileName le fichier du scénario
+     * @return le scénario
+     * @throw std::runtime_error si le fichier ne peut pas être lu ou n'est pas valide,
+     * avec la liste des erreurs
+     */
+    static Scenario load(const std::string& fileName);
+
+    /**
+     * @brief apply Sélectionne la maquette, place les aiguillages et fixe la politique d'enclenchement
+     */
+    void apply() const;
+
+    /**
+     * @brief instantiate Construit les locomotives, la section partagée, la station et les comportements
+     * @param runSeed la graine de la simulation, dont sont dérivés les générateurs des locomotives
+     * @return les objets construits, dont les threads ne sont pas lancés
+     * @throw std::runtime_error si un parcours n'est pas valide
+     */
+    std::unique_ptr<ScenarioInstance> instantiate(unsigned int runSeed) const;
+
+    /**
+     * @brief layout La maquette
+     */
+    std::string layout;
+
+    /**
+     * @brief hasSeed true si le scénario fixe la graine de la simulation
+     */
+    bool hasSeed{false};
+
+    /**
+     * @brief seed La graine de la simulation
+     */
+    unsigned int seed{0};
+
+    /**
+     * @brief switches Les positions initiales des aiguillages
+     */
+    std::vector<std::pair<int, int>> switches;
+
+    /**
+     * @brief entrance Le contact d'entrée de la section partagée
+     */
+    int entrance{-1};
+
+    /**
+     * @brief exit Le contact de sortie de la section partagée
+     */
+    int exit{-1};
+
+    /**
+     * @brief behavior Les réglages du comportement des locomotives
+     */
+    BehaviorSettings behavior;
+
+    /**
+     * @brief metricsPeriod La période d'affichage des mesures de la section et de la station, en secondes
+     */
+    int metricsPeriod{60};
+
+    /**
+     * @brief interlocking La politique d'enclenchement des aiguillages (voir fixer_enclenchement)
+     */
+    int interlocking{ENCLENCHEMENT_APPLIQUER};
+
+    /**
+     * @brief locos Les locomotives
+     */
+    std::vector<LocoConfig> locos;
+
+private:
+    /**
+     * @brief validate Vérifie la cohérence du scénario
+     * @param errors la liste à laquelle ajouter les erreurs
+     */
+    void validate(std::vector<std::string>& errors) const;
+};
+
+#endif // SCENARIO_H
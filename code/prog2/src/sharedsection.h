@@ -23,7 +23,12 @@
 
 #include "locomotive.h"
 #include "ctrain_handler.h"
+#include "profilverrous.h"
 #include "sharedsectioninterface.h"
+#include "syncmetrics.h"
+
+// Point de synchronisation du mutex de la section partagée (voir attendre_tour)
+#define SYNC_POINT_SHARED_SECTION 1
 
 /**
  * @brief La classe SharedSection implémente l'interface SharedSectionInterface qui
@@ -35,10 +40,11 @@ public:
     /**
      * @brief SharedSection Constructeur de la classe qui représente la section partagée.
      * Initialisez vos éventuels attributs ici, sémaphores etc.
+     * @param metrics Les mesures de la section, nullptr pour ne pas mesurer
      */
-    SharedSection() : mode(PriorityMode::HIGH_PRIORITY),
-                    occupied(false), semaphore(1), mutex(), 
-                    waitingSemaphore(0) {}
+    SharedSection(std::shared_ptr<SyncMetrics> metrics = nullptr) : mode(PriorityMode::HIGH_PRIORITY),
+                    occupied(false), semaphore("SharedSection.semaphore", 1), mutex("SharedSection.mutex"),
+                    waitingSemaphore("SharedSection.waitingSemaphore", 0), metrics(metrics) {}
 
     /**
      * @brief request Méthode a appeler pour indiquer que la locomotive désire accéder à la
@@ -50,7 +56,7 @@ public:
      */
    void request(Locomotive& loco, int locoId, int priority) override {
         // On va modifier la file d'attente, on doit donc verrouiller le mutex
-        mutex.lock();
+        lockMutex();
 
         // Vérifie si la locomotive a déjà fait une demande (elle ne devrait pas, mais on ne sait jamais)
         auto it = std::find_if(requestQueue.begin(), requestQueue.end(),
@@ -59,6 +65,9 @@ public:
         if (it == requestQueue.end()) { // Si la locomotive n'a pas encore fait de demande, c'est donc le cas normal
             // Ajoute la demande dans la file
             requestQueue.push_back({priority, locoId});
+            if (metrics) {
+                metrics->requested(locoId, requestQueue.size());
+            }
             loco.afficherMessage(QString("Locomotive %1 asked for the shared section with a priority of %2.")
                                      .arg(locoId)
                                      .arg(priority));
@@ -88,13 +97,14 @@ public:
         // On mémorise la vitesse actuelle de la locomotive au cas où elle devrait s'arrêter
         int vitesse = loco.vitesse();
 
-        // On mémorise si la locomotive a dû s'arrêter
+        // On mémorise si la locomotive a dû s'arrêter, et depuis quand
         bool hadToStop = false;
+        qint64 stopTime = 0;
 
         // Tant que la locomotive ne peut pas accéder à la section partagée
         while (!canContinue) {
             // Vu qu'on va modifier la file d'attente, on doit verrouiller le mutex
-            mutex.lock();
+            lockMutex();
 
             // Vérifie si la file d'attente est vide. Elle ne devrait pas l'être, 
             // vu qu'au moins la locomotive actuelle devrait être dedans
@@ -112,6 +122,7 @@ public:
                     loco.fixerVitesse(0);
                     // On mémorise qu'on a dû arrêter la locomotive
                     hadToStop = true;
+                    stopTime = SyncMetrics::now();
                 }
                 // On attend que la section partagée soit libérée et qu'on nous réveille
                 waitingSemaphore.acquire();
@@ -120,6 +131,9 @@ public:
                 occupied = true;
                 // On retire notre demande de la file
                 requestQueue.erase(requestQueue.begin());
+                if (metrics) {
+                    metrics->accessGranted(loco.numero(), requestQueue.size());
+                }
                 // On ne gère plus que des variables locales, on peut donc déverrouiller le mutex
                 mutex.unlock();
                 // On mémorise qu'on peut sortir de la boucle
@@ -127,6 +141,9 @@ public:
                 // Si on a dû arrêter la locomotive, on la redémarre
                 if(hadToStop) {
                     loco.fixerVitesse(vitesse);
+                    if (metrics) {
+                        metrics->stopped(loco.numero(), SyncMetrics::now() - stopTime);
+                    }
                 }
                 // On accède à la section partagée
                 semaphore.acquire();
@@ -142,9 +159,12 @@ public:
      */
     void leave(Locomotive& loco) override {
         // On se réserve le droit de modifier les variables partagées
-        mutex.lock();
+        lockMutex();
         // On a quitte la section partagée
         occupied = false;
+        if (metrics) {
+            metrics->left();
+        }
 
         // On mémorise la taille de la queue afin de ne pas avoir à la recalculer à chaque itération
         int size = requestQueue.size();
@@ -163,7 +183,7 @@ public:
     }
 
     void togglePriorityMode() {
-        mutex.lock();
+        lockMutex();
         // Change le mode de priorité
         mode = (mode == PriorityMode::HIGH_PRIORITY) ? PriorityMode::LOW_PRIORITY : PriorityMode::HIGH_PRIORITY;
         // Trie la file d'attente (normalement, on ne devrait pas avoir de locomotives en attente)
@@ -175,6 +195,16 @@ public:
 
 private:
 
+    /**
+     * @brief lockMutex Verrouille le mutex. L'ordre dans lequel les locomotives obtiennent le mutex
+     * décide de l'accès à la section partagée : il est enregistré avec la trace, et imposé lors d'un rejeu
+     */
+    void lockMutex() {
+        attendre_tour(SYNC_POINT_SHARED_SECTION);
+        mutex.lock();
+        consigner_decision(SYNC_POINT_SHARED_SECTION);
+    }
+
     void sortRequestQueue() {
         // Trie la file par priorité décroissante si le mode est HIGH_PRIORITY, sinon par priorité croissante
         // De la sorte, on pourra retirer l'élément le plus prioritaire de la file en retirant l'élément au début
@@ -196,17 +226,17 @@ private:
     /**
      * @brief semaphore Sémaphore pour gérer l'accès à la section partagée
      */
-    PcoSemaphore semaphore;
+    SemaphoreInstrumente<PcoSemaphore> semaphore;
 
     /**
      * @brief waitingSemaphore Sémaphore pour gérer l'attente des locomotives
      */
-    PcoSemaphore waitingSemaphore;
+    SemaphoreInstrumente<PcoSemaphore> waitingSemaphore;
 
     /**
      * @brief mutex Mutex pour protéger l'accès à occupied et requestQueue
      */
-    PcoMutex mutex;
+    MutexInstrumente<PcoMutex> mutex;
 
     /**
      * @brief occupied Indique si la section partagée est occupée (dont si l'accès a déjà été donné à une locomotive)
@@ -222,6 +252,11 @@ private:
      * @brief requestQueue File d'attente des requêtes pour la section partagée
      */
     std::deque<std::pair<int, int>> requestQueue;
+
+    /**
+     * @brief metrics Mesures de la section, nullptr si elle n'est pas mesurée
+     */
+    std::shared_ptr<SyncMetrics> metrics;
 };
 
 
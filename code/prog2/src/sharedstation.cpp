@@ -15,17 +15,25 @@
 #include <chrono>
 #include <thread>
 
+#include "ctrain_handler.h"
 #include "sharedstation.h"
 
-SharedStation::SharedStation(int nbTrains, std::shared_ptr<SharedSectionInterface> sharedSection)
-                : nbTrains(nbTrains), trainsAtStation(0), stationSemaphore(0), 
-                  stationMutex(), sharedSection(sharedSection) {
+SharedStation::SharedStation(int nbTrains, std::shared_ptr<SharedSectionInterface> sharedSection,
+                             std::shared_ptr<SyncMetrics> metrics)
+                : nbTrains(nbTrains), trainsAtStation(0), stationSemaphore("SharedStation.semaphore", 0),
+                  stationMutex("SharedStation.mutex"), sharedSection(sharedSection), metrics(metrics) {
 
 }
 
-void SharedStation::trainArrived() {
+void SharedStation::trainArrived(int locoId) {
+    // L'attente est mesurée de l'arrivée du train à son départ
+    qint64 arrivalTime = SyncMetrics::now();
+
     // Quand un train arrive, on réserve le droit de modification de la variable trainsAtStation
+    // L'ordre d'arrivée décide du train qui attend les autres : il est enregistré, et imposé lors d'un rejeu
+    attendre_tour(SYNC_POINT_STATION);
     stationMutex.lock();
+    consigner_decision(SYNC_POINT_STATION);
     ++trainsAtStation;
     if(trainsAtStation == nbTrains) { // Si tous les trains sont arrivés
         // On inverse le mode de priorité
@@ -49,4 +57,8 @@ void SharedStation::trainArrived() {
         // On attend que le reste des trains arrive
         stationSemaphore.acquire();
     }
+
+    if (metrics) {
+        metrics->barrierWaited(locoId, SyncMetrics::now() - arrivalTime);
+    }
 }
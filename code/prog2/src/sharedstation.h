@@ -14,6 +14,9 @@
 
 #include "sharedsection.h"
 
+// Point de synchronisation du mutex de la station (voir attendre_tour)
+#define SYNC_POINT_STATION 2
+
 /**
  * @brief La classe SharedStation représente un moyen de coordiner 
  * l'arrivée de plusieurs trains à leur station respective
@@ -24,13 +27,16 @@ public:
     /**
      * @brief SharedStation Constructeur de la classe SharedStation
      * @param nbTrains Le nombre de trains qui doivent arriver à la station
+     * @param metrics Les mesures de la station, nullptr pour ne pas mesurer
      */
-    SharedStation(int nbTrains, std::shared_ptr<SharedSectionInterface> sharedSection);
+    SharedStation(int nbTrains, std::shared_ptr<SharedSectionInterface> sharedSection,
+                  std::shared_ptr<SyncMetrics> metrics = nullptr);
 
     /**
      * @brief trainArrived Méthode à appeler lorsqu'un train arrive à la station
+     * @param locoId Le numéro de la locomotive du train
      */
-    void trainArrived();
+    void trainArrived(int locoId);
 
 private:
     /**
@@ -46,12 +52,12 @@ private:
     /**
      * @brief stationMutex Mutex pour protéger la variable trainsAtStation
      */
-    PcoMutex stationMutex;
+    MutexInstrumente<PcoMutex> stationMutex;
 
     /**
      * @brief stationSemaphore Sémaphore pour attendre que tous les trains soient arrivés à la station
      */
-    PcoSemaphore stationSemaphore;
+    SemaphoreInstrumente<PcoSemaphore> stationSemaphore;
 
     /**
      * @brief sharedSection La section partagée pour laquelle on doit changer la priorité 
@@ -59,6 +65,11 @@ private:
      */
     std::shared_ptr<SharedSectionInterface> sharedSection;
 
+    /**
+     * @brief metrics Mesures de la station, nullptr si elle n'est pas mesurée
+     */
+    std::shared_ptr<SyncMetrics> metrics;
+
 };
 
 #endif // SHARED_STATION_H
\ No newline at end of file
@@ -0,0 +1,153 @@
+//    ___  _________    ___  ___  ___ ____ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  / / / //
+//  / ___/ /__/ /_/ / / __// // / __/_  _/ //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+// ==========================================================
+// Fichier : syncmetrics.cpp
+// Description : Implémentation des mesures de la section
+//               partagée et de la station.
+// ==========================================================
+
+#include <chrono>
+#include <thread>
+
+#include "ctrain_handler.h"
+#include "syncmetrics.h"
+
+SyncMetrics::SyncMetrics(const std::vector<int>& locoNumbers) : start(now()), lastDepthChange(start) {
+    for (int number : locoNumbers) {
+        locos[number] = std::make_unique<LocoMetrics>();
+    }
+}
+
+qint64 SyncMetrics::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+SyncMetrics::LocoMetrics* SyncMetrics::loco(int locoId) const {
+    // La table n'est plus modifiée après la construction : la lire ne demande pas de verrou
+    auto it = locos.find(locoId);
+    return it == locos.end() ? nullptr : it->second.get();
+}
+
+void SyncMetrics::queueChanged(std::size_t queueSize) {
+    qint64 time = now();
+    depth.enregistrer(qint64(lastDepth), quint64(time - lastDepthChange));
+    lastDepth = queueSize;
+    lastDepthChange = time;
+}
+
+void SyncMetrics::requested(int locoId, std::size_t queueSize) {
+    queueChanged(queueSize);
+    if (LocoMetrics* metrics = loco(locoId)) {
+        metrics->requestTime = now();
+    }
+}
+
+void SyncMetrics::accessGranted(int locoId, std::size_t queueSize) {
+    queueChanged(queueSize);
+    qint64 time = now();
+    occupiedSince = time;
+    if (LocoMetrics* metrics = loco(locoId)) {
+        qint64 requestTime = metrics->requestTime.exchange(-1);
+        if (requestTime >= 0) {
+            metrics->requestToAccess.enregistrer(time - requestTime);
+        }
+    }
+}
+
+void SyncMetrics::stopped(int locoId, qint64 duration) {
+    if (LocoMetrics* metrics = loco(locoId)) {
+        metrics->timeStopped.enregistrer(duration);
+    }
+}
+
+void SyncMetrics::left() {
+    qint64 since = occupiedSince.exchange(-1);
+    if (since >= 0) {
+        occupiedTotal += now() - since;
+    }
+}
+
+void SyncMetrics::barrierWaited(int locoId, qint64 duration) {
+    if (LocoMetrics* metrics = loco(locoId)) {
+        metrics->barrierWait.enregistrer(duration);
+    }
+}
+
+const Histogramme* SyncMetrics::requestToAccess(int locoId) const {
+    LocoMetrics* metrics = loco(locoId);
+    return metrics == nullptr ? nullptr : &metrics->requestToAccess;
+}
+
+const Histogramme* SyncMetrics::timeStopped(int locoId) const {
+    LocoMetrics* metrics = loco(locoId);
+    return metrics == nullptr ? nullptr : &metrics->timeStopped;
+}
+
+const Histogramme* SyncMetrics::barrierWait(int locoId) const {
+    LocoMetrics* metrics = loco(locoId);
+    return metrics == nullptr ? nullptr : &metrics->barrierWait;
+}
+
+const Histogramme& SyncMetrics::queueDepth() const {
+    return depth;
+}
+
+double SyncMetrics::occupancy() const {
+    qint64 time = now();
+    qint64 occupied = occupiedTotal;
+    qint64 since = occupiedSince;
+    if (since >= 0) {
+        occupied += time - since;
+    }
+    return time > start ? double(occupied) / double(time - start) : 0.0;
+}
+
+QString SyncMetrics::report() const {
+    QString text = QString("Shared section: occupancy %1 %, queue depth (time-weighted) mean %2, max %3")
+                       .arg(occupancy() * 100.0, 0, 'f', 1)
+                       .arg(depth.getMoyenne(), 0, 'f', 2)
+                       .arg(depth.getMax());
+
+    // Les durées sont affichées en ms
+    for (const auto& entry : locos) {
+        text += QString("\nLoco %1\n  request to access: %2\n  stopped:           %3\n  station wait:      %4")
+                    .arg(entry.first)
+                    .arg(entry.second->requestToAccess.resume(1000.0, "ms"))
+                    .arg(entry.second->timeStopped.resume(1000.0, "ms"))
+                    .arg(entry.second->barrierWait.resume(1000.0, "ms"));
+    }
+    return text;
+}
+
+MetricsReporter::MetricsReporter(std::shared_ptr<SyncMetrics> metrics, int period)
+    : metrics(metrics), period(period) {}
+
+void MetricsReporter::stop() {
+    stopped = true;
+}
+
+void MetricsReporter::run() {
+    // On attend par petits pas, pour que stop() soit pris en compte rapidement
+    const auto step = std::chrono::milliseconds(100);
+    auto next = std::chrono::steady_clock::now() + std::chrono::seconds(period);
+    while (!stopped) {
+        std::this_thread::sleep_for(step);
+        if (std::chrono::steady_clock::now() >= next) {
+            afficher_message(qPrintable(metrics->report()));
+            next += std::chrono::seconds(period);
+        }
+    }
+}
+
+void MetricsReporter::printStartMessage() {
+    qDebug() << "[START] Metrics thread launched";
+}
+
+void MetricsReporter::printCompletionMessage() {
+    qDebug() << "[STOP] Metrics thread correctly stopped";
+}
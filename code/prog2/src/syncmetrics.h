@@ -0,0 +1,203 @@
+//    ___  _________    ___  ___  ___ ____ //
+//   / _ \/ ___/ __ \  |_  |/ _ \|_  / / / //
+//  / ___/ /__/ /_/ / / __// // / __/_  _/ //
+// /_/   \___/\____/ /____/\___/____//_/   //
+//                                         //
+
+// ==========================================================
+// Fichier : syncmetrics.h
+// Description : Mesures de la section partagée et de la station
+//               (attentes, occupation, file d'attente), et thread
+//               qui les affiche périodiquement.
+// ==========================================================
+
+#ifndef SYNCMETRICS_H
+#define SYNCMETRICS_H
+
+#include <QString>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "histogramme.h"
+#include "launchable.h"
+
+/**
+ * @brief La classe SyncMetrics relève les mesures de la section partagée et de la station.
+ * Pour chaque locomotive : le temps entre sa demande et l'accès à la section, le temps passé
+ * arrêtée devant la section et l'attente à la station. Pour la section : la fraction du temps
+ * où elle est occupée et la longueur de la file d'attente, pondérée par sa durée.
+ *
+ * Les durées sont en µs de temps réel. Les histogrammes sont sans verrou : les mesures peuvent
+ * rester actives en permanence, et être lues pendant la simulation depuis n'importe quel thread.
+ */
+class SyncMetrics {
+public:
+    /**
+     * @brief SyncMetrics Constructeur
+     * @param locoNumbers les numéros des locomotives mesurées, les autres sont ignorées
+     */
+    explicit SyncMetrics(const std::vector<int>& locoNumbers);
+
+    /**
+     * @brief now Retourne l'instant actuel, en µs, pour les mesures
+     */
+    static qint64 now();
+
+    /**
+     * @brief requested Note la demande d'accès à la section d'une locomotive
+     * @param locoId la locomotive
+     * @param queueSize la longueur de la file d'attente, demande comprise.
+     * A appeler avec le mutex de la section verrouillé
+     */
+    void requested(int locoId, std::size_t queueSize);
+
+    /**
+     * @brief accessGranted Note l'accès à la section d'une locomotive
+     * @param locoId la locomotive
+     * @param queueSize la longueur de la file d'attente, demande retirée.
+     * A appeler avec le mutex de la section verrouillé
+     */
+    void accessGranted(int locoId, std::size_t queueSize);
+
+    /**
+     * @brief stopped Note le temps passé arrêtée devant la section par une locomotive
+     * @param locoId la locomotive
+     * @param duration la durée, en µs
+     */
+    void stopped(int locoId, qint64 duration);
+
+    /**
+     * @brief left Note la libération de la section
+     */
+    void left();
+
+    /**
+     * @brief barrierWaited Note l'attente d'une locomotive à la station
+     * @param locoId la locomotive
+     * @param duration la durée, en µs
+     */
+    void barrierWaited(int locoId, qint64 duration);
+
+    /**
+     * @brief requestToAccess Temps entre la demande et l'accès à la section, en µs
+     * @return l'histogramme de la locomotive, nullptr si elle n'est pas mesurée
+     */
+    const Histogramme* requestToAccess(int locoId) const;
+
+    /**
+     * @brief timeStopped Temps passé arrêtée devant la section, en µs
+     * @return l'histogramme de la locomotive, nullptr si elle n'est pas mesurée
+     */
+    const Histogramme* timeStopped(int locoId) const;
+
+    /**
+     * @brief barrierWait Attente à la station, en µs
+     * @return l'histogramme de la locomotive, nullptr si elle n'est pas mesurée
+     */
+    const Histogramme* barrierWait(int locoId) const;
+
+    /**
+     * @brief queueDepth Longueur de la file d'attente de la section, chaque valeur étant
+     * pondérée par sa durée en µs
+     */
+    const Histogramme& queueDepth() const;
+
+    /**
+     * @brief occupancy Fraction du temps où la section est occupée, depuis la construction
+     */
+    double occupancy() const;
+
+    /**
+     * @brief report Résumé des mesures, sur plusieurs lignes
+     */
+    QString report() const;
+
+private:
+    struct LocoMetrics {
+        Histogramme requestToAccess;
+        Histogramme timeStopped;
+        Histogramme barrierWait;
+
+        /**
+         * @brief requestTime Instant de la demande en cours, -1 sinon
+         */
+        std::atomic<qint64> requestTime{-1};
+    };
+
+    /**
+     * @brief loco Retourne les mesures d'une locomotive, nullptr si elle n'est pas mesurée
+     */
+    LocoMetrics* loco(int locoId) const;
+
+    /**
+     * @brief queueChanged Pondère la longueur précédente de la file par sa durée
+     */
+    void queueChanged(std::size_t queueSize);
+
+    /**
+     * @brief locos Les mesures par locomotive, fixées à la construction
+     */
+    std::map<int, std::unique_ptr<LocoMetrics>> locos;
+
+    /**
+     * @brief start Instant du début des mesures
+     */
+    const qint64 start;
+
+    /**
+     * @brief occupiedTotal Durée d'occupation de la section, hors occupation en cours
+     */
+    std::atomic<qint64> occupiedTotal{0};
+
+    /**
+     * @brief occupiedSince Début de l'occupation en cours, -1 si la section est libre
+     */
+    std::atomic<qint64> occupiedSince{-1};
+
+    /**
+     * @brief depth Longueurs de la file d'attente, pondérées par leur durée
+     */
+    Histogramme depth;
+
+    /**
+     * @brief lastDepth, lastDepthChange Longueur de la file et instant de son dernier changement,
+     * protégés par le mutex de la section
+     */
+    std::size_t lastDepth{0};
+    qint64 lastDepthChange;
+};
+
+/**
+ * @brief La classe MetricsReporter affiche périodiquement les mesures dans la console
+ */
+class MetricsReporter : public Launchable {
+public:
+    /**
+     * @brief MetricsReporter Constructeur
+     * @param metrics les mesures à afficher
+     * @param period la période d'affichage, en secondes
+     */
+    MetricsReporter(std::shared_ptr<SyncMetrics> metrics, int period);
+
+    /**
+     * @brief stop Termine le thread après l'affichage en cours
+     */
+    void stop();
+
+protected:
+    void run() override;
+
+    void printStartMessage() override;
+
+    void printCompletionMessage() override;
+
+private:
+    std::shared_ptr<SyncMetrics> metrics;
+    int period;
+    std::atomic<bool> stopped{false};
+};
+
+#endif // SYNCMETRICS_H